@@ -42,14 +42,14 @@
 //! \param[in] class_name Name of the application to run inheriting from mango::application.
 //! \return 0 on success, 1 else.
 #define MANGO_DEFINE_APPLICATION_MAIN(class_name)                    \
-    int main(int, char**)                                            \
+    int main(int argc, char** argv)                                  \
     {                                                                \
         shared_ptr<class_name> app = std::make_shared<class_name>(); \
         weak_ptr<context> c        = app->get_context();             \
         if (auto sp = c.lock())                                      \
         {                                                            \
             sp->set_application(app);                                \
-            return app->run();                                       \
+            return app->run(static_cast<mango::uint32>(argc), argv); \
         }                                                            \
         MANGO_LOG_CRITICAL("Context is expired");                    \
         std::cin.get();                                              \
@@ -80,6 +80,18 @@ namespace mango
 
         //! \brief Runs the application.
         //! \details This includes the application loop that runs until the termination.
+        //! All arguments are parsed once before the loop, unknown ones are logged and ignored.
+        //! The argument "--frames <n>" ends the loop after n frames, this can be used for automated rendering and benchmarks.
+        //! Afterwards the gbuffer size and the average timings of all passes are logged.
+        //! The argument "--trace <path>" writes the recorded profiling zones to a chrome trace file when the loop ends.
+        //! The argument "--screenshot <path>" writes the last rendered frame to a png file.
+        //! The arguments "--model <path>" and "--environment <path>" load a gltf model and a hdr environment into the current \a scene, so something is rendered without interaction.
+        //! The argument "--gbuffer <standard|compact|compact_depth_stencil>" overrides the configured \a gbuffer_layout.
+        //! The arguments "--depth-pre-pass" and "--no-sorting" override the configured ordering of the geometry, "--overdraw" logs the shaded fragments per pixel.
+        //! The argument "--occlusion-culling" enables culling of occluded models and logs the number of culled models.
+        //! The argument "--meshlet-culling" enables culling the meshlets of dense primitives on the gpu.
+        //! The argument "--dynamic-resolution <ms>" scales the resolution to keep the gpu time of a frame below the given milliseconds.
+        //! The argument "--quantize-vertices" interleaves and quantizes the vertex attributes of models loaded into the current \a scene afterwards.
         //! \param[in] argc Number of command line arguments \a argv.
         //! \param[in] argv Command line arguments.
         //! \return 0 on success, else 1.
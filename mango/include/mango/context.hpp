@@ -17,6 +17,13 @@ namespace mango
     class render_system;
     class scene;
 
+    //! \brief The types of resources loaded by mango.
+    enum class resource_type : uint8
+    {
+        image, //!< Images loaded from files.
+        model  //!< Models loaded from gltf files.
+    };
+
     //! \brief Context interface.
     //! \details The context holds shared pointers to the various subsystems of mango.
     //! It can be used to read, create and modify data in mango.
@@ -58,6 +65,17 @@ namespace mango
         //! \details By making a scene current the old scene will be destroyed if no reference is hold by the user.
         //! \return The current scene.
         virtual shared_ptr<scene>& get_current_scene() = 0;
+
+        //! \brief Sets the cpu memory budget for loaded resources.
+        //! \details If the budget is exceeded, the least recently used resources without any reference are released.
+        //! Referenced resources are never released, so the budget can be exceeded temporarily.
+        //! \param[in] budget The memory budget in bytes.
+        virtual void set_resource_memory_budget(ptr_size budget) = 0;
+
+        //! \brief Returns the cpu memory occupied by loaded resources of a specific type.
+        //! \param[in] type The \a resource_type to query the memory for.
+        //! \return The memory in bytes.
+        virtual ptr_size get_resource_memory_usage(resource_type type) = 0;
     };
 } // namespace mango
 
@@ -18,6 +18,7 @@ namespace mango
 #include <mango/context.hpp>
 #include <mango/input_system.hpp>
 #include <mango/log.hpp>
+#include <mango/profile.hpp>
 #include <mango/render_system.hpp>
 #include <mango/scene.hpp>
 #include <mango/system.hpp>
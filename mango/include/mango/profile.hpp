@@ -0,0 +1,83 @@
+//! \file      profile.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_PROFILE_HPP
+#define MANGO_PROFILE_HPP
+
+#include <chrono>
+#include <mango/types.hpp>
+
+namespace mango
+{
+    //! \namespace mango::profile A namespace used to enable cpu profiling capabilities.
+    namespace profile
+    {
+        //! \brief Returns the current time of the profiling clock.
+        //! \return The time in nanoseconds.
+        inline int64 now()
+        {
+            return static_cast<int64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        //! \brief Records a finished zone in the ring buffer of the calling thread.
+        //! \details Each thread keeps the last zones it recorded, older ones get overwritten.
+        //! \param[in] name The name of the zone. Has to stay valid until the zone is written, string literals should be used.
+        //! \param[in] begin The time in nanoseconds the zone started.
+        //! \param[in] end The time in nanoseconds the zone ended.
+        void record_zone(const char* name, int64 begin, int64 end);
+
+        //! \brief Writes all recorded zones of all threads in the chrome trace event format.
+        //! \details The file can be loaded in chrome://tracing or the perfetto ui.
+        //! Zones recorded by other threads while writing may be missing.
+        //! \param[in] path The path of the file to write.
+        //! \return True on success, else false. Failures are logged, success is left to the caller.
+        bool write_chrome_trace(const string& path);
+
+        //! \brief Measures the time from construction to destruction as a zone.
+        class scoped_zone
+        {
+          public:
+            //! \brief Starts the zone.
+            //! \param[in] name The name of the zone. Has to stay valid until the zone is written, string literals should be used.
+            scoped_zone(const char* name)
+                : m_name(name)
+                , m_begin(now())
+            {
+            }
+
+            ~scoped_zone()
+            {
+                record_zone(m_name, m_begin, now());
+            }
+
+          private:
+            //! \brief The name of the zone.
+            const char* m_name;
+            //! \brief The time in nanoseconds the zone started.
+            int64 m_begin;
+        };
+    } // namespace profile
+} // namespace mango
+
+//! \cond NO_DOC
+#define MANGO_PROFILE_CONCAT_IMPL(a, b) a##b
+#define MANGO_PROFILE_CONCAT(a, b) MANGO_PROFILE_CONCAT_IMPL(a, b)
+//! \endcond
+
+#if defined(MANGO_PROFILE) || defined(MANGO_DOCUMENTATION)
+//! \brief Macro to profile the enclosing scope as a zone with a specific name.
+//! \details Zones are only recorded if profiling is enabled.
+#define MANGO_PROFILE_ZONE(name) ::mango::profile::scoped_zone MANGO_PROFILE_CONCAT(mango_profile_zone_, __LINE__)(name)
+#else
+//! \brief Macro to profile the enclosing scope as a zone with a specific name.
+//! \details Zones are only recorded if profiling is enabled.
+#define MANGO_PROFILE_ZONE(name) \
+    do                           \
+    {                            \
+    } while (0)
+#endif // MANGO_PROFILE || MANGO_DOCUMENTATION
+
+#endif // MANGO_PROFILE_HPP
@@ -12,6 +12,7 @@
 #include <mango/context.hpp>
 #include <mango/system.hpp>
 #include <mango/types.hpp>
+#include <vector>
 
 namespace mango
 {
@@ -41,6 +42,17 @@ namespace mango
         number_of_step_types
     };
 
+    //! \brief The layout of the gbuffer of the deferred \a render_pipeline.
+    //! \details The compact layouts cut the bandwidth of the geometry and the lighting pass.
+    //! The normal is octahedral encoded, the emissive color shares a target with the metallic value and no mipmaps are generated for the targets.
+    //! The alpha of the base color is not stored, so everything in the gbuffer is opaque.
+    enum class gbuffer_layout : uint8
+    {
+        standard,             //!< Four color targets and a 32 bit float depth target. 20 bytes per pixel.
+        compact,              //!< Three color targets and a 32 bit float depth target. 16 bytes per pixel.
+        compact_depth_stencil //!< Three color targets and a 24 bit depth target with 8 bit stencil. 16 bytes per pixel.
+    };
+
     //! \brief The configuration for the \a render_system.
     //! \details Should be used to configure the \a render_system in the \a application create() method.
     class render_configuration
@@ -50,6 +62,14 @@ namespace mango
         render_configuration()
             : m_base_pipeline(render_pipeline::default_pbr)
             , m_vsync(true)
+            , m_texture_memory_budget(0)
+            , m_gbuffer_layout(gbuffer_layout::standard)
+            , m_depth_pre_pass(false)
+            , m_front_to_back_sorting(true)
+            , m_overdraw_measurement(false)
+            , m_occlusion_culling(false)
+            , m_meshlet_culling(false)
+            , m_target_frame_time(0.0f)
         {
             std::memset(m_render_steps, 0, render_step::number_of_step_types * sizeof(bool));
         }
@@ -60,6 +80,14 @@ namespace mango
         render_configuration(render_pipeline base_render_pipeline, bool vsync)
             : m_base_pipeline(base_render_pipeline)
             , m_vsync(vsync)
+            , m_texture_memory_budget(0)
+            , m_gbuffer_layout(gbuffer_layout::standard)
+            , m_depth_pre_pass(false)
+            , m_front_to_back_sorting(true)
+            , m_overdraw_measurement(false)
+            , m_occlusion_culling(false)
+            , m_meshlet_culling(false)
+            , m_target_frame_time(0.0f)
         {
             std::memset(m_render_steps, 0, render_step::number_of_step_types * sizeof(bool));
         }
@@ -93,6 +121,88 @@ namespace mango
             return *this;
         }
 
+        //! \brief Sets or changes the gpu memory budget for streamed textures in the \a render_configuration.
+        //! \details Material textures are streamed, if the budget is greater than zero. Else they are always completely resident.
+        //! \param[in] budget The configurated memory budget in MiB.
+        //! \return A reference to the modified \a render_configuration.
+        inline render_configuration& set_texture_memory_budget(uint32 budget)
+        {
+            m_texture_memory_budget = budget;
+            return *this;
+        }
+
+        //! \brief Sets or changes the \a gbuffer_layout of the deferred \a render_pipeline in the \a render_configuration.
+        //! \param[in] layout The configurated \a gbuffer_layout.
+        //! \return A reference to the modified \a render_configuration.
+        inline render_configuration& set_gbuffer_layout(gbuffer_layout layout)
+        {
+            m_gbuffer_layout = layout;
+            return *this;
+        }
+
+        //! \brief Enables or disables the depth pre-pass in the \a render_configuration.
+        //! \details The pre-pass only writes the depth of opaque geometry, so the geometry pass shades each pixel once.
+        //! This pays off for scenes with a lot of overdraw and expensive materials.
+        //! \param[in] enabled True if the depth pre-pass should be rendered, else false.
+        //! \return A reference to the modified \a render_configuration.
+        inline render_configuration& set_depth_pre_pass(bool enabled)
+        {
+            m_depth_pre_pass = enabled;
+            return *this;
+        }
+
+        //! \brief Enables or disables sorting opaque draws front to back by their view depth in the \a render_configuration.
+        //! \details Near geometry is drawn first, so hidden fragments get rejected by the early depth test.
+        //! \param[in] enabled True if opaque draws should be sorted, else false.
+        //! \return A reference to the modified \a render_configuration.
+        inline render_configuration& set_front_to_back_sorting(bool enabled)
+        {
+            m_front_to_back_sorting = enabled;
+            return *this;
+        }
+
+        //! \brief Enables or disables counting the fragments shaded by the geometry pass in the \a render_configuration.
+        //! \details This is a debug mode, the counting itself costs performance.
+        //! \param[in] enabled True if the overdraw should be measured, else false.
+        //! \return A reference to the modified \a render_configuration.
+        inline render_configuration& set_overdraw_measurement(bool enabled)
+        {
+            m_overdraw_measurement = enabled;
+            return *this;
+        }
+
+        //! \brief Enables or disables hierarchical depth occlusion culling in the \a render_configuration.
+        //! \details Models hidden behind the depth of an earlier frame are not drawn. This pays off for scenes with a lot of occluded geometry.
+        //! \param[in] enabled True if occluded models should be culled, else false.
+        //! \return A reference to the modified \a render_configuration.
+        inline render_configuration& set_occlusion_culling(bool enabled)
+        {
+            m_occlusion_culling = enabled;
+            return *this;
+        }
+
+        //! \brief Enables or disables culling the meshlets of dense primitives on the gpu in the \a render_configuration.
+        //! \details Meshlets outside of the view, facing away from the camera or hidden behind the depth of the last frame are not drawn.
+        //! The depth is only tested if occlusion culling is enabled as well.
+        //! \param[in] enabled True if meshlets should be culled, else false.
+        //! \return A reference to the modified \a render_configuration.
+        inline render_configuration& set_meshlet_culling(bool enabled)
+        {
+            m_meshlet_culling = enabled;
+            return *this;
+        }
+
+        //! \brief Sets the gpu frame time the resolution is scaled for in the \a render_configuration.
+        //! \details The geometry and the lighting are rendered with a lower resolution when the gpu takes longer than the target.
+        //! The result is upscaled and sharpened to the size of the viewport.
+        //! \param[in] milliseconds The target gpu time of a frame in milliseconds. 0 disables the dynamic resolution.
+        //! \return A reference to the modified \a render_configuration.
+        inline render_configuration& set_target_frame_time(float milliseconds)
+        {
+            m_target_frame_time = milliseconds;
+            return *this;
+        }
+
         //! \brief Retrieves and returns the setting for vertical synchronization of the \a render_configuration.
         //! \return The current configurated vertical synchronization setting.
         inline bool is_vsync_enabled() const
@@ -100,6 +210,62 @@ namespace mango
             return m_vsync;
         }
 
+        //! \brief Retrieves and returns the gpu memory budget for streamed textures of the \a render_configuration.
+        //! \return The current configurated memory budget in MiB. 0 if texture streaming is disabled.
+        inline uint32 get_texture_memory_budget() const
+        {
+            return m_texture_memory_budget;
+        }
+
+        //! \brief Retrieves and returns the \a gbuffer_layout of the \a render_configuration.
+        //! \return The current configurated \a gbuffer_layout.
+        inline gbuffer_layout get_gbuffer_layout() const
+        {
+            return m_gbuffer_layout;
+        }
+
+        //! \brief Retrieves and returns the setting for the depth pre-pass of the \a render_configuration.
+        //! \return True if the depth pre-pass is enabled, else false.
+        inline bool is_depth_pre_pass_enabled() const
+        {
+            return m_depth_pre_pass;
+        }
+
+        //! \brief Retrieves and returns the setting for front to back sorting of the \a render_configuration.
+        //! \return True if opaque draws are sorted front to back, else false.
+        inline bool is_front_to_back_sorting_enabled() const
+        {
+            return m_front_to_back_sorting;
+        }
+
+        //! \brief Retrieves and returns the setting for measuring the overdraw of the \a render_configuration.
+        //! \return True if the overdraw is measured, else false.
+        inline bool is_overdraw_measurement_enabled() const
+        {
+            return m_overdraw_measurement;
+        }
+
+        //! \brief Retrieves and returns the setting for occlusion culling of the \a render_configuration.
+        //! \return True if occluded models are culled, else false.
+        inline bool is_occlusion_culling_enabled() const
+        {
+            return m_occlusion_culling;
+        }
+
+        //! \brief Retrieves and returns the setting for meshlet culling of the \a render_configuration.
+        //! \return True if meshlets are culled on the gpu, else false.
+        inline bool is_meshlet_culling_enabled() const
+        {
+            return m_meshlet_culling;
+        }
+
+        //! \brief Retrieves and returns the gpu frame time the resolution is scaled for of the \a render_configuration.
+        //! \return The target gpu time of a frame in milliseconds, 0 if the dynamic resolution is disabled.
+        inline float get_target_frame_time() const
+        {
+            return m_target_frame_time;
+        }
+
         //! \brief Retrieves and returns the base \a render_pipeline set in the \a render_configuration.
         //! \return The current configurated base \a render_pipeline of the \a render_system.
         inline render_pipeline get_base_render_pipeline() const
@@ -123,6 +289,82 @@ namespace mango
         bool m_vsync;
         //! \brief The configurated additional \ render_steps of the \a render_configuration to enable or disable vertical synchronization.
         bool m_render_steps[render_step::number_of_step_types];
+        //! \brief The configurated gpu memory budget for streamed textures in MiB.
+        uint32 m_texture_memory_budget;
+        //! \brief The configurated \a gbuffer_layout of the deferred \a render_pipeline.
+        gbuffer_layout m_gbuffer_layout;
+        //! \brief The configurated setting of the \a render_configuration to enable or disable the depth pre-pass.
+        bool m_depth_pre_pass;
+        //! \brief The configurated setting of the \a render_configuration to enable or disable sorting opaque draws front to back.
+        bool m_front_to_back_sorting;
+        //! \brief The configurated setting of the \a render_configuration to enable or disable measuring the overdraw.
+        bool m_overdraw_measurement;
+        //! \brief The configurated setting of the \a render_configuration to enable or disable occlusion culling.
+        bool m_occlusion_culling;
+        //! \brief The configurated setting of the \a render_configuration to enable or disable meshlet culling.
+        bool m_meshlet_culling;
+        //! \brief The configurated gpu frame time in milliseconds the resolution is scaled for. 0 disables the dynamic resolution.
+        float m_target_frame_time;
+    };
+
+    //! \brief Statistics of the texture streaming in the \a render_system.
+    struct texture_streaming_statistics
+    {
+        uint32 streamed_textures; //!< The number of streamed textures.
+        uint32 resident_levels;   //!< The number of mipmap levels of all streamed textures resident on the gpu.
+        uint32 total_levels;      //!< The number of mipmap levels of all streamed textures.
+        ptr_size resident_memory; //!< The gpu memory occupied by the resident levels in bytes.
+        ptr_size memory_budget;   //!< The gpu memory budget in bytes.
+        uint32 uploaded_levels;   //!< The number of levels made resident in the last frame.
+        uint32 evicted_levels;    //!< The number of levels evicted in the last frame.
+        uint32 starved_textures;  //!< The number of textures that did not get their requested levels in the last frame.
+    };
+
+    //! \brief Statistics of the gbuffer of the \a render_system.
+    struct gbuffer_statistics
+    {
+        gbuffer_layout layout;  //!< The layout of the gbuffer.
+        uint32 bytes_per_pixel; //!< The size of all targets of one pixel in bytes. Each byte is written by the geometry pass and read by the lighting pass.
+        ptr_size memory;        //!< The gpu memory occupied by all targets in bytes.
+    };
+
+    //! \brief Statistics of the graphics state changes recorded by the \a render_system.
+    struct state_change_statistics
+    {
+        uint32 issued_changes; //!< The number of state changes in the last frame that required a call to the gpu.
+        uint32 elided_changes; //!< The number of redundant state changes in the last frame that were filtered.
+    };
+
+    //! \brief Statistics of the overdraw of the geometry pass of the \a render_system.
+    struct overdraw_statistics
+    {
+        bool measured;           //!< True if the overdraw is measured, else all other values are zero.
+        uint32 shaded_fragments; //!< The number of fragments shaded by the geometry pass in a recent frame.
+        uint32 pixels;           //!< The number of pixels of the gbuffer.
+        float overdraw;          //!< The shaded fragments per pixel. 1 means every pixel was shaded once, less if parts of the screen are empty.
+    };
+
+    //! \brief Statistics of the occlusion culling of the \a render_system.
+    struct occlusion_culling_statistics
+    {
+        bool enabled;          //!< True if occluded models are culled, else all other values are zero.
+        uint32 tested_objects; //!< The number of models with bounds tested against the depth in the last frame.
+        uint32 culled_objects; //!< The number of models culled as occluded in the last frame.
+    };
+
+    //! \brief Timings of one pass rendered by the \a render_system.
+    struct pass_timing
+    {
+        string name;    //!< The name of the pass.
+        float gpu_time; //!< The time the gpu spent on the pass in milliseconds.
+        float cpu_time; //!< The time the cpu spent submitting the pass in milliseconds.
+    };
+
+    //! \brief Timings of all passes of one frame rendered by the \a render_system.
+    struct frame_timings
+    {
+        uint64 frame;                    //!< The number of the frame.
+        std::vector<pass_timing> passes; //!< The timings of the passes in the order they were started.
     };
 
     //! \brief A system for window creation and handling.
@@ -136,6 +378,32 @@ namespace mango
         //! \param[in] configuration The \a render_configuration to use for the window.
         virtual void configure(const render_configuration& configuration) = 0;
 
+        //! \brief Retrieves the statistics of the texture streaming.
+        //! \return The \a texture_streaming_statistics of the last frame. All values are zero, if texture streaming is disabled.
+        virtual texture_streaming_statistics get_texture_streaming_statistics() = 0;
+
+        //! \brief Retrieves the statistics of the graphics state changes.
+        //! \return The \a state_change_statistics of the last frame.
+        virtual state_change_statistics get_state_change_statistics() = 0;
+
+        //! \brief Retrieves the gpu and cpu timings of the passes in the last frames.
+        //! \details Timings are available a few frames after rendering, since they are read back without waiting for the gpu.
+        //! \return The \a frame_timings of the last frames, the oldest one first.
+        virtual std::vector<frame_timings> get_frame_timings() = 0;
+
+        //! \brief Retrieves the statistics of the gbuffer.
+        //! \return The \a gbuffer_statistics of the current gbuffer.
+        virtual gbuffer_statistics get_gbuffer_statistics() = 0;
+
+        //! \brief Retrieves the statistics of the overdraw of the geometry pass.
+        //! \details The fragments are read back a few frames after rendering, since reading does not wait for the gpu.
+        //! \return The \a overdraw_statistics of a recent frame. Only measured if enabled in the \a render_configuration.
+        virtual overdraw_statistics get_overdraw_statistics() = 0;
+
+        //! \brief Retrieves the statistics of the occlusion culling.
+        //! \return The \a occlusion_culling_statistics of the last frame. Only counted if enabled in the \a render_configuration.
+        virtual occlusion_culling_statistics get_occlusion_culling_statistics() = 0;
+
       protected:
         virtual bool create()         = 0;
         virtual void update(float dt) = 0;
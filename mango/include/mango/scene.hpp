@@ -25,6 +25,8 @@ namespace mango
     class context_impl;
     class shader_program;
     class buffer;
+    class sampler;
+    class texture_cache;
     //! \brief The \a scene of mango.
     //! \details A collection of entities, components and systems. Responsible for handling content in mango.
     class scene
@@ -58,6 +60,13 @@ namespace mango
         //! \return The created camera entity.
         entity create_default_camera();
 
+        //! \brief Creates a light entity.
+        //! \details An entity with \a light_component and \a transform_component.
+        //! The light is placed at the origin, the parameters can be changed afterwards.
+        //! \param[in] type The \a light_type of the light to create.
+        //! \return The created light entity.
+        entity create_light(light_type type);
+
         //! \brief Creates entities from a model loaded from a gltf file.
         //! \details Internally creates entities with \a mesh_components, \a material_components, \a transform_components and \a node_components.
         //! All the components are filled with data loaded from the gltf file.
@@ -65,6 +74,16 @@ namespace mango
         //! \return A list of all created entities.
         std::vector<entity> create_entities_from_model(const string& path);
 
+        //! \brief Enables or disables the quantization of the vertex attributes of models created afterwards.
+        //! \details The attributes of each primitive are interleaved into one buffer and take 20 instead of 48 bytes per vertex.
+        //! Positions are stored with 16 bits relative to the bounds of the mesh, normals octahedral encoded with 16 bits, texture coordinates as half floats and tangents with 10 bits.
+        //! Meshes with attributes that are not 32 bit floats are not quantized.
+        //! \param[in] enabled True if vertices should be quantized, else false.
+        inline void set_vertex_quantization(bool enabled)
+        {
+            m_vertex_quantization = enabled;
+        }
+
         //! \brief Creates an environment entity.
         //! \details An entity with \a environment_component.
         //! The environment texture is preprocessed, prefiltered and can be rendered as a cube. This is done with a \a pipeline_step.
@@ -100,6 +119,14 @@ namespace mango
             return m_cameras.get_component_for_entity(e);
         }
 
+        //! \brief Retrieves the \a light_component from a specific \a entity.
+        //! \param[in] e The \a entity to get the \a light_component for.
+        //! \return The \a light_component or nullptr if non-existent.
+        inline light_component* get_light_component(entity e)
+        {
+            return m_lights.get_component_for_entity(e);
+        }
+
         //! \brief Retrieves the \a camera_data for the currently active camera.
         //! \details Has to be checked if pointer are null. Also can only be used for a short time.
         //! \return The \a camera_data.
@@ -120,8 +147,10 @@ namespace mango
         //! \param[in] n The node loaded by tinygltf.
         //! \param[in] parent_world The parents world transformation matrix.
         //! \param[in] buffer_map The mapped buffers of the model.
+        //! \param[in] model_path The path of the model. Used to identify cached resources.
         //! \return The root node of the function call.
-        entity build_model_node(std::vector<entity>& entities, tinygltf::Model& m, tinygltf::Node& n, const glm::mat4& parent_world, const std::map<int, shared_ptr<buffer>>& buffer_map);
+        entity build_model_node(std::vector<entity>& entities, tinygltf::Model& m, tinygltf::Node& n, const glm::mat4& parent_world, const std::map<int, shared_ptr<buffer>>& buffer_map,
+                                const string& model_path);
 
         //! \brief Attaches a \a mesh_component to an \a entity with data loaded by tinygltf.
         //! \details Internally called by create_entities_from_model(...).
@@ -129,14 +158,54 @@ namespace mango
         //! \param[in] m The model loaded by tinygltf.
         //! \param[in] mesh The mesh loaded by tinygltf.
         //! \param[in] buffer_map The mapped buffers of the model.
-        void build_model_mesh(entity node, tinygltf::Model& m, tinygltf::Mesh& mesh, const std::map<int, shared_ptr<buffer>>& buffer_map);
+        //! \param[in] model_path The path of the model. Used to identify cached resources.
+        void build_model_mesh(entity node, tinygltf::Model& m, tinygltf::Mesh& mesh, const std::map<int, shared_ptr<buffer>>& buffer_map, const string& model_path);
 
         //! \brief Loads a \a material and stores it in the component.
         //! \details Loads all supported component values and textures if they exist.
         //! \param[out] material The component to store the material in.
         //! \param[in] primitive The tinygltf primitive the material is linked to.
         //! \param[in] m The model loaded by tinygltf.
-        void load_material(material_component& material, const tinygltf::Primitive& primitive, tinygltf::Model& m);
+        //! \param[in] model_path The path of the model. Used to identify cached resources.
+        void load_material(material_component& material, const tinygltf::Primitive& primitive, tinygltf::Model& m, const string& model_path);
+
+        //! \brief Loads a texture referenced by a material.
+        //! \details Each image is only uploaded once per color space and usage, all further references get the cached texture.
+        //! \param[in] m The model loaded by tinygltf.
+        //! \param[in] texture_index The index of the texture in the model.
+        //! \param[in] standard_color_space True if the texture should be interpreted as SRGB, else false.
+        //! \param[in] normal_map True if the texture contains tangent space normals, else false.
+        //! \param[in] model_path The path of the model. Used to identify cached resources.
+        //! \param[out] texture_sampler The sampler to use with the texture.
+        //! \return A pointer to the texture or nullptr if the texture has no image.
+        shared_ptr<texture> load_texture(tinygltf::Model& m, int texture_index, bool standard_color_space, bool normal_map, const string& model_path, shared_ptr<sampler>& texture_sampler);
+
+        //! \brief Loads a model and builds all its entities below a root entity.
+        //! \details Internally called by create_entities_from_model(...) and when the model file is modified.
+        //! \param[in] root The entity the nodes of the model are attached to.
+        //! \param[in] path The path to the gltf model to load.
+        //! \param[in] entities The entity array where all entities are inserted.
+        void build_model(entity root, const string& path, std::vector<entity>& entities);
+
+        //! \brief Loads a hdr image and sets it as texture of an \a environment_component.
+        //! \details Internally called by create_environment_from_hdr(...) and when the image file is modified.
+        //! \param[out] environment The component to store the texture in.
+        //! \param[in] path The path to the hdr image to load.
+        //! \param[in] rendered_mip_level The mip level of the irradiance map to render as background.
+        void build_environment(environment_component& environment, const string& path, float rendered_mip_level);
+
+        //! \brief Watches a file entities were created from for modifications.
+        //! \param[in] path The path to the file.
+        void watch_file(const string& path);
+
+        //! \brief Reimports all models and environments created from a modified file.
+        //! \details Only the entities below the root entity of a model are replaced, so the root and its transformation stay valid.
+        //! \param[in] path The path to the modified file.
+        void reload_file(const string& path);
+
+        //! \brief Removes an entity and all entities attached to it.
+        //! \param[in] e The root of the entities to remove.
+        void remove_entity_tree(entity e);
 
         friend class context_impl; // TODO Paul: Could this be avoided?
         //! \brief Mangos internal context for shared usage in all \a render_systems.
@@ -154,9 +223,29 @@ namespace mango
         scene_component_manager<camera_component> m_cameras;
         //! \brief All \a environment_components. There is only one unique at the moment.
         scene_component_manager<environment_component> m_environments;
+        //! \brief All \a light_components.
+        scene_component_manager<light_component> m_lights;
         //! \brief The currently active camera entity.
         entity m_active_camera;
 
+        //! \brief Cache for textures and samplers shared between materials.
+        shared_ptr<texture_cache> m_texture_cache;
+        //! \brief True if the vertex attributes of models created are quantized, else false.
+        bool m_vertex_quantization;
+
+        //! \brief Information about the file an \a environment_component was created from.
+        struct environment_source
+        {
+            string path;              //!< The path to the hdr image.
+            float rendered_mip_level; //!< The mip level of the irradiance map to render as background.
+        };
+        //! \brief The model files the root entities of models were created from.
+        std::map<entity, string> m_model_sources;
+        //! \brief The hdr files the environment entities were created from.
+        std::map<entity, environment_source> m_environment_sources;
+        //! \brief The ids of the file watches for all files entities were created from.
+        std::map<string, uint32> m_file_watches;
+
         //! \brief Scene boundaries.
         struct scene_bounds
         {
@@ -14,6 +14,7 @@ namespace mango
 {
     // fwd
     class vertex_array;
+    class buffer;
     struct material;
     class texture;
 
@@ -49,6 +50,25 @@ namespace mango
         orthographic_camera //!< Orthographic projection. Usually useful for 2D scenes or UI.
     };
 
+    //! \brief A level of detail of a \a primitive_component. All levels share the vertex data and the index buffer.
+    struct primitive_lod
+    {
+        uint32 first; //!< First index.
+        uint32 count; //!< Number of elements.
+        float error;  //!< The largest distance of the simplified surface to the full detail one in model space.
+    };
+
+    //! \brief The meshlets of a \a primitive_component, small clusters of triangles culled on the gpu.
+    struct primitive_meshlets
+    {
+        shared_ptr<buffer> meshlet_buffer; //!< The bounds and index ranges of the meshlets.
+        shared_ptr<buffer> index_buffer;   //!< The index buffer of the primitive. The meshlets are ranges of the full detail level, the visible indices are written behind all levels.
+        shared_ptr<buffer> draw_buffer;    //!< The indirect draw command drawing the visible indices.
+        uint32 meshlet_count;              //!< The number of meshlets.
+        uint32 index_count;                //!< The number of indices of all meshlets.
+        uint32 visible_offset;             //!< The offset of the visible indices in the index buffer in bytes.
+    };
+
     //! \brief Component used to describe a primitive draw call. Used by \a mesh_component.
     struct primitive_component
     {
@@ -58,6 +78,12 @@ namespace mango
         uint32 count;                                 //!< Number of elements/vertices.
         index_type type_index;                        //!< The type of the values in the index buffer.
         uint32 instance_count;                        //!< Number of instances. Usually 1.
+        //! \brief The levels of detail from full to lowest detail. Empty if the primitive is not simplified, first and count are used then.
+        std::vector<primitive_lod> lods;
+        //! \brief The index of the level of detail drawn in the last frame.
+        uint32 current_lod;
+        //! \brief The meshlets of the full detail level. Nullptr if the primitive is not split into meshlets.
+        shared_ptr<primitive_meshlets> meshlets;
     };
 
     //! \brief Component used for materials.
@@ -78,6 +104,13 @@ namespace mango
         bool has_normals;
         //! \brief Specifies if the mesh has tangents.
         bool has_tangents;
+        //! \brief Specifies if the vertex attributes of all primitives are quantized relative to the bounds of the mesh.
+        bool has_quantized_attributes;
+
+        //! \brief The minimum of the axis aligned bounding box of all primitives in model space.
+        glm::vec3 min_extents;
+        //! \brief The maximum of the axis aligned bounding box of all primitives in model space.
+        glm::vec3 max_extents;
     };
 
     //! \brief Component used for camera entities.
@@ -114,6 +147,25 @@ namespace mango
         shared_ptr<texture> hdr_texture;                   //!< The hdr texture used to build the environment.
     };
 
+    //! \brief Light types used in \a light_components.
+    enum class light_type : uint8
+    {
+        point_light, //!< Emits light in all directions from its position.
+        spot_light   //!< Emits light in a cone from its position.
+    };
+
+    //! \brief Component used for punctual light entities.
+    //! \details The position is taken from the world transformation of the entity. Spot lights shine along the negative z axis of it.
+    struct light_component
+    {
+        light_type type        = light_type::point_light; //!< The type of the light.
+        glm::vec3 color        = glm::vec3(1.0f);         //!< The linear color of the light.
+        float intensity        = 1.0f;                    //!< The luminous intensity of the light in candela.
+        float range            = 10.0f;                   //!< The distance where the light has no influence anymore.
+        float inner_cone_angle = 0.0f;                    //!< The angle in radians from the spot direction the falloff starts at. Only used by spot lights.
+        float outer_cone_angle = 0.7853982f;              //!< The angle in radians from the spot direction the falloff ends at. Only used by spot lights.
+    };
+
     // TODO Paul: This will be reworked when we need the reflection for the components.
     //! \cond NO_COND
     template <typename T>
@@ -181,6 +233,14 @@ namespace mango
             return "environment_component";
         }
     };
+    template <>
+    struct type_name<light_component>
+    {
+        static const char* get()
+        {
+            return "light_component";
+        }
+    };
     //! \endcond
 } // namespace mango
 
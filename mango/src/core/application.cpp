@@ -4,13 +4,17 @@
 //! \date      2020
 //! \copyright Apache License 2.0
 
+#include <algorithm>
 #include <core/context_impl.hpp>
 #include <core/input_system_impl.hpp>
 #include <core/timer.hpp>
 #include <core/window_system_impl.hpp>
+#include <cstdlib>
+#include <cstring>
 #include <graphics/command_buffer.hpp>
 #include <mango/application.hpp>
 #include <mango/assert.hpp>
+#include <mango/profile.hpp>
 #include <mango/scene.hpp>
 #include <rendering/render_system_impl.hpp>
 #include <resources/resource_system.hpp>
@@ -20,6 +24,35 @@
 
 using namespace mango;
 
+//! \brief Logs the average gpu and cpu time of each pass over all recorded frames.
+//! \param[in] timings The \a frame_timings of the last frames.
+static void log_average_pass_timings(const std::vector<frame_timings>& timings)
+{
+    struct pass_average
+    {
+        string name;
+        float gpu_time;
+        float cpu_time;
+        uint32 count;
+    };
+    std::vector<pass_average> averages;
+    for (auto& frame : timings)
+    {
+        for (auto& pass : frame.passes)
+        {
+            auto it = std::find_if(averages.begin(), averages.end(), [&pass](const pass_average& a) { return a.name == pass.name; });
+            if (it == averages.end())
+                it = averages.insert(averages.end(), pass_average{ pass.name, 0.0f, 0.0f, 0 });
+            it->gpu_time += pass.gpu_time;
+            it->cpu_time += pass.cpu_time;
+            it->count++;
+        }
+    }
+
+    for (auto& a : averages)
+        MANGO_LOG_INFO("Pass {0}: {1} ms gpu, {2} ms cpu on average over {3} frames.", a.name, a.gpu_time / static_cast<float>(a.count), a.cpu_time / static_cast<float>(a.count), a.count);
+}
+
 application::application()
 {
     m_context = std::make_shared<context_impl>();
@@ -37,44 +70,198 @@ application::~application()
 
 uint32 application::run(uint32 t_argc, char** t_argv)
 {
-    MANGO_UNUSED(t_argc);
-    MANGO_UNUSED(t_argv);
+    shared_ptr<render_system_impl> render_system = m_context->get_render_system_internal().lock();
+    MANGO_ASSERT(render_system, "Render System is expired!");
+    shared_ptr<scene> current_scene = m_context->get_current_scene();
+
+    // a frame limit makes the loop terminate without a window close event.
+    uint32 frame_limit = 0;
+    // the recorded profiling zones are written to this file after the loop.
+    string trace_path;
+    // the last frame is written to this file.
+    string screenshot_path;
+    // scene content to render without user interaction, loaded after all options are applied.
+    string model_path;
+    string environment_path;
+    for (uint32 i = 1; i < t_argc; ++i)
+    {
+        const char* argument = t_argv[i];
+        const char* value    = i + 1 < t_argc ? t_argv[i + 1] : nullptr;
+
+        if (std::strcmp(argument, "--frames") == 0 && value)
+        {
+            frame_limit = static_cast<uint32>(std::strtoul(value, nullptr, 10));
+            ++i;
+        }
+        else if (std::strcmp(argument, "--trace") == 0 && value)
+        {
+            trace_path = value;
+            ++i;
+        }
+        else if (std::strcmp(argument, "--screenshot") == 0 && value)
+        {
+            screenshot_path = value;
+            ++i;
+        }
+        else if (std::strcmp(argument, "--model") == 0 && value)
+        {
+            model_path = value;
+            ++i;
+        }
+        else if (std::strcmp(argument, "--environment") == 0 && value)
+        {
+            environment_path = value;
+            ++i;
+        }
+        // the gbuffer layout can be overridden to compare the layouts with the same application.
+        else if (std::strcmp(argument, "--gbuffer") == 0 && value)
+        {
+            if (std::strcmp(value, "standard") == 0)
+                render_system->set_gbuffer_layout(gbuffer_layout::standard);
+            else if (std::strcmp(value, "compact") == 0)
+                render_system->set_gbuffer_layout(gbuffer_layout::compact);
+            else if (std::strcmp(value, "compact_depth_stencil") == 0)
+                render_system->set_gbuffer_layout(gbuffer_layout::compact_depth_stencil);
+            else
+                MANGO_LOG_WARN("Unknown gbuffer layout {0}!", value);
+            ++i;
+        }
+        // the ordering and culling of the geometry can be overridden to measure the effect on the overdraw.
+        else if (std::strcmp(argument, "--depth-pre-pass") == 0)
+            render_system->set_depth_pre_pass(true);
+        else if (std::strcmp(argument, "--no-sorting") == 0)
+            render_system->set_front_to_back_sorting(false);
+        else if (std::strcmp(argument, "--overdraw") == 0)
+            render_system->set_overdraw_measurement(true);
+        else if (std::strcmp(argument, "--occlusion-culling") == 0)
+            render_system->set_occlusion_culling(true);
+        else if (std::strcmp(argument, "--meshlet-culling") == 0)
+            render_system->set_meshlet_culling(true);
+        // the resolution is scaled down when the gpu takes longer than the target frame time.
+        else if (std::strcmp(argument, "--dynamic-resolution") == 0 && value)
+        {
+            render_system->set_target_frame_time(std::strtof(value, nullptr));
+            ++i;
+        }
+        // models loaded afterwards can be imported with quantized vertices to compare the memory and bandwidth.
+        else if (std::strcmp(argument, "--quantize-vertices") == 0 && current_scene)
+            current_scene->set_vertex_quantization(true);
+        else
+            MANGO_LOG_WARN("Unknown or incomplete argument {0}!", argument);
+    }
+
+    if (current_scene && !model_path.empty())
+        current_scene->create_entities_from_model(model_path);
+    if (current_scene && !environment_path.empty())
+        current_scene->create_environment_from_hdr(environment_path, 0.0f);
 
     bool should_close = false;
+    uint32 frames     = 0;
+    timer run_timer;
+    run_timer.start();
 
     while (!should_close)
     {
+        MANGO_PROFILE_ZONE("frame");
         shared_ptr<window_system_impl> ws = m_context->get_window_system_internal().lock();
         MANGO_ASSERT(ws, "Window System is expired!");
         shared_ptr<input_system_impl> is = m_context->get_input_system_internal().lock();
         MANGO_ASSERT(is, "Input System is expired!");
         shared_ptr<render_system_impl> rs = m_context->get_render_system_internal().lock();
         MANGO_ASSERT(rs, "Render System is expired!");
+        shared_ptr<resource_system> res = m_context->get_resource_system_internal().lock();
+        MANGO_ASSERT(res, "Resource System is expired!");
         shared_ptr<scene> scene = m_context->get_current_scene();
 
         // poll events
-        ws->poll_events();
-        should_close = ws->should_close();
+        {
+            MANGO_PROFILE_ZONE("poll events");
+            ws->poll_events();
+            should_close = ws->should_close();
+        }
 
         float frame_time = static_cast<float>(m_frame_timer->elapsedMicroseconds().count()) * 0.000001f; // We need the resolution.
         m_frame_timer->restart();
 
         // update
-        update(frame_time);
-        ws->update(frame_time);
-        is->update(frame_time);
-        rs->update(frame_time);
-        scene->update(frame_time);
+        {
+            MANGO_PROFILE_ZONE("application update");
+            update(frame_time);
+        }
+        {
+            MANGO_PROFILE_ZONE("window system update");
+            ws->update(frame_time);
+        }
+        {
+            MANGO_PROFILE_ZONE("input system update");
+            is->update(frame_time);
+        }
+        {
+            MANGO_PROFILE_ZONE("render system update");
+            rs->update(frame_time);
+        }
+        {
+            MANGO_PROFILE_ZONE("scene update");
+            scene->update(frame_time);
+        }
+        {
+            MANGO_PROFILE_ZONE("resource system update");
+            res->update(frame_time);
+        }
 
         // render
-        rs->begin_render();
-        //
-        scene->render();
-        //
-        rs->finish_render();
+        {
+            MANGO_PROFILE_ZONE("begin render");
+            rs->begin_render();
+        }
+        {
+            MANGO_PROFILE_ZONE("scene render");
+            scene->render();
+        }
+        {
+            MANGO_PROFILE_ZONE("finish render");
+            rs->finish_render();
+        }
+
+        if (frame_limit > 0 && ++frames >= frame_limit)
+            should_close = true;
+
+        // the back buffer is undefined after swapping, so the last frame is read back before.
+        if (should_close && !screenshot_path.empty() && rs->write_screenshot(screenshot_path))
+            MANGO_LOG_INFO("Wrote the last frame to {0}.", screenshot_path);
 
         // swap buffers
-        ws->swap_buffers();
+        {
+            MANGO_PROFILE_ZONE("swap buffers");
+            ws->swap_buffers();
+        }
+    }
+
+    if (frame_limit > 0)
+    {
+        MANGO_LOG_INFO("Rendered {0} frames in {1} ms.", frames, run_timer.elapsedMilliseconds().count());
+
+        // benchmark report.
+        shared_ptr<render_system_impl> rs = m_context->get_render_system_internal().lock();
+        MANGO_ASSERT(rs, "Render System is expired!");
+        gbuffer_statistics gbuffer = rs->get_gbuffer_statistics();
+        MANGO_LOG_INFO("Gbuffer uses {0} bytes per pixel, {1} KiB in total.", gbuffer.bytes_per_pixel, gbuffer.memory / 1024);
+        log_average_pass_timings(rs->get_frame_timings());
+        overdraw_statistics overdraw = rs->get_overdraw_statistics();
+        if (overdraw.measured)
+            MANGO_LOG_INFO("Geometry pass shaded {0} fragments for {1} pixels, overdraw is {2}.", overdraw.shaded_fragments, overdraw.pixels, overdraw.overdraw);
+        occlusion_culling_statistics culling = rs->get_occlusion_culling_statistics();
+        if (culling.enabled)
+            MANGO_LOG_INFO("Occlusion culling culled {0} of {1} tested objects in the last frame.", culling.culled_objects, culling.tested_objects);
+    }
+
+    if (!trace_path.empty())
+    {
+#if !defined(MANGO_PROFILE)
+        MANGO_LOG_WARN("Profiling is disabled, the trace does not contain any zones!");
+#endif // !MANGO_PROFILE
+        if (profile::write_chrome_trace(trace_path))
+            MANGO_LOG_INFO("Wrote the chrome trace to {0}.", trace_path);
     }
 
     return 0;
@@ -8,6 +8,9 @@
 #if defined(WIN32)
 #include <core/win32_input_system.hpp>
 #include <core/win32_window_system.hpp>
+#elif defined(LINUX) && defined(MANGO_HEADLESS)
+#include <core/headless_input_system.hpp>
+#include <core/headless_window_system.hpp>
 #elif defined(LINUX)
 #include <core/linux_input_system.hpp>
 #include <core/linux_window_system.hpp>
@@ -67,6 +70,18 @@ shared_ptr<scene>& context_impl::get_current_scene()
     return m_current_scene;
 }
 
+void context_impl::set_resource_memory_budget(ptr_size budget)
+{
+    MANGO_ASSERT(m_resource_system, "Resource System is invalid!");
+    m_resource_system->set_memory_budget(budget);
+}
+
+ptr_size context_impl::get_resource_memory_usage(resource_type type)
+{
+    MANGO_ASSERT(m_resource_system, "Resource System is invalid!");
+    return m_resource_system->get_memory_usage(type);
+}
+
 weak_ptr<window_system_impl> context_impl::get_window_system_internal()
 {
     return m_window_system;
@@ -108,6 +123,9 @@ bool context_impl::create()
 #if defined(WIN32)
     m_window_system = std::make_shared<win32_window_system>(shared_from_this());
     m_input_system  = std::make_shared<win32_input_system>(shared_from_this());
+#elif defined(LINUX) && defined(MANGO_HEADLESS)
+    m_window_system = std::make_shared<headless_window_system>(shared_from_this());
+    m_input_system  = std::make_shared<headless_input_system>(shared_from_this());
 #elif defined(LINUX)
     m_window_system = std::make_shared<linux_window_system>(shared_from_this());
     m_input_system  = std::make_shared<linux_input_system>(shared_from_this());
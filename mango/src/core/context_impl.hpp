@@ -29,6 +29,8 @@ namespace mango
         void register_scene(shared_ptr<scene>& scene) override;
         void make_scene_current(shared_ptr<scene>& scene) override;
         shared_ptr<scene>& get_current_scene() override;
+        void set_resource_memory_budget(ptr_size budget) override;
+        ptr_size get_resource_memory_usage(resource_type type) override;
 
         //! \brief Creation function for the context.
         //! \details Creates and initializes various systems like \a window_system.
@@ -0,0 +1,91 @@
+//! \file      headless_input_system.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <core/headless_input_system.hpp>
+#include <mango/assert.hpp>
+
+using namespace mango;
+
+headless_input_system::headless_input_system(const shared_ptr<context_impl>& context)
+{
+    m_input_user_data.shared_context = context;
+}
+
+headless_input_system::~headless_input_system() {}
+
+bool headless_input_system::create()
+{
+    return true;
+}
+
+void headless_input_system::set_platform_data(const shared_ptr<platform_data>& data)
+{
+    MANGO_UNUSED(data);
+}
+
+void headless_input_system::update(float dt)
+{
+    MANGO_UNUSED(dt);
+}
+
+void headless_input_system::destroy() {}
+
+input_action headless_input_system::get_key(key_code key)
+{
+    MANGO_UNUSED(key);
+    return input_action::RELEASE;
+}
+
+input_action headless_input_system::get_mouse_button(mouse_button button)
+{
+    MANGO_UNUSED(button);
+    return input_action::RELEASE;
+}
+
+modifier headless_input_system::get_modifiers()
+{
+    return modifier::NONE;
+}
+
+glm::vec2 headless_input_system::get_mouse_position()
+{
+    return glm::vec2(0.0f);
+}
+
+glm::vec2 headless_input_system::get_mouse_scroll()
+{
+    return glm::vec2(0.0f);
+}
+
+void headless_input_system::set_key_callback(key_callback callback)
+{
+    m_input_user_data.key_change.connect(callback);
+}
+
+void headless_input_system::set_mouse_button_callback(mouse_button_callback callback)
+{
+    m_input_user_data.mouse_button_change.connect(callback);
+}
+
+void headless_input_system::set_mouse_position_callback(mouse_position_callback callback)
+{
+    m_input_user_data.mouse_position_change.connect(callback);
+}
+
+void headless_input_system::set_mouse_scroll_callback(mouse_scroll_callback callback)
+{
+    m_input_user_data.mouse_scroll_change.connect(callback);
+}
+
+void headless_input_system::set_drag_and_drop_callback(drag_n_drop_callback callback)
+{
+    m_input_user_data.drag_n_drop_change.connect(callback);
+}
+
+void headless_input_system::hide_cursor(bool hide)
+{
+    MANGO_UNUSED(hide);
+}
@@ -0,0 +1,47 @@
+//! \file      headless_input_system.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_HEADLESS_INPUT_SYSTEM_HPP
+#define MANGO_HEADLESS_INPUT_SYSTEM_HPP
+
+#include <core/input_system_impl.hpp>
+
+namespace mango
+{
+    //! \brief The \a input_system used with the \a headless_window_system.
+    //! \details There is no window receiving input, so all keys and buttons are released and callbacks are never called.
+    class headless_input_system : public input_system_impl
+    {
+      public:
+        //! \brief Constructs the \a headless_input_system.
+        //! \param[in] context The internally shared context of mango.
+        headless_input_system(const shared_ptr<context_impl>& context);
+
+        ~headless_input_system();
+        bool create() override;
+        virtual void set_platform_data(const shared_ptr<platform_data>& data) override;
+
+        virtual void update(float dt) override;
+        virtual void destroy() override;
+
+        virtual input_action get_key(key_code key) override;
+        virtual input_action get_mouse_button(mouse_button button) override;
+        virtual modifier get_modifiers() override;
+        virtual glm::vec2 get_mouse_position() override;
+        virtual glm::vec2 get_mouse_scroll() override;
+
+        virtual void set_key_callback(key_callback callback) override;
+        virtual void set_mouse_button_callback(mouse_button_callback callback) override;
+        virtual void set_mouse_position_callback(mouse_position_callback callback) override;
+        virtual void set_mouse_scroll_callback(mouse_scroll_callback callback) override;
+        virtual void set_drag_and_drop_callback(drag_n_drop_callback callback) override;
+
+        virtual void hide_cursor(bool hide) override;
+    };
+
+} // namespace mango
+
+#endif // MANGO_HEADLESS_INPUT_SYSTEM_HPP
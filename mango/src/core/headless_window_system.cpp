@@ -0,0 +1,211 @@
+//! \file      headless_window_system.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <core/headless_window_system.hpp>
+#include <core/input_system_impl.hpp>
+#include <cstring>
+#include <mango/assert.hpp>
+#include <rendering/render_system_impl.hpp>
+
+using namespace mango;
+
+//! \brief Checks if an EGL extension is supported.
+//! \param[in] extensions The space separated extension string.
+//! \param[in] name The name of the extension.
+//! \return True if the extension is supported, else false.
+static bool egl_extension_supported(const char* extensions, const char* name)
+{
+    if (!extensions)
+        return false;
+
+    ptr_size length = std::strlen(name);
+    for (const char* found = std::strstr(extensions, name); found; found = std::strstr(found + length, name))
+    {
+        bool starts = found == extensions || found[-1] == ' ';
+        bool ends   = found[length] == ' ' || found[length] == '\0';
+        if (starts && ends)
+            return true;
+    }
+    return false;
+}
+
+headless_window_system::headless_window_system(const shared_ptr<context_impl>& context)
+    : m_window_configuration()
+    , m_display(EGL_NO_DISPLAY)
+    , m_config(nullptr)
+    , m_context(EGL_NO_CONTEXT)
+    , m_surface(EGL_NO_SURFACE)
+{
+    m_shared_context                      = context;
+    m_platform_data                       = std::make_shared<platform_data>();
+    m_platform_data->native_window_handle = nullptr;
+}
+
+headless_window_system::~headless_window_system() {}
+
+bool headless_window_system::create()
+{
+    // the surfaceless platform does not require any display server.
+    const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    EGLDisplay display            = EGL_NO_DISPLAY;
+    if (egl_extension_supported(client_extensions, "EGL_MESA_platform_surfaceless") && egl_extension_supported(client_extensions, "EGL_EXT_platform_base"))
+    {
+        auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (get_platform_display)
+            display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        MANGO_LOG_ERROR("Initilization of egl failed! No offscreen context is created!");
+        return false;
+    }
+    m_display = display;
+    MANGO_LOG_DEBUG("EGL Version is {0}.{1}", major, minor);
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        MANGO_LOG_ERROR("EGL does not support OpenGL! No offscreen context is created!");
+        return false;
+    }
+
+    const EGLint config_attributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_RED_SIZE,     8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+                                         EGL_ALPHA_SIZE,   8,               EGL_DEPTH_SIZE,      24,             EGL_STENCIL_SIZE, 8, EGL_NONE };
+    EGLConfig config;
+    EGLint config_count = 0;
+    if (!eglChooseConfig(display, config_attributes, &config, 1, &config_count) || config_count < 1)
+    {
+        MANGO_LOG_ERROR("No EGL config with pbuffer support found! No offscreen context is created!");
+        return false;
+    }
+    m_config = config;
+
+    const EGLint context_attributes[] = { EGL_CONTEXT_MAJOR_VERSION,
+                                          4,
+                                          EGL_CONTEXT_MINOR_VERSION,
+                                          5,
+                                          EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                          EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#ifdef MANGO_DEBUG
+                                          EGL_CONTEXT_OPENGL_DEBUG,
+                                          EGL_TRUE,
+#endif // MANGO_DEBUG
+                                          EGL_NONE };
+    m_context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+    if (m_context == EGL_NO_CONTEXT)
+    {
+        MANGO_LOG_ERROR("eglCreateContext failed! No offscreen context is created!");
+        return false;
+    }
+
+    return create_surface();
+}
+
+bool headless_window_system::create_surface()
+{
+    MANGO_ASSERT(m_display != EGL_NO_DISPLAY, "Display is not valid!");
+    uint32 width  = m_window_configuration.get_width();
+    uint32 height = m_window_configuration.get_height();
+
+    eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_surface != EGL_NO_SURFACE)
+        eglDestroySurface(m_display, m_surface);
+
+    const EGLint surface_attributes[]     = { EGL_WIDTH, static_cast<EGLint>(width), EGL_HEIGHT, static_cast<EGLint>(height), EGL_NONE };
+    m_surface                             = eglCreatePbufferSurface(m_display, m_config, surface_attributes);
+    m_platform_data->native_window_handle = m_surface;
+    if (m_surface == EGL_NO_SURFACE)
+    {
+        MANGO_LOG_ERROR("eglCreatePbufferSurface failed! No offscreen surface is created!");
+        return false;
+    }
+
+    make_window_context_current();
+    MANGO_LOG_DEBUG("Offscreen Surface Size is {0} x {1}", width, height);
+    return true;
+}
+
+void headless_window_system::swap_buffers()
+{
+    MANGO_ASSERT(m_platform_data->native_window_handle, "Surface Handle is not valid!");
+    // has no effect on pbuffers, but finishes the frame like for windows.
+    eglSwapBuffers(m_display, m_surface);
+}
+
+void headless_window_system::set_size(uint32 width, uint32 height)
+{
+    MANGO_ASSERT(m_platform_data->native_window_handle, "Surface Handle is not valid!");
+    m_window_configuration.set_width(width);
+    m_window_configuration.set_height(height);
+    if (!create_surface())
+        return;
+
+    // there is no resize event like for windows.
+    auto rs = m_shared_context->get_render_system_internal().lock();
+    if (rs && width > 0 && height > 0)
+        rs->set_viewport(0, 0, width, height);
+}
+
+void headless_window_system::configure(const window_configuration& configuration)
+{
+    m_window_configuration = configuration;
+    if (!create_surface())
+        return;
+
+    auto input = m_shared_context->get_input_system_internal().lock();
+    MANGO_ASSERT(input, "Input system not valid!");
+    input->set_platform_data(m_platform_data);
+
+    m_shared_context->set_gl_loading_procedure(reinterpret_cast<mango_gl_load_proc>(eglGetProcAddress));
+}
+
+void headless_window_system::update(float dt)
+{
+    MANGO_UNUSED(dt);
+}
+
+void headless_window_system::poll_events() {}
+
+bool headless_window_system::should_close()
+{
+    // there is no window to close, the application has to limit the number of frames.
+    return false;
+}
+
+void headless_window_system::set_vsync(bool enabled)
+{
+    make_window_context_current();
+    eglSwapInterval(m_display, enabled ? 1 : 0);
+}
+
+void headless_window_system::make_window_context_current()
+{
+    MANGO_ASSERT(m_platform_data->native_window_handle, "Surface Handle is not valid!");
+    eglMakeCurrent(m_display, m_surface, m_surface, m_context);
+}
+
+void headless_window_system::destroy()
+{
+    if (m_display == EGL_NO_DISPLAY)
+        return;
+
+    eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_surface != EGL_NO_SURFACE)
+        eglDestroySurface(m_display, m_surface);
+    if (m_context != EGL_NO_CONTEXT)
+        eglDestroyContext(m_display, m_context);
+    eglTerminate(m_display);
+
+    m_surface                             = EGL_NO_SURFACE;
+    m_context                             = EGL_NO_CONTEXT;
+    m_display                             = EGL_NO_DISPLAY;
+    m_platform_data->native_window_handle = nullptr;
+}
@@ -0,0 +1,75 @@
+//! \file      headless_window_system.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_HEADLESS_WINDOW_SYSTEM_HPP
+#define MANGO_HEADLESS_WINDOW_SYSTEM_HPP
+
+#include <core/window_system_impl.hpp>
+
+namespace mango
+{
+    //! \brief A \a window_system rendering offscreen without any display.
+    //! \details The context is created with EGL on the surfaceless platform if available, else on the default display.
+    //! Instead of a window a pbuffer surface with the configured size is used as default framebuffer.
+    //! This works with software rasterizers like llvmpipe and can be used for automated rendering on machines without a display or gpu.
+    class headless_window_system : public window_system_impl
+    {
+      public:
+        //! \brief Constructs the \a headless_window_system.
+        //! \param[in] context The internally shared context of mango.
+        headless_window_system(const shared_ptr<context_impl>& context);
+        ~headless_window_system();
+        bool create() override;
+        void configure(const window_configuration& configuration) override;
+
+        inline uint32 get_width() override
+        {
+            return m_window_configuration.get_width();
+        }
+        inline uint32 get_height() override
+        {
+            return m_window_configuration.get_height();
+        }
+        void set_size(uint32 width, uint32 height) override;
+
+        void swap_buffers() override;
+        void update(float dt) override;
+        void poll_events() override;
+        bool should_close() override;
+        void destroy() override;
+        void set_vsync(bool enabled) override;
+        void make_window_context_current() override;
+
+        inline shared_ptr<platform_data> get_platform_data() override
+        {
+            return m_platform_data;
+        }
+
+      private:
+        //! \brief Creates the pbuffer surface with the configured size and makes the context current.
+        //! \return True on success, else false.
+        bool create_surface();
+
+        //! \brief The \a window_configuration for the \a headless_window_system.
+        //! \details This holds the size of the offscreen surface.
+        window_configuration m_window_configuration;
+
+        //! \brief The platform data holds the handle of the offscreen surface.
+        shared_ptr<platform_data> m_platform_data;
+
+        //! \brief The EGL display.
+        void* m_display;
+        //! \brief The EGL framebuffer configuration used for the context and the surface.
+        void* m_config;
+        //! \brief The EGL context.
+        void* m_context;
+        //! \brief The EGL pbuffer surface.
+        void* m_surface;
+    };
+
+} // namespace mango
+
+#endif // MANGO_HEADLESS_WINDOW_SYSTEM_HPP
@@ -0,0 +1,162 @@
+//! \file      profile.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <mango/log.hpp>
+#include <mango/profile.hpp>
+#include <mutex>
+#include <vector>
+
+using namespace mango;
+
+//! \brief A finished zone.
+struct zone_event
+{
+    const char* name; //!< The name of the zone.
+    int64 begin;      //!< The time in nanoseconds the zone started.
+    int64 end;        //!< The time in nanoseconds the zone ended.
+};
+
+//! \brief The ring buffer of the zones recorded by one thread.
+struct thread_zones
+{
+    uint32 thread_index;            //!< The index of the thread in the order of the first recorded zone.
+    std::vector<zone_event> events; //!< The ring buffer of zones.
+    std::atomic<uint64> written;    //!< The number of zones written so far.
+};
+
+//! \brief The number of zones each thread keeps.
+static const uint64 zones_per_thread = 1 << 16;
+
+//! \brief Guards the list of all threads that recorded zones.
+static std::mutex g_threads_mutex;
+//! \brief The ring buffers of all threads that recorded zones. Kept after a thread exits, so its zones can still be written.
+static std::vector<shared_ptr<thread_zones>> g_threads;
+
+//! \brief Returns the ring buffer of the calling thread and registers it on first use.
+//! \return The \a thread_zones of the calling thread.
+static thread_zones& get_thread_zones()
+{
+    thread_local shared_ptr<thread_zones> zones;
+    if (!zones)
+    {
+        zones = std::make_shared<thread_zones>();
+        zones->events.resize(zones_per_thread);
+        zones->written.store(0);
+
+        std::lock_guard<std::mutex> lock(g_threads_mutex);
+        zones->thread_index = static_cast<uint32>(g_threads.size());
+        g_threads.push_back(zones);
+    }
+    return *zones;
+}
+
+//! \brief Writes a string escaped for json.
+//! \param[in] out The stream to write to.
+//! \param[in] str The string to write.
+static void write_json_string(std::ofstream& out, const char* str)
+{
+    out << '"';
+    for (const char* c = str; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            out << '\\' << *c;
+        else if (static_cast<unsigned char>(*c) >= 0x20)
+            out << *c;
+    }
+    out << '"';
+}
+
+void profile::record_zone(const char* name, int64 begin, int64 end)
+{
+    thread_zones& zones = get_thread_zones();
+
+    // only the owning thread writes, the counter publishes the zone to the trace writer.
+    uint64 index  = zones.written.load(std::memory_order_relaxed);
+    zone_event& e = zones.events[index % zones_per_thread];
+    e.name        = name;
+    e.begin       = begin;
+    e.end         = end;
+    zones.written.store(index + 1, std::memory_order_release);
+}
+
+bool profile::write_chrome_trace(const string& path)
+{
+    std::vector<shared_ptr<thread_zones>> threads;
+    {
+        std::lock_guard<std::mutex> lock(g_threads_mutex);
+        threads = g_threads;
+    }
+
+    struct thread_snapshot
+    {
+        uint32 thread_index;
+        std::vector<zone_event> events;
+    };
+    std::vector<thread_snapshot> snapshots;
+    int64 first_begin = std::numeric_limits<int64>::max();
+
+    for (auto& zones : threads)
+    {
+        thread_snapshot snapshot;
+        snapshot.thread_index = zones->thread_index;
+
+        uint64 written = zones->written.load(std::memory_order_acquire);
+        uint64 first   = written > zones_per_thread ? written - zones_per_thread : 0;
+        for (uint64 i = first; i < written; ++i)
+            snapshot.events.push_back(zones->events[i % zones_per_thread]);
+
+        // zones overwritten by the owning thread while copying are not valid anymore.
+        uint64 overwritten = zones->written.load(std::memory_order_acquire);
+        uint64 valid_first = overwritten > zones_per_thread ? overwritten - zones_per_thread : 0;
+        if (valid_first > first)
+            snapshot.events.erase(snapshot.events.begin(), snapshot.events.begin() + static_cast<std::ptrdiff_t>(std::min(valid_first - first, written - first)));
+
+        for (auto& e : snapshot.events)
+            first_begin = std::min(first_begin, e.begin);
+        snapshots.push_back(snapshot);
+    }
+
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.is_open())
+    {
+        MANGO_LOG_ERROR("Could not open {0} to write the trace!", path);
+        return false;
+    }
+
+    // complete events with timestamps in microseconds relative to the first zone.
+    out << std::fixed;
+    out.precision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first_event = true;
+    for (auto& snapshot : snapshots)
+    {
+        if (!first_event)
+            out << ',';
+        first_event = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << snapshot.thread_index << ",\"args\":{\"name\":\"thread " << snapshot.thread_index << "\"}}";
+
+        for (auto& e : snapshot.events)
+        {
+            out << ",{\"name\":";
+            write_json_string(out, e.name);
+            out << ",\"cat\":\"mango\",\"ph\":\"X\",\"pid\":0,\"tid\":" << snapshot.thread_index;
+            out << ",\"ts\":" << static_cast<double>(e.begin - first_begin) * 0.001;
+            out << ",\"dur\":" << static_cast<double>(e.end - e.begin) * 0.001 << '}';
+        }
+    }
+    out << "]}\n";
+
+    if (!out.good())
+    {
+        MANGO_LOG_ERROR("Writing the trace to {0} failed!", path);
+        return false;
+    }
+    return true;
+}
@@ -4,12 +4,15 @@
 //! \date      2020
 //! \copyright Apache License 2.0
 
+#include <core/timer.hpp>
 #include <graphics/buffer.hpp>
 #include <graphics/command_buffer.hpp>
 #include <graphics/framebuffer.hpp>
+#include <graphics/sampler.hpp>
 #include <graphics/shader_program.hpp>
 #include <graphics/texture.hpp>
 #include <graphics/vertex_array.hpp>
+#include <mango/profile.hpp>
 
 using namespace mango;
 
@@ -34,6 +37,7 @@ command_buffer::~command_buffer()
 
 void command_buffer::execute()
 {
+    MANGO_PROFILE_ZONE("command buffer execute");
     MANGO_ASSERT(m_first != nullptr, "Command buffer is empty!");
     MANGO_ASSERT(m_last != nullptr, "Command buffer is empty!");
 
@@ -79,6 +83,68 @@ void command_buffer::set_viewport(uint32 x, uint32 y, uint32 width, uint32 heigh
     }
 }
 
+void command_buffer::set_scissor_test(bool enabled)
+{
+    class set_scissor_test_cmd : public command
+    {
+      public:
+        bool m_enabled;
+        set_scissor_test_cmd(bool enabled)
+            : m_enabled(enabled)
+        {
+        }
+
+        void execute(graphics_state& state) override
+        {
+            if (m_enabled)
+            {
+                glEnable(GL_SCISSOR_TEST);
+            }
+            else
+            {
+                glDisable(GL_SCISSOR_TEST);
+            }
+            state.set_scissor_test(m_enabled);
+        }
+    };
+
+    if (m_building_state.set_scissor_test(enabled))
+    {
+        submit<set_scissor_test_cmd>(enabled);
+    }
+}
+
+void command_buffer::set_scissor(uint32 x, uint32 y, uint32 width, uint32 height)
+{
+    class set_scissor_cmd : public command
+    {
+      public:
+        struct
+        {
+            uint32 x;
+            uint32 y;
+            uint32 width;
+            uint32 height;
+        } m_rect;
+
+        set_scissor_cmd(uint32 x, uint32 y, uint32 width, uint32 height)
+            : m_rect{ x, y, width, height }
+        {
+        }
+
+        void execute(graphics_state& state) override
+        {
+            glScissor(m_rect.x, m_rect.y, m_rect.width, m_rect.height);
+            state.set_scissor(m_rect.x, m_rect.y, m_rect.width, m_rect.height);
+        }
+    };
+
+    if (m_building_state.set_scissor(x, y, width, height))
+    {
+        submit<set_scissor_cmd>(x, y, width, height);
+    }
+}
+
 void command_buffer::set_depth_test(bool enabled)
 {
     class set_depth_test_cmd : public command
@@ -134,6 +200,55 @@ void command_buffer::set_depth_func(compare_operation op)
     }
 }
 
+void command_buffer::set_depth_write(bool enabled)
+{
+    class set_depth_write_cmd : public command
+    {
+      public:
+        bool m_enabled;
+        set_depth_write_cmd(bool enabled)
+            : m_enabled(enabled)
+        {
+        }
+
+        void execute(graphics_state& state) override
+        {
+            glDepthMask(m_enabled ? GL_TRUE : GL_FALSE);
+            state.set_depth_write(m_enabled);
+        }
+    };
+
+    if (m_building_state.set_depth_write(enabled))
+    {
+        submit<set_depth_write_cmd>(enabled);
+    }
+}
+
+void command_buffer::set_color_mask(bool enabled)
+{
+    class set_color_mask_cmd : public command
+    {
+      public:
+        bool m_enabled;
+        set_color_mask_cmd(bool enabled)
+            : m_enabled(enabled)
+        {
+        }
+
+        void execute(graphics_state& state) override
+        {
+            g_bool mask = m_enabled ? GL_TRUE : GL_FALSE;
+            glColorMask(mask, mask, mask, mask);
+            state.set_color_mask(m_enabled);
+        }
+    };
+
+    if (m_building_state.set_color_mask(enabled))
+    {
+        submit<set_color_mask_cmd>(enabled);
+    }
+}
+
 void command_buffer::set_polygon_mode(polygon_face face, polygon_mode mode)
 {
     class set_polygon_mode_cmd : public command
@@ -224,26 +339,28 @@ void command_buffer::bind_single_uniform(g_uint location, void* uniform_value, g
     class bind_single_uniform_cmd : public command
     {
       public:
-        std::vector<uint8> m_data;
+        //! \brief The value. Single uniforms are at most a mat4, so no allocation is required.
+        uint8 m_data[sizeof(glm::mat4)];
         g_uint m_location;
+        g_intptr m_data_size;
         bind_single_uniform_cmd(g_uint location, void* uniform_value, g_intptr data_size)
             : m_location(location)
+            , m_data_size(data_size)
         {
-            m_data.reserve(data_size);
-            memcpy(&m_data[0], static_cast<uint8*>(uniform_value), data_size);
+            MANGO_ASSERT(data_size <= static_cast<g_intptr>(sizeof(m_data)), "Single uniform is too big!");
+            memcpy(m_data, static_cast<uint8*>(uniform_value), static_cast<size_t>(data_size));
         }
 
         void execute(graphics_state& state) override
         {
-            void* data    = static_cast<void*>(m_data.data());
-            auto uniforms = state.m_internal_state.shader_program->get_single_bindings();
-            auto it       = uniforms.listed_data.find(m_location);
-            if (it == uniforms.listed_data.end())
-                return; // Ignore.
+            state.bind_single_uniform(m_location, m_data, m_data_size);
 
-            uniform_binding_data::uniform u = it->second;
+            void* data           = static_cast<void*>(m_data);
+            const auto& uniforms = state.m_internal_state.shader_program->get_single_bindings().listed_data;
+            if (m_location >= uniforms.size())
+                return; // Ignore.
 
-            switch (u.type)
+            switch (uniforms[m_location].type)
             {
             case shader_resource_type::FLOAT:
             {
@@ -301,14 +418,15 @@ void command_buffer::bind_single_uniform(g_uint location, void* uniform_value, g
                 glUniformMatrix4fv(m_location, 1, GL_FALSE, static_cast<float*>(data));
                 break;
             }
+            case shader_resource_type::NONE:
+                return; // Ignore, no active uniform at this location.
             default:
                 MANGO_LOG_ERROR("Unknown uniform type!");
             }
-            state.bind_single_uniform();
         }
     };
 
-    if (m_building_state.bind_single_uniform())
+    if (m_building_state.bind_single_uniform(location, uniform_value, data_size))
     {
         submit<bind_single_uniform_cmd>(location, uniform_value, data_size);
     }
@@ -326,9 +444,10 @@ void command_buffer::bind_uniform_buffer(g_uint index, buffer_ptr uniform_buffer
             , m_buffer(uniform_buffer)
         {
         }
-        void execute(graphics_state&) override
+        void execute(graphics_state& state) override
         {
             m_buffer->bind(buffer_target::UNIFORM_BUFFER, m_index, 0);
+            state.bind_uniform_buffer(m_index, m_buffer);
         }
     };
 
@@ -338,7 +457,41 @@ void command_buffer::bind_uniform_buffer(g_uint index, buffer_ptr uniform_buffer
     }
 }
 
-void command_buffer::bind_texture(uint32 binding, texture_ptr texture, g_uint uniform_location)
+void command_buffer::bind_buffer(buffer_target target, g_uint index, buffer_ptr buffer, g_intptr offset, g_sizeiptr size)
+{
+    class bind_buffer_cmd : public command
+    {
+      public:
+        buffer_target m_target;
+        g_uint m_index;
+        buffer_ptr m_buffer;
+        g_intptr m_offset;
+        g_sizeiptr m_size;
+        bind_buffer_cmd(buffer_target target, g_uint index, buffer_ptr buffer, g_intptr offset, g_sizeiptr size)
+            : m_target(target)
+            , m_index(index)
+            , m_buffer(buffer)
+            , m_offset(offset)
+            , m_size(size)
+        {
+        }
+
+        void execute(graphics_state& state) override
+        {
+            MANGO_ASSERT(m_buffer, "Buffer does not exist anymore.");
+            m_buffer->bind(m_target, m_index, m_offset, m_size);
+            state.bind_buffer(m_target, m_index, m_buffer->get_name(), m_offset, m_size);
+        }
+    };
+
+    MANGO_ASSERT(buffer, "Can not bind a non existent buffer!");
+    if (m_building_state.bind_buffer(target, index, buffer->get_name(), offset, size))
+    {
+        submit<bind_buffer_cmd>(target, index, buffer, offset, size);
+    }
+}
+
+void command_buffer::bind_texture(uint32 binding, texture_ptr texture, g_uint uniform_location, sampler_ptr sampler)
 {
     class bind_texture_cmd : public command
     {
@@ -346,32 +499,39 @@ void command_buffer::bind_texture(uint32 binding, texture_ptr texture, g_uint un
         uint32 m_binding;
         texture_ptr m_texture;
         uint32 m_uniform_location;
-        bind_texture_cmd(uint32 binding, texture_ptr texture, g_uint uniform_location)
+        sampler_ptr m_sampler;
+        bind_texture_cmd(uint32 binding, texture_ptr texture, g_uint uniform_location, sampler_ptr sampler)
             : m_binding(binding)
             , m_texture(texture)
             , m_uniform_location(uniform_location)
+            , m_sampler(sampler)
         {
         }
 
         void execute(graphics_state& state) override
         {
+            if (m_sampler)
+                m_sampler->bind_sampler_unit(m_binding);
+            else
+                glBindSampler(m_binding, 0);
+
             if (m_texture)
             {
                 m_texture->bind_texture_unit(m_binding);
-                state.bind_texture(m_binding, m_texture->get_name());
+                state.bind_texture(m_binding, m_texture->get_name(), m_sampler ? m_sampler->get_name() : 0);
                 glUniform1i(m_uniform_location, m_binding);
             }
             else
             {
                 glBindTextureUnit(m_binding, 0);
-                state.bind_texture(m_binding, 0);
+                state.bind_texture(m_binding, 0, m_sampler ? m_sampler->get_name() : 0);
             }
         }
     };
 
-    if (m_building_state.bind_texture(binding, texture ? texture->get_name() : 0))
+    if (m_building_state.bind_texture(binding, texture ? texture->get_name() : 0, sampler ? sampler->get_name() : 0))
     {
-        submit<bind_texture_cmd>(binding, texture, uniform_location);
+        submit<bind_texture_cmd>(binding, texture, uniform_location, sampler);
     }
 }
 
@@ -398,23 +558,18 @@ void command_buffer::bind_image_texture(uint32 binding, texture_ptr texture, g_i
         {
         }
 
-        void execute(graphics_state&) override
+        void execute(graphics_state& state) override
         {
-            if (m_texture)
-            {
-                glBindImageTexture(m_binding, m_texture->get_name(), m_level, m_layered, m_layer, m_access, m_element_format);
-            }
-            else
-            {
-                glBindImageTexture(m_binding, 0, m_level, m_layered, m_layer, m_access, m_element_format);
-            }
+            g_uint name = m_texture ? m_texture->get_name() : 0;
+            glBindImageTexture(m_binding, name, m_level, m_layered, m_layer, m_access, m_element_format);
+            state.bind_image_texture(m_binding, name, m_level, m_layered, m_layer, m_access, m_element_format);
         }
     };
 
-    //if (m_building_state.bind_texture(binding, texture ? texture->get_name() : 0)) // TODO Paul: We need extra handling in the state. Because of layer access.
-    //{
+    if (m_building_state.bind_image_texture(binding, texture ? texture->get_name() : 0, level, layered, layer, base_access_to_gl(access), static_cast<g_enum>(element_format)))
+    {
         submit<bind_image_texture_cmd>(binding, texture, level, layered, layer, access, element_format);
-    //}
+    }
 }
 
 void command_buffer::bind_framebuffer(framebuffer_ptr framebuffer)
@@ -507,6 +662,30 @@ void command_buffer::wait_for_buffer(buffer_ptr buffer)
     submit<wait_for_buffer_cmd>(buffer);
 }
 
+void command_buffer::write_timestamp(g_uint query, int64* cpu_timestamp)
+{
+    class write_timestamp_cmd : public command
+    {
+      public:
+        g_uint m_query;
+        int64* m_cpu_timestamp;
+        write_timestamp_cmd(g_uint query, int64* cpu_timestamp)
+            : m_query(query)
+            , m_cpu_timestamp(cpu_timestamp)
+        {
+        }
+
+        void execute(graphics_state&) override
+        {
+            glQueryCounter(m_query, GL_TIMESTAMP);
+            if (m_cpu_timestamp)
+                *m_cpu_timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+        }
+    };
+
+    submit<write_timestamp_cmd>(query, cpu_timestamp);
+}
+
 void command_buffer::calculate_mipmaps(texture_ptr texture)
 {
     class calculate_mipmaps_cmd : public command
@@ -621,7 +800,7 @@ void command_buffer::clear_framebuffer(clear_buffer_mask buffer_mask, attachment
     submit<clear_cmd>(framebuffer, buffer_mask, att_mask, r, g, b, a);
 }
 
-void command_buffer::draw_arrays(primitive_topology topology, uint32 first, uint32 count, uint32 instance_count)
+void command_buffer::draw_arrays(primitive_topology topology, uint32 first, uint32 count, uint32 instance_count, uint32 base_instance)
 {
     class draw_arrays_cmd : public command
     {
@@ -630,17 +809,23 @@ void command_buffer::draw_arrays(primitive_topology topology, uint32 first, uint
         uint32 m_first;
         uint32 m_count;
         uint32 m_instance_count;
-        draw_arrays_cmd(primitive_topology topology, uint32 first, uint32 count, uint32 instance_count)
+        uint32 m_base_instance;
+        draw_arrays_cmd(primitive_topology topology, uint32 first, uint32 count, uint32 instance_count, uint32 base_instance)
             : m_topology(topology)
             , m_first(first)
             , m_count(count)
             , m_instance_count(instance_count)
+            , m_base_instance(base_instance)
         {
         }
 
         void execute(graphics_state&) override
         {
-            if (m_instance_count > 1)
+            if (m_base_instance > 0)
+            {
+                glDrawArraysInstancedBaseInstance(static_cast<g_enum>(m_topology), m_first, m_count, m_instance_count, m_base_instance);
+            }
+            else if (m_instance_count > 1)
             {
                 glDrawArraysInstanced(static_cast<g_enum>(m_topology), m_first, m_count, m_instance_count);
             }
@@ -651,10 +836,10 @@ void command_buffer::draw_arrays(primitive_topology topology, uint32 first, uint
         }
     };
 
-    submit<draw_arrays_cmd>(topology, first, count, instance_count);
+    submit<draw_arrays_cmd>(topology, first, count, instance_count, base_instance);
 }
 
-void command_buffer::draw_elements(primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count)
+void command_buffer::draw_elements(primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count, uint32 base_instance)
 {
     class draw_elements_cmd : public command
     {
@@ -664,18 +849,24 @@ void command_buffer::draw_elements(primitive_topology topology, uint32 first, ui
         uint32 m_count;
         index_type m_type;
         uint32 m_instance_count;
-        draw_elements_cmd(primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count)
+        uint32 m_base_instance;
+        draw_elements_cmd(primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count, uint32 base_instance)
             : m_topology(topology)
             , m_first(first)
             , m_count(count)
             , m_type(type)
             , m_instance_count(instance_count)
+            , m_base_instance(base_instance)
         {
         }
 
         void execute(graphics_state&) override
         {
-            if (m_instance_count > 1)
+            if (m_base_instance > 0)
+            {
+                glDrawElementsInstancedBaseInstance(static_cast<g_enum>(m_topology), m_count, static_cast<g_enum>(m_type), (g_byte*)NULL + m_first, m_instance_count, m_base_instance);
+            }
+            else if (m_instance_count > 1)
             {
                 glDrawElementsInstanced(static_cast<g_enum>(m_topology), m_count, static_cast<g_enum>(m_type), (g_byte*)NULL + m_first, m_instance_count);
             }
@@ -686,7 +877,37 @@ void command_buffer::draw_elements(primitive_topology topology, uint32 first, ui
         }
     };
 
-    submit<draw_elements_cmd>(topology, first, count, type, instance_count);
+    submit<draw_elements_cmd>(topology, first, count, type, instance_count, base_instance);
+}
+
+void command_buffer::draw_elements_indirect(primitive_topology topology, index_type type, buffer_ptr indirect_buffer, g_intptr offset)
+{
+    class draw_elements_indirect_cmd : public command
+    {
+      public:
+        primitive_topology m_topology;
+        index_type m_type;
+        buffer_ptr m_indirect_buffer;
+        g_intptr m_offset;
+        draw_elements_indirect_cmd(primitive_topology topology, index_type type, buffer_ptr indirect_buffer, g_intptr offset)
+            : m_topology(topology)
+            , m_type(type)
+            , m_indirect_buffer(indirect_buffer)
+            , m_offset(offset)
+        {
+        }
+
+        void execute(graphics_state&) override
+        {
+            MANGO_ASSERT(m_indirect_buffer, "Indirect buffer does not exist anymore.");
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirect_buffer->get_name());
+            glDrawElementsIndirect(static_cast<g_enum>(m_topology), static_cast<g_enum>(m_type), (g_byte*)NULL + m_offset);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+    };
+
+    MANGO_ASSERT(indirect_buffer, "Can not draw with a non existent indirect buffer!");
+    submit<draw_elements_indirect_cmd>(topology, type, indirect_buffer, offset);
 }
 
 void command_buffer::dispatch_compute(uint32 num_x_groups, uint32 num_y_groups, uint32 num_z_groups)
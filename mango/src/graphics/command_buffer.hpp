@@ -53,6 +53,18 @@ namespace mango
         //! \param[in] height The height of the viewport.
         void set_viewport(uint32 x, uint32 y, uint32 width, uint32 height);
 
+        //! \brief Enables or disables the scissor test.
+        //! \details Clears are limited to the scissor rectangle as well.
+        //! \param[in] enabled True if the scissor test should be enabled, else false.
+        void set_scissor_test(bool enabled);
+
+        //! \brief Sets the scissor rectangle.
+        //! \param[in] x The x position of the scissor rectangle.
+        //! \param[in] y The y position of the scissor rectangle.
+        //! \param[in] width The width of the scissor rectangle.
+        //! \param[in] height The height of the scissor rectangle.
+        void set_scissor(uint32 x, uint32 y, uint32 width, uint32 height);
+
         //! \brief Clears attachments of a framebuffer.
         //! \param[in] buffer_mask The mask describes which buffers should be cleared.
         //! \param[in] att_mask The mask describes which attachments should be cleared.
@@ -71,6 +83,15 @@ namespace mango
         //! \param[in] op The \a compare_operation to use for depth testing.
         void set_depth_func(compare_operation op);
 
+        //! \brief Enables or disables writing to the depth buffer.
+        //! \details Clearing the depth buffer also requires depth writes to be enabled.
+        //! \param[in] enabled True if depth values should be written, else false.
+        void set_depth_write(bool enabled);
+
+        //! \brief Enables or disables writing to all color buffers.
+        //! \param[in] enabled True if color values should be written, else false.
+        void set_color_mask(bool enabled);
+
         //! \brief Sets the \a polygon_mode as well as the \a polygon_faces used for drawing.
         //! \param[in] face The \a polygon_faces to draw.
         //! \param[in] mode The \a polygon_mode used for drawing.
@@ -96,11 +117,20 @@ namespace mango
         //! \param[in] uniform_buffer The \a uniform \a buffer to bind.
         void bind_uniform_buffer(g_uint index, buffer_ptr uniform_buffer);
 
+        //! \brief Binds a range of a \a buffer to an indexed target.
+        //! \param[in] target The \a buffer_target to bind to. Has to be \a UNIFORM_BUFFER or \a SHADER_STORAGE_BUFFER.
+        //! \param[in] index The index to bind the \a buffer to.
+        //! \param[in] buffer The \a buffer to bind.
+        //! \param[in] offset The offset of the range in bytes.
+        //! \param[in] size The size of the range in bytes.
+        void bind_buffer(buffer_target target, g_uint index, buffer_ptr buffer, g_intptr offset, g_sizeiptr size);
+
         //! \brief Binds a \a texture for drawing.
         //! \param[in] binding The binding location to bind the \a texture to.
         //! \param[in] texture A pointer to the \a texture to bind.
         //! \param[in] uniform_location The location to bind the index integer value to.
-        void bind_texture(uint32 binding, texture_ptr texture, g_uint uniform_location);
+        //! \param[in] sampler A pointer to the \a sampler to bind to the same binding. Leave empty or pass nullptr to use the parameters of the \a texture.
+        void bind_texture(uint32 binding, texture_ptr texture, g_uint uniform_location, sampler_ptr sampler = nullptr);
 
         //! \brief Binds a \a texture as an image.
         //! \param[in] binding The binding location to bind the \a texture to.
@@ -128,6 +158,12 @@ namespace mango
         //! \param[in] buffer The pointer to the \a buffer to wait for.
         void wait_for_buffer(buffer_ptr buffer);
 
+        //! \brief Records a gpu timestamp, when all previous commands are completely executed on the gpu.
+        //! \details The result can be retrieved without stalling once GL_QUERY_RESULT_AVAILABLE is set for the query.
+        //! \param[in] query The name of the query object. Has to be created with GL_TIMESTAMP as target.
+        //! \param[out] cpu_timestamp Optional location to store the cpu time in nanoseconds when the command is executed. Has to stay valid until execution.
+        void write_timestamp(g_uint query, int64* cpu_timestamp = nullptr);
+
         //! \brief Calcukates the mipmaps for the \a texture.
         //! \details This is used to recalculate the mipmaps after the pixels where changed by a compute shader.
         //! \param[in] texture The pointer to the \a texture to calculate the mipmaps.
@@ -139,7 +175,8 @@ namespace mango
         //! \param[in] first The first index to start drawing from.
         //! \param[in] count The number of vertices to draw.
         //! \param[in] instance_count The number of instances to draw. For normal drawing pass 1.
-        void draw_arrays(primitive_topology topology, uint32 first, uint32 count, uint32 instance_count = 1);
+        //! \param[in] base_instance The base instance. Also readable in shaders as gl_BaseInstance, if supported.
+        void draw_arrays(primitive_topology topology, uint32 first, uint32 count, uint32 instance_count = 1, uint32 base_instance = 0);
 
         //! \brief Draws elements.
         //! \details All the information not given in the argument list is retrieved from the state.
@@ -148,7 +185,16 @@ namespace mango
         //! \param[in] count The number of indices to draw.
         //! \param[in] type The \a index_type of the values in the index buffer.
         //! \param[in] instance_count The number of instances to draw. For normal drawing pass 1.
-        void draw_elements(primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count = 1);
+        //! \param[in] base_instance The base instance. Also readable in shaders as gl_BaseInstance, if supported.
+        void draw_elements(primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count = 1, uint32 base_instance = 0);
+
+        //! \brief Draws elements with the parameters stored in a \a buffer.
+        //! \details All the information not given in the argument list is retrieved from the state.
+        //! \param[in] topology The topology used for drawing the bound vertex data.
+        //! \param[in] type The \a index_type of the values in the index buffer.
+        //! \param[in] indirect_buffer The \a buffer with the count, instance count, first index, base vertex and base instance of the draw.
+        //! \param[in] offset The offset of the parameters in the \a buffer in bytes.
+        void draw_elements_indirect(primitive_topology topology, index_type type, buffer_ptr indirect_buffer, g_intptr offset = 0);
 
         //! \brief Enables or disables face culling.
         //! \param[in] enabled True if face culling should be enabled, else false.
@@ -86,6 +86,7 @@ namespace mango
         virtual uint32 get_height() = 0;
 
         //! \brief Resizes the \a framebuffer and all its attachments.
+        //! \details The attachments are recreated, nothing is done if the size does not change.
         //! \param[in] width The new width of the \a framebuffer in pixels.
         //! \param[in] height The new height of the \a framebuffer in pixels.
         virtual void resize(uint32 width, uint32 height) = 0;
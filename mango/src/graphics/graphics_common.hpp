@@ -7,6 +7,7 @@
 #ifndef MANGO_GRAPHICS_COMMON_HPP
 #define MANGO_GRAPHICS_COMMON_HPP
 
+#include <cstring>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <mango/assert.hpp>
@@ -25,6 +26,8 @@ namespace mango
     MANGO_GRAPHICS_OBJECT_IMPL(buffer)
     MANGO_GRAPHICS_OBJECT(texture)
     MANGO_GRAPHICS_OBJECT_IMPL(texture)
+    MANGO_GRAPHICS_OBJECT(sampler)
+    MANGO_GRAPHICS_OBJECT_IMPL(sampler)
     MANGO_GRAPHICS_OBJECT(shader)
     MANGO_GRAPHICS_OBJECT_IMPL(shader)
     MANGO_GRAPHICS_OBJECT(shader_program)
@@ -61,6 +64,12 @@ namespace mango
         texture_ptr normal_texture;             //!< The texture for normals.
         texture_ptr emissive_color_texture;     //!< The texture for the emissive color value.
 
+        sampler_ptr base_color_sampler;         //!< The sampler for the base_color_texture. Nullptr to use the parameters of the texture.
+        sampler_ptr roughness_metallic_sampler; //!< The sampler for the roughness_metallic_texture. Nullptr to use the parameters of the texture.
+        sampler_ptr occlusion_sampler;          //!< The sampler for the occlusion_texture. Nullptr to use the parameters of the texture.
+        sampler_ptr normal_sampler;             //!< The sampler for the normal_texture. Nullptr to use the parameters of the texture.
+        sampler_ptr emissive_color_sampler;     //!< The sampler for the emissive_color_texture. Nullptr to use the parameters of the texture.
+
         bool double_sided;          //!< Specifies if the material is double sided.
         alpha_mode alpha_rendering; //!< Specifies the materials alpha mode.
         float alpha_cutoff;         //!< Specifies a cutoff value if alpha_rendering is MASK.
@@ -314,6 +323,7 @@ namespace mango
         UNSIGNED_INT_10_10_10_2     = 0x8036,
         UNSIGNED_INT_2_10_10_10_REV = 0x8368,
         INT_2_10_10_10_REV          = 0x8D9F,
+        UNSIGNED_INT_24_8           = 0x84FA,
         // internal_formats
         R8                 = 0x8229,
         R16                = 0x822A,
@@ -370,6 +380,7 @@ namespace mango
         DEPTH_COMPONENT16  = 0x81A5,
         DEPTH_COMPONENT24  = 0x81A6,
         DEPTH_COMPONENT32  = 0x81A7,
+        DEPTH24_STENCIL8   = 0x88F0,
         // Pixel formats
         DEPTH_COMPONENT = 0x1902,
         STENCIL_INDEX   = 0x1901,
@@ -554,6 +565,10 @@ namespace mango
             number_of_components = 4;
             normalized           = true;
             return GL_UNSIGNED_INT;
+        case format::INT_2_10_10_10_REV:
+            number_of_components = 4;
+            normalized           = true;
+            return GL_INT_2_10_10_10_REV;
         default:
             MANGO_ASSERT(false, "Invalid format! Could also be, that I did not think of adding this here!");
             return GL_NONE;
@@ -729,6 +744,12 @@ namespace mango
             return 4 * sizeof(g_ushort);
         case format::RGBA32UI:
             return 4 * sizeof(g_uint);
+        case format::RGB10_A2:
+            return 1 * sizeof(g_uint);
+        case format::DEPTH_COMPONENT32F:
+            return 1 * sizeof(g_float);
+        case format::DEPTH24_STENCIL8:
+            return 1 * sizeof(g_uint);
         default:
             MANGO_ASSERT(false, "Invalid internal format! Could also be, that I did not think of adding this here!");
             return 0;
@@ -951,7 +972,8 @@ namespace mango
         VERTEX_BUFFER,
         INDEX_BUFFER,
         UNIFORM_BUFFER,
-        TEXTURE_BUFFER
+        TEXTURE_BUFFER,
+        SHADER_STORAGE_BUFFER
     };
 
     //! \brief A set of access bits used for accessing buffers.
@@ -1269,6 +1291,23 @@ namespace mango
         }
     }
 
+    //! \brief Checks if the driver supports an OpenGl extension.
+    //! \details Requires a current context. Iterates over all extensions, so the result should be stored if it is required frequently.
+    //! \param[in] name The name of the extension, e.g. GL_ARB_bindless_texture.
+    //! \return True if the extension is available, else false.
+    inline bool extension_supported(const char* name)
+    {
+        g_int ext_count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &ext_count);
+        for (g_int i = 0; i < ext_count; ++i)
+        {
+            const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<g_uint>(i)));
+            if (ext && std::strcmp(ext, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
 } // namespace mango
 
 #endif // MANGO_GRAPHICS_COMMON_HPP
\ No newline at end of file
@@ -4,32 +4,44 @@
 //! \date      2020
 //! \copyright Apache License 2.0
 
+#include <algorithm>
+#include <cstring>
+#include <graphics/buffer.hpp>
 #include <graphics/graphics_state.hpp>
 #include <graphics/shader_program.hpp>
 #include <graphics/vertex_array.hpp>
 #include <mango/assert.hpp>
-#include <map>
 
 using namespace mango;
 
 graphics_state::graphics_state()
 {
     m_internal_state.shader_program        = nullptr;
+    m_internal_state.shader_program_name   = 0;
     m_internal_state.framebuffer           = nullptr;
     m_internal_state.vertex_array          = nullptr;
     m_internal_state.viewport.x            = 0;
     m_internal_state.viewport.y            = 0;
     m_internal_state.viewport.width        = 0;
     m_internal_state.viewport.height       = 0;
+    m_internal_state.scissor.enabled       = false;
+    m_internal_state.scissor.x             = 0;
+    m_internal_state.scissor.y             = 0;
+    m_internal_state.scissor.width         = 0;
+    m_internal_state.scissor.height        = 0;
     m_internal_state.poly_mode.face        = polygon_face::FACE_FRONT_AND_BACK;
     m_internal_state.poly_mode.mode        = polygon_mode::FILL;
     m_internal_state.depth_test.enabled    = false;
     m_internal_state.depth_test.depth_func = compare_operation::LESS;
+    m_internal_state.depth_test.write      = true;
+    m_internal_state.color_mask            = true;
     m_internal_state.face_culling.enabled  = false;
     m_internal_state.face_culling.face     = polygon_face::FACE_BACK;
     m_internal_state.blending.enabled      = false;
     m_internal_state.blending.src          = blend_factor::ONE;
     m_internal_state.blending.dest         = blend_factor::ZERO;
+    m_change_counters.issued               = 0;
+    m_change_counters.elided               = 0;
 }
 
 bool graphics_state::set_viewport(uint32 x, uint32 y, uint32 width, uint32 height)
@@ -40,9 +52,32 @@ bool graphics_state::set_viewport(uint32 x, uint32 y, uint32 width, uint32 heigh
         m_internal_state.viewport.y      = y;
         m_internal_state.viewport.width  = width;
         m_internal_state.viewport.height = height;
-        return true;
+        return changed();
     }
-    return false;
+    return elided();
+}
+
+bool graphics_state::set_scissor_test(bool enabled)
+{
+    if (m_internal_state.scissor.enabled != enabled)
+    {
+        m_internal_state.scissor.enabled = enabled;
+        return changed();
+    }
+    return elided();
+}
+
+bool graphics_state::set_scissor(uint32 x, uint32 y, uint32 width, uint32 height)
+{
+    if (x != m_internal_state.scissor.x || y != m_internal_state.scissor.y || width != m_internal_state.scissor.width || height != m_internal_state.scissor.height)
+    {
+        m_internal_state.scissor.x      = x;
+        m_internal_state.scissor.y      = y;
+        m_internal_state.scissor.width  = width;
+        m_internal_state.scissor.height = height;
+        return changed();
+    }
+    return elided();
 }
 
 bool graphics_state::set_depth_test(bool enabled)
@@ -50,9 +85,9 @@ bool graphics_state::set_depth_test(bool enabled)
     if (m_internal_state.depth_test.enabled != enabled)
     {
         m_internal_state.depth_test.enabled = enabled;
-        return true;
+        return changed();
     }
-    return false;
+    return elided();
 }
 
 bool graphics_state::set_depth_func(compare_operation op)
@@ -60,9 +95,29 @@ bool graphics_state::set_depth_func(compare_operation op)
     if (m_internal_state.depth_test.depth_func != op)
     {
         m_internal_state.depth_test.depth_func = op;
-        return true;
+        return changed();
     }
-    return false;
+    return elided();
+}
+
+bool graphics_state::set_depth_write(bool enabled)
+{
+    if (m_internal_state.depth_test.write != enabled)
+    {
+        m_internal_state.depth_test.write = enabled;
+        return changed();
+    }
+    return elided();
+}
+
+bool graphics_state::set_color_mask(bool enabled)
+{
+    if (m_internal_state.color_mask != enabled)
+    {
+        m_internal_state.color_mask = enabled;
+        return changed();
+    }
+    return elided();
 }
 
 bool graphics_state::set_polygon_mode(polygon_face face, polygon_mode mode)
@@ -71,9 +126,9 @@ bool graphics_state::set_polygon_mode(polygon_face face, polygon_mode mode)
     {
         m_internal_state.poly_mode.face = face;
         m_internal_state.poly_mode.mode = mode;
-        return true;
+        return changed();
     }
-    return false;
+    return elided();
 }
 
 bool graphics_state::bind_vertex_array(vertex_array_ptr vertex_array)
@@ -81,47 +136,120 @@ bool graphics_state::bind_vertex_array(vertex_array_ptr vertex_array)
     if (m_internal_state.vertex_array != vertex_array)
     {
         m_internal_state.vertex_array = vertex_array;
-        return true;
+        return changed();
     }
-    return false;
+    return elided();
 }
 
 bool graphics_state::bind_shader_program(shader_program_ptr shader_program)
 {
-    if (m_internal_state.shader_program != shader_program)
+    g_uint name = shader_program ? shader_program->get_name() : 0;
+    if (m_internal_state.shader_program != shader_program || m_internal_state.shader_program_name != name)
     {
-        m_internal_state.shader_program = shader_program;
-        m_internal_state.m_active_texture_bindings.fill(0);
-        return true;
+        m_internal_state.shader_program      = shader_program;
+        m_internal_state.shader_program_name = name;
+        // sampler uniforms are set when textures are bound, they are part of the program state.
+        std::fill(m_internal_state.m_active_texture_bindings.begin(), m_internal_state.m_active_texture_bindings.end(), 0);
+        std::fill(m_internal_state.m_active_sampler_bindings.begin(), m_internal_state.m_active_sampler_bindings.end(), 0);
+
+        // a name can be reused by a new program after the old one was released.
+        if (shader_program)
+        {
+            program_uniforms& uniforms = m_internal_state.m_uniforms[name];
+            if (uniforms.program.lock() != shader_program)
+            {
+                uniforms.program = shader_program;
+                uniforms.values.clear();
+            }
+        }
+        return changed();
     }
-    return false;
+    return elided();
 }
 
-bool graphics_state::bind_single_uniform()
+bool graphics_state::bind_single_uniform(g_uint location, const void* uniform_value, g_intptr data_size)
 {
-    // TODO Paul
-    return true;
+    MANGO_ASSERT(data_size <= static_cast<g_intptr>(sizeof(uniform_data::data)), "Single uniform is too big!");
+    if (!m_internal_state.shader_program)
+        return changed();
+
+    auto& values = m_internal_state.m_uniforms[m_internal_state.shader_program_name].values;
+    auto it      = values.find(location);
+    if (it == values.end() || it->second.size != data_size || std::memcmp(it->second.data, uniform_value, static_cast<size_t>(data_size)) != 0)
+    {
+        uniform_data& value = values[location];
+        value.size          = data_size;
+        std::memcpy(value.data, uniform_value, static_cast<size_t>(data_size));
+        return changed();
+    }
+    return elided();
 }
 
 bool graphics_state::bind_uniform_buffer(g_uint index, buffer_ptr uniform_buffer)
 {
-    MANGO_UNUSED(index);
-    MANGO_UNUSED(uniform_buffer);
-    // TODO Paul
-    return true;
+    return bind_buffer(buffer_target::UNIFORM_BUFFER, index, uniform_buffer ? uniform_buffer->get_name() : 0, 0, uniform_buffer ? static_cast<g_sizeiptr>(uniform_buffer->byte_length()) : 0);
+}
+
+bool graphics_state::bind_buffer(buffer_target target, g_uint index, g_uint name, g_intptr offset, g_sizeiptr size)
+{
+    std::vector<buffer_binding>* bindings = nullptr;
+    if (target == buffer_target::UNIFORM_BUFFER)
+        bindings = &m_internal_state.m_active_uniform_buffers;
+    else if (target == buffer_target::SHADER_STORAGE_BUFFER)
+        bindings = &m_internal_state.m_active_storage_buffers;
+    else
+        return changed();
+
+    if (index >= bindings->size())
+        bindings->resize(index + 1, { 0, 0, 0 });
+
+    buffer_binding& binding = bindings->at(index);
+    if (binding.name != name || binding.offset != offset || binding.size != size)
+    {
+        binding.name   = name;
+        binding.offset = offset;
+        binding.size   = size;
+        return changed();
+    }
+    return elided();
+}
+
+bool graphics_state::bind_image_texture(uint32 binding, g_uint name, g_int level, bool layered, g_int layer, g_enum access, g_enum element_format)
+{
+    auto& images = m_internal_state.m_active_image_bindings;
+    if (binding >= images.size())
+        images.resize(binding + 1, { 0, 0, false, 0, 0, 0 });
+
+    image_binding& image = images.at(binding);
+    if (image.name != name || image.level != level || image.layered != layered || image.layer != layer || image.access != access || image.element_format != element_format)
+    {
+        image.name           = name;
+        image.level          = level;
+        image.layered        = layered;
+        image.layer          = layer;
+        image.access         = access;
+        image.element_format = element_format;
+        return changed();
+    }
+    return elided();
 }
 
-bool graphics_state::bind_texture(uint32 binding, uint32 name)
+bool graphics_state::bind_texture(uint32 binding, uint32 name, uint32 sampler_name)
 {
-    if (binding > max_texture_bindings)
-        return true;
+    if (binding >= m_internal_state.m_active_texture_bindings.size())
+    {
+        m_internal_state.m_active_texture_bindings.resize(binding + 1, 0);
+        m_internal_state.m_active_sampler_bindings.resize(binding + 1, 0);
+    }
     auto& t_name = m_internal_state.m_active_texture_bindings.at(binding);
-    if (t_name != name)
+    auto& s_name = m_internal_state.m_active_sampler_bindings.at(binding);
+    if (t_name != name || s_name != sampler_name)
     {
         t_name = name;
-        return true;
+        s_name = sampler_name;
+        return changed();
     }
-    return false;
+    return elided();
 }
 
 bool graphics_state::bind_framebuffer(framebuffer_ptr framebuffer)
@@ -129,9 +257,9 @@ bool graphics_state::bind_framebuffer(framebuffer_ptr framebuffer)
     if (m_internal_state.framebuffer != framebuffer)
     {
         m_internal_state.framebuffer = framebuffer;
-        return true;
+        return changed();
     }
-    return false;
+    return elided();
 }
 
 bool graphics_state::set_face_culling(bool enabled)
@@ -139,9 +267,9 @@ bool graphics_state::set_face_culling(bool enabled)
     if (m_internal_state.face_culling.enabled != enabled)
     {
         m_internal_state.face_culling.enabled = enabled;
-        return true;
+        return changed();
     }
-    return false;
+    return elided();
 }
 
 bool graphics_state::set_cull_face(polygon_face face)
@@ -149,9 +277,9 @@ bool graphics_state::set_cull_face(polygon_face face)
     if (m_internal_state.face_culling.face != face)
     {
         m_internal_state.face_culling.face = face;
-        return true;
+        return changed();
     }
-    return false;
+    return elided();
 }
 
 bool graphics_state::set_blending(bool enabled)
@@ -159,9 +287,9 @@ bool graphics_state::set_blending(bool enabled)
     if (m_internal_state.blending.enabled != enabled)
     {
         m_internal_state.blending.enabled = enabled;
-        return true;
+        return changed();
     }
-    return false;
+    return elided();
 }
 
 bool graphics_state::set_blend_factors(blend_factor source, blend_factor destination)
@@ -170,7 +298,19 @@ bool graphics_state::set_blend_factors(blend_factor source, blend_factor destina
     {
         m_internal_state.blending.src  = source;
         m_internal_state.blending.dest = destination;
-        return true;
+        return changed();
     }
+    return elided();
+}
+
+bool graphics_state::changed()
+{
+    m_change_counters.issued++;
+    return true;
+}
+
+bool graphics_state::elided()
+{
+    m_change_counters.elided++;
     return false;
 }
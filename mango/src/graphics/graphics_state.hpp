@@ -8,6 +8,8 @@
 #define MANGO_GRAPHICS_STATE
 
 #include <graphics/graphics_common.hpp>
+#include <unordered_map>
+#include <vector>
 
 namespace mango
 {
@@ -15,7 +17,7 @@ namespace mango
     //! \details This is mostly used to avoid unnecessary calls to the gpu.
     //! The calls do only change values in this state; there is nothing changed in the real graphics state.
     //! All functions return true, if the values in the current state were changed, else false.
-    //! This is used to check if a real call is required.
+    //! This is used to check if a real call is required. The number of required and redundant changes is counted.
     struct graphics_state
     {
       public:
@@ -30,6 +32,19 @@ namespace mango
         //! \return True if state changed, else false.
         bool set_viewport(uint32 x, uint32 y, uint32 width, uint32 height);
 
+        //! \brief Enables or disables the scissor test.
+        //! \param[in] enabled True if the scissor test should be enabled, else false.
+        //! \return True if state changed, else false.
+        bool set_scissor_test(bool enabled);
+
+        //! \brief Sets the scissor rectangle.
+        //! \param[in] x The x position of the scissor rectangle.
+        //! \param[in] y The y position of the scissor rectangle.
+        //! \param[in] width The width of the scissor rectangle.
+        //! \param[in] height The height of the scissor rectangle.
+        //! \return True if state changed, else false.
+        bool set_scissor(uint32 x, uint32 y, uint32 width, uint32 height);
+
         //! \brief Enables or disables the depth test.
         //! \param[in] enabled True if the depth test should be enabled, else false.
         //! \return True if state changed, else false.
@@ -40,6 +55,16 @@ namespace mango
         //! \return True if state changed, else false.
         bool set_depth_func(compare_operation op);
 
+        //! \brief Enables or disables writing to the depth buffer.
+        //! \param[in] enabled True if depth values should be written, else false.
+        //! \return True if state changed, else false.
+        bool set_depth_write(bool enabled);
+
+        //! \brief Enables or disables writing to all color buffers.
+        //! \param[in] enabled True if color values should be written, else false.
+        //! \return True if state changed, else false.
+        bool set_color_mask(bool enabled);
+
         //! \brief Sets the \a polygon_mode as well as the \a polygon_faces used for drawing.
         //! \param[in] face The \a polygon_faces to draw.
         //! \param[in] mode The \a polygon_mode used for drawing.
@@ -56,10 +81,13 @@ namespace mango
         //! \return True if state changed, else false.
         bool bind_shader_program(shader_program_ptr shader_program);
 
-        //! \brief Binds a non buffered uniform.
-        //! \details This gets reset after every draw call.
+        //! \brief Binds a non buffered uniform of the bound \a shader_program.
+        //! \details The values are cached per \a shader_program and location, since they are part of the program state.
+        //! \param[in] location The uniform location to bind the value to.
+        //! \param[in] uniform_value Pointer to the value.
+        //! \param[in] data_size Size of the value in bytes.
         //! \return True if state changed, else false.
-        bool bind_single_uniform();
+        bool bind_single_uniform(g_uint location, const void* uniform_value, g_intptr data_size);
 
         //! \brief Binds an \a uniform \a buffer for drawing.
         //! \param[in] index The \a uniform \a buffer index to bind the \a buffer to.
@@ -67,11 +95,32 @@ namespace mango
         //! \return True if state changed, else false.
         bool bind_uniform_buffer(g_uint index, buffer_ptr uniform_buffer);
 
+        //! \brief Binds a range of a \a buffer to an indexed target.
+        //! \param[in] target The \a buffer_target. Only \a UNIFORM_BUFFER and \a SHADER_STORAGE_BUFFER bindings are cached.
+        //! \param[in] index The index to bind the \a buffer to.
+        //! \param[in] name The name of the \a buffer.
+        //! \param[in] offset The offset of the range in bytes.
+        //! \param[in] size The size of the range in bytes.
+        //! \return True if state changed, else false.
+        bool bind_buffer(buffer_target target, g_uint index, g_uint name, g_intptr offset, g_sizeiptr size);
+
+        //! \brief Binds a \a texture as an image.
+        //! \param[in] binding The image unit to bind the \a texture to.
+        //! \param[in] name The name of the \a texture.
+        //! \param[in] level The level of the image.
+        //! \param[in] layered Specifies whether a layered texture binding is established.
+        //! \param[in] layer The layer if \a layered is false.
+        //! \param[in] access The access as an OpenGL enumeration.
+        //! \param[in] element_format The format used for formatted stores as an OpenGL enumeration.
+        //! \return True if state changed, else false.
+        bool bind_image_texture(uint32 binding, g_uint name, g_int level, bool layered, g_int layer, g_enum access, g_enum element_format);
+
         //! \brief Binds a \a texture for drawing.
         //! \param[in] binding The binding location to bind the \a texture too.
         //! \param[in] name The name of the \a texture.
+        //! \param[in] sampler_name The name of the \a sampler bound to the same binding. 0 if the \a texture parameters are used.
         //! \return True if state changed, else false.
-        bool bind_texture(uint32 binding, uint32 name);
+        bool bind_texture(uint32 binding, uint32 name, uint32 sampler_name = 0);
 
         //! \brief Binds a \a framebuffer for drawing.
         //! \param[in] framebuffer The pointer to the \a framebuffer to bind.
@@ -99,16 +148,53 @@ namespace mango
         //! \return True if state changed, else false.
         bool set_blend_factors(blend_factor source, blend_factor destination);
 
-        //! \brief The maximum number of texture bindings (not really, just supported by the state).
-        const static uint32 max_texture_bindings = 16; // TODO Paul: We should really define these things somewhere else. And query from OpenGL.
+        //! \brief A range of a \a buffer bound to an indexed target.
+        struct buffer_binding
+        {
+            g_uint name;     //!< The name of the \a buffer.
+            g_intptr offset; //!< The offset of the range in bytes.
+            g_sizeiptr size; //!< The size of the range in bytes.
+        };
+
+        //! \brief A \a texture bound as an image.
+        struct image_binding
+        {
+            g_uint name;           //!< The name of the \a texture.
+            g_int level;           //!< The level of the image.
+            bool layered;          //!< True if the binding is layered.
+            g_int layer;           //!< The layer if not layered.
+            g_enum access;         //!< The access.
+            g_enum element_format; //!< The format used for formatted stores.
+        };
+
+        //! \brief The value of a single uniform. Single uniforms are at most a mat4.
+        struct uniform_data
+        {
+            g_intptr size;                  //!< The size of the value in bytes.
+            uint8 data[sizeof(float) * 16]; //!< The value.
+        };
+
+        //! \brief The single uniform values of one \a shader_program.
+        struct program_uniforms
+        {
+            weak_ptr<shader_program> program;                  //!< The \a shader_program. Used to detect names reused by new programs.
+            std::unordered_map<g_uint, uniform_data> values; //!< The values by location.
+        };
+
         //! \brief Structure to cache the state of the graphics pipeline.
         struct internal_state
         {
             shader_program_ptr shader_program; //!< Cached shader program.
+            g_uint shader_program_name;        //!< The name of the cached shader program. Changes when the shader program is reloaded.
             framebuffer_ptr framebuffer;       //!< Cached framebuffer.
             vertex_array_ptr vertex_array;     //!< Cached vertex array.
 
-            std::array<uint32, max_texture_bindings> m_active_texture_bindings; //!< Bindings from binding points to texture names.
+            std::vector<uint32> m_active_texture_bindings;           //!< Bindings from binding points to texture names.
+            std::vector<uint32> m_active_sampler_bindings;           //!< Bindings from binding points to sampler names.
+            std::vector<image_binding> m_active_image_bindings;      //!< Bindings from image units to images.
+            std::vector<buffer_binding> m_active_uniform_buffers;    //!< Bindings from uniform buffer indices to buffer ranges.
+            std::vector<buffer_binding> m_active_storage_buffers;    //!< Bindings from shader storage buffer indices to buffer ranges.
+            std::unordered_map<g_uint, program_uniforms> m_uniforms; //!< Single uniform values by \a shader_program name.
 
             struct
             {
@@ -118,6 +204,15 @@ namespace mango
                 uint32 height; //!< Viewport height.
             } viewport;        //!< Cached viewport.
 
+            struct
+            {
+                bool enabled;  //!< Enabled or disabled.
+                uint32 x;      //!< Scissor rectangle x position.
+                uint32 y;      //!< Scissor rectangle y position.
+                uint32 width;  //!< Scissor rectangle width.
+                uint32 height; //!< Scissor rectangle height.
+            } scissor;         //!< Cached scissor test.
+
             struct
             {
                 polygon_face face; //!< Polygon mode face.
@@ -128,8 +223,11 @@ namespace mango
             {
                 bool enabled;                 //!< Enabled or disabled.
                 compare_operation depth_func; //!< Compare operation.
+                bool write;                   //!< Depth writes enabled or disabled.
             } depth_test;                     //!< Cached depth test.
 
+            bool color_mask; //!< Cached color write mask for all channels.
+
             struct
             {
                 bool enabled;      //!< Enabled or disabled.
@@ -143,6 +241,21 @@ namespace mango
                 blend_factor dest; //!< Destination blend factor.
             } blending;            //!< Cached blend state.
         } m_internal_state;        //!< The internal state.
+
+        //! \brief Counters of the state changes since the last reset.
+        struct
+        {
+            uint32 issued; //!< The number of changes requiring a call.
+            uint32 elided; //!< The number of redundant changes not requiring a call.
+        } m_change_counters;
+
+      private:
+        //! \brief Counts a change requiring a call.
+        //! \return Always true.
+        bool changed();
+        //! \brief Counts a redundant change.
+        //! \return Always false.
+        bool elided();
     };
 } // namespace mango
 
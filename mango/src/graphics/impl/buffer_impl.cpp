@@ -29,6 +29,10 @@ buffer_impl::buffer_impl(const buffer_configuration& configuration)
     {
         m_target = GL_TEXTURE_BUFFER;
     }
+    else if (configuration.m_target == buffer_target::SHADER_STORAGE_BUFFER)
+    {
+        m_target = GL_SHADER_STORAGE_BUFFER;
+    }
 
     bool persistent = false;
 
@@ -108,6 +112,10 @@ void buffer_impl::bind(buffer_target target, g_uint index, g_intptr offset, g_si
     {
         gl_target = GL_TEXTURE_BUFFER;
     }
+    else if (target == buffer_target::SHADER_STORAGE_BUFFER)
+    {
+        gl_target = GL_SHADER_STORAGE_BUFFER;
+    }
     else if (target == buffer_target::NONE)
     {
         gl_target = m_target;
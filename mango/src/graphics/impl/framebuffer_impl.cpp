@@ -75,6 +75,9 @@ framebuffer_impl::~framebuffer_impl()
 void framebuffer_impl::resize(uint32 width, uint32 height)
 {
     MANGO_ASSERT(is_created(), "Framebuffer not created!");
+    // the attachments are immutable, so every real resize reallocates all of them.
+    if (width == m_width && height == m_height)
+        return;
     m_width  = width;
     m_height = height;
     // TODO Paul: Is there a cleaner way to do that?
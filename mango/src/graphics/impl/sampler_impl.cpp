@@ -0,0 +1,42 @@
+//! \file      sampler_impl.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <glad/glad.h>
+#include <graphics/impl/sampler_impl.hpp>
+
+using namespace mango;
+
+sampler_impl::sampler_impl(const sampler_configuration& configuration)
+    : m_texture_min_filter(configuration.m_texture_min_filter)
+    , m_texture_mag_filter(configuration.m_texture_mag_filter)
+    , m_texture_wrap_s(configuration.m_texture_wrap_s)
+    , m_texture_wrap_t(configuration.m_texture_wrap_t)
+{
+    glCreateSamplers(1, &m_name);
+    glSamplerParameteri(m_name, GL_TEXTURE_MIN_FILTER, filter_parameter_to_gl(m_texture_min_filter));
+    glSamplerParameteri(m_name, GL_TEXTURE_MAG_FILTER, filter_parameter_to_gl(m_texture_mag_filter));
+    glSamplerParameteri(m_name, GL_TEXTURE_WRAP_S, wrap_parameter_to_gl(m_texture_wrap_s));
+    glSamplerParameteri(m_name, GL_TEXTURE_WRAP_T, wrap_parameter_to_gl(m_texture_wrap_t));
+}
+
+sampler_impl::~sampler_impl()
+{
+    if (is_created())
+        release();
+}
+
+void sampler_impl::release()
+{
+    MANGO_ASSERT(is_created(), "Sampler not created!");
+    glDeleteSamplers(1, &m_name);
+    m_name = 0; // This is needed for is_created();
+}
+
+void sampler_impl::bind_sampler_unit(g_uint unit)
+{
+    MANGO_ASSERT(is_created(), "Sampler not created!");
+    glBindSampler(unit, m_name);
+}
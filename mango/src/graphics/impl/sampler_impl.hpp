@@ -0,0 +1,58 @@
+//! \file      sampler_impl.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_SAMPLER_IMPL_HPP
+#define MANGO_SAMPLER_IMPL_HPP
+
+#include <graphics/sampler.hpp>
+
+namespace mango
+{
+    //! \brief The implementation of the \a sampler.
+    class sampler_impl : public sampler
+    {
+      public:
+        //! \brief Constructs the \a sampler_impl.
+        //! \param[in] configuration The \a sampler_configuration.
+        sampler_impl(const sampler_configuration& configuration);
+        ~sampler_impl();
+
+        inline texture_parameter min_filter() override
+        {
+            return m_texture_min_filter;
+        }
+
+        inline texture_parameter mag_filter() override
+        {
+            return m_texture_mag_filter;
+        }
+
+        inline texture_parameter wrap_s() override
+        {
+            return m_texture_wrap_s;
+        }
+
+        inline texture_parameter wrap_t() override
+        {
+            return m_texture_wrap_t;
+        }
+
+        void bind_sampler_unit(g_uint unit) override;
+        void release() override;
+
+      private:
+        //! \brief The filter to use when the texture size gets smaller.
+        texture_parameter m_texture_min_filter;
+        //! \brief The filter to use when the texture size gets bigger.
+        texture_parameter m_texture_mag_filter;
+        //! \brief The wrapping procedure in s direction for texture coordinates not in [0, 1].
+        texture_parameter m_texture_wrap_s;
+        //! \brief The wrapping procedure in t direction for texture coordinates not in [0, 1].
+        texture_parameter m_texture_wrap_t;
+    };
+} // namespace mango
+
+#endif // MANGO_SAMPLER_IMPL_HPP
@@ -4,33 +4,66 @@
 //! \date      2020
 //! \copyright Apache License 2.0
 
+#include <algorithm>
 #include <fstream>
 #include <glad/glad.h>
 #include <graphics/impl/shader_impl.hpp>
+#include <sstream>
 
 using namespace mango;
 
+//! \brief Reads the content of a file.
+//! \param[in] path The path to the file.
+//! \param[out] content The content of the file.
+//! \return True if the file could be read, else false.
+static bool read_file(const string& path, string& content)
+{
+    std::ifstream input_stream(path, std::ios::in | std::ios::binary);
+    if (!input_stream)
+        return false;
+
+    input_stream.seekg(0, std::ios::end);
+    content.resize(static_cast<uint32_t>(input_stream.tellg()));
+    input_stream.seekg(0, std::ios::beg);
+    input_stream.read(&content[0], content.size());
+    input_stream.close();
+    return true;
+}
+
 shader_impl::shader_impl(const shader_configuration& configuration)
     : m_path(configuration.m_path)
     , m_type(configuration.m_type)
+    , m_defines(configuration.m_defines)
+    , m_compiled(false)
+    , m_checked(false)
 {
     // load the shader from the source file
-    string source_string = "";
-    std::ifstream input_stream(m_path, std::ios::in | std::ios::binary);
-    if (input_stream)
-    {
-        input_stream.seekg(0, std::ios::end);
-        source_string.resize(static_cast<uint32_t>(input_stream.tellg()));
-        input_stream.seekg(0, std::ios::beg);
-        input_stream.read(&source_string[0], source_string.size());
-        input_stream.close();
-    }
+    m_source = "";
+    if (!preprocess(m_path, 0, m_defines, m_source, m_included_files))
+        MANGO_LOG_ERROR("Preprocessing shader {0} failed!", m_path);
 
     m_name                        = glCreateShader(shader_type_to_gl(m_type));
-    const g_char* source_c_string = source_string.c_str();
+    const g_char* source_c_string = m_source.c_str();
     // MANGO_LOG_DEBUG(source_c_string);
     glShaderSource(m_name, 1, &source_c_string, 0);
+}
+
+void shader_impl::compile()
+{
+    if (m_compiled)
+        return;
+    m_compiled = true;
+
     glCompileShader(m_name);
+}
+
+bool shader_impl::check_compile_status()
+{
+    compile();
+    if (m_checked)
+        return is_created();
+    m_checked = true;
+
     g_int status = 0;
     glGetShaderiv(m_name, GL_COMPILE_STATUS, &status);
     if (GL_FALSE == status)
@@ -44,8 +77,63 @@ shader_impl::shader_impl(const shader_configuration& configuration)
         m_name = 0; // This is done, because we check if it is != 0 to make sure it is valid.
 
         MANGO_LOG_ERROR("Shader link failure : {0} !", info_log.data());
-        return;
+        return false;
+    }
+    return true;
+}
+
+bool shader_impl::preprocess(const string& path, int32 source_number, const std::vector<shader_define>& defines, string& source, std::vector<string>& included_files)
+{
+    string content;
+    if (!read_file(path, content))
+    {
+        MANGO_LOG_ERROR("Can not read shader source {0}!", path);
+        return false;
+    }
+
+    const string directory = path.substr(0, path.find_last_of("\\/") + 1);
+    std::istringstream stream(content);
+    string line;
+    int32 line_number = 0;
+    while (std::getline(stream, line))
+    {
+        ++line_number;
+        std::size_t start = line.find_first_not_of(" \t");
+        if (start != string::npos && line.compare(start, 8, "#include") == 0)
+        {
+            std::size_t open  = line.find('"', start + 8);
+            std::size_t close = (open == string::npos) ? string::npos : line.find('"', open + 1);
+            if (close == string::npos)
+            {
+                MANGO_LOG_ERROR("Invalid include in {0} line {1}!", path, line_number);
+                return false;
+            }
+
+            string include_path = directory + line.substr(open + 1, close - open - 1);
+            if (std::find(included_files.begin(), included_files.end(), include_path) == included_files.end())
+            {
+                included_files.push_back(include_path);
+                int32 include_number = static_cast<int32>(included_files.size());
+                source += "#line 1 " + std::to_string(include_number) + "\n";
+                if (!preprocess(include_path, include_number, defines, source, included_files))
+                    return false;
+            }
+            source += "#line " + std::to_string(line_number + 1) + " " + std::to_string(source_number) + "\n";
+            continue;
+        }
+
+        source += line;
+        source += '\n';
+
+        // definitions have to follow the version directive.
+        if (source_number == 0 && !defines.empty() && start != string::npos && line.compare(start, 8, "#version") == 0)
+        {
+            for (auto& d : defines)
+                source += "#define " + d.name + " " + d.value + "\n";
+            source += "#line " + std::to_string(line_number + 1) + " 0\n";
+        }
     }
+    return true;
 }
 
 shader_impl::~shader_impl()
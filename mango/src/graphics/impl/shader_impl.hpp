@@ -27,11 +27,56 @@ namespace mango
             return m_type;
         }
 
+        inline const string& get_path() override
+        {
+            return m_path;
+        }
+
+        inline const string& get_source() override
+        {
+            return m_source;
+        }
+
+        inline const std::vector<shader_define>& get_defines() override
+        {
+            return m_defines;
+        }
+
+        inline const std::vector<string>& get_included_files() override
+        {
+            return m_included_files;
+        }
+
+        void compile() override;
+        bool check_compile_status() override;
+
+        //! \brief Loads a source file and appends it to a shader source.
+        //! \details Resolves #include "file" directives relative to the directory of the including file. Each file is included only once.
+        //! The definitions are added after the #version directive of the main file. #line directives keep line numbers in error logs correct.
+        //! Does not need an OpenGl context.
+        //! \param[in] path The path to the source file.
+        //! \param[in] source_number The number identifying the file in #line directives. 0 for the main file.
+        //! \param[in] defines The preprocessor definitions to add to the main file.
+        //! \param[in,out] source The preprocessed source the file is appended to.
+        //! \param[in,out] included_files The files already included, new includes are appended.
+        //! \return True if the file and all includes could be loaded, else false.
+        static bool preprocess(const string& path, int32 source_number, const std::vector<shader_define>& defines, string& source, std::vector<string>& included_files);
+
       private:
         //! \brief Path to shader source of this \a shader. Relative to project folder.
-        const char* m_path;
+        string m_path;
         //! \brief The \a shader_type of this \a shader.
         shader_type m_type;
+        //! \brief The preprocessor definitions of this \a shader.
+        std::vector<shader_define> m_defines;
+        //! \brief The files included by the source of this \a shader.
+        std::vector<string> m_included_files;
+        //! \brief The preprocessed source code of this \a shader.
+        string m_source;
+        //! \brief True if the compilation of the \a shader was already issued, else false.
+        bool m_compiled;
+        //! \brief True if the result of the compilation was already checked, else false.
+        bool m_checked;
     };
 } // namespace mango
 
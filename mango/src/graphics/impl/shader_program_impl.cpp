@@ -4,12 +4,96 @@
 //! \date      2020
 //! \copyright Apache License 2.0
 
+#include <core/timer.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <graphics/impl/shader_program_impl.hpp>
 #include <graphics/shader.hpp>
+#include <util/hashing.hpp>
+#if defined(LINUX)
+#include <sys/stat.h>
+#elif defined(WIN32)
+#include <direct.h>
+#endif
 
 using namespace mango;
 
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+//! \brief The directory linked program binaries are stored in. Relative to project folder.
+static const string program_binary_cache_directory = "res/shader_cache/";
+//! \brief Identifies a file in the program binary cache.
+static const uint32 program_binary_magic = 0x4d504243; // MPBC
+
+//! \brief Header of a file in the program binary cache.
+struct program_binary_header
+{
+    uint32 magic;         //!< Has to be program_binary_magic.
+    uint32 binary_format; //!< The driver specific format of the binary.
+    uint64 key;           //!< The key of the program.
+    uint64 length;        //!< The length of the binary in bytes.
+};
+
+//! \brief Calculates the key of a program in the program binary cache.
+//! \details The key is the fnv1a hash of the shader sources and the driver. Sources include all defines, so each permutation gets its own entry.
+//! \param[in] shaders The shaders of the program.
+//! \return The key of the program.
+static uint64 program_binary_key(const std::vector<shader_ptr>& shaders)
+{
+    fnv1a hash;
+    // binaries are only valid for the same driver.
+    const g_enum driver_strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+    for (g_enum name : driver_strings)
+    {
+        const char* str = reinterpret_cast<const char*>(glGetString(name));
+        if (str)
+            hash(str, std::strlen(str));
+    }
+    for (auto& s : shaders)
+    {
+        shader_type type = s->get_type();
+        hash(&type, sizeof(type));
+        hash(s->get_source().data(), s->get_source().size());
+    }
+    return static_cast<uint64>(static_cast<std::size_t>(hash));
+}
+
+//! \brief Returns the path of the program binary cache file for a key.
+//! \param[in] key The key of the program.
+//! \return The path of the file.
+static string program_binary_path(uint64 key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return program_binary_cache_directory + name;
+}
+
+//! \brief Checks if the driver supports KHR_parallel_shader_compile.
+//! \details Without the extension the completion status can not be polled and finishing a build blocks.
+//! \return True if the completion status of shaders and programs can be queried, else false.
+static bool parallel_compile_supported()
+{
+    // queried once, since this is checked on every use of a program that is still building.
+    static const bool supported = extension_supported("GL_KHR_parallel_shader_compile");
+    return supported;
+}
+
+//! \brief Checks if the driver supports program binaries.
+//! \return True if at least one program binary format is supported, else false.
+static bool program_binaries_supported()
+{
+    static g_int format_count = -1;
+    if (format_count < 0)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    return format_count > 0;
+}
+
 shader_program_impl::shader_program_impl()
+    : m_binding_data_valid(false)
+    , m_reload_name(0)
 {
     m_binding_data.listed_data.clear();
     m_name = glCreateProgram();
@@ -17,22 +101,32 @@ shader_program_impl::shader_program_impl()
 
 shader_program_impl::~shader_program_impl()
 {
+    discard_reload();
     glDeleteProgram(m_name);
     m_binding_data.listed_data.clear();
 }
 
 void shader_program_impl::use()
 {
+    complete_build();
     glUseProgram(m_name);
 }
 
 const uniform_binding_data& shader_program_impl::get_single_bindings()
 {
+    complete_build();
     MANGO_ASSERT(is_created(), "Shader program not created!");
-    if (!m_binding_data.listed_data.empty())
-    {
-        return m_binding_data;
-    }
+    if (!m_binding_data_valid)
+        reflect_uniforms();
+
+    return m_binding_data;
+}
+
+void shader_program_impl::reflect_uniforms()
+{
+    // built once after linking, lookups are done by indexing with the location.
+    m_binding_data.listed_data.clear();
+    m_binding_data_valid = true;
 
     g_int uniform_count = 0;
     glGetProgramiv(m_name, GL_ACTIVE_UNIFORMS, &uniform_count);
@@ -49,17 +143,24 @@ const uniform_binding_data& shader_program_impl::get_single_bindings()
 
         for (g_int i = 0; i < uniform_count; ++i)
         {
-            glGetActiveUniform(m_name, i, max_name_len, &length, &size, &type, uniform_name.data());
+            glGetActiveUniform(m_name, static_cast<g_uint>(i), max_name_len, &length, &size, &type, uniform_name.data());
+
+            g_int location = glGetUniformLocation(m_name, uniform_name.data());
+            if (location < 0)
+                continue; // members of uniform blocks have no location.
 
             uniform_binding_data::uniform u;
-            g_uint location = glGetUniformLocation(m_name, uniform_name.data());
-            u.type          = shader_resource_type_from_gl(type);
+            u.type = shader_resource_type_from_gl(type);
 
-            m_binding_data.listed_data.insert({ location, u });
+            if (static_cast<size_t>(location) >= m_binding_data.listed_data.size())
+            {
+                uniform_binding_data::uniform none;
+                none.type = shader_resource_type::NONE;
+                m_binding_data.listed_data.resize(static_cast<size_t>(location) + 1, none);
+            }
+            m_binding_data.listed_data[static_cast<size_t>(location)] = u;
         }
     }
-
-    return m_binding_data;
 }
 
 void shader_program_impl::create_graphics_pipeline_impl(shader_ptr vertex_shader, shader_ptr tess_control_shader, shader_ptr tess_eval_shader, shader_ptr geometry_shader, shader_ptr fragment_shader)
@@ -68,26 +169,13 @@ void shader_program_impl::create_graphics_pipeline_impl(shader_ptr vertex_shader
     MANGO_ASSERT(vertex_shader, "Vertex shader is mandatory for a graphics pipeline!");
     MANGO_ASSERT(fragment_shader, "Fragment shader is mandatory for a graphics pipeline!");
 
-    glAttachShader(m_name, vertex_shader->get_name());
     m_shaders.push_back(vertex_shader);
-
     if (tess_control_shader)
-    {
-        glAttachShader(m_name, tess_control_shader->get_name());
         m_shaders.push_back(tess_control_shader);
-    }
     if (tess_eval_shader)
-    {
-        glAttachShader(m_name, tess_eval_shader->get_name());
         m_shaders.push_back(tess_eval_shader);
-    }
     if (geometry_shader)
-    {
-        glAttachShader(m_name, geometry_shader->get_name());
         m_shaders.push_back(geometry_shader);
-    }
-
-    glAttachShader(m_name, fragment_shader->get_name());
     m_shaders.push_back(fragment_shader);
 
     link_program();
@@ -98,7 +186,6 @@ void shader_program_impl::create_compute_pipeline_impl(shader_ptr compute_shader
     MANGO_ASSERT(is_created(), "Shader program not created!");
     MANGO_ASSERT(compute_shader, "Compute shader is mandatory for a compute pipeline!");
 
-    glAttachShader(m_name, compute_shader->get_name());
     m_shaders.push_back(compute_shader);
 
     link_program();
@@ -108,21 +195,237 @@ void shader_program_impl::link_program()
 {
     MANGO_ASSERT(is_created(), "Shader program not created and can not be linked!");
 
-    glLinkProgram(m_name);
+    // the result is checked when the program is required the first time, so drivers can compile in parallel.
+    start_build(m_build, m_name, m_shaders);
+}
+
+bool shader_program_impl::is_ready()
+{
+    if (!m_build.linking)
+        return true;
+
+    if (parallel_compile_supported())
+    {
+        g_int completed = GL_FALSE;
+        glGetProgramiv(m_name, GL_COMPLETION_STATUS_KHR, &completed);
+        if (GL_FALSE == completed)
+            return false;
+    }
+
+    complete_build();
+    return true;
+}
+
+void shader_program_impl::complete_build()
+{
+    if (!m_build.linking)
+        return;
+
+    if (!finish_build(m_build, m_name, m_shaders))
+    {
+        glDeleteProgram(m_name);
+        m_name = 0; // This is done, because we check if it is != 0 to make sure it is valid.
+    }
+}
+
+void shader_program_impl::start_build(build_state& build, g_uint program, const std::vector<shader_ptr>& shaders)
+{
+    build.build_timer.start();
+    build.linking   = false;
+    build.cacheable = program_binaries_supported();
+    build.key       = 0;
+    if (build.cacheable)
+    {
+        build.key = program_binary_key(shaders);
+        if (load_binary(program, build.key))
+        {
+            MANGO_LOG_DEBUG("Program loaded from binary cache in {0} us.", build.build_timer.elapsedMicroseconds().count());
+            return;
+        }
+    }
+
+    // fallback to compilation from source. Nothing is queried here, so the driver does not have to finish any compilation.
+    for (auto& s : shaders)
+    {
+        s->compile();
+        glAttachShader(program, s->get_name());
+    }
 
+    if (build.cacheable)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    glLinkProgram(program);
+    build.linking = true;
+}
+
+bool shader_program_impl::finish_build(build_state& build, g_uint program, const std::vector<shader_ptr>& shaders)
+{
+    if (!build.linking)
+        return true;
+    build.linking = false;
+
+    bool compiled = true;
+    for (auto& s : shaders)
+        compiled = s->check_compile_status() && compiled;
+
+    if (!compiled || !check_link_status(program))
+        return false;
+
+    if (build.cacheable)
+        store_binary(program, build.key);
+
+    MANGO_LOG_DEBUG("Program compiled from source in {0} us.", build.build_timer.elapsedMicroseconds().count());
+    return true;
+}
+
+bool shader_program_impl::load_binary(g_uint program, uint64 key)
+{
+    std::ifstream input_stream(program_binary_path(key), std::ios::in | std::ios::binary);
+    if (!input_stream)
+        return false;
+
+    program_binary_header header;
+    input_stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!input_stream || header.magic != program_binary_magic || header.key != key)
+        return false;
+
+    std::vector<char> binary(static_cast<size_t>(header.length));
+    input_stream.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+    if (!input_stream)
+        return false;
+
+    // the driver rejects binaries it can not use anymore, the program gets linked from source then.
+    glProgramBinary(program, header.binary_format, binary.data(), static_cast<g_sizei>(binary.size()));
+    g_int status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (GL_FALSE == status)
+    {
+        MANGO_LOG_DEBUG("Cached program binary rejected, compiling from source!");
+        return false;
+    }
+    return true;
+}
+
+void shader_program_impl::store_binary(g_uint program, uint64 key)
+{
+    g_int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    program_binary_header header;
+    header.magic  = program_binary_magic;
+    header.key    = key;
+    header.length = static_cast<uint64>(length);
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    g_enum binary_format = GL_NONE;
+    glGetProgramBinary(program, length, &length, &binary_format, binary.data());
+    header.binary_format = static_cast<uint32>(binary_format);
+
+#if defined(LINUX)
+    mkdir(program_binary_cache_directory.c_str(), 0755);
+#elif defined(WIN32)
+    _mkdir(program_binary_cache_directory.c_str());
+#endif
+
+    std::ofstream output_stream(program_binary_path(key), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!output_stream)
+    {
+        MANGO_LOG_WARN("Can not write program binary to cache directory {0}!", program_binary_cache_directory);
+        return;
+    }
+    output_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output_stream.write(binary.data(), static_cast<std::streamsize>(length));
+}
+
+bool shader_program_impl::check_link_status(g_uint program)
+{
     g_int status = 0;
-    glGetProgramiv(m_name, GL_LINK_STATUS, &status);
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
     if (GL_FALSE == status)
     {
         g_int log_length = 0;
-        glGetProgramiv(m_name, GL_INFO_LOG_LENGTH, &log_length);
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
         std::vector<g_char> info_log(log_length);
-        glGetProgramInfoLog(m_name, log_length, &log_length, info_log.data());
-
-        glDeleteProgram(m_name);
-        m_name = 0; // This is done, because we check if it is != 0 to make sure it is valid.
+        glGetProgramInfoLog(program, log_length, &log_length, info_log.data());
 
         MANGO_LOG_ERROR("Program link failure : {0} !", info_log.data());
-        return;
+        return false;
+    }
+    return true;
+}
+
+void shader_program_impl::start_reload()
+{
+    complete_build();
+    MANGO_ASSERT(is_created(), "Shader program not created!");
+
+    // the sources changed again, so a reload in progress is outdated.
+    discard_reload();
+
+    for (auto& s : m_shaders)
+    {
+        shader_configuration config(s->get_path().c_str());
+        config.m_type    = s->get_type();
+        config.m_defines = s->get_defines();
+        m_reload_shaders.push_back(shader::create(config));
+    }
+
+    // the old program stays in use while the driver builds the new one.
+    m_reload_name = glCreateProgram();
+    start_build(m_reload_build, m_reload_name, m_reload_shaders);
+}
+
+bool shader_program_impl::is_reload_ready()
+{
+    if (!m_reload_name)
+        return false;
+
+    if (m_reload_build.linking && parallel_compile_supported())
+    {
+        g_int completed = GL_FALSE;
+        glGetProgramiv(m_reload_name, GL_COMPLETION_STATUS_KHR, &completed);
+        return GL_FALSE != completed;
+    }
+    return true;
+}
+
+bool shader_program_impl::finish_reload()
+{
+    if (!m_reload_name)
+        return false;
+    complete_build();
+
+    g_uint program = m_reload_name;
+    m_reload_name  = 0;
+    if (!finish_build(m_reload_build, program, m_reload_shaders))
+    {
+        glDeleteProgram(program);
+        m_reload_shaders.clear();
+        return false;
     }
+
+    // the old sources are gone, so their binary would only waste space in the cache.
+    if (m_build.cacheable && m_build.key != m_reload_build.key)
+        std::remove(program_binary_path(m_build.key).c_str());
+
+    glDeleteProgram(m_name);
+    m_name = program;
+    m_shaders.swap(m_reload_shaders);
+    m_reload_shaders.clear();
+    m_build.cacheable    = m_reload_build.cacheable;
+    m_build.key          = m_reload_build.key;
+    m_binding_data_valid = false;
+    return true;
+}
+
+void shader_program_impl::discard_reload()
+{
+    if (!m_reload_name)
+        return;
+    glDeleteProgram(m_reload_name);
+    m_reload_name = 0;
+    m_reload_shaders.clear();
+    m_reload_build.linking = false;
 }
@@ -7,6 +7,7 @@
 #ifndef MANGO_SHADER_PROGRAM_IMPL_HPP
 #define MANGO_SHADER_PROGRAM_IMPL_HPP
 
+#include <core/timer.hpp>
 #include <graphics/shader_program.hpp>
 
 namespace mango
@@ -20,6 +21,15 @@ namespace mango
 
         void use() override;
         const uniform_binding_data& get_single_bindings() override;
+        bool is_ready() override;
+        void start_reload() override;
+        bool is_reload_ready() override;
+        bool finish_reload() override;
+
+        inline const std::vector<shader_ptr>& get_shaders() override
+        {
+            return m_shaders;
+        }
 
         //! \brief Initializes a graphics pipeline.
         //! \param[in] vertex_shader A pointer to the vertex shader source.
@@ -34,15 +44,77 @@ namespace mango
         void create_compute_pipeline_impl(shader_ptr compute_shader);
 
       private:
+        //! \brief State of a build in progress.
+        struct build_state
+        {
+            bool linking   = false; //!< True if linking was issued and the result was not checked yet.
+            bool cacheable = false; //!< True if the binary should be stored in the program binary cache.
+            uint64 key     = 0;     //!< The key of the program in the program binary cache.
+            timer build_timer;      //!< Measures the build time.
+        };
+
         //! \brief The data containing information about uniform bindings.
         uniform_binding_data m_binding_data;
+        //! \brief True if \a m_binding_data was built for the linked program, else false.
+        bool m_binding_data_valid;
+
+        //! \brief Queries all active uniforms of the linked program and builds \a m_binding_data.
+        void reflect_uniforms();
 
         //! \brief Links the \a shader_program.
         void link_program();
 
+        //! \brief Checks the link status of a program object and logs errors.
+        //! \details Blocks until linking finished.
+        //! \param[in] program The name of the program to check.
+        //! \return True if linking succeeded, else false.
+        bool check_link_status(g_uint program);
+
+        //! \brief Starts building a program object from \a shaders.
+        //! \details Loads the linked binary from the program binary cache if possible.
+        //! On a cache miss compilation and linking of the \a shaders is issued without waiting for the results.
+        //! \param[in,out] build The \a build_state of the program.
+        //! \param[in] program The name of the program to build.
+        //! \param[in] shaders The \a shaders of the program.
+        void start_build(build_state& build, g_uint program, const std::vector<shader_ptr>& shaders);
+
+        //! \brief Finishes a build started with start_build().
+        //! \details Blocks until compiling and linking finished and stores the binary in the program binary cache.
+        //! \param[in,out] build The \a build_state of the program.
+        //! \param[in] program The name of the program to finish.
+        //! \param[in] shaders The \a shaders of the program.
+        //! \return True if the program is linked, else false.
+        bool finish_build(build_state& build, g_uint program, const std::vector<shader_ptr>& shaders);
+
+        //! \brief Deletes the program of a reload that is still in progress.
+        void discard_reload();
+
+        //! \brief Finishes the build of the \a shader_program if it is still in progress.
+        void complete_build();
+
+        //! \brief Loads a linked binary from the program binary cache.
+        //! \param[in] program The name of the program to load the binary into.
+        //! \param[in] key The key of the program in the cache.
+        //! \return True if the binary was found and accepted by the driver, else false.
+        bool load_binary(g_uint program, uint64 key);
+
+        //! \brief Stores the linked binary of a program in the program binary cache.
+        //! \param[in] program The name of the linked program.
+        //! \param[in] key The key of the program in the cache.
+        void store_binary(g_uint program, uint64 key);
+
         //! \brief All \a shaders attached to this \a shader_program.
         std::vector<shader_ptr> m_shaders;
 
+        //! \brief The state of the current build.
+        build_state m_build;
+
+        //! \brief The name of the program built by a reload in progress. 0 if there is no reload in progress.
+        g_uint m_reload_name;
+        //! \brief The recompiled \a shaders of the reload in progress.
+        std::vector<shader_ptr> m_reload_shaders;
+        //! \brief The state of the reload build.
+        build_state m_reload_build;
     };
 } // namespace mango
 
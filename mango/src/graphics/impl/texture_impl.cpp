@@ -6,9 +6,39 @@
 
 #include <glad/glad.h>
 #include <graphics/impl/texture_impl.hpp>
+#include <graphics/sampler.hpp>
 
 using namespace mango;
 
+//! \brief Converts an 8 bit SRGB encoded value to linear space.
+//! \param[in] value The SRGB encoded value.
+//! \return The linear value in [0, 1].
+static float srgb_to_linear(g_ubyte value)
+{
+    static float table[256];
+    static bool initialized = false;
+    if (!initialized)
+    {
+        for (uint32 i = 0; i < 256; ++i)
+        {
+            float c  = static_cast<float>(i) / 255.0f;
+            table[i] = c <= 0.04045f ? c / 12.92f : glm::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        initialized = true;
+    }
+    return table[value];
+}
+
+//! \brief Converts a linear value to 8 bit SRGB encoding.
+//! \param[in] value The linear value in [0, 1].
+//! \return The SRGB encoded value.
+static g_ubyte linear_to_srgb(float value)
+{
+    value   = glm::clamp(value, 0.0f, 1.0f);
+    float c = value <= 0.0031308f ? value * 12.92f : 1.055f * glm::pow(value, 1.0f / 2.4f) - 0.055f;
+    return static_cast<g_ubyte>(c * 255.0f + 0.5f);
+}
+
 texture_impl::texture_impl(const texture_configuration& configuration)
     : m_texture_min_filter(configuration.m_texture_min_filter)
     , m_texture_mag_filter(configuration.m_texture_mag_filter)
@@ -17,20 +47,31 @@ texture_impl::texture_impl(const texture_configuration& configuration)
     , m_is_standard_color_space(configuration.m_is_standard_color_space)
     , m_generate_mipmaps(configuration.m_generate_mipmaps)
     , m_is_cubemap(configuration.m_is_cubemap)
+    , m_is_normal_map(configuration.m_is_normal_map)
+    , m_streamed_texel_size(0)
+    , m_resident_level(0)
+{
+    m_name = create_texture_object();
+}
+
+g_uint texture_impl::create_texture_object()
 {
     g_enum type = GL_TEXTURE_2D;
 
     if (m_is_cubemap)
         type = GL_TEXTURE_CUBE_MAP;
 
-    glCreateTextures(type, 1, &m_name);
-    glTextureParameteri(m_name, GL_TEXTURE_MIN_FILTER, filter_parameter_to_gl(m_texture_min_filter));
-    glTextureParameteri(m_name, GL_TEXTURE_MAG_FILTER, filter_parameter_to_gl(m_texture_mag_filter));
-    glTextureParameteri(m_name, GL_TEXTURE_WRAP_S, wrap_parameter_to_gl(m_texture_wrap_s));
-    glTextureParameteri(m_name, GL_TEXTURE_WRAP_T, wrap_parameter_to_gl(m_texture_wrap_t));
+    g_uint name;
+    glCreateTextures(type, 1, &name);
+    glTextureParameteri(name, GL_TEXTURE_MIN_FILTER, filter_parameter_to_gl(m_texture_min_filter));
+    glTextureParameteri(name, GL_TEXTURE_MAG_FILTER, filter_parameter_to_gl(m_texture_mag_filter));
+    glTextureParameteri(name, GL_TEXTURE_WRAP_S, wrap_parameter_to_gl(m_texture_wrap_s));
+    glTextureParameteri(name, GL_TEXTURE_WRAP_T, wrap_parameter_to_gl(m_texture_wrap_t));
 
     if (m_is_cubemap)
-        glTextureParameteri(m_name, GL_TEXTURE_WRAP_R, wrap_parameter_to_gl(m_texture_wrap_t)); // TODO Paul: Extra parameter!
+        glTextureParameteri(name, GL_TEXTURE_WRAP_R, wrap_parameter_to_gl(m_texture_wrap_t)); // TODO Paul: Extra parameter!
+
+    return name;
 }
 
 texture_impl::~texture_impl()
@@ -42,8 +83,11 @@ texture_impl::~texture_impl()
 void texture_impl::release()
 {
     MANGO_ASSERT(is_created(), "Texture not created!");
+    discard_readbacks();
+    release_retired_storage();
     glDeleteTextures(1, &m_name);
     m_name = 0; // This is needed for is_created();
+    m_resident_handles.clear();
 }
 
 void texture_impl::set_data(format internal_format, uint32 width, uint32 height, format pixel_format, format type, const void* data)
@@ -69,7 +113,7 @@ void texture_impl::set_data(format internal_format, uint32 width, uint32 height,
         {
             glTextureSubImage2D(m_name, 0, 0, 0, width, height, gl_pixel_f, gl_type, data);
         }
-        if (mipmaps())
+        if (mipmaps() > 1)
         {
             glGenerateTextureMipmap(m_name);
         }
@@ -82,13 +126,282 @@ void texture_impl::set_data(format internal_format, uint32 width, uint32 height,
             for (uint32 i = 0; i < 6; ++i)
                 glTextureSubImage3D(m_name, 0, 0, 0, i, width, height, 1, gl_pixel_f, gl_type, data); // TODO Paul: Is this correct?
         }
-        if (mipmaps())
+        if (mipmaps() > 1)
         {
             glGenerateTextureMipmap(m_name);
         }
     }
 }
 
+void texture_impl::set_streamed_data(format internal_format, uint32 width, uint32 height, format pixel_format, format type, const void* data, uint32 resident_level)
+{
+    MANGO_ASSERT(is_created(), "Texture not created!");
+    MANGO_ASSERT(width > 0, "Texture width is invalid!");
+    MANGO_ASSERT(height > 0, "Texture height is invalid!");
+
+    uint32 components = 0;
+    switch (pixel_format)
+    {
+    case format::RED:
+        components = 1;
+        break;
+    case format::RG:
+        components = 2;
+        break;
+    case format::RGB:
+    case format::BGR:
+        components = 3;
+        break;
+    case format::RGBA:
+    case format::BGRA:
+        components = 4;
+        break;
+    default:
+        break;
+    }
+
+    if (m_is_cubemap || !data || type != format::UNSIGNED_BYTE || components == 0 || mipmaps() < 2)
+    {
+        set_data(internal_format, width, height, pixel_format, type, data);
+        return;
+    }
+
+    // levels of the previous data still in transfer are outdated.
+    discard_readbacks();
+
+    m_width               = width;
+    m_height              = height;
+    m_format              = pixel_format;
+    m_internal_format     = internal_format;
+    m_component_type      = type;
+    m_streamed_texel_size = components;
+
+    // SRGB color channels have to be averaged in linear space, alpha is always linear.
+    const bool srgb             = internal_format == format::SRGB8 || internal_format == format::SRGB8_ALPHA8;
+    const uint32 srgb_channels  = srgb ? glm::min(components, 3u) : 0;
+    const bool renormalize      = m_is_normal_map && components >= 3;
+    std::vector<float> filtered = std::vector<float>(components);
+
+    // build the mipchain on the cpu with a simple box filter.
+    m_streamed_levels.resize(mipmaps());
+    const g_ubyte* source = static_cast<const g_ubyte*>(data);
+    m_streamed_levels[0].assign(source, source + static_cast<ptr_size>(width) * height * components);
+    for (uint32 level = 1; level < mipmaps(); ++level)
+    {
+        const uint32 src_width  = glm::max(width >> (level - 1), 1u);
+        const uint32 src_height = glm::max(height >> (level - 1), 1u);
+        const uint32 dst_width  = glm::max(width >> level, 1u);
+        const uint32 dst_height = glm::max(height >> level, 1u);
+
+        const std::vector<g_ubyte>& src = m_streamed_levels[level - 1];
+        std::vector<g_ubyte>& dst       = m_streamed_levels[level];
+        dst.resize(static_cast<ptr_size>(dst_width) * dst_height * components);
+
+        for (uint32 y = 0; y < dst_height; ++y)
+        {
+            const uint32 y0 = glm::min(2 * y, src_height - 1);
+            const uint32 y1 = glm::min(2 * y + 1, src_height - 1);
+            for (uint32 x = 0; x < dst_width; ++x)
+            {
+                const uint32 x0       = glm::min(2 * x, src_width - 1);
+                const uint32 x1       = glm::min(2 * x + 1, src_width - 1);
+                const uint32 texels[] = { y0 * src_width + x0, y0 * src_width + x1, y1 * src_width + x0, y1 * src_width + x1 };
+                for (uint32 c = 0; c < components; ++c)
+                {
+                    float sum = 0.0f;
+                    for (uint32 t = 0; t < 4; ++t)
+                    {
+                        g_ubyte value = src[texels[t] * components + c];
+                        sum += c < srgb_channels ? srgb_to_linear(value) : static_cast<float>(value) / 255.0f;
+                    }
+                    filtered[c] = 0.25f * sum;
+                }
+
+                // averaged normals are shorter than one, so they get rescaled to unit length.
+                if (renormalize)
+                {
+                    glm::vec3 normal = glm::vec3(filtered[0], filtered[1], filtered[2]) * 2.0f - 1.0f;
+                    float length     = glm::length(normal);
+                    normal           = length > 1e-5f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+                    filtered[0]      = normal.x * 0.5f + 0.5f;
+                    filtered[1]      = normal.y * 0.5f + 0.5f;
+                    filtered[2]      = normal.z * 0.5f + 0.5f;
+                }
+
+                for (uint32 c = 0; c < components; ++c)
+                {
+                    g_ubyte& texel = dst[(y * dst_width + x) * components + c];
+                    texel          = c < srgb_channels ? linear_to_srgb(filtered[c]) : static_cast<g_ubyte>(glm::clamp(filtered[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+                }
+            }
+        }
+    }
+
+    // nothing is resident at the moment.
+    m_resident_level = mipmaps();
+    set_resident_level(resident_level);
+}
+
+void texture_impl::set_resident_level(uint32 level)
+{
+    MANGO_ASSERT(is_created(), "Texture not created!");
+    MANGO_ASSERT(is_streamed(), "Texture is not streamed!");
+    level = glm::min(level, mipmaps() - 1);
+    if (level == m_resident_level)
+        return;
+
+    g_enum gl_internal_f = static_cast<g_enum>(m_internal_format);
+    g_enum gl_pixel_f    = static_cast<g_enum>(m_format);
+    g_enum gl_type       = static_cast<g_enum>(m_component_type);
+
+    // Immutable storage can not release or add levels, so the storage gets reallocated for the resident part of the mipchain.
+    g_uint resident_name = create_texture_object();
+    glTextureStorage2D(resident_name, static_cast<g_sizei>(mipmaps() - level), gl_internal_f, static_cast<g_sizei>(glm::max(m_width >> level, 1u)),
+                       static_cast<g_sizei>(glm::max(m_height >> level, 1u)));
+
+    // levels uploaded again have to be on the cpu, this only stalls if they were evicted in the same update.
+    if (level < m_resident_level)
+        finish_readbacks(true);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    if (level > m_resident_level)
+    {
+        // evicted levels are only on the gpu, they are copied to a pixel buffer and stored on the cpu once the copy is finished.
+        level_readback readback;
+        readback.first_level = m_resident_level;
+        readback.end_level   = level;
+
+        ptr_size buffer_size = 0;
+        for (uint32 l = m_resident_level; l < level; ++l)
+            buffer_size += streamed_level_size(l);
+        glCreateBuffers(1, &readback.buffer);
+        glNamedBufferStorage(readback.buffer, static_cast<g_sizeiptr>(buffer_size), nullptr, GL_CLIENT_STORAGE_BIT);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+        ptr_size offset = 0;
+        for (uint32 l = m_resident_level; l < level; ++l)
+        {
+            const ptr_size size = streamed_level_size(l);
+            glGetTextureImage(m_name, static_cast<g_int>(l - m_resident_level), gl_pixel_f, gl_type, static_cast<g_sizei>(size), reinterpret_cast<void*>(offset));
+            offset += size;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_pending_readbacks.push_back(readback);
+    }
+    for (uint32 l = level; l < mipmaps(); ++l)
+    {
+        const g_sizei level_width  = static_cast<g_sizei>(glm::max(m_width >> l, 1u));
+        const g_sizei level_height = static_cast<g_sizei>(glm::max(m_height >> l, 1u));
+        if (l >= m_resident_level)
+        {
+            // level is already on the gpu.
+            glCopyImageSubData(m_name, GL_TEXTURE_2D, static_cast<g_int>(l - m_resident_level), 0, 0, 0, resident_name, GL_TEXTURE_2D, static_cast<g_int>(l - level), 0, 0, 0, level_width,
+                               level_height, 1);
+        }
+        else
+        {
+            glTextureSubImage2D(resident_name, static_cast<g_int>(l - level), 0, 0, level_width, level_height, gl_pixel_f, gl_type, m_streamed_levels[l].data());
+            // the gpu holds the level now, the cpu copy is not required anymore.
+            std::vector<g_ubyte>().swap(m_streamed_levels[l]);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    // frames in flight can still sample the old storage, so it is only retired here.
+    m_retired_names.push_back(m_name);
+    m_retired_handles.insert(m_retired_handles.end(), m_resident_handles.begin(), m_resident_handles.end());
+    m_resident_handles.clear();
+    m_name           = resident_name;
+    m_resident_level = level;
+}
+
+bool texture_impl::release_retired_storage()
+{
+    for (g_uint64 handle : m_retired_handles)
+        glMakeTextureHandleNonResidentARB(handle);
+    m_retired_handles.clear();
+
+    if (!m_retired_names.empty())
+        glDeleteTextures(static_cast<g_sizei>(m_retired_names.size()), m_retired_names.data());
+    m_retired_names.clear();
+
+    return finish_readbacks(false);
+}
+
+ptr_size texture_impl::streamed_level_size(uint32 level)
+{
+    return static_cast<ptr_size>(glm::max(m_width >> level, 1u)) * glm::max(m_height >> level, 1u) * m_streamed_texel_size;
+}
+
+bool texture_impl::finish_readbacks(bool wait)
+{
+    for (auto it = m_pending_readbacks.begin(); it != m_pending_readbacks.end();)
+    {
+        // reading the buffer waits for the copy anyway, so the fence is only polled when the caller does not want to wait.
+        if (!wait)
+        {
+            g_enum result = glClientWaitSync(it->fence, 0, 0);
+            if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+            {
+                ++it;
+                continue;
+            }
+        }
+
+        ptr_size offset = 0;
+        for (uint32 l = it->first_level; l < it->end_level; ++l)
+        {
+            std::vector<g_ubyte>& cpu_level = m_streamed_levels[l];
+            cpu_level.resize(streamed_level_size(l));
+            glGetNamedBufferSubData(it->buffer, static_cast<g_intptr>(offset), static_cast<g_sizeiptr>(cpu_level.size()), cpu_level.data());
+            offset += cpu_level.size();
+        }
+
+        glDeleteSync(it->fence);
+        glDeleteBuffers(1, &it->buffer);
+        it = m_pending_readbacks.erase(it);
+    }
+
+    return m_pending_readbacks.empty();
+}
+
+void texture_impl::discard_readbacks()
+{
+    for (level_readback& readback : m_pending_readbacks)
+    {
+        glDeleteSync(readback.fence);
+        glDeleteBuffers(1, &readback.buffer);
+    }
+    m_pending_readbacks.clear();
+}
+
+ptr_size texture_impl::level_memory(uint32 level)
+{
+    // Three component textures are usually padded to four components by the driver.
+    const ptr_size texel_size = m_streamed_texel_size == 3 ? 4 : m_streamed_texel_size;
+    ptr_size memory           = 0;
+    for (uint32 l = level; l < mipmaps(); ++l)
+        memory += static_cast<ptr_size>(glm::max(m_width >> l, 1u)) * glm::max(m_height >> l, 1u) * texel_size;
+    return memory;
+}
+
+g_uint64 texture_impl::get_bindless_handle(const sampler_ptr& smp)
+{
+    MANGO_ASSERT(is_created(), "Texture not created!");
+    // the same pair of texture and sampler always returns the same handle.
+    g_uint64 handle = smp ? glGetTextureSamplerHandleARB(m_name, smp->get_name()) : glGetTextureHandleARB(m_name);
+    MANGO_ASSERT(handle != 0, "Creation of bindless handle failed!");
+    if (!glIsTextureHandleResidentARB(handle))
+    {
+        glMakeTextureHandleResidentARB(handle);
+        m_resident_handles.push_back(handle);
+    }
+    return handle;
+}
+
 void texture_impl::bind_texture_unit(g_uint unit)
 {
     MANGO_ASSERT(is_created(), "Texture not created!");
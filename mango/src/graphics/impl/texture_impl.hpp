@@ -8,6 +8,7 @@
 #define MANGO_TEXTURE_IMPL_HPP
 
 #include <graphics/texture.hpp>
+#include <vector>
 
 namespace mango
 {
@@ -80,12 +81,53 @@ namespace mango
             return m_is_cubemap;
         }
 
+        inline bool is_streamed() override
+        {
+            return !m_streamed_levels.empty();
+        }
+
+        inline uint32 resident_level() override
+        {
+            return m_resident_level;
+        }
+
         void set_data(format internal_format, uint32 width, uint32 height, format pixel_format, format type, const void* data) override;
+        void set_streamed_data(format internal_format, uint32 width, uint32 height, format pixel_format, format type, const void* data, uint32 resident_level) override;
+        void set_resident_level(uint32 level) override;
+        bool release_retired_storage() override;
+        ptr_size level_memory(uint32 level) override;
+        g_uint64 get_bindless_handle(const sampler_ptr& smp) override;
         void bind_texture_unit(g_uint unit) override;
         void unbind() override;
         void release() override;
 
       private:
+        //! \brief Creates a new texture object with the parameters of the \a texture.
+        //! \return The name of the created texture object.
+        g_uint create_texture_object();
+
+        //! \brief Returns the size of a mipmap level in the \a streamed_levels.
+        //! \param[in] level The mipmap level.
+        //! \return The size of the level in bytes.
+        ptr_size streamed_level_size(uint32 level);
+
+        //! \brief Stores the evicted levels the gpu finished copying back in the \a streamed_levels.
+        //! \param[in] wait True if copies still in transfer should be waited for, else they are kept for a later call.
+        //! \return True if no copy is in transfer anymore, else false.
+        bool finish_readbacks(bool wait);
+
+        //! \brief Deletes all copies of evicted levels without storing them.
+        void discard_readbacks();
+
+        //! \brief The asynchronous copy of levels evicted by one call to set_resident_level().
+        struct level_readback
+        {
+            uint32 first_level; //!< The most detailed level copied.
+            uint32 end_level;   //!< One past the least detailed level copied.
+            g_uint buffer;      //!< The pixel buffer the levels are copied to, tightly packed one after another.
+            g_sync fence;       //!< The fence signaled when the copy is finished.
+        };
+
         //! \brief The width of the \a texture.
         uint32 m_width;
         //! \brief The height of the \a texture.
@@ -110,6 +152,25 @@ namespace mango
         uint32 m_generate_mipmaps;
         //! \brief Specifies if the texture is a cubemap.
         bool m_is_cubemap;
+        //! \brief Specifies if the texture contains tangent space normals.
+        bool m_is_normal_map;
+
+        //! \brief The cpu side mipchain of a streamed \a texture. Empty if the \a texture is not streamed.
+        //! \details Only the levels not resident on the gpu hold data, the resident ones are released after the upload.
+        //! Evicted levels stay empty until their readback is finished.
+        std::vector<std::vector<g_ubyte>> m_streamed_levels;
+        //! \brief The number of bytes per texel in the \a streamed_levels.
+        uint32 m_streamed_texel_size;
+        //! \brief The most detailed mipmap level resident on the gpu.
+        uint32 m_resident_level;
+        //! \brief The bindless handles of the current storage made resident by get_bindless_handle().
+        std::vector<g_uint64> m_resident_handles;
+        //! \brief The names of storage replaced by set_resident_level() that may still be used by the gpu.
+        std::vector<g_uint> m_retired_names;
+        //! \brief The resident bindless handles of the retired storage.
+        std::vector<g_uint64> m_retired_handles;
+        //! \brief The copies of evicted levels still in transfer to the cpu.
+        std::vector<level_readback> m_pending_readbacks;
     };
 } // namespace mango
 
@@ -0,0 +1,15 @@
+//! \file      sampler.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <graphics/impl/sampler_impl.hpp>
+#include <graphics/sampler.hpp>
+
+using namespace mango;
+
+sampler_ptr sampler::create(const sampler_configuration& configuration)
+{
+    return std::static_pointer_cast<sampler>(std::make_shared<sampler_impl>(configuration));
+}
@@ -0,0 +1,111 @@
+//! \file      sampler.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_SAMPLER_HPP
+#define MANGO_SAMPLER_HPP
+
+#include <graphics/graphics_object.hpp>
+#include <util/hashing.hpp>
+
+namespace mango
+{
+    //! \brief A configuration for \a samplers.
+    class sampler_configuration : public graphics_configuration
+    {
+      public:
+        //! \brief Constructs a new \a sampler_configuration with default values.
+        sampler_configuration()
+            : graphics_configuration()
+        {
+        }
+
+        //! \brief Constructs a new \a sampler_configuration.
+        sampler_configuration(texture_parameter min_filter, texture_parameter mag_filter, texture_parameter wrap_s, texture_parameter wrap_t)
+            : graphics_configuration()
+            , m_texture_min_filter(min_filter)
+            , m_texture_mag_filter(mag_filter)
+            , m_texture_wrap_s(wrap_s)
+            , m_texture_wrap_t(wrap_t)
+        {
+        }
+
+        //! \brief The filter to use when the texture size gets smaller.
+        texture_parameter m_texture_min_filter = texture_parameter::FILTER_LINEAR;
+        //! \brief The filter to use when the texture size gets bigger.
+        texture_parameter m_texture_mag_filter = texture_parameter::FILTER_LINEAR;
+        //! \brief The wrapping procedure in s direction for texture coordinates not in [0, 1].
+        texture_parameter m_texture_wrap_s = texture_parameter::WRAP_REPEAT;
+        //! \brief The wrapping procedure in t direction for texture coordinates not in [0, 1].
+        texture_parameter m_texture_wrap_t = texture_parameter::WRAP_REPEAT;
+
+        //! \brief Returns if the \a sampler_configuration is valid.
+        //! \details The magnification filter can not use mipmaps.
+        //! \return True, if the configuration is valid, else false.
+        bool is_valid() const
+        {
+            return m_texture_mag_filter < texture_parameter::FILTER_NEAREST_MIPMAP_NEAREST;
+        }
+
+        //! \brief Hash function for the \a sampler_configuration.
+        //! \return The hash value.
+        std::size_t hash_code() const
+        {
+            fnv1a hash;
+            hash(&m_texture_min_filter, sizeof(m_texture_min_filter));
+            hash(&m_texture_mag_filter, sizeof(m_texture_mag_filter));
+            hash(&m_texture_wrap_s, sizeof(m_texture_wrap_s));
+            hash(&m_texture_wrap_t, sizeof(m_texture_wrap_t));
+            return static_cast<std::size_t>(hash);
+        }
+
+        //! \brief Comparison operator for \a sampler_configurations.
+        //! \param[in] other The \a sampler_configuration to compare this to.
+        //! \return True if this and other are equal, else false.
+        bool operator==(const sampler_configuration& other) const
+        {
+            return m_texture_min_filter == other.m_texture_min_filter && m_texture_mag_filter == other.m_texture_mag_filter && m_texture_wrap_s == other.m_texture_wrap_s &&
+                   m_texture_wrap_t == other.m_texture_wrap_t;
+        }
+    };
+
+    //! \brief The sampling state used to read from \a textures.
+    //! \details A \a sampler bound to the same unit as a \a texture overrides the filter and wrap parameters of the \a texture.
+    //! This way \a textures can be shared between materials with different sampling states.
+    class sampler : public graphics_object
+    {
+      public:
+        //! \brief Creates a new \a sampler and returns a pointer to it.
+        //! \param[in] configuration The \a sampler_configuration for the new \a sampler.
+        //! \return A pointer to the new \a sampler.
+        static sampler_ptr create(const sampler_configuration& configuration);
+
+        //! \brief Returns the minification filter of the \a sampler.
+        //! \return Minification filter of the \a sampler.
+        virtual texture_parameter min_filter() = 0;
+        //! \brief Returns the magnification filter of the \a sampler.
+        //! \return Magnification filter of the \a sampler.
+        virtual texture_parameter mag_filter() = 0;
+        //! \brief Returns the wrap parameter in s direction of the \a sampler.
+        //! \return Wrap parameter in s direction of the \a sampler.
+        virtual texture_parameter wrap_s() = 0;
+        //! \brief Returns the wrap parameter in t direction of the \a sampler.
+        //! \return Wrap parameter in t direction of the \a sampler.
+        virtual texture_parameter wrap_t() = 0;
+
+        //! \brief Binds the \a sampler to a specific texture unit.
+        //! \param[in] unit The unit to bind the \a sampler to.
+        virtual void bind_sampler_unit(g_uint unit) = 0;
+
+        //! \brief Releases the \a sampler.
+        virtual void release() = 0;
+
+      protected:
+        sampler()  = default;
+        ~sampler() = default;
+    };
+} // namespace mango
+
+#endif // MANGO_SAMPLER_HPP
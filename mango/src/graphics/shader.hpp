@@ -8,9 +8,17 @@
 #define MANGO_SHADER_HPP
 
 #include <graphics/graphics_object.hpp>
+#include <vector>
 
 namespace mango
 {
+    //! \brief A preprocessor definition added to the source of a \a shader.
+    struct shader_define
+    {
+        string name;  //!< The name of the definition.
+        string value; //!< The value of the definition. Can be empty.
+    };
+
     //! \brief A configuration for \a shaders.
     class shader_configuration : public graphics_configuration
     {
@@ -35,6 +43,9 @@ namespace mango
         //! \brief The type of the shader described by the source.
         shader_type m_type = shader_type::NONE;
 
+        //! \brief Definitions added after the version directive of the source. Used to build permutations of one source.
+        std::vector<shader_define> m_defines;
+
         bool is_valid() const
         {
             return nullptr != m_path && m_type != shader_type::NONE;
@@ -54,6 +65,33 @@ namespace mango
         //! \return Type of the \a shader.
         virtual shader_type get_type() = 0;
 
+        //! \brief Returns the path to the source of the \a shader.
+        //! \return The path to the shader source. Relative to project folder.
+        virtual const string& get_path() = 0;
+
+        //! \brief Returns the preprocessed source of the \a shader.
+        //! \return The source code loaded from the path with all includes resolved and definitions added.
+        virtual const string& get_source() = 0;
+
+        //! \brief Returns the preprocessor definitions the \a shader was created with.
+        //! \return The list of \a shader_defines.
+        virtual const std::vector<shader_define>& get_defines() = 0;
+
+        //! \brief Returns all files included by the source of the \a shader.
+        //! \return The paths to the included files. Relative to project folder.
+        virtual const std::vector<string>& get_included_files() = 0;
+
+        //! \brief Issues the compilation of the \a shader.
+        //! \details The source is only compiled on the first call. Compilation is deferred until the \a shader is required,
+        //! since \a shader_programs loaded from the program binary cache do not need it.
+        //! The result is not queried, so drivers supporting KHR_parallel_shader_compile can compile in the background.
+        virtual void compile() = 0;
+
+        //! \brief Checks the result of the compilation and logs errors.
+        //! \details Blocks until compilation finished.
+        //! \return True if the \a shader compiled successfully, else false.
+        virtual bool check_compile_status() = 0;
+
       protected:
         shader() = default;
         ~shader() = default;
@@ -9,6 +9,7 @@
 
 #include <graphics/graphics_object.hpp>
 #include <unordered_map>
+#include <vector>
 
 namespace mango
 {
@@ -22,9 +23,9 @@ namespace mango
             shader_resource_type type;
         };
 
-        //! \brief A list of \a uniform information filled after compiling.
-        //! \details Maps locations to \a uniforms.
-        std::unordered_map<g_uint, uniform> listed_data;
+        //! \brief A list of \a uniform information filled after linking.
+        //! \details Indexed by the uniform location. Locations without an active \a uniform have the type \a NONE.
+        std::vector<uniform> listed_data;
     };
 
     //! \brief A program containing compiled and linked shaders.
@@ -53,6 +54,31 @@ namespace mango
         //! \return The \a uniform_binding_data of all \a shaders in the \a shader_program.
         virtual const uniform_binding_data& get_single_bindings() = 0;
 
+        //! \brief Checks if compiling and linking of the \a shader_program finished.
+        //! \details Programs are compiled and linked asynchronously if the driver supports KHR_parallel_shader_compile.
+        //! Using a \a shader_program that is not ready blocks until it is.
+        //! \return True if the \a shader_program can be used without blocking, else false.
+        virtual bool is_ready() = 0;
+
+        //! \brief Starts recompiling all \a shaders from their sources and relinking the \a shader_program.
+        //! \details The new program is built in the background, the old one stays in use until finish_reload() is called.
+        //! A reload that is still in progress is discarded.
+        virtual void start_reload() = 0;
+
+        //! \brief Checks if a reload started with start_reload() finished compiling and linking.
+        //! \return True if finish_reload() can be called without blocking, false if no reload is in progress or it is not finished yet.
+        virtual bool is_reload_ready() = 0;
+
+        //! \brief Finishes a reload started with start_reload().
+        //! \details The new program replaces the old one only if compilation and linking succeed, else the old one is kept.
+        //! This changes the name of the \a shader_program and should only be called between frames.
+        //! \return True if the \a shader_program was replaced, else false.
+        virtual bool finish_reload() = 0;
+
+        //! \brief Retrieves the \a shaders attached to the \a shader_program.
+        //! \return A list of pointers to the attached \a shaders.
+        virtual const std::vector<shader_ptr>& get_shaders() = 0;
+
       protected:
         shader_program() = default;
         ~shader_program() = default;
@@ -49,6 +49,8 @@ namespace mango
         uint32 m_generate_mipmaps = 1;
         //! \brief Specifies if the texture is a cubemap.
         bool m_is_cubemap = false;
+        //! \brief Specifies if the texture contains tangent space normals. Streamed mipchains renormalize these.
+        bool m_is_normal_map = false;
 
         // We could need more parameters:
         // glTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
@@ -122,6 +124,52 @@ namespace mango
         //! \param[in] data The data to set the \a texture memory specified before to.
         virtual void set_data(format internal_format, uint32 width, uint32 height, format pixel_format, format type, const void* data) = 0;
 
+        //! \brief Sets the data of the \a texture for streaming.
+        //! \details The complete mipchain is built on the cpu, but only the levels starting at \a resident_level get uploaded to the gpu.
+        //! Only the levels that are not resident are kept on the cpu. SRGB data is filtered in linear space, normal maps get renormalized.
+        //! Streaming is only supported for \a UNSIGNED_BYTE data of non cubemap \a textures with a mipchain, in all other cases this falls back to set_data().
+        //! \param[in] internal_format The internal \a texture \a format to use. See set_data() for possible values.
+        //! \param[in] width The width of the \a texture.
+        //! \param[in] height The height of the \a texture.
+        //! \param[in] pixel_format The pixel \a format. Has to be \a RED, \a RG, \a RGB, \a BGR, \a RGBA or \a BGRA to be streamed.
+        //! \param[in] type The type of the data. Has to be \a UNSIGNED_BYTE to be streamed.
+        //! \param[in] data The data of the most detailed level.
+        //! \param[in] resident_level The most detailed mipmap level that should be resident on the gpu after the call.
+        virtual void set_streamed_data(format internal_format, uint32 width, uint32 height, format pixel_format, format type, const void* data, uint32 resident_level) = 0;
+
+        //! \brief Returns if the data of the \a texture is streamed.
+        //! \return True if the \a texture is streamed, else false.
+        virtual bool is_streamed() = 0;
+
+        //! \brief Returns the most detailed mipmap level of the \a texture resident on the gpu.
+        //! \return The most detailed resident level. 0 if the complete mipchain is resident.
+        virtual uint32 resident_level() = 0;
+
+        //! \brief Changes the mipmap levels of a streamed \a texture that are resident on the gpu.
+        //! \details The gpu storage is reallocated for the levels starting at \a level. Levels that are already resident get copied on the gpu, missing ones are uploaded from the cpu.
+        //! Evicted levels are copied back to the cpu asynchronously, the copy is finished by release_retired_storage().
+        //! This changes the name of the \a texture. The old storage and its bindless handles stay valid until release_retired_storage() is called.
+        //! \param[in] level The most detailed mipmap level that should be resident.
+        virtual void set_resident_level(uint32 level) = 0;
+
+        //! \brief Releases the gpu storage replaced by set_resident_level().
+        //! \details Makes the bindless handles of the old storage non resident and deletes it. Evicted levels the gpu finished copying back are stored on the cpu.
+        //! Should be called once the gpu finished all frames recorded before the storage was replaced.
+        //! \return True if everything is released, false if evicted levels are still copied back and it has to be called again later.
+        virtual bool release_retired_storage() = 0;
+
+        //! \brief Returns the gpu memory a streamed \a texture occupies, when all levels starting at \a level are resident.
+        //! \param[in] level The most detailed mipmap level.
+        //! \return The memory size in bytes.
+        virtual ptr_size level_memory(uint32 level) = 0;
+
+        //! \brief Returns a bindless handle of the \a texture and makes it resident.
+        //! \details Requires ARB_bindless_texture. After the first handle is created the \a texture parameters can not be changed anymore.
+        //! The handle is only valid as long as the name of the \a texture does not change.
+        //! \param[in] smp The \a sampler to sample the \a texture with. Nullptr to use the parameters of the \a texture.
+        //! \return The resident handle.
+        virtual g_uint64 get_bindless_handle(const sampler_ptr& smp) = 0;
+
         //! \brief Binds the \a texture to a specific unit.
         //! \param[in] unit The unit to bind the \a texture to.
         virtual void bind_texture_unit(g_uint unit) = 0;
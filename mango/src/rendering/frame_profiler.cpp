@@ -0,0 +1,128 @@
+//! \file      frame_profiler.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <core/timer.hpp>
+#include <glad/glad.h>
+#include <rendering/frame_profiler.hpp>
+
+using namespace mango;
+
+frame_profiler::frame_profiler(uint32 history_size)
+    : m_current_slot(0)
+    , m_frame(0)
+    , m_history_size(history_size)
+{
+    m_slots.resize(frames_in_flight);
+    for (auto& slot : m_slots)
+    {
+        slot.frame = 0;
+        slot.queries.resize(max_timestamps);
+        glCreateQueries(GL_TIMESTAMP, static_cast<g_sizei>(max_timestamps), slot.queries.data());
+        // written by commands on execution, so the storage is never reallocated.
+        slot.cpu_timestamps.resize(max_timestamps, 0);
+        slot.used_timestamps = 0;
+    }
+}
+
+frame_profiler::~frame_profiler()
+{
+    for (auto& slot : m_slots)
+        glDeleteQueries(static_cast<g_sizei>(max_timestamps), slot.queries.data());
+}
+
+void frame_profiler::begin_frame()
+{
+    MANGO_ASSERT(m_open_passes.empty(), "Not all passes of the last frame ended!");
+    m_open_passes.clear();
+
+    ++m_frame;
+    m_current_slot = (m_current_slot + 1) % frames_in_flight;
+
+    // the slot was recorded frames_in_flight frames ago, so the results are usually available.
+    frame_slot& slot = m_slots[m_current_slot];
+    if (slot.used_timestamps > 0)
+        read_back(slot);
+
+    slot.frame           = m_frame;
+    slot.used_timestamps = 0;
+    slot.passes.clear();
+}
+
+void frame_profiler::begin_pass(const string& name, const command_buffer_ptr& command_buffer)
+{
+    frame_slot& slot = m_slots[m_current_slot];
+
+    recorded_pass pass;
+    pass.name  = name;
+    pass.begin = write_timestamp(command_buffer);
+    pass.end   = invalid_timestamp;
+
+    m_open_passes.push_back(static_cast<uint32>(slot.passes.size()));
+    slot.passes.push_back(pass);
+}
+
+void frame_profiler::end_pass(const command_buffer_ptr& command_buffer)
+{
+    MANGO_ASSERT(!m_open_passes.empty(), "No pass was started!");
+    if (m_open_passes.empty())
+        return;
+
+    frame_slot& slot = m_slots[m_current_slot];
+    slot.passes[m_open_passes.back()].end = write_timestamp(command_buffer);
+    m_open_passes.pop_back();
+}
+
+uint32 frame_profiler::write_timestamp(const command_buffer_ptr& command_buffer)
+{
+    frame_slot& slot = m_slots[m_current_slot];
+    if (slot.used_timestamps >= max_timestamps)
+        return invalid_timestamp;
+
+    uint32 index = slot.used_timestamps++;
+    if (command_buffer)
+        command_buffer->write_timestamp(slot.queries[index], &slot.cpu_timestamps[index]);
+    else
+    {
+        glQueryCounter(slot.queries[index], GL_TIMESTAMP);
+        slot.cpu_timestamps[index] = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+    }
+
+    return index;
+}
+
+void frame_profiler::read_back(frame_slot& slot)
+{
+    // timestamps complete in order, so all results are available if the last one is.
+    g_int available = 0;
+    glGetQueryObjectiv(slot.queries[slot.used_timestamps - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+        MANGO_LOG_DEBUG("Timings of frame {0} are not available, the frame is dropped.", slot.frame);
+        return;
+    }
+
+    std::vector<uint64> gpu_timestamps(slot.used_timestamps);
+    for (uint32 i = 0; i < slot.used_timestamps; ++i)
+        glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &gpu_timestamps[i]);
+
+    frame_timings timings;
+    timings.frame = slot.frame;
+    for (auto& pass : slot.passes)
+    {
+        if (pass.begin == invalid_timestamp || pass.end == invalid_timestamp)
+            continue;
+
+        pass_timing timing;
+        timing.name     = pass.name;
+        timing.gpu_time = static_cast<float>(gpu_timestamps[pass.end] - gpu_timestamps[pass.begin]) * 1e-6f;
+        timing.cpu_time = static_cast<float>(slot.cpu_timestamps[pass.end] - slot.cpu_timestamps[pass.begin]) * 1e-6f;
+        timings.passes.push_back(timing);
+    }
+
+    m_history.push_back(timings);
+    while (m_history.size() > m_history_size)
+        m_history.pop_front();
+}
@@ -0,0 +1,98 @@
+//! \file      frame_profiler.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_FRAME_PROFILER_HPP
+#define MANGO_FRAME_PROFILER_HPP
+
+#include <deque>
+#include <graphics/command_buffer.hpp>
+#include <mango/render_system.hpp>
+
+namespace mango
+{
+    //! \brief Measures the gpu and cpu time of the passes rendered in each frame.
+    //! \details Passes are enclosed by timestamp queries. The queries of the last \a frames_in_flight frames are kept,
+    //! so results are only read back when the gpu finished them and reading never stalls.
+    //! Frames with results that are still not available when their queries get reused are dropped.
+    class frame_profiler
+    {
+      public:
+        //! \brief Constructs the \a frame_profiler.
+        //! \param[in] history_size The number of frames to keep the timings for.
+        frame_profiler(uint32 history_size);
+        ~frame_profiler();
+
+        //! \brief Starts a new frame and retrieves the timings of the oldest frame in flight.
+        //! \details Has to be called once per frame before any pass is started.
+        void begin_frame();
+
+        //! \brief Starts a pass. Passes can be nested.
+        //! \param[in] name The name of the pass.
+        //! \param[in] command_buffer The \a command_buffer recording the pass. Nullptr to measure commands executed immediately.
+        void begin_pass(const string& name, const command_buffer_ptr& command_buffer = nullptr);
+
+        //! \brief Ends the last started pass.
+        //! \param[in] command_buffer The \a command_buffer recording the pass. Nullptr to measure commands executed immediately.
+        void end_pass(const command_buffer_ptr& command_buffer = nullptr);
+
+        //! \brief Returns the timings of the last frames.
+        //! \return The \a frame_timings of the last frames with results, the oldest one first.
+        inline const std::deque<frame_timings>& get_frame_timings() const
+        {
+            return m_history;
+        }
+
+      private:
+        //! \brief A pass recorded in a frame.
+        struct recorded_pass
+        {
+            string name;  //!< The name of the pass.
+            uint32 begin; //!< The index of the timestamp at the start of the pass.
+            uint32 end;   //!< The index of the timestamp at the end of the pass.
+        };
+
+        //! \brief The queries and passes of one frame in flight.
+        struct frame_slot
+        {
+            uint64 frame;                      //!< The number of the frame recorded in the slot.
+            std::vector<g_uint> queries;       //!< The timestamp queries.
+            std::vector<int64> cpu_timestamps; //!< The cpu times in nanoseconds of the timestamps.
+            uint32 used_timestamps;            //!< The number of timestamps written in the frame.
+            std::vector<recorded_pass> passes; //!< The passes recorded in the frame.
+        };
+
+        //! \brief Writes a timestamp in the current frame.
+        //! \param[in] command_buffer The \a command_buffer to write the timestamp with. Nullptr to write it immediately.
+        //! \return The index of the timestamp, or invalid_timestamp if all timestamps of the frame are used.
+        uint32 write_timestamp(const command_buffer_ptr& command_buffer);
+
+        //! \brief Reads back the timings of a frame into the history.
+        //! \param[in] slot The \a frame_slot to read.
+        void read_back(frame_slot& slot);
+
+        //! \brief The queries and passes of the frames in flight.
+        std::vector<frame_slot> m_slots;
+        //! \brief The index of the \a frame_slot of the current frame.
+        uint32 m_current_slot;
+        //! \brief The number of the current frame.
+        uint64 m_frame;
+        //! \brief The indices of the started passes, that did not end yet.
+        std::vector<uint32> m_open_passes;
+        //! \brief The timings of the last frames.
+        std::deque<frame_timings> m_history;
+        //! \brief The number of frames to keep the timings for.
+        uint32 m_history_size;
+
+        //! \brief The number of frames recorded before their queries are reused.
+        const uint32 frames_in_flight = 3;
+        //! \brief The maximum number of timestamps written per frame.
+        const uint32 max_timestamps = 64;
+        //! \brief The index marking a timestamp that could not be written.
+        const uint32 invalid_timestamp = ~0u;
+    };
+} // namespace mango
+
+#endif // MANGO_FRAME_PROFILER_HPP
@@ -0,0 +1,277 @@
+//! \file      hi_z_culling.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glad/glad.h>
+#include <graphics/buffer.hpp>
+#include <graphics/shader.hpp>
+#include <graphics/shader_program.hpp>
+#include <graphics/texture.hpp>
+#include <rendering/hi_z_culling.hpp>
+
+using namespace mango;
+
+hi_z_culling::hi_z_culling()
+    : m_pyramid_view_projection(1.0f)
+    , m_depth_width(0)
+    , m_depth_height(0)
+    , m_readback_level(0)
+    , m_readback_width(0)
+    , m_readback_height(0)
+    , m_current_slot(0)
+    , m_pyramid_recorded(false)
+    , m_depth_view_projection(1.0f)
+    , m_tested_models(0)
+    , m_culled_models(0)
+{
+    readback_slot unused_slot;
+    unused_slot.mapped_memory   = nullptr;
+    unused_slot.fence           = nullptr;
+    unused_slot.view_projection = glm::mat4(1.0f);
+    m_slots.assign(frames_in_flight, unused_slot);
+}
+
+hi_z_culling::~hi_z_culling()
+{
+    for (auto& slot : m_slots)
+    {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+    }
+}
+
+bool hi_z_culling::create()
+{
+    shader_configuration shader_config;
+    shader_config.m_path    = "res/shader/c_hi_z_downsample.glsl";
+    shader_config.m_type    = shader_type::COMPUTE_SHADER;
+    shader_config.m_defines = { { "FROM_DEPTH", "" } };
+    shader_ptr depth_compute = shader::create(shader_config);
+    shader_config.m_defines.clear();
+    shader_ptr level_compute = shader::create(shader_config);
+    if (!depth_compute || !level_compute)
+    {
+        MANGO_LOG_ERROR("Creation of hi-z downsample compute shaders failed!");
+        return false;
+    }
+
+    m_downsample_depth = shader_program::create_compute_pipeline(depth_compute);
+    m_downsample_level = shader_program::create_compute_pipeline(level_compute);
+    if (!m_downsample_depth || !m_downsample_level)
+    {
+        MANGO_LOG_ERROR("Creation of hi-z downsample compute shader programs failed!");
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<shader_program_ptr> hi_z_culling::get_shader_programs()
+{
+    return { m_downsample_depth, m_downsample_level };
+}
+
+void hi_z_culling::create_pyramid(uint32 width, uint32 height)
+{
+    m_depth_width  = width;
+    m_depth_height = height;
+
+    // the pyramid ends with the first level small enough to be read back and tested on the cpu.
+    uint32 level_width  = std::max((width + 1) / 2, 1u);
+    uint32 level_height = std::max((height + 1) / 2, 1u);
+    m_readback_level    = 0;
+    while (level_width > max_readback_size || level_height > max_readback_size)
+    {
+        level_width  = std::max(level_width / 2, 1u);
+        level_height = std::max(level_height / 2, 1u);
+        ++m_readback_level;
+    }
+    m_readback_width  = level_width;
+    m_readback_height = level_height;
+
+    texture_configuration pyramid_config;
+    pyramid_config.m_generate_mipmaps        = m_readback_level + 1;
+    pyramid_config.m_is_standard_color_space = false;
+    pyramid_config.m_texture_min_filter      = texture_parameter::FILTER_NEAREST;
+    pyramid_config.m_texture_mag_filter      = texture_parameter::FILTER_NEAREST;
+    pyramid_config.m_texture_wrap_s          = texture_parameter::WRAP_CLAMP_TO_EDGE;
+    pyramid_config.m_texture_wrap_t          = texture_parameter::WRAP_CLAMP_TO_EDGE;
+    m_pyramid                                = texture::create(pyramid_config);
+    m_pyramid->set_data(format::R32F, std::max((width + 1) / 2, 1u), std::max((height + 1) / 2, 1u), format::RED, format::FLOAT, nullptr);
+
+    // copies in flight have the old size, so they are dropped.
+    ptr_size readback_bytes = static_cast<ptr_size>(m_readback_width) * m_readback_height * sizeof(g_float);
+    for (auto& slot : m_slots)
+    {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        buffer_configuration pixel_buffer_config(readback_bytes, buffer_target::NONE, buffer_access::MAPPED_ACCESS_READ);
+        slot.pixel_buffer  = buffer::create(pixel_buffer_config);
+        slot.mapped_memory = slot.pixel_buffer ? slot.pixel_buffer->map(0, slot.pixel_buffer->byte_length(), buffer_access::MAPPED_ACCESS_READ) : nullptr;
+    }
+    m_depth_levels.clear();
+}
+
+void hi_z_culling::begin_frame()
+{
+    m_tested_models    = 0;
+    m_culled_models    = 0;
+    m_pyramid_recorded = false;
+    m_current_slot     = (m_current_slot + 1) % frames_in_flight;
+
+    readback_slot& slot = m_slots[m_current_slot];
+    if (!slot.fence)
+        return;
+
+    // the copy was started frames_in_flight frames ago, if it is still not finished the older depth is kept.
+    g_enum result = glClientWaitSync(slot.fence, 0, 0);
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+    {
+        MANGO_LOG_DEBUG("Hi-z depth is not available, the frame is dropped.");
+        return;
+    }
+    if (!slot.mapped_memory)
+        return;
+
+    depth_level level;
+    level.width  = m_readback_width;
+    level.height = m_readback_height;
+    level.depth.resize(static_cast<ptr_size>(level.width) * level.height);
+    std::memcpy(level.depth.data(), slot.mapped_memory, level.depth.size() * sizeof(float));
+    m_depth_levels.assign(1, level);
+    m_depth_view_projection = slot.view_projection;
+
+    // the coarser levels are cheap on the cpu and keep the number of texels per test small for large models.
+    while (m_depth_levels.back().width > 1 || m_depth_levels.back().height > 1)
+    {
+        const depth_level& source = m_depth_levels.back();
+        depth_level target;
+        target.width  = std::max(source.width / 2, 1u);
+        target.height = std::max(source.height / 2, 1u);
+        target.depth.assign(static_cast<ptr_size>(target.width) * target.height, 0.0f);
+        for (uint32 y = 0; y < source.height; ++y)
+        {
+            uint32 target_y = std::min(y * target.height / source.height, target.height - 1);
+            for (uint32 x = 0; x < source.width; ++x)
+            {
+                uint32 target_x = std::min(x * target.width / source.width, target.width - 1);
+                float& farthest = target.depth[target_y * target.width + target_x];
+                farthest        = std::max(farthest, source.depth[y * source.width + x]);
+            }
+        }
+        m_depth_levels.push_back(target);
+    }
+}
+
+bool hi_z_culling::is_occluded(const glm::mat4& model_matrix, const glm::vec3& min_extents, const glm::vec3& max_extents)
+{
+    if (m_depth_levels.empty())
+        return false;
+    ++m_tested_models;
+
+    // screen space bounds of the box in the frame the depth was rendered in.
+    glm::mat4 model_view_projection = m_depth_view_projection * model_matrix;
+    glm::vec2 min_uv(1.0f);
+    glm::vec2 max_uv(0.0f);
+    float nearest_depth = 1.0f;
+    for (uint32 i = 0; i < 8; ++i)
+    {
+        glm::vec4 corner((i & 1) ? max_extents.x : min_extents.x, (i & 2) ? max_extents.y : min_extents.y, (i & 4) ? max_extents.z : min_extents.z, 1.0f);
+        glm::vec4 clip = model_view_projection * corner;
+        if (clip.w <= 0.0f)
+            return false; // crosses the camera plane.
+
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        min_uv        = glm::min(min_uv, glm::vec2(ndc) * 0.5f + 0.5f);
+        max_uv        = glm::max(max_uv, glm::vec2(ndc) * 0.5f + 0.5f);
+        nearest_depth = std::min(nearest_depth, ndc.z * 0.5f + 0.5f);
+    }
+    // models outside of the depth are not hidden by it, frustum culling is not done here.
+    if (nearest_depth <= 0.0f || min_uv.x < 0.0f || min_uv.y < 0.0f || max_uv.x > 1.0f || max_uv.y > 1.0f)
+        return false;
+
+    // the finest level where the box covers only a few texels.
+    const depth_level* level = nullptr;
+    uint32 x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    for (auto& l : m_depth_levels)
+    {
+        level = &l;
+        x0    = std::min(static_cast<uint32>(min_uv.x * static_cast<float>(l.width)), l.width - 1);
+        y0    = std::min(static_cast<uint32>(min_uv.y * static_cast<float>(l.height)), l.height - 1);
+        x1    = std::min(static_cast<uint32>(max_uv.x * static_cast<float>(l.width)), l.width - 1);
+        y1    = std::min(static_cast<uint32>(max_uv.y * static_cast<float>(l.height)), l.height - 1);
+        if (x1 - x0 < max_tested_texels && y1 - y0 < max_tested_texels)
+            break;
+    }
+
+    float farthest_depth = 0.0f;
+    for (uint32 y = y0; y <= y1; ++y)
+    {
+        for (uint32 x = x0; x <= x1; ++x)
+            farthest_depth = std::max(farthest_depth, level->depth[y * level->width + x]);
+    }
+
+    if (nearest_depth <= farthest_depth)
+        return false;
+
+    ++m_culled_models;
+    return true;
+}
+
+void hi_z_culling::build_pyramid(const command_buffer_ptr& command_buffer, const texture_ptr& depth, const glm::mat4& view_projection)
+{
+    if (!m_pyramid || depth->get_width() != m_depth_width || depth->get_height() != m_depth_height)
+        create_pyramid(depth->get_width(), depth->get_height());
+
+    // each texel gets the farthest depth of all texels it covers in the level before.
+    command_buffer->bind_shader_program(m_downsample_depth);
+    command_buffer->bind_texture(0, depth, 0);
+    command_buffer->bind_image_texture(1, m_pyramid, 0, false, 0, base_access::WRITE_ONLY, format::R32F);
+    uint32 width  = std::max((m_depth_width + 1) / 2, 1u);
+    uint32 height = std::max((m_depth_height + 1) / 2, 1u);
+    command_buffer->dispatch_compute((width + 7) / 8, (height + 7) / 8, 1);
+
+    command_buffer->bind_shader_program(m_downsample_level);
+    for (uint32 level = 1; level <= m_readback_level; ++level)
+    {
+        command_buffer->add_memory_barrier(memory_barrier_bit::SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        command_buffer->bind_image_texture(0, m_pyramid, static_cast<g_int>(level - 1), false, 0, base_access::READ_ONLY, format::R32F);
+        command_buffer->bind_image_texture(1, m_pyramid, static_cast<g_int>(level), false, 0, base_access::WRITE_ONLY, format::R32F);
+        width  = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        command_buffer->dispatch_compute((width + 7) / 8, (height + 7) / 8, 1);
+    }
+    command_buffer->add_memory_barrier(memory_barrier_bit::TEXTURE_UPDATE_BARRIER_BIT);
+    command_buffer->bind_image_texture(0, nullptr, 0, false, 0, base_access::READ_ONLY, format::R32F);
+    command_buffer->bind_image_texture(1, nullptr, 0, false, 0, base_access::WRITE_ONLY, format::R32F);
+    command_buffer->bind_shader_program(nullptr);
+
+    m_slots[m_current_slot].view_projection = view_projection;
+    m_pyramid_view_projection               = view_projection;
+    m_pyramid_recorded                      = true;
+}
+
+void hi_z_culling::end_frame()
+{
+    readback_slot& slot = m_slots[m_current_slot];
+    if (!m_pyramid_recorded || !slot.pixel_buffer)
+        return;
+
+    // the copy to the pixel buffer runs asynchronously, the fence tells when the cpu can read it.
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pixel_buffer->get_name());
+    glGetTextureImage(m_pyramid->get_name(), static_cast<g_int>(m_readback_level), GL_RED, GL_FLOAT, static_cast<g_sizei>(slot.pixel_buffer->byte_length()), nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (slot.fence)
+        glDeleteSync(slot.fence);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
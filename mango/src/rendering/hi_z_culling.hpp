@@ -0,0 +1,157 @@
+//! \file      hi_z_culling.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_HI_Z_CULLING_HPP
+#define MANGO_HI_Z_CULLING_HPP
+
+#include <graphics/command_buffer.hpp>
+#include <mango/render_system.hpp>
+
+namespace mango
+{
+    //! \brief Culls models hidden behind the depth of an earlier frame.
+    //! \details After the geometry pass a pyramid with the farthest depth of each texel is built from the gbuffer depth with compute shaders.
+    //! A coarse level of the pyramid is read back without stalling, so the bounds of the models are tested on the cpu with the depth of a frame \a frames_in_flight frames ago.
+    //! The test is conservative for static geometry, moving models or a fast camera can be culled for a few frames too long.
+    class hi_z_culling
+    {
+      public:
+        hi_z_culling();
+        ~hi_z_culling();
+
+        //! \brief Creates the \a shader_programs building the pyramid.
+        //! \return True on success, else false.
+        bool create();
+
+        //! \brief Returns the \a shader_programs building the pyramid.
+        //! \return The \a shader_programs, so they can be watched and polled.
+        std::vector<shader_program_ptr> get_shader_programs();
+
+        //! \brief Starts a new frame and takes the depth of the oldest frame in flight for the tests, if it is available.
+        //! \details Has to be called once per frame before any model is tested.
+        void begin_frame();
+
+        //! \brief Tests the bounds of a model against the depth read back.
+        //! \param[in] model_matrix The model matrix of the model.
+        //! \param[in] min_extents The minimum of the axis aligned bounding box of the model in model space.
+        //! \param[in] max_extents The maximum of the axis aligned bounding box of the model in model space.
+        //! \return True if the model is completely hidden, else false.
+        bool is_occluded(const glm::mat4& model_matrix, const glm::vec3& min_extents, const glm::vec3& max_extents);
+
+        //! \brief Records building the pyramid from the depth of the current frame.
+        //! \param[in] command_buffer The \a command_buffer to record to.
+        //! \param[in] depth The depth target of the gbuffer after the geometry pass.
+        //! \param[in] view_projection The view projection matrix the depth was rendered with.
+        void build_pyramid(const command_buffer_ptr& command_buffer, const texture_ptr& depth, const glm::mat4& view_projection);
+
+        //! \brief Ends the frame after its commands were executed.
+        //! \details Starts copying the coarse level of the pyramid to the cpu.
+        void end_frame();
+
+        //! \brief Returns the number of models tested in the current frame.
+        //! \return The number of tested models.
+        inline uint32 get_tested_models() const
+        {
+            return m_tested_models;
+        }
+
+        //! \brief Returns the number of models culled in the current frame.
+        //! \return The number of occluded models.
+        inline uint32 get_culled_models() const
+        {
+            return m_culled_models;
+        }
+
+        //! \brief Returns the pyramid built in the last frame, so it can be tested against on the gpu.
+        //! \return The pyramid or nullptr if none was built yet.
+        inline texture_ptr get_pyramid() const
+        {
+            return m_pyramid;
+        }
+
+        //! \brief Returns the number of levels of the pyramid.
+        //! \return The number of levels, the last one is the level read back.
+        inline uint32 get_pyramid_levels() const
+        {
+            return m_readback_level + 1;
+        }
+
+        //! \brief Returns the view projection matrix the pyramid of the last frame was built with.
+        //! \return The view projection matrix.
+        inline const glm::mat4& get_pyramid_view_projection() const
+        {
+            return m_pyramid_view_projection;
+        }
+
+      private:
+        //! \brief Creates the pyramid and the readback buffers for a depth target size.
+        //! \param[in] width The width of the depth target.
+        //! \param[in] height The height of the depth target.
+        void create_pyramid(uint32 width, uint32 height);
+
+        //! \brief The readback of the coarse level of one frame in flight.
+        struct readback_slot
+        {
+            buffer_ptr pixel_buffer;   //!< The buffer the coarse level is copied to.
+            const void* mapped_memory; //!< The persistently mapped memory of the pixel buffer.
+            g_sync fence;              //!< The fence signaled when the copy is finished. Nullptr if nothing is in flight.
+            glm::mat4 view_projection; //!< The view projection matrix the depth was rendered with.
+        };
+
+        //! \brief The compute \a shader_program building the first level of the pyramid from the depth target.
+        shader_program_ptr m_downsample_depth;
+        //! \brief The compute \a shader_program building a level of the pyramid from the previous one.
+        shader_program_ptr m_downsample_level;
+
+        //! \brief The pyramid with the farthest depth. The first level has half the size of the depth target, the last one is read back.
+        texture_ptr m_pyramid;
+        //! \brief The view projection matrix the pyramid was built with.
+        glm::mat4 m_pyramid_view_projection;
+        //! \brief The width of the depth target the pyramid was created for.
+        uint32 m_depth_width;
+        //! \brief The height of the depth target the pyramid was created for.
+        uint32 m_depth_height;
+        //! \brief The index of the pyramid level that is read back.
+        uint32 m_readback_level;
+        //! \brief The width of the pyramid level that is read back.
+        uint32 m_readback_width;
+        //! \brief The height of the pyramid level that is read back.
+        uint32 m_readback_height;
+
+        //! \brief The readbacks of the frames in flight.
+        std::vector<readback_slot> m_slots;
+        //! \brief The index of the \a readback_slot of the current frame.
+        uint32 m_current_slot;
+        //! \brief True if a pyramid was recorded in the current frame, else false.
+        bool m_pyramid_recorded;
+
+        //! \brief A level of the depth pyramid on the cpu.
+        struct depth_level
+        {
+            uint32 width;             //!< The width of the level.
+            uint32 height;            //!< The height of the level.
+            std::vector<float> depth; //!< The farthest depth of each texel, the first row is the bottom one.
+        };
+        //! \brief The levels on the cpu used for testing. The first one is the level read back, the others are reduced down to one texel.
+        std::vector<depth_level> m_depth_levels;
+        //! \brief The view projection matrix the depth on the cpu was rendered with.
+        glm::mat4 m_depth_view_projection;
+
+        //! \brief The number of models tested in the current frame.
+        uint32 m_tested_models;
+        //! \brief The number of models culled in the current frame.
+        uint32 m_culled_models;
+
+        //! \brief The number of frames recorded before their readback is reused.
+        const uint32 frames_in_flight = 3;
+        //! \brief The maximum width and height of the pyramid level read back.
+        const uint32 max_readback_size = 128;
+        //! \brief The maximum number of texels in each direction a model covers in the level it is tested with.
+        const uint32 max_tested_texels = 4;
+    };
+} // namespace mango
+
+#endif // MANGO_HI_Z_CULLING_HPP
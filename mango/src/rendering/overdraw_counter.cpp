@@ -0,0 +1,95 @@
+//! \file      overdraw_counter.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <glad/glad.h>
+#include <graphics/buffer.hpp>
+#include <rendering/overdraw_counter.hpp>
+
+using namespace mango;
+
+overdraw_counter::overdraw_counter()
+    : m_mapped_counter_memory(nullptr)
+    , m_slot_size(0)
+    , m_current_slot(0)
+    , m_shaded_fragments(0)
+{
+    g_int alignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    ptr_size offset_alignment = static_cast<ptr_size>(alignment);
+    m_slot_size               = (sizeof(g_uint) + offset_alignment - 1) / offset_alignment * offset_alignment;
+
+    // the counters start at zero, afterwards they are only read.
+    std::vector<g_ubyte> zeros(frames_in_flight * m_slot_size, 0);
+    buffer_configuration counter_buffer_config(zeros.size(), buffer_target::SHADER_STORAGE_BUFFER, buffer_access::MAPPED_ACCESS_READ);
+    counter_buffer_config.m_data = zeros.data();
+    m_counter_buffer             = buffer::create(counter_buffer_config);
+    if (!m_counter_buffer)
+    {
+        MANGO_LOG_ERROR("Creation of overdraw counter buffer failed! Overdraw is not measured!");
+        return;
+    }
+    m_mapped_counter_memory = m_counter_buffer->map(0, m_counter_buffer->byte_length(), buffer_access::MAPPED_ACCESS_READ);
+
+    counter_slot unused_slot;
+    unused_slot.fence      = nullptr;
+    unused_slot.last_value = 0;
+    m_slots.assign(frames_in_flight, unused_slot);
+}
+
+overdraw_counter::~overdraw_counter()
+{
+    for (auto& slot : m_slots)
+    {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+    }
+}
+
+void overdraw_counter::begin_frame()
+{
+    m_current_slot = (m_current_slot + 1) % frames_in_flight;
+
+    counter_slot& slot = m_slots[m_current_slot];
+    if (!slot.fence || !m_mapped_counter_memory)
+        return;
+
+    // the frame was submitted frames_in_flight frames ago, so waiting is rare. Skipping would mix two frames in one counter.
+    g_enum result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED)
+    {
+        MANGO_LOG_DEBUG("Overdraw counter is not available, the frame is dropped.");
+        return;
+    }
+
+    // unsigned arithmetic handles the counter wrapping around.
+    g_uint value       = *reinterpret_cast<const g_uint*>(static_cast<const g_byte*>(m_mapped_counter_memory) + m_current_slot * m_slot_size);
+    m_shaded_fragments = value - slot.last_value;
+    slot.last_value    = value;
+}
+
+void overdraw_counter::bind(const command_buffer_ptr& command_buffer, g_uint binding)
+{
+    if (!m_counter_buffer)
+        return;
+
+    command_buffer->bind_buffer(buffer_target::SHADER_STORAGE_BUFFER, binding, m_counter_buffer, static_cast<g_intptr>(m_current_slot * m_slot_size), static_cast<g_sizeiptr>(sizeof(g_uint)));
+}
+
+void overdraw_counter::end_frame()
+{
+    if (!m_counter_buffer)
+        return;
+
+    counter_slot& slot = m_slots[m_current_slot];
+    if (slot.fence)
+        glDeleteSync(slot.fence);
+
+    // shader writes to a persistently mapped buffer are only visible to the client after this barrier.
+    glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,73 @@
+//! \file      overdraw_counter.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_OVERDRAW_COUNTER_HPP
+#define MANGO_OVERDRAW_COUNTER_HPP
+
+#include <graphics/command_buffer.hpp>
+#include <mango/render_system.hpp>
+
+namespace mango
+{
+    //! \brief Counts the fragments shaded by the geometry pass in each frame.
+    //! \details The fragment shader increments an atomic counter in a shader storage buffer.
+    //! Each of the \a frames_in_flight frames uses its own counter, which is read back when the gpu finished the frame.
+    //! The counters are never reset, the fragments of a frame are the difference to the last value read.
+    //! This is a debug mode, every fragment shader invocation contends on the same counter.
+    class overdraw_counter
+    {
+      public:
+        //! \brief Constructs the \a overdraw_counter.
+        overdraw_counter();
+        ~overdraw_counter();
+
+        //! \brief Starts a new frame and reads the counter of the oldest frame in flight.
+        //! \details Has to be called once per frame before the counter is bound.
+        void begin_frame();
+
+        //! \brief Binds the counter of the current frame for the geometry pass.
+        //! \param[in] command_buffer The \a command_buffer recording the geometry pass.
+        //! \param[in] binding The shader storage buffer binding of the counter.
+        void bind(const command_buffer_ptr& command_buffer, g_uint binding);
+
+        //! \brief Ends the frame after its commands were executed.
+        //! \details Inserts the fence marking the counter of the frame as readable.
+        void end_frame();
+
+        //! \brief Returns the number of fragments shaded in the last frame read back.
+        //! \return The number of fragments shaded by the geometry pass.
+        inline uint32 get_shaded_fragments() const
+        {
+            return m_shaded_fragments;
+        }
+
+      private:
+        //! \brief The counter and fence of one frame in flight.
+        struct counter_slot
+        {
+            g_sync fence;      //!< The fence signaled when the frame is finished on the gpu. Nullptr if nothing is in flight.
+            uint32 last_value; //!< The value of the counter when it was read the last time.
+        };
+
+        //! \brief The shader storage buffer with one counter per frame in flight.
+        buffer_ptr m_counter_buffer;
+        //! \brief The persistently mapped memory of the counter buffer.
+        void* m_mapped_counter_memory;
+        //! \brief The size of the range of one counter in bytes, aligned for binding.
+        ptr_size m_slot_size;
+        //! \brief The counters of the frames in flight.
+        std::vector<counter_slot> m_slots;
+        //! \brief The index of the \a counter_slot of the current frame.
+        uint32 m_current_slot;
+        //! \brief The number of fragments shaded in the last frame read back.
+        uint32 m_shaded_fragments;
+
+        //! \brief The number of frames recorded before their counter is reused.
+        const uint32 frames_in_flight = 3;
+    };
+} // namespace mango
+
+#endif // MANGO_OVERDRAW_COUNTER_HPP
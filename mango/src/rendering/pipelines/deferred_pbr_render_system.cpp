@@ -4,18 +4,27 @@
 //! \date      2020
 //! \copyright Apache License 2.0
 
+#include <algorithm>
+#include <core/timer.hpp>
 #include <core/window_system_impl.hpp>
+#include <cmath>
+#include <cstring>
+#include <functional>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <graphics/buffer.hpp>
 #include <graphics/framebuffer.hpp>
+#include <graphics/sampler.hpp>
 #include <graphics/shader.hpp>
 #include <graphics/shader_program.hpp>
 #include <graphics/texture.hpp>
 #include <graphics/vertex_array.hpp>
+#include <limits>
+#include <mango/profile.hpp>
 #include <mango/scene.hpp>
 #include <rendering/pipelines/deferred_pbr_render_system.hpp>
 #include <rendering/steps/ibl_step.hpp>
+#include <resources/resource_system.hpp>
 
 #ifdef MANGO_DEBUG
 static void GLAPIENTRY debugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam);
@@ -23,13 +32,6 @@ static void GLAPIENTRY debugCallback(GLenum source, GLenum type, GLuint id, GLen
 
 using namespace mango;
 
-//! \brief Single uniforms for the lighting pass accessed and utilized only internally by the renderer at the moment.
-struct lighting_pass_uniforms
-{
-    glm::mat4 inverse_view_projection; //!< The inverse of the queried camera view projection matrix of the current scene.
-    glm::vec3 camera_position;         //!< The position of the queried camera of the current scene.
-};
-
 //! \brief Default vertex array object for second pass with geometry shader generated geometry.
 vertex_array_ptr default_vao;
 //! \brief Default texture that is bound to every texture unit not in use to prevent warnings.
@@ -37,7 +39,47 @@ texture_ptr default_texture;
 
 deferred_pbr_render_system::deferred_pbr_render_system(const shared_ptr<context_impl>& context)
     : render_system_impl(context)
+    , m_gbuffer_layout(gbuffer_layout::standard)
+    , m_view_projection(1.0f)
+    , m_depth_pre_pass(false)
+    , m_front_to_back_sorting(true)
+    , m_target_frame_time(0.0f)
+    , m_render_scale(1.0f)
+    , m_last_scaled_frame(0)
+    , m_render_width(0)
+    , m_render_height(0)
+    , m_clear_whole_gbuffer(true)
+    , m_mapped_object_memory(nullptr)
+    , m_object_buffer_half_size(0)
+    , m_object_buffer_half(0)
+    , m_object_id(0)
+    , m_draw_parameters(false)
+    , m_mapped_light_memory(nullptr)
+    , m_light_buffer_half_size(0)
+    , m_light_buffer_half(0)
+    , m_light_count(0)
+    , m_mapped_material_memory(nullptr)
+    , m_bindless_textures(false)
+    , m_model_matrix(1.0f)
+    , m_inverse_model_matrix(1.0f)
+    , m_model_footprint(std::numeric_limits<float>::max())
+    , m_model_view_depth(0.0f)
+    , m_camera_position(0.0f)
+    , m_view_matrix(1.0f)
+    , m_projection_matrix(1.0f)
+    , m_camera_planes(0.1f, 100.0f)
+    , m_projection_scale(1.0f)
+    , m_perspective_projection(true)
+    , m_viewport_x(0)
+    , m_viewport_y(0)
+    , m_viewport_width(0)
+    , m_viewport_height(0)
+    , m_viewport_changed(false)
+    , m_shader_programs_ready(false)
+    , m_loading_frame(false)
 {
+    std::memset(&m_state_change_statistics, 0, sizeof(m_state_change_statistics));
+    std::memset(&m_occlusion_culling_statistics, 0, sizeof(m_occlusion_culling_statistics));
 }
 
 deferred_pbr_render_system::~deferred_pbr_render_system() {}
@@ -62,39 +104,18 @@ bool deferred_pbr_render_system::create()
     // glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_OTHER, 0, GL_DEBUG_SEVERITY_NOTIFICATION, -1, "Test Message GLDebug!");
 #endif // MANGO_DEBUG
 
+    m_frame_profiler = std::make_shared<frame_profiler>(profiled_frames);
+
     shared_ptr<window_system_impl> ws = m_shared_context->get_window_system_internal().lock();
     MANGO_ASSERT(ws, "Window System is expireds!");
     uint32 w = ws->get_width();
     uint32 h = ws->get_height();
+    m_viewport_width  = w;
+    m_viewport_height = h;
+    m_render_width    = w;
+    m_render_height   = h;
 
-    framebuffer_configuration config;
-    texture_configuration attachment_config;
-    attachment_config.m_generate_mipmaps        = 1;
-    attachment_config.m_is_standard_color_space = false;
-    attachment_config.m_texture_min_filter      = texture_parameter::FILTER_NEAREST;
-    attachment_config.m_texture_mag_filter      = texture_parameter::FILTER_NEAREST;
-    attachment_config.m_texture_wrap_s          = texture_parameter::WRAP_CLAMP_TO_EDGE;
-    attachment_config.m_texture_wrap_t          = texture_parameter::WRAP_CLAMP_TO_EDGE;
-
-    config.m_color_attachment0 = texture::create(attachment_config);
-    config.m_color_attachment0->set_data(format::RGBA8, w, h, format::RGBA, format::UNSIGNED_INT_8_8_8_8, nullptr);
-    config.m_color_attachment1 = texture::create(attachment_config);
-    config.m_color_attachment1->set_data(format::RGB10_A2, w, h, format::RGBA, format::UNSIGNED_INT_10_10_10_2, nullptr);
-    config.m_color_attachment2 = texture::create(attachment_config);
-    config.m_color_attachment2->set_data(format::RGBA8, w, h, format::RGBA, format::UNSIGNED_INT_8_8_8_8, nullptr);
-    config.m_color_attachment3 = texture::create(attachment_config);
-    config.m_color_attachment3->set_data(format::RGBA8, w, h, format::RGBA, format::UNSIGNED_INT_8_8_8_8, nullptr);
-    config.m_depth_attachment = texture::create(attachment_config);
-    // glTextureParameteri(config.m_depth_attachment->get_name(), GL_TEXTURE_COMPARE_MODE, GL_NONE);
-    // glTextureParameteri(config.m_depth_attachment->get_name(), GL_DEPTH_TEXTURE_MODE, GL_LUMINANCE);
-    config.m_depth_attachment->set_data(format::DEPTH_COMPONENT32F, w, h, format::DEPTH_COMPONENT, format::FLOAT, nullptr);
-
-    config.m_width  = w;
-    config.m_height = h;
-
-    m_gbuffer = framebuffer::create(config);
-
-    if (!m_gbuffer)
+    if (!create_gbuffer(get_render_target_size(w), get_render_target_size(h)))
     {
         MANGO_LOG_ERROR("Creation of gbuffer failed! Render system not available!");
         return false;
@@ -117,62 +138,184 @@ bool deferred_pbr_render_system::create()
     }
     m_frame_uniform_offset = 0;
 
+    // persistent object buffer
+    g_int storage_buffer_alignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storage_buffer_alignment);
+    ptr_size alignment        = static_cast<ptr_size>(glm::max(storage_buffer_alignment, 1));
+    m_object_buffer_half_size = (object_entries * sizeof(scene_object_data) + alignment - 1) / alignment * alignment;
+
+    buffer_configuration object_buffer_config(2 * m_object_buffer_half_size, buffer_target::SHADER_STORAGE_BUFFER, buffer_access::MAPPED_ACCESS_WRITE);
+    m_object_buffer = buffer::create(object_buffer_config);
+    if (!m_object_buffer)
+    {
+        MANGO_LOG_ERROR("Creation of object buffer failed! Render system not available!");
+        return false;
+    }
+
+    m_mapped_object_memory = m_object_buffer->map(0, m_object_buffer->byte_length(), buffer_access::MAPPED_ACCESS_WRITE);
+    if (!m_mapped_object_memory)
+    {
+        MANGO_LOG_ERROR("Mapping of objects failed! Render system not available!");
+        return false;
+    }
+    object_slot unwritten_slot;
+    unwritten_slot.model_matrix             = glm::mat4(1.0f);
+    unwritten_slot.inverse_model_matrix     = glm::mat4(1.0f);
+    unwritten_slot.has_normals              = false;
+    unwritten_slot.has_tangents             = false;
+    unwritten_slot.has_quantized_attributes = false;
+    unwritten_slot.position_offset          = glm::vec3(0.0f);
+    unwritten_slot.position_scale           = glm::vec3(1.0f);
+    unwritten_slot.written                  = false;
+    m_object_slots.assign(2 * object_entries, unwritten_slot);
+
+    // without draw parameters the draw index is set as uniform for each draw call.
+    m_draw_parameters = extension_supported("GL_ARB_shader_draw_parameters");
+    MANGO_LOG_DEBUG("Shader draw parameters {0}.", m_draw_parameters ? "enabled" : "not supported");
+
+    // persistent light buffer
+    m_light_buffer_half_size = (max_lights * sizeof(scene_light_data) + alignment - 1) / alignment * alignment;
+
+    buffer_configuration light_buffer_config(2 * m_light_buffer_half_size, buffer_target::SHADER_STORAGE_BUFFER, buffer_access::MAPPED_ACCESS_WRITE);
+    m_light_buffer = buffer::create(light_buffer_config);
+    if (!m_light_buffer)
+    {
+        MANGO_LOG_ERROR("Creation of light buffer failed! Render system not available!");
+        return false;
+    }
+
+    m_mapped_light_memory = m_light_buffer->map(0, m_light_buffer->byte_length(), buffer_access::MAPPED_ACCESS_WRITE);
+    if (!m_mapped_light_memory)
+    {
+        MANGO_LOG_ERROR("Mapping of lights failed! Render system not available!");
+        return false;
+    }
+
+    // light clusters only live on the gpu, the active flags have to start cleared.
+    uint32 cluster_count = cluster_grid_x * cluster_grid_y * cluster_grid_z;
+    buffer_configuration cluster_buffer_config(cluster_count * 2 * sizeof(g_uint), buffer_target::SHADER_STORAGE_BUFFER, buffer_access::DYNAMIC_STORAGE);
+    m_cluster_buffer = buffer::create(cluster_buffer_config);
+    buffer_configuration cluster_light_index_buffer_config(cluster_count * max_lights_per_cluster * sizeof(g_uint), buffer_target::SHADER_STORAGE_BUFFER, buffer_access::DYNAMIC_STORAGE);
+    m_cluster_light_index_buffer = buffer::create(cluster_light_index_buffer_config);
+    if (!m_cluster_buffer || !m_cluster_light_index_buffer)
+    {
+        MANGO_LOG_ERROR("Creation of light cluster buffers failed! Render system not available!");
+        return false;
+    }
+    g_uint cleared = 0;
+    m_cluster_buffer->set_data(format::R32UI, 0, static_cast<g_sizeiptr>(m_cluster_buffer->byte_length()), format::RED_INTEGER, format::UNSIGNED_INT, &cleared);
+
+    // persistent material buffer
+    buffer_configuration material_buffer_config(max_materials * sizeof(scene_material_data), buffer_target::SHADER_STORAGE_BUFFER, buffer_access::MAPPED_ACCESS_WRITE);
+    m_material_buffer = buffer::create(material_buffer_config);
+    if (!m_material_buffer)
+    {
+        MANGO_LOG_ERROR("Creation of material buffer failed! Render system not available!");
+        return false;
+    }
+
+    m_mapped_material_memory = m_material_buffer->map(0, m_material_buffer->byte_length(), buffer_access::MAPPED_ACCESS_WRITE);
+    if (!m_mapped_material_memory)
+    {
+        MANGO_LOG_ERROR("Mapping of materials failed! Render system not available!");
+        return false;
+    }
+    m_free_material_indices.reserve(max_materials);
+    for (uint32 i = max_materials; i > 0; --i)
+        m_free_material_indices.push_back(i - 1);
+
+    // without bindless textures the material textures are bound for each draw call.
+    m_bindless_textures = extension_supported("GL_ARB_bindless_texture");
+    MANGO_LOG_DEBUG("Bindless textures {0}.", m_bindless_textures ? "enabled" : "not supported");
+
+    // startup time of the programs depends on the program binary cache being cold or warm.
+    timer program_timer;
+    program_timer.start();
+
     // scene geometry pass
-    shader_configuration shader_config;
-    shader_config.m_path = "res/shader/v_scene_gltf.glsl";
-    shader_config.m_type = shader_type::VERTEX_SHADER;
-    shader_ptr d_vertex  = shader::create(shader_config);
-    if (!d_vertex)
+    m_scene_geometry_pass = get_scene_geometry_pass(0);
+    if (!m_scene_geometry_pass)
     {
-        MANGO_LOG_ERROR("Creation of geometry pass vertex shader failed! Render system not available!");
+        MANGO_LOG_ERROR("Creation of geometry pass failed! Render system not available!");
         return false;
     }
 
-    shader_config.m_path  = "res/shader/f_scene_gltf.glsl";
-    shader_config.m_type  = shader_type::FRAGMENT_SHADER;
-    shader_ptr d_fragment = shader::create(shader_config);
-    if (!d_fragment)
+    // depth pre-pass, the vertex shader is shared with the geometry pass, so both produce the same depth.
+    shader_configuration depth_shader_config;
+    depth_shader_config.m_path = "res/shader/v_scene_gltf.glsl";
+    depth_shader_config.m_type = shader_type::VERTEX_SHADER;
+    if (m_draw_parameters)
+        depth_shader_config.m_defines.push_back({ "DRAW_PARAMETERS", "" });
+    shader_ptr depth_vertex = shader::create(depth_shader_config);
+    depth_shader_config.m_defines.clear();
+
+    depth_shader_config.m_path = "res/shader/f_depth_only.glsl";
+    depth_shader_config.m_type = shader_type::FRAGMENT_SHADER;
+    shader_ptr depth_fragment  = shader::create(depth_shader_config);
+    if (!depth_vertex || !depth_fragment)
     {
-        MANGO_LOG_ERROR("Creation of geometry pass fragment shader failed! Render system not available!");
+        MANGO_LOG_ERROR("Creation of depth pre-pass shaders failed! Render system not available!");
+        return false;
+    }
+
+    m_depth_pre_pass_program = shader_program::create_graphics_pipeline(depth_vertex, nullptr, nullptr, nullptr, depth_fragment);
+    if (!m_depth_pre_pass_program)
+    {
+        MANGO_LOG_ERROR("Creation of depth pre-pass failed! Render system not available!");
         return false;
     }
 
-    m_scene_geometry_pass = shader_program::create_graphics_pipeline(d_vertex, nullptr, nullptr, nullptr, d_fragment);
     // shader light pass
+    if (!create_lighting_pass())
+    {
+        MANGO_LOG_ERROR("Creation of lighting pass failed! Render system not available!");
+        return false;
+    }
 
-    shader_config.m_path = "res/shader/v_empty.glsl";
-    shader_config.m_type = shader_type::VERTEX_SHADER;
-    d_vertex             = shader::create(shader_config);
-    if (!d_vertex)
+    // light culling
+    shader_configuration shader_config;
+    shader_config.m_path           = "res/shader/c_mark_active_clusters.glsl";
+    shader_config.m_type           = shader_type::COMPUTE_SHADER;
+    shader_config.m_defines        = get_light_cluster_defines();
+    shader_ptr mark_active_compute = shader::create(shader_config);
+    if (!mark_active_compute)
     {
-        MANGO_LOG_ERROR("Creation of lighting vertex shader failed! Render system not available!");
+        MANGO_LOG_ERROR("Creation of active cluster compute shader failed! Render system not available!");
         return false;
     }
 
-    shader_config.m_path  = "res/shader/g_create_screen_space_quad.glsl";
-    shader_config.m_type  = shader_type::GEOMETRY_SHADER;
-    shader_ptr d_geometry = shader::create(shader_config);
-    if (!d_geometry)
+    m_mark_active_clusters = shader_program::create_compute_pipeline(mark_active_compute);
+    if (!m_mark_active_clusters)
     {
-        MANGO_LOG_ERROR("Creation of lighting geometry shader failed! Render system not available!");
+        MANGO_LOG_ERROR("Creation of active cluster compute shader program failed! Render system not available!");
         return false;
     }
 
-    shader_config.m_path = "res/shader/f_deferred_lighting.glsl";
-    shader_config.m_type = shader_type::FRAGMENT_SHADER;
-    d_fragment           = shader::create(shader_config);
-    if (!d_fragment)
+    shader_config.m_path             = "res/shader/c_assign_lights.glsl";
+    shader_config.m_type             = shader_type::COMPUTE_SHADER;
+    shader_ptr assign_lights_compute = shader::create(shader_config);
+    if (!assign_lights_compute)
     {
-        MANGO_LOG_ERROR("Creation of lighting fragment shader failed! Render system not available!");
+        MANGO_LOG_ERROR("Creation of light assignment compute shader failed! Render system not available!");
         return false;
     }
 
-    m_lighting_pass = shader_program::create_graphics_pipeline(d_vertex, nullptr, nullptr, d_geometry, d_fragment);
-    if (!m_lighting_pass)
+    m_assign_lights = shader_program::create_compute_pipeline(assign_lights_compute);
+    if (!m_assign_lights)
     {
-        MANGO_LOG_ERROR("Creation of lighting pass failed! Render system not available!");
+        MANGO_LOG_ERROR("Creation of light assignment compute shader program failed! Render system not available!");
         return false;
     }
+    MANGO_LOG_INFO("Shader programs created in {0} ms.", program_timer.elapsedMilliseconds().count());
+
+    // modified shader sources are reloaded between frames.
+    shared_ptr<resource_system> res = m_shared_context->get_resource_system_internal().lock();
+    if (res)
+    {
+        res->watch_shader_program(m_depth_pre_pass_program);
+        res->watch_shader_program(m_mark_active_clusters);
+        res->watch_shader_program(m_assign_lights);
+    }
 
     // default vao needed
     default_vao = vertex_array::create();
@@ -182,7 +325,11 @@ bool deferred_pbr_render_system::create()
         return false;
     }
     // default texture needed (config is not relevant)
-    default_texture = texture::create(attachment_config);
+    texture_configuration default_texture_config;
+    default_texture_config.m_is_standard_color_space = false;
+    default_texture_config.m_texture_min_filter      = texture_parameter::FILTER_NEAREST;
+    default_texture_config.m_texture_mag_filter      = texture_parameter::FILTER_NEAREST;
+    default_texture = texture::create(default_texture_config);
     if (!default_texture)
     {
         MANGO_LOG_ERROR("Creation of default texture failed! Render system not available!");
@@ -196,12 +343,354 @@ bool deferred_pbr_render_system::create()
     return true;
 }
 
+bool deferred_pbr_render_system::create_gbuffer(uint32 width, uint32 height)
+{
+    bool compact = m_gbuffer_layout != gbuffer_layout::standard;
+
+    framebuffer_configuration config;
+    texture_configuration attachment_config;
+    attachment_config.m_generate_mipmaps        = 1; // the targets are only sampled at level 0, so only one level is allocated.
+    attachment_config.m_is_standard_color_space = false;
+    attachment_config.m_texture_min_filter      = texture_parameter::FILTER_NEAREST;
+    attachment_config.m_texture_mag_filter      = texture_parameter::FILTER_NEAREST;
+    attachment_config.m_texture_wrap_s          = texture_parameter::WRAP_CLAMP_TO_EDGE;
+    attachment_config.m_texture_wrap_t          = texture_parameter::WRAP_CLAMP_TO_EDGE;
+
+    // the compact layout stores the occlusion in the alpha of the base color, the roughness next to the octahedral normal and the metallic value next to the emissive color.
+    config.m_color_attachment0 = texture::create(attachment_config);
+    config.m_color_attachment0->set_data(format::RGBA8, width, height, format::RGBA, format::UNSIGNED_INT_8_8_8_8, nullptr);
+    config.m_color_attachment1 = texture::create(attachment_config);
+    config.m_color_attachment1->set_data(format::RGB10_A2, width, height, format::RGBA, format::UNSIGNED_INT_10_10_10_2, nullptr);
+    config.m_color_attachment2 = texture::create(attachment_config);
+    config.m_color_attachment2->set_data(format::RGBA8, width, height, format::RGBA, format::UNSIGNED_INT_8_8_8_8, nullptr);
+    if (!compact)
+    {
+        config.m_color_attachment3 = texture::create(attachment_config);
+        config.m_color_attachment3->set_data(format::RGBA8, width, height, format::RGBA, format::UNSIGNED_INT_8_8_8_8, nullptr);
+    }
+
+    if (m_gbuffer_layout == gbuffer_layout::compact_depth_stencil)
+    {
+        config.m_depth_stencil_attachment = texture::create(attachment_config);
+        config.m_depth_stencil_attachment->set_data(format::DEPTH24_STENCIL8, width, height, format::DEPTH_STENCIL, format::UNSIGNED_INT_24_8, nullptr);
+    }
+    else
+    {
+        config.m_depth_attachment = texture::create(attachment_config);
+        // glTextureParameteri(config.m_depth_attachment->get_name(), GL_TEXTURE_COMPARE_MODE, GL_NONE);
+        // glTextureParameteri(config.m_depth_attachment->get_name(), GL_DEPTH_TEXTURE_MODE, GL_LUMINANCE);
+        config.m_depth_attachment->set_data(format::DEPTH_COMPONENT32F, width, height, format::DEPTH_COMPONENT, format::FLOAT, nullptr);
+    }
+
+    config.m_width  = width;
+    config.m_height = height;
+
+    m_gbuffer = framebuffer::create(config);
+    if (!m_gbuffer)
+        return false;
+    m_clear_whole_gbuffer = true;
+
+    gbuffer_statistics statistics = get_gbuffer_statistics();
+    MANGO_LOG_DEBUG("Gbuffer uses {0} bytes per pixel, {1} KiB in total.", statistics.bytes_per_pixel, statistics.memory / 1024);
+    return true;
+}
+
+bool deferred_pbr_render_system::create_lighting_pass()
+{
+    shader_configuration shader_config;
+
+    shader_config.m_path = "res/shader/v_empty.glsl";
+    shader_config.m_type = shader_type::VERTEX_SHADER;
+    shader_ptr d_vertex  = shader::create(shader_config);
+    if (!d_vertex)
+    {
+        MANGO_LOG_ERROR("Creation of lighting vertex shader failed!");
+        return false;
+    }
+
+    shader_config.m_path  = "res/shader/g_create_screen_space_quad.glsl";
+    shader_config.m_type  = shader_type::GEOMETRY_SHADER;
+    shader_ptr d_geometry = shader::create(shader_config);
+    if (!d_geometry)
+    {
+        MANGO_LOG_ERROR("Creation of lighting geometry shader failed!");
+        return false;
+    }
+
+    shader_config.m_path    = "res/shader/f_deferred_lighting.glsl";
+    shader_config.m_type    = shader_type::FRAGMENT_SHADER;
+    shader_config.m_defines = get_light_cluster_defines();
+    if (m_gbuffer_layout != gbuffer_layout::standard)
+        shader_config.m_defines.push_back({ "COMPACT_GBUFFER", "" });
+    shader_ptr d_fragment = shader::create(shader_config);
+    if (!d_fragment)
+    {
+        MANGO_LOG_ERROR("Creation of lighting fragment shader failed!");
+        return false;
+    }
+
+    m_lighting_pass = shader_program::create_graphics_pipeline(d_vertex, nullptr, nullptr, d_geometry, d_fragment);
+    if (!m_lighting_pass)
+        return false;
+
+    // modified shader sources are reloaded between frames.
+    shared_ptr<resource_system> res = m_shared_context->get_resource_system_internal().lock();
+    if (res)
+        res->watch_shader_program(m_lighting_pass);
+
+    return true;
+}
+
+bool deferred_pbr_render_system::create_lighting_target(uint32 width, uint32 height)
+{
+    framebuffer_configuration config;
+    texture_configuration attachment_config;
+    attachment_config.m_generate_mipmaps        = 1;
+    attachment_config.m_is_standard_color_space = false;
+    attachment_config.m_texture_min_filter      = texture_parameter::FILTER_LINEAR; // sampled bilinear by the upscale pass.
+    attachment_config.m_texture_mag_filter      = texture_parameter::FILTER_LINEAR;
+    attachment_config.m_texture_wrap_s          = texture_parameter::WRAP_CLAMP_TO_EDGE;
+    attachment_config.m_texture_wrap_t          = texture_parameter::WRAP_CLAMP_TO_EDGE;
+
+    // the lighting output is already tone mapped, so eight bits are enough.
+    config.m_color_attachment0 = texture::create(attachment_config);
+    config.m_color_attachment0->set_data(format::RGBA8, width, height, format::RGBA, format::UNSIGNED_INT_8_8_8_8, nullptr);
+
+    // the skybox is tested against the depth written by the lighting pass.
+    attachment_config.m_texture_min_filter = texture_parameter::FILTER_NEAREST;
+    attachment_config.m_texture_mag_filter = texture_parameter::FILTER_NEAREST;
+    config.m_depth_attachment              = texture::create(attachment_config);
+    config.m_depth_attachment->set_data(format::DEPTH_COMPONENT32F, width, height, format::DEPTH_COMPONENT, format::FLOAT, nullptr);
+
+    config.m_width  = width;
+    config.m_height = height;
+
+    m_lighting_target = framebuffer::create(config);
+    return m_lighting_target != nullptr;
+}
+
+bool deferred_pbr_render_system::create_upscale_pass()
+{
+    shader_configuration shader_config;
+
+    shader_config.m_path = "res/shader/v_empty.glsl";
+    shader_config.m_type = shader_type::VERTEX_SHADER;
+    shader_ptr u_vertex  = shader::create(shader_config);
+
+    shader_config.m_path  = "res/shader/g_create_screen_space_quad.glsl";
+    shader_config.m_type  = shader_type::GEOMETRY_SHADER;
+    shader_ptr u_geometry = shader::create(shader_config);
+
+    shader_config.m_path  = "res/shader/f_upscale_sharpen.glsl";
+    shader_config.m_type  = shader_type::FRAGMENT_SHADER;
+    shader_ptr u_fragment = shader::create(shader_config);
+    if (!u_vertex || !u_geometry || !u_fragment)
+    {
+        MANGO_LOG_ERROR("Creation of upscale shaders failed!");
+        return false;
+    }
+
+    m_upscale_pass = shader_program::create_graphics_pipeline(u_vertex, nullptr, nullptr, u_geometry, u_fragment);
+    if (!m_upscale_pass)
+        return false;
+
+    shared_ptr<resource_system> res = m_shared_context->get_resource_system_internal().lock();
+    if (res)
+        res->watch_shader_program(m_upscale_pass);
+
+    return true;
+}
+
+void deferred_pbr_render_system::update_render_scale()
+{
+    if (!m_lighting_target)
+    {
+        m_render_scale = 1.0f;
+        return;
+    }
+
+    const std::deque<frame_timings>& history = m_frame_profiler->get_frame_timings();
+    if (history.empty() || history.back().frame == m_last_scaled_frame)
+        return;
+    m_last_scaled_frame = history.back().frame;
+
+    // the frame pass encloses all other passes.
+    float gpu_time = 0.0f;
+    for (auto& pass : history.back().passes)
+    {
+        if (pass.name == "frame")
+            gpu_time = pass.gpu_time;
+    }
+    if (gpu_time <= 0.0f)
+        return;
+
+    // most of the frame time scales with the number of pixels, so each axis is scaled with the square root of the time ratio.
+    float ideal_scale = glm::clamp(m_render_scale * std::sqrt(m_target_frame_time / gpu_time), min_render_scale, 1.0f);
+    if (std::abs(ideal_scale - m_render_scale) < render_scale_tolerance)
+        return;
+
+    m_render_scale += (ideal_scale - m_render_scale) * render_scale_damping;
+}
+
+glm::vec2 deferred_pbr_render_system::get_render_uv_scale() const
+{
+    return glm::vec2(static_cast<float>(m_render_width) / static_cast<float>(m_gbuffer->get_width()), static_cast<float>(m_render_height) / static_cast<float>(m_gbuffer->get_height()));
+}
+
+std::vector<shader_define> deferred_pbr_render_system::get_light_cluster_defines() const
+{
+    // the cluster grid is compiled into all programs using the light clusters.
+    return { { "CLUSTER_GRID_X", std::to_string(cluster_grid_x) },
+             { "CLUSTER_GRID_Y", std::to_string(cluster_grid_y) },
+             { "CLUSTER_GRID_Z", std::to_string(cluster_grid_z) },
+             { "MAX_LIGHTS_PER_CLUSTER", std::to_string(max_lights_per_cluster) } };
+}
+
+texture_ptr deferred_pbr_render_system::get_gbuffer_depth()
+{
+    if (m_gbuffer_layout == gbuffer_layout::compact_depth_stencil)
+        return m_gbuffer->get_attachment(framebuffer_attachment::DEPTH_STENCIL_ATTACHMENT);
+    return m_gbuffer->get_attachment(framebuffer_attachment::DEPTH_ATTACHMENT);
+}
+
+void deferred_pbr_render_system::set_gbuffer_layout(gbuffer_layout layout)
+{
+    if (layout == m_gbuffer_layout)
+        return;
+
+    m_gbuffer_layout = layout;
+    if (!create_gbuffer(m_gbuffer->get_width(), m_gbuffer->get_height()))
+    {
+        MANGO_LOG_ERROR("Creation of gbuffer failed!");
+        return;
+    }
+
+    // all programs writing or reading the gbuffer are specialized for the layout.
+    m_scene_geometry_passes.clear();
+    m_scene_geometry_pass = get_scene_geometry_pass(0);
+    if (!create_lighting_pass())
+        MANGO_LOG_ERROR("Creation of lighting pass failed!");
+    m_shader_programs_ready = false;
+}
+
+void deferred_pbr_render_system::set_depth_pre_pass(bool enabled)
+{
+    m_depth_pre_pass = enabled;
+}
+
+void deferred_pbr_render_system::set_front_to_back_sorting(bool enabled)
+{
+    m_front_to_back_sorting = enabled;
+}
+
+void deferred_pbr_render_system::set_overdraw_measurement(bool enabled)
+{
+    if (enabled == (m_overdraw_counter != nullptr))
+        return;
+
+    if (enabled)
+        m_overdraw_counter = std::make_shared<overdraw_counter>();
+    else
+        m_overdraw_counter = nullptr;
+
+    // the counting is compiled into the permutations of the geometry pass.
+    m_scene_geometry_passes.clear();
+    m_scene_geometry_pass   = get_scene_geometry_pass(0);
+    m_shader_programs_ready = false;
+}
+
+void deferred_pbr_render_system::set_occlusion_culling(bool enabled)
+{
+    if (enabled == (m_hi_z_culling != nullptr))
+        return;
+
+    m_hi_z_culling = nullptr;
+    if (!enabled)
+        return;
+
+    auto culling = std::make_shared<hi_z_culling>();
+    if (!culling->create())
+    {
+        MANGO_LOG_ERROR("Creation of occlusion culling failed! Occluded models are drawn.");
+        return;
+    }
+    m_hi_z_culling          = culling;
+    m_shader_programs_ready = false;
+
+    shared_ptr<resource_system> res = m_shared_context->get_resource_system_internal().lock();
+    if (res)
+    {
+        for (auto& program : m_hi_z_culling->get_shader_programs())
+            res->watch_shader_program(program);
+    }
+}
+
+void deferred_pbr_render_system::set_meshlet_culling(bool enabled)
+{
+    if (enabled == (m_meshlet_culling != nullptr))
+        return;
+
+    m_meshlet_culling = nullptr;
+    if (!enabled)
+        return;
+
+    shader_configuration shader_config;
+    shader_config.m_path       = "res/shader/c_meshlet_culling.glsl";
+    shader_config.m_type       = shader_type::COMPUTE_SHADER;
+    shader_ptr cull_compute    = shader::create(shader_config);
+    shader_program_ptr program = cull_compute ? shader_program::create_compute_pipeline(cull_compute) : nullptr;
+    if (!program)
+    {
+        MANGO_LOG_ERROR("Creation of meshlet culling compute shader failed! Meshlets are not culled.");
+        return;
+    }
+    m_meshlet_culling       = program;
+    m_shader_programs_ready = false;
+
+    shared_ptr<resource_system> res = m_shared_context->get_resource_system_internal().lock();
+    if (res)
+        res->watch_shader_program(m_meshlet_culling);
+}
+
+void deferred_pbr_render_system::set_target_frame_time(float milliseconds)
+{
+    m_target_frame_time = glm::max(milliseconds, 0.0f);
+    m_render_scale      = 1.0f;
+    if (m_target_frame_time <= 0.0f)
+    {
+        m_lighting_target = nullptr;
+        m_upscale_pass    = nullptr;
+        return;
+    }
+    if (m_lighting_target)
+        return;
+
+    // the gbuffer keeps the size of the viewport, frames rendered with a lower resolution only use a part of it.
+    if (!create_lighting_target(m_gbuffer->get_width(), m_gbuffer->get_height()) || !create_upscale_pass())
+    {
+        MANGO_LOG_ERROR("Creation of dynamic resolution targets failed! The resolution is not scaled.");
+        m_target_frame_time = 0.0f;
+        m_lighting_target   = nullptr;
+        m_upscale_pass      = nullptr;
+        return;
+    }
+    m_shader_programs_ready = false;
+}
+
 void deferred_pbr_render_system::configure(const render_configuration& configuration)
 {
     auto ws = m_shared_context->get_window_system_internal().lock();
     MANGO_ASSERT(ws, "Window System is expired!");
     ws->set_vsync(configuration.is_vsync_enabled());
 
+    set_gbuffer_layout(configuration.get_gbuffer_layout());
+    set_depth_pre_pass(configuration.is_depth_pre_pass_enabled());
+    set_front_to_back_sorting(configuration.is_front_to_back_sorting_enabled());
+    set_overdraw_measurement(configuration.is_overdraw_measurement_enabled());
+    set_occlusion_culling(configuration.is_occlusion_culling_enabled());
+    set_meshlet_culling(configuration.is_meshlet_culling_enabled());
+    set_target_frame_time(configuration.get_target_frame_time());
+
     // additional render steps
     if (configuration.get_render_steps()[mango::render_step::ibl])
     {
@@ -210,55 +699,173 @@ void deferred_pbr_render_system::configure(const render_configuration& configura
         auto step_ibl = std::make_shared<ibl_step>();
         step_ibl->create();
         m_pipeline_steps[mango::render_step::ibl] = std::static_pointer_cast<pipeline_step>(step_ibl);
+
+        shared_ptr<resource_system> res = m_shared_context->get_resource_system_internal().lock();
+        if (res)
+        {
+            for (auto& program : step_ibl->get_shader_programs())
+                res->watch_shader_program(program);
+        }
+    }
+
+    if (configuration.get_texture_memory_budget() > 0)
+    {
+        ptr_size budget = static_cast<ptr_size>(configuration.get_texture_memory_budget()) * 1024 * 1024;
+        if (!m_texture_streaming)
+            m_texture_streaming = std::make_shared<texture_streaming>(budget);
+        else
+            m_texture_streaming->set_memory_budget(budget);
     }
 }
 
 void deferred_pbr_render_system::begin_render()
 {
+    m_frame_profiler->begin_frame();
+
+    if (m_viewport_changed)
+        resize_render_targets();
+
+    // programs compile in parallel, until all of them are ready only a loading frame is shown instead of blocking.
+    m_loading_frame = !shader_programs_ready();
+    if (m_loading_frame)
+        return;
+
+    if (m_overdraw_counter)
+        m_overdraw_counter->begin_frame();
+    if (m_hi_z_culling)
+        m_hi_z_culling->begin_frame();
+
+    // the footprints requested in the last frame are made resident before any texture is used.
+    if (m_texture_streaming)
+    {
+        MANGO_PROFILE_ZONE("texture streaming update");
+        m_texture_streaming->update();
+    }
+
+    // the resolution of the frame follows the gpu time of an earlier one.
+    update_render_scale();
+    uint32 render_width  = std::max(static_cast<uint32>(static_cast<float>(m_viewport_width) * m_render_scale + 0.5f), 1u);
+    uint32 render_height = std::max(static_cast<uint32>(static_cast<float>(m_viewport_height) * m_render_scale + 0.5f), 1u);
+    if (render_width != m_render_width || render_height != m_render_height)
+        m_clear_whole_gbuffer = true;
+    m_render_width  = render_width;
+    m_render_height = render_height;
+
+    m_frame_profiler->begin_pass("frame", m_command_buffer);
+    m_frame_profiler->begin_pass("geometry", m_command_buffer);
+
     m_command_buffer->set_depth_test(true);
     m_command_buffer->set_depth_func(compare_operation::LESS);
     m_command_buffer->set_face_culling(true);
     m_command_buffer->set_cull_face(polygon_face::FACE_BACK);
     m_command_buffer->bind_framebuffer(m_gbuffer);
-    m_command_buffer->clear_framebuffer(clear_buffer_mask::COLOR_AND_DEPTH, attachment_mask::ALL_DRAW_BUFFERS_AND_DEPTH, 0.0f, 0.0f, 0.0f, 0.0f, m_gbuffer);
-    m_command_buffer->bind_shader_program(m_scene_geometry_pass);
+    // the gbuffer is usually larger than the render area, the scissor limits the clears to it.
+    m_command_buffer->set_scissor(0, 0, m_render_width, m_render_height);
+    m_command_buffer->set_scissor_test(!m_clear_whole_gbuffer);
+    if (m_gbuffer_layout == gbuffer_layout::compact_depth_stencil)
+        m_command_buffer->clear_framebuffer(clear_buffer_mask::COLOR_AND_DEPTH_STENCIL, attachment_mask::ALL, 0.0f, 0.0f, 0.0f, 0.0f, m_gbuffer);
+    else
+        m_command_buffer->clear_framebuffer(clear_buffer_mask::COLOR_AND_DEPTH, attachment_mask::ALL_DRAW_BUFFERS_AND_DEPTH, 0.0f, 0.0f, 0.0f, 0.0f, m_gbuffer);
+    m_command_buffer->set_scissor_test(true);
+    m_command_buffer->set_viewport(0, 0, m_render_width, m_render_height);
+    m_clear_whole_gbuffer = false;
 
     auto scene  = m_shared_context->get_current_scene();
     auto camera = scene->get_active_camera_data();
     if (camera.camera_info)
     {
         set_view_projection_matrix(camera.camera_info->view_projection);
+        m_view_matrix            = camera.camera_info->view;
+        m_projection_matrix      = camera.camera_info->projection;
+        m_camera_planes          = glm::vec2(camera.camera_info->z_near, camera.camera_info->z_far);
+        m_projection_scale       = camera.camera_info->projection[1][1];
+        m_perspective_projection = camera.camera_info->type == camera_type::perspective_camera;
     }
+    if (camera.transform)
+        m_camera_position = glm::vec3(camera.transform->world_transformation_matrix[3]);
 
     m_command_buffer->wait_for_buffer(m_frame_uniform_buffer);
+    set_camera_uniforms();
+    update_object_buffer();
+    update_light_buffer();
+    update_material_buffer();
     // m_command_buffer->set_polygon_mode(polygon_face::FACE_FRONT_AND_BACK, polygon_mode::LINE);
 }
 
 void deferred_pbr_render_system::finish_render()
 {
+    if (m_loading_frame)
+    {
+        m_command_buffer->bind_framebuffer(nullptr); // bind default.
+        m_command_buffer->clear_framebuffer(clear_buffer_mask::COLOR_AND_DEPTH_STENCIL, attachment_mask::ALL, 0.0f, 0.0f, 0.2f, 1.0f);
+        update_state_change_statistics();
+        m_command_buffer->execute();
+        m_frame_uniform_offset = 0;
+        return;
+    }
+
+    render_geometry();
+
     m_command_buffer->bind_vertex_array(nullptr);
     m_command_buffer->bind_shader_program(nullptr);
+    m_frame_profiler->end_pass(m_command_buffer);
+
+    // only the lower left part of the gbuffer is rendered to, if the resolution is scaled.
+    glm::vec2 uv_scale = get_render_uv_scale();
+
+    // the depth of this frame culls the models of a later frame.
+    if (m_hi_z_culling)
+    {
+        // the pyramid is built from the whole gbuffer, so the projection is mapped to the rendered part of it.
+        glm::mat4 render_area(1.0f);
+        render_area[0][0] = uv_scale.x;
+        render_area[1][1] = uv_scale.y;
+        render_area[3][0] = uv_scale.x - 1.0f;
+        render_area[3][1] = uv_scale.y - 1.0f;
+
+        m_frame_profiler->begin_pass("hi-z pyramid", m_command_buffer);
+        m_hi_z_culling->build_pyramid(m_command_buffer, get_gbuffer_depth(), render_area * m_view_projection);
+        m_frame_profiler->end_pass(m_command_buffer);
+
+        m_occlusion_culling_statistics.enabled        = true;
+        m_occlusion_culling_statistics.tested_objects = m_hi_z_culling->get_tested_models();
+        m_occlusion_culling_statistics.culled_objects = m_hi_z_culling->get_culled_models();
+    }
+    else
+        std::memset(&m_occlusion_culling_statistics, 0, sizeof(m_occlusion_culling_statistics));
+
+    m_frame_profiler->begin_pass("light culling", m_command_buffer);
+    assign_lights_to_clusters();
+    m_frame_profiler->end_pass(m_command_buffer);
 
-    m_command_buffer->bind_framebuffer(nullptr); // bind default.
-    m_command_buffer->clear_framebuffer(clear_buffer_mask::COLOR_AND_DEPTH_STENCIL, attachment_mask::ALL, 0.0f, 0.0f, 0.2f, 1.0f);
+    m_frame_profiler->begin_pass("lighting", m_command_buffer);
+    if (m_lighting_target)
+    {
+        // lit with the resolution of the gbuffer and upscaled afterwards.
+        m_command_buffer->bind_framebuffer(m_lighting_target);
+        m_command_buffer->clear_framebuffer(clear_buffer_mask::COLOR_AND_DEPTH, attachment_mask::ALL_DRAW_BUFFERS_AND_DEPTH, 0.0f, 0.0f, 0.2f, 1.0f, m_lighting_target);
+    }
+    else
+    {
+        m_command_buffer->set_scissor_test(false);
+        m_command_buffer->bind_framebuffer(nullptr); // bind default.
+        m_command_buffer->clear_framebuffer(clear_buffer_mask::COLOR_AND_DEPTH_STENCIL, attachment_mask::ALL, 0.0f, 0.0f, 0.2f, 1.0f);
+        m_command_buffer->set_viewport(m_viewport_x, m_viewport_y, m_viewport_width, m_viewport_height);
+    }
     m_command_buffer->set_polygon_mode(polygon_face::FACE_FRONT_AND_BACK, polygon_mode::FILL);
     m_command_buffer->bind_shader_program(m_lighting_pass);
 
+    // the camera uniforms are still bound from the geometry pass.
     auto scene  = m_shared_context->get_current_scene();
     auto camera = scene->get_active_camera_data();
-    lighting_pass_uniforms lp_uniforms;
-    if (camera.camera_info && camera.transform)
-    {
-        lp_uniforms.inverse_view_projection = glm::inverse(camera.camera_info->view_projection);
-        lp_uniforms.camera_position         = camera.transform->world_transformation_matrix[3];
-    }
-    m_command_buffer->bind_single_uniform(0, &lp_uniforms.inverse_view_projection, sizeof(lp_uniforms.inverse_view_projection));
-    m_command_buffer->bind_single_uniform(1, &lp_uniforms.camera_position, sizeof(lp_uniforms.camera_position));
     m_command_buffer->bind_texture(0, m_gbuffer->get_attachment(framebuffer_attachment::COLOR_ATTACHMENT0), 2);
     m_command_buffer->bind_texture(1, m_gbuffer->get_attachment(framebuffer_attachment::COLOR_ATTACHMENT1), 3);
     m_command_buffer->bind_texture(2, m_gbuffer->get_attachment(framebuffer_attachment::COLOR_ATTACHMENT2), 4);
-    m_command_buffer->bind_texture(3, m_gbuffer->get_attachment(framebuffer_attachment::COLOR_ATTACHMENT3), 5);
-    m_command_buffer->bind_texture(4, m_gbuffer->get_attachment(framebuffer_attachment::DEPTH_ATTACHMENT), 6);
+    // the compact layout has no fourth target.
+    texture_ptr gbuffer_c3 = m_gbuffer->get_attachment(framebuffer_attachment::COLOR_ATTACHMENT3);
+    m_command_buffer->bind_texture(3, gbuffer_c3 ? gbuffer_c3 : default_texture, 5);
+    m_command_buffer->bind_texture(4, get_gbuffer_depth(), 6);
+    m_command_buffer->bind_single_uniform(10, &uv_scale, sizeof(glm::vec2));
     if (m_pipeline_steps[mango::render_step::ibl])
         std::static_pointer_cast<ibl_step>(m_pipeline_steps[mango::render_step::ibl])->bind_image_based_light_maps(m_command_buffer);
 
@@ -266,6 +873,7 @@ void deferred_pbr_render_system::finish_render()
     m_command_buffer->bind_vertex_array(default_vao);
 
     m_command_buffer->draw_arrays(primitive_topology::POINTS, 0, 1);
+    m_frame_profiler->end_pass(m_command_buffer);
 
     // We try to reset the default state as possible, without crashing all optimizations.
 
@@ -281,177 +889,706 @@ void deferred_pbr_render_system::finish_render()
 
         m_command_buffer->set_depth_func(compare_operation::LESS_EQUAL);
         m_command_buffer->set_cull_face(polygon_face::FACE_FRONT);
+        m_frame_profiler->begin_pass("ibl skybox", m_command_buffer);
         m_pipeline_steps[mango::render_step::ibl]->execute(m_command_buffer);
+        m_frame_profiler->end_pass(m_command_buffer);
     }
 
+    if (m_lighting_target)
+    {
+        m_frame_profiler->begin_pass("upscale", m_command_buffer);
+        m_command_buffer->set_scissor_test(false);
+        m_command_buffer->bind_framebuffer(nullptr); // bind default.
+        m_command_buffer->clear_framebuffer(clear_buffer_mask::COLOR_AND_DEPTH_STENCIL, attachment_mask::ALL, 0.0f, 0.0f, 0.2f, 1.0f);
+        m_command_buffer->set_viewport(m_viewport_x, m_viewport_y, m_viewport_width, m_viewport_height);
+        m_command_buffer->set_depth_func(compare_operation::LESS);
+        m_command_buffer->set_cull_face(polygon_face::FACE_BACK);
+        m_command_buffer->bind_shader_program(m_upscale_pass);
+
+        // lower resolutions lose more detail, so they are sharpened more.
+        float sharpness = max_sharpness * (1.0f - m_render_scale) / (1.0f - min_render_scale);
+        m_command_buffer->bind_texture(0, m_lighting_target->get_attachment(framebuffer_attachment::COLOR_ATTACHMENT0), 0);
+        m_command_buffer->bind_single_uniform(1, &uv_scale, sizeof(glm::vec2));
+        m_command_buffer->bind_single_uniform(2, &sharpness, sizeof(float));
+        m_command_buffer->bind_vertex_array(default_vao);
+        m_command_buffer->draw_arrays(primitive_topology::POINTS, 0, 1);
+
+        m_command_buffer->bind_vertex_array(nullptr);
+        m_command_buffer->bind_shader_program(nullptr);
+        m_frame_profiler->end_pass(m_command_buffer);
+    }
+
+    m_frame_profiler->end_pass(m_command_buffer);
     m_command_buffer->lock_buffer(m_frame_uniform_buffer);
 
+    update_state_change_statistics();
     m_command_buffer->execute();
+    if (m_overdraw_counter)
+        m_overdraw_counter->end_frame();
+    if (m_hi_z_culling)
+        m_hi_z_culling->end_frame();
 
     m_frame_uniform_offset = 0;
 }
 
-void deferred_pbr_render_system::set_viewport(uint32 x, uint32 y, uint32 width, uint32 height)
+void deferred_pbr_render_system::render_geometry()
 {
-    m_command_buffer->set_viewport(x, y, width, height);
-    m_gbuffer->resize(width, height);
+    cull_meshlets();
+
+    // near geometry first, so hidden fragments fail the early depth test.
+    if (m_front_to_back_sorting)
+        std::stable_sort(m_draw_calls.begin(), m_draw_calls.end(), [](const draw_call& a, const draw_call& b) { return a.view_depth < b.view_depth; });
+
+    m_bound_geometry_pass = nullptr;
+    if (m_depth_pre_pass)
+    {
+        m_frame_profiler->begin_pass("depth pre-pass", m_command_buffer);
+        m_command_buffer->set_color_mask(false);
+        m_command_buffer->bind_shader_program(m_depth_pre_pass_program);
+        for (auto& call : m_draw_calls)
+        {
+            // alpha masked materials discard in the fragment shader, so their depth is only written in the geometry pass.
+            if (!call.alpha_mask)
+                record_draw_call(call, true);
+        }
+        m_command_buffer->set_color_mask(true);
+        m_frame_profiler->end_pass(m_command_buffer);
+
+        // the depth is resolved, so the order does not matter anymore and grouping by program saves state changes.
+        // alpha masked draws come last, they still have to write their depth.
+        std::stable_sort(m_draw_calls.begin(), m_draw_calls.end(), [](const draw_call& a, const draw_call& b) {
+            if (a.alpha_mask != b.alpha_mask)
+                return b.alpha_mask;
+            return std::less<shader_program*>()(a.geometry_pass.get(), b.geometry_pass.get());
+        });
+    }
+
+    if (m_overdraw_counter)
+        m_overdraw_counter->bind(m_command_buffer, 8);
+
+    for (auto& call : m_draw_calls)
+    {
+        // opaque fragments pass only with exactly the depth of the pre-pass.
+        bool depth_resolved = m_depth_pre_pass && !call.alpha_mask;
+        m_command_buffer->set_depth_func(depth_resolved ? compare_operation::LESS_EQUAL : compare_operation::LESS);
+        m_command_buffer->set_depth_write(!depth_resolved);
+        record_draw_call(call, false);
+    }
+    m_command_buffer->set_depth_func(compare_operation::LESS);
+    m_command_buffer->set_depth_write(true);
+
+    m_draw_calls.clear();
 }
 
-void deferred_pbr_render_system::update(float dt)
+void deferred_pbr_render_system::cull_meshlets()
 {
-    MANGO_UNUSED(dt);
-}
+    if (!m_meshlet_culling || std::none_of(m_draw_calls.begin(), m_draw_calls.end(), [](const draw_call& call) { return call.meshlets != nullptr; }))
+        return;
 
-void deferred_pbr_render_system::destroy() {}
+    m_frame_profiler->begin_pass("meshlet culling", m_command_buffer);
+    m_command_buffer->bind_shader_program(m_meshlet_culling);
 
-render_pipeline deferred_pbr_render_system::get_base_render_pipeline()
-{
-    return render_pipeline::deferred_pbr;
+    // the pyramid still holds the depth of the last frame, it is projected with the matrix of that frame.
+    texture_ptr hi_z               = m_hi_z_culling ? m_hi_z_culling->get_pyramid() : nullptr;
+    g_int hi_z_levels              = 0;
+    glm::mat4 hi_z_view_projection = glm::mat4(1.0f);
+    if (hi_z)
+    {
+        m_command_buffer->add_memory_barrier(memory_barrier_bit::TEXTURE_FETCH_BARRIER_BIT);
+        hi_z_levels          = static_cast<g_int>(m_hi_z_culling->get_pyramid_levels());
+        hi_z_view_projection = m_hi_z_culling->get_pyramid_view_projection();
+    }
+    m_command_buffer->bind_texture(0, hi_z ? hi_z : default_texture, 0);
+    m_command_buffer->bind_single_uniform(2, &hi_z_view_projection, sizeof(glm::mat4));
+
+    for (auto& call : m_draw_calls)
+    {
+        if (!call.meshlets)
+            continue;
+        const primitive_meshlets& meshlets = *call.meshlets;
+
+        // the count is cleared before the commands of this frame are executed and after the ones of the last frame.
+        g_uint zero = 0;
+        meshlets.draw_buffer->set_data(format::R32UI, 0, sizeof(g_uint), format::RED_INTEGER, format::UNSIGNED_INT, &zero);
+
+        // the normal cones are tested in model space, so the camera is transformed instead of all cones.
+        glm::vec3 model_camera_position = glm::vec3(call.inverse_model_matrix * glm::vec4(m_camera_position, 1.0f));
+        glm::ivec4 meshlet_info         = glm::ivec4(static_cast<g_int>(meshlets.meshlet_count), static_cast<g_int>(meshlets.visible_offset / sizeof(uint32)), static_cast<g_int>(call.instance_count),
+                                             static_cast<g_int>(m_draw_parameters ? call.draw_index : 0));
+        glm::ivec2 cull_flags           = glm::ivec2(call.mat->double_sided ? 0 : 1, hi_z_levels);
+        m_command_buffer->bind_single_uniform(1, &call.model_matrix, sizeof(glm::mat4));
+        m_command_buffer->bind_single_uniform(3, &model_camera_position, sizeof(glm::vec3));
+        m_command_buffer->bind_single_uniform(4, &meshlet_info, sizeof(glm::ivec4));
+        m_command_buffer->bind_single_uniform(5, &cull_flags, sizeof(glm::ivec2));
+
+        g_sizeiptr index_bytes = static_cast<g_sizeiptr>(meshlets.index_count * sizeof(uint32));
+        m_command_buffer->bind_buffer(buffer_target::SHADER_STORAGE_BUFFER, 9, meshlets.meshlet_buffer, 0, static_cast<g_sizeiptr>(meshlets.meshlet_buffer->byte_length()));
+        m_command_buffer->bind_buffer(buffer_target::SHADER_STORAGE_BUFFER, 10, meshlets.index_buffer, 0, index_bytes);
+        m_command_buffer->bind_buffer(buffer_target::SHADER_STORAGE_BUFFER, 11, meshlets.index_buffer, static_cast<g_intptr>(meshlets.visible_offset), index_bytes);
+        m_command_buffer->bind_buffer(buffer_target::SHADER_STORAGE_BUFFER, 12, meshlets.draw_buffer, 0, static_cast<g_sizeiptr>(meshlets.draw_buffer->byte_length()));
+
+        // one work group per meshlet, the y dimension is only used when the x dimension exceeds the guaranteed limit.
+        uint32 x_groups = std::min(meshlets.meshlet_count, max_compute_work_groups);
+        m_command_buffer->dispatch_compute(x_groups, (meshlets.meshlet_count + x_groups - 1) / x_groups, 1);
+    }
+
+    // the indices and draw commands are consumed by the following draws.
+    m_command_buffer->add_memory_barrier(memory_barrier_bit::ELEMENT_ARRAY_BARRIER_BIT);
+    m_command_buffer->add_memory_barrier(memory_barrier_bit::COMMAND_BARRIER_BIT);
+    m_command_buffer->bind_shader_program(nullptr);
+    m_frame_profiler->end_pass(m_command_buffer);
 }
 
-void deferred_pbr_render_system::set_model_info(const glm::mat4& model_matrix, bool has_normals, bool has_tangents)
+void deferred_pbr_render_system::record_draw_call(const draw_call& call, bool depth_only)
 {
-    class set_model_matrix_cmd : public command
+    m_command_buffer->bind_vertex_array(call.vertex_array);
+
+    if (!depth_only)
     {
-      public:
-        buffer_ptr m_uniform_buffer;
-        uint32 m_offset;
-        set_model_matrix_cmd(buffer_ptr uniform_buffer, uint32 offset)
-            : m_uniform_buffer(uniform_buffer)
-            , m_offset(offset)
+        if (call.geometry_pass != m_bound_geometry_pass)
         {
+            m_command_buffer->bind_shader_program(call.geometry_pass);
+            m_bound_geometry_pass = call.geometry_pass;
         }
 
-        void execute(graphics_state&) override
+        if (!m_bindless_textures)
         {
-            MANGO_ASSERT(m_uniform_buffer, "Uniforms do not exist anymore.");
-            m_uniform_buffer->bind(buffer_target::UNIFORM_BUFFER, 0, m_offset, sizeof(scene_vertex_uniforms));
+            // unchanged bindings are filtered by the command buffer.
+            const material_ptr& mat = call.mat;
+            if (mat->base_color_texture)
+                m_command_buffer->bind_texture(0, mat->base_color_texture, 1, mat->base_color_sampler);
+            if (mat->roughness_metallic_texture)
+                m_command_buffer->bind_texture(1, mat->roughness_metallic_texture, 2, mat->roughness_metallic_sampler);
+            if (mat->occlusion_texture)
+                m_command_buffer->bind_texture(2, mat->occlusion_texture, 3, mat->occlusion_sampler);
+            if (mat->normal_texture)
+                m_command_buffer->bind_texture(3, mat->normal_texture, 4, mat->normal_sampler);
+            if (mat->emissive_color_texture)
+                m_command_buffer->bind_texture(4, mat->emissive_color_texture, 5, mat->emissive_color_sampler);
         }
-    };
+    }
+
+    // the object and material data are persistent on the gpu, only the indices have to be passed.
+    if (!m_draw_parameters)
+    {
+        g_int draw_index_uniform = static_cast<g_int>(call.draw_index);
+        m_command_buffer->bind_single_uniform(0, &draw_index_uniform, sizeof(g_int));
+    }
+    uint32 base_instance = m_draw_parameters ? call.draw_index : 0;
 
-    scene_vertex_uniforms u{ std140_mat4(model_matrix), std140_mat3(glm::transpose(glm::inverse(model_matrix))), std140_bool(has_normals), std140_bool(has_tangents), 0, 0 };
+    if (call.mat->double_sided)
+        m_command_buffer->set_face_culling(false);
 
-    MANGO_ASSERT(m_frame_uniform_offset < uniform_buffer_size - sizeof(scene_vertex_uniforms), "Uniform buffer size is too small.");
-    memcpy(static_cast<g_byte*>(m_mapped_uniform_memory) + m_frame_uniform_offset, &u, sizeof(scene_vertex_uniforms));
+    if (call.type == index_type::NONE)
+        m_command_buffer->draw_arrays(call.topology, call.first, call.count, call.instance_count, base_instance);
+    else if (call.meshlets)
+        m_command_buffer->draw_elements_indirect(call.topology, call.type, call.meshlets->draw_buffer);
+    else
+        m_command_buffer->draw_elements(call.topology, call.first, call.count, call.type, call.instance_count, base_instance);
 
-    m_command_buffer->submit<set_model_matrix_cmd>(m_frame_uniform_buffer, m_frame_uniform_offset);
-    m_frame_uniform_offset += m_uniform_buffer_alignment;
+    m_command_buffer->set_face_culling(true);
 }
 
-void deferred_pbr_render_system::draw_mesh(const material_ptr& mat, primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count)
+shader_program_ptr deferred_pbr_render_system::get_scene_geometry_pass(uint32 features)
 {
-    class push_material_cmd : public command
+    auto it = m_scene_geometry_passes.find(features);
+    if (it != m_scene_geometry_passes.end())
+        return it->second;
+
+    static const std::pair<material_feature, const char*> feature_defines[] = { { base_color_texture_feature, "BASE_COLOR_TEXTURE" },
+                                                                                { roughness_metallic_texture_feature, "ROUGHNESS_METALLIC_TEXTURE" },
+                                                                                { occlusion_texture_feature, "OCCLUSION_TEXTURE" },
+                                                                                { packed_occlusion_feature, "PACKED_OCCLUSION" },
+                                                                                { normal_texture_feature, "NORMAL_TEXTURE" },
+                                                                                { emissive_color_texture_feature, "EMISSIVE_COLOR_TEXTURE" },
+                                                                                { alpha_mask_feature, "ALPHA_MASK" } };
+
+    shader_configuration shader_config;
+    shader_config.m_path = "res/shader/v_scene_gltf.glsl";
+    shader_config.m_type = shader_type::VERTEX_SHADER;
+    if (m_draw_parameters)
+        shader_config.m_defines.push_back({ "DRAW_PARAMETERS", "" });
+    shader_ptr d_vertex = shader::create(shader_config);
+    shader_config.m_defines.clear();
+
+    shader_config.m_path = "res/shader/f_scene_gltf.glsl";
+    shader_config.m_type = shader_type::FRAGMENT_SHADER;
+    for (auto& feature : feature_defines)
     {
-      public:
-        buffer_ptr m_uniform_buffer;
-        uint32 m_offset;
-        push_material_cmd(buffer_ptr uniform_buffer, uint32 offset)
-            : m_uniform_buffer(uniform_buffer)
-            , m_offset(offset)
-        {
-        }
+        if (features & feature.first)
+            shader_config.m_defines.push_back({ feature.second, "" });
+    }
+    if (m_bindless_textures)
+        shader_config.m_defines.push_back({ "BINDLESS_TEXTURES", "" });
+    if (m_gbuffer_layout != gbuffer_layout::standard)
+        shader_config.m_defines.push_back({ "COMPACT_GBUFFER", "" });
+    if (m_overdraw_counter)
+        shader_config.m_defines.push_back({ "OVERDRAW_COUNTER", "" });
+    shader_ptr d_fragment = shader::create(shader_config);
 
-        void execute(graphics_state&) override
-        {
-            MANGO_ASSERT(m_uniform_buffer, "Uniforms do not exist anymore.");
-            m_uniform_buffer->bind(buffer_target::UNIFORM_BUFFER, 1, m_offset, sizeof(scene_material_uniforms));
-        }
-    };
+    shader_program_ptr geometry_pass = shader_program::create_graphics_pipeline(d_vertex, nullptr, nullptr, nullptr, d_fragment);
+    m_scene_geometry_passes.insert({ features, geometry_pass });
 
-    scene_material_uniforms u;
+    // modified shader sources are reloaded between frames.
+    shared_ptr<resource_system> res = m_shared_context->get_resource_system_internal().lock();
+    if (res)
+        res->watch_shader_program(geometry_pass);
 
-    u.base_color = std140_vec4(mat->base_color);
-    u.metallic   = (g_float)mat->metallic;
-    u.roughness  = (g_float)mat->roughness;
-    if (mat->base_color_texture)
+    return geometry_pass;
+}
+
+bool deferred_pbr_render_system::shader_programs_ready()
+{
+    if (m_shader_programs_ready)
+        return true;
+
+    // all programs are polled, so each one gets completed as soon as it is done.
+    bool ready = m_scene_geometry_pass->is_ready();
+    ready      = m_depth_pre_pass_program->is_ready() && ready;
+    ready      = m_lighting_pass->is_ready() && ready;
+    ready      = m_mark_active_clusters->is_ready() && ready;
+    ready      = m_assign_lights->is_ready() && ready;
+    if (m_hi_z_culling)
     {
-        u.base_color_texture = std140_bool(true);
-        m_command_buffer->bind_texture(0, mat->base_color_texture, 1);
+        for (auto& program : m_hi_z_culling->get_shader_programs())
+            ready = program->is_ready() && ready;
     }
-    else
+    if (m_meshlet_culling)
+        ready = m_meshlet_culling->is_ready() && ready;
+    if (m_upscale_pass)
+        ready = m_upscale_pass->is_ready() && ready;
+    if (m_pipeline_steps[mango::render_step::ibl])
     {
-        u.base_color_texture = std140_bool(false);
-        m_command_buffer->bind_texture(0, default_texture, 1);
+        for (auto& program : m_pipeline_steps[mango::render_step::ibl]->get_shader_programs())
+            ready = program->is_ready() && ready;
     }
-    if (mat->roughness_metallic_texture)
+
+    m_shader_programs_ready = ready;
+    return ready;
+}
+
+void deferred_pbr_render_system::set_viewport(uint32 x, uint32 y, uint32 width, uint32 height)
+{
+    // resizing a window reports every intermediate size, the render targets are adjusted once at the beginning of the next frame.
+    m_viewport_x       = x;
+    m_viewport_y       = y;
+    m_viewport_width   = width;
+    m_viewport_height  = height;
+    m_viewport_changed = true;
+}
+
+void deferred_pbr_render_system::resize_render_targets()
+{
+    m_viewport_changed = false;
+
+    uint32 width     = get_render_target_size(m_viewport_width);
+    uint32 height    = get_render_target_size(m_viewport_height);
+    bool fits        = width <= m_gbuffer->get_width() && height <= m_gbuffer->get_height();
+    bool mostly_used = 2 * static_cast<uint64>(width) * height > static_cast<uint64>(m_gbuffer->get_width()) * m_gbuffer->get_height();
+    if (fits && mostly_used)
+        return;
+
+    m_gbuffer->resize(width, height);
+    if (m_lighting_target)
+        m_lighting_target->resize(width, height);
+    m_clear_whole_gbuffer = true;
+    MANGO_LOG_DEBUG("Render targets resized to {0} x {1} for a viewport of {2} x {3}.", width, height, m_viewport_width, m_viewport_height);
+}
+
+void deferred_pbr_render_system::update(float dt)
+{
+    MANGO_UNUSED(dt);
+}
+
+void deferred_pbr_render_system::destroy() {}
+
+render_pipeline deferred_pbr_render_system::get_base_render_pipeline()
+{
+    return render_pipeline::deferred_pbr;
+}
+
+texture_streaming_statistics deferred_pbr_render_system::get_texture_streaming_statistics()
+{
+    if (m_texture_streaming)
+        return m_texture_streaming->get_statistics();
+
+    texture_streaming_statistics statistics;
+    std::memset(&statistics, 0, sizeof(statistics));
+    return statistics;
+}
+
+state_change_statistics deferred_pbr_render_system::get_state_change_statistics()
+{
+    return m_state_change_statistics;
+}
+
+overdraw_statistics deferred_pbr_render_system::get_overdraw_statistics()
+{
+    overdraw_statistics statistics;
+    std::memset(&statistics, 0, sizeof(statistics));
+    if (!m_overdraw_counter)
+        return statistics;
+
+    statistics.measured         = true;
+    statistics.shaded_fragments = m_overdraw_counter->get_shaded_fragments();
+    statistics.pixels           = m_render_width * m_render_height;
+    statistics.overdraw         = statistics.pixels > 0 ? static_cast<float>(statistics.shaded_fragments) / static_cast<float>(statistics.pixels) : 0.0f;
+    return statistics;
+}
+
+occlusion_culling_statistics deferred_pbr_render_system::get_occlusion_culling_statistics()
+{
+    return m_occlusion_culling_statistics;
+}
+
+std::vector<frame_timings> deferred_pbr_render_system::get_frame_timings()
+{
+    const std::deque<frame_timings>& history = m_frame_profiler->get_frame_timings();
+    return std::vector<frame_timings>(history.begin(), history.end());
+}
+
+gbuffer_statistics deferred_pbr_render_system::get_gbuffer_statistics()
+{
+    gbuffer_statistics statistics;
+    statistics.layout          = m_gbuffer_layout;
+    statistics.bytes_per_pixel = 0;
+
+    const framebuffer_attachment attachments[] = { framebuffer_attachment::COLOR_ATTACHMENT0, framebuffer_attachment::COLOR_ATTACHMENT1, framebuffer_attachment::COLOR_ATTACHMENT2,
+                                                   framebuffer_attachment::COLOR_ATTACHMENT3, framebuffer_attachment::DEPTH_ATTACHMENT,  framebuffer_attachment::DEPTH_STENCIL_ATTACHMENT };
+    for (auto attachment : attachments)
     {
-        u.roughness_metallic_texture = std140_bool(true);
-        m_command_buffer->bind_texture(1, mat->roughness_metallic_texture, 2);
+        texture_ptr target = m_gbuffer->get_attachment(attachment);
+        if (target)
+            statistics.bytes_per_pixel += static_cast<uint32>(number_of_basic_machine_units(target->get_internal_format()));
     }
-    else
+    statistics.memory = static_cast<ptr_size>(statistics.bytes_per_pixel) * m_gbuffer->get_width() * m_gbuffer->get_height();
+
+    return statistics;
+}
+
+void deferred_pbr_render_system::update_state_change_statistics()
+{
+    // the changes are filtered while recording, so the building state has the counters.
+    auto& counters                           = m_command_buffer->get_state().m_change_counters;
+    m_state_change_statistics.issued_changes = counters.issued;
+    m_state_change_statistics.elided_changes = counters.elided;
+    counters.issued                          = 0;
+    counters.elided                          = 0;
+}
+
+void deferred_pbr_render_system::set_model_info(uint32 object_id, const glm::mat4& model_matrix, bool has_normals, bool has_tangents, bool has_quantized_attributes, const glm::vec3& position_offset,
+                                                const glm::vec3& position_scale)
+{
+    if (m_loading_frame)
+        return;
+
+    MANGO_ASSERT(object_id >= 1 && object_id <= max_entities, "Object id is out of range!");
+    m_object_id        = object_id;
+    m_model_matrix     = model_matrix;
+    m_model_footprint  = std::numeric_limits<float>::max(); // without bounds everything is required.
+    m_model_view_depth = -(m_view_matrix * model_matrix[3]).z;
+
+    // the entry is only written if it changed since the last frame using the same half of the buffer.
+    uint32 index      = m_object_buffer_half * object_entries + object_id;
+    object_slot& slot = m_object_slots[index];
+    if (slot.written && slot.has_normals == has_normals && slot.has_tangents == has_tangents && slot.has_quantized_attributes == has_quantized_attributes && slot.position_offset == position_offset &&
+        slot.position_scale == position_scale && slot.model_matrix == model_matrix)
     {
-        u.roughness_metallic_texture = std140_bool(false);
-        m_command_buffer->bind_texture(1, default_texture, 2);
+        m_inverse_model_matrix = slot.inverse_model_matrix;
+        return;
     }
+
+    // the inverse is only calculated for changed entries. Model matrices are affine, so the normal matrix is the transposed upper 3x3 of it.
+    slot.model_matrix             = model_matrix;
+    slot.inverse_model_matrix     = glm::inverse(model_matrix);
+    slot.has_normals              = has_normals;
+    slot.has_tangents             = has_tangents;
+    slot.has_quantized_attributes = has_quantized_attributes;
+    slot.position_offset          = position_offset;
+    slot.position_scale           = position_scale;
+    slot.written                  = true;
+
+    scene_object_data data{ std140_mat4(model_matrix),
+                            std140_mat3(glm::transpose(glm::mat3(slot.inverse_model_matrix))),
+                            std140_bool(has_normals),
+                            std140_bool(has_tangents),
+                            std140_bool(has_quantized_attributes),
+                            0,
+                            std140_vec4(glm::vec4(position_offset, 0.0f)),
+                            std140_vec4(glm::vec4(position_scale, 0.0f)) };
+
+    memcpy(static_cast<g_byte*>(m_mapped_object_memory) + m_object_buffer_half * m_object_buffer_half_size + object_id * sizeof(scene_object_data), &data, sizeof(scene_object_data));
+    m_inverse_model_matrix = slot.inverse_model_matrix;
+}
+
+bool deferred_pbr_render_system::set_model_bounds(const glm::vec3& min_extents, const glm::vec3& max_extents)
+{
+    if (m_loading_frame)
+        return true;
+
+    // bounding sphere in world space.
+    glm::vec3 center = glm::vec3(m_model_matrix * glm::vec4((min_extents + max_extents) * 0.5f, 1.0f));
+    float scale      = glm::max(glm::length(glm::vec3(m_model_matrix[0])), glm::max(glm::length(glm::vec3(m_model_matrix[1])), glm::length(glm::vec3(m_model_matrix[2]))));
+    float radius     = glm::length(max_extents - min_extents) * 0.5f * scale;
+
+    m_model_view_depth = -(m_view_matrix * glm::vec4(center, 1.0f)).z;
+
+    float distance = glm::length(center - m_camera_position);
+    if (!m_perspective_projection)
+        m_model_footprint = radius * m_projection_scale * static_cast<float>(m_render_height);
+    else if (distance <= radius)
+        m_model_footprint = std::numeric_limits<float>::max();
+    else
+        m_model_footprint = radius / distance * m_projection_scale * static_cast<float>(m_render_height);
+
+    // occluded models neither draw nor request textures.
+    return !m_hi_z_culling || !m_hi_z_culling->is_occluded(m_model_matrix, min_extents, max_extents);
+}
+
+void deferred_pbr_render_system::draw_mesh(const vertex_array_ptr& vertex_array, const material_ptr& mat, primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count,
+                                           const shared_ptr<primitive_meshlets>& meshlets)
+{
+    if (m_loading_frame)
+        return;
+
+    // the geometry pass is specialized for the material, so it does not branch on the features per fragment.
+    uint32 features = 0;
+    if (mat->base_color_texture)
+        features |= base_color_texture_feature;
+    if (mat->roughness_metallic_texture)
+        features |= roughness_metallic_texture_feature;
     if (mat->occlusion_texture)
+        features |= occlusion_texture_feature;
+    else if (mat->packed_occlusion)
+        features |= packed_occlusion_feature;
+    if (mat->normal_texture)
+        features |= normal_texture_feature;
+    if (mat->emissive_color_texture)
+        features |= emissive_color_texture_feature;
+    if (mat->alpha_rendering == alpha_mode::MODE_MASK)
+        features |= alpha_mask_feature;
+
+    if (m_texture_streaming)
     {
-        u.occlusion_texture = std140_bool(true);
-        m_command_buffer->bind_texture(2, mat->occlusion_texture, 3);
-        u.packed_occlusion = std140_bool(false);
+        m_texture_streaming->request(mat->base_color_texture, m_model_footprint);
+        m_texture_streaming->request(mat->roughness_metallic_texture, m_model_footprint);
+        m_texture_streaming->request(mat->occlusion_texture, m_model_footprint);
+        m_texture_streaming->request(mat->normal_texture, m_model_footprint);
+        m_texture_streaming->request(mat->emissive_color_texture, m_model_footprint);
     }
-    else
+
+    // the draw calls are recorded in finish_render(), after they were sorted.
+    draw_call call;
+    call.vertex_array         = vertex_array;
+    call.mat                  = mat;
+    call.geometry_pass        = get_scene_geometry_pass(features);
+    call.topology             = topology;
+    call.first                = first;
+    call.count                = count;
+    call.type                 = type;
+    call.instance_count       = instance_count;
+    call.draw_index           = (m_object_id << material_index_bits) | get_material_index(mat);
+    call.view_depth           = m_model_view_depth;
+    call.alpha_mask           = (features & alpha_mask_feature) != 0;
+    call.meshlets             = m_meshlet_culling ? meshlets : nullptr;
+    call.model_matrix         = m_model_matrix;
+    call.inverse_model_matrix = m_inverse_model_matrix;
+    m_draw_calls.push_back(call);
+}
+
+uint32 deferred_pbr_render_system::get_material_index(const material_ptr& mat)
+{
+    const texture_ptr textures[5] = { mat->base_color_texture, mat->roughness_metallic_texture, mat->occlusion_texture, mat->normal_texture, mat->emissive_color_texture };
+    const sampler_ptr samplers[5] = { mat->base_color_sampler, mat->roughness_metallic_sampler, mat->occlusion_sampler, mat->normal_sampler, mat->emissive_color_sampler };
+
+    auto it = m_material_slots.find(mat.get());
+    if (it != m_material_slots.end())
     {
-        u.occlusion_texture = std140_bool(false);
-        m_command_buffer->bind_texture(2, default_texture, 3);
-        // eventually it is packed
-        u.packed_occlusion = std140_bool(mat->packed_occlusion);
+        if (!it->second.mat.expired())
+        {
+            if (!m_bindless_textures)
+                return it->second.index;
+
+            // streaming changes the names of textures and invalidates their handles.
+            bool changed = false;
+            for (uint32 i = 0; i < 5; ++i)
+                changed |= (textures[i] ? textures[i]->get_name() : 0) != it->second.texture_names[i];
+            if (!changed)
+                return it->second.index;
+        }
+
+        // the gpu can still read the old data, so a refreshed or a released material with the same address gets a fresh slot.
+        m_replaced_material_indices.push_back(it->second.index);
+        m_material_slots.erase(it);
     }
-    if (mat->normal_texture)
+
+    if (m_free_material_indices.empty())
     {
-        u.normal_texture = std140_bool(true);
-        m_command_buffer->bind_texture(3, mat->normal_texture, 4);
+        MANGO_LOG_WARN("Material buffer is full! Rendering with the first material.");
+        return 0;
     }
-    else
+    material_slot slot;
+    slot.mat   = mat;
+    slot.index = m_free_material_indices.back();
+    m_free_material_indices.pop_back();
+
+    scene_material_data data;
+    data.base_color     = std140_vec4(mat->base_color);
+    data.emissive_color = std140_vec4(glm::vec4(mat->emissive_color, 0.0f));
+    data.metallic       = mat->metallic;
+    data.roughness      = mat->roughness;
+    data.alpha_cutoff   = mat->alpha_cutoff;
+    data.padding0       = 0.0f;
+    data.padding1       = 0;
+    for (uint32 i = 0; i < 5; ++i)
     {
-        u.normal_texture = std140_bool(false);
-        m_command_buffer->bind_texture(3, default_texture, 4);
+        slot.texture_names[i]   = textures[i] ? textures[i]->get_name() : 0;
+        data.texture_handles[i] = (m_bindless_textures && textures[i]) ? textures[i]->get_bindless_handle(samplers[i]) : 0;
     }
-    if (mat->emissive_color_texture)
+
+    memcpy(static_cast<g_byte*>(m_mapped_material_memory) + slot.index * sizeof(scene_material_data), &data, sizeof(scene_material_data));
+    m_material_slots.insert({ mat.get(), slot });
+
+    return slot.index;
+}
+
+void deferred_pbr_render_system::update_object_buffer()
+{
+    m_object_buffer_half = 1 - m_object_buffer_half;
+    m_command_buffer->bind_buffer(buffer_target::SHADER_STORAGE_BUFFER, 4, m_object_buffer, static_cast<g_intptr>(m_object_buffer_half * m_object_buffer_half_size), static_cast<g_sizeiptr>(m_object_buffer_half_size));
+}
+
+void deferred_pbr_render_system::update_light_buffer()
+{
+    m_light_buffer_half = 1 - m_light_buffer_half;
+    m_light_count       = 0;
+    m_command_buffer->bind_buffer(buffer_target::SHADER_STORAGE_BUFFER, 5, m_light_buffer, static_cast<g_intptr>(m_light_buffer_half * m_light_buffer_half_size), static_cast<g_sizeiptr>(m_light_buffer_half_size));
+    m_command_buffer->bind_buffer(buffer_target::SHADER_STORAGE_BUFFER, 6, m_cluster_buffer, 0, static_cast<g_sizeiptr>(m_cluster_buffer->byte_length()));
+    m_command_buffer->bind_buffer(buffer_target::SHADER_STORAGE_BUFFER, 7, m_cluster_light_index_buffer, 0, static_cast<g_sizeiptr>(m_cluster_light_index_buffer->byte_length()));
+}
+
+void deferred_pbr_render_system::assign_lights_to_clusters()
+{
+    // the lights are culled against the froxels containing gbuffer depth, so empty space does not get any lights.
+    m_command_buffer->bind_shader_program(m_mark_active_clusters);
+    m_command_buffer->bind_texture(0, get_gbuffer_depth(), 1);
+    glm::ivec2 render_size = glm::ivec2(static_cast<g_int>(m_render_width), static_cast<g_int>(m_render_height));
+    m_command_buffer->bind_single_uniform(2, &render_size, sizeof(glm::ivec2));
+    m_command_buffer->dispatch_compute((m_render_width + 7) / 8, (m_render_height + 7) / 8, 1);
+    m_command_buffer->add_memory_barrier(memory_barrier_bit::SHADER_STORAGE_BARRIER_BIT);
+
+    m_command_buffer->bind_shader_program(m_assign_lights);
+    g_int light_count = static_cast<g_int>(m_light_count);
+    m_command_buffer->bind_single_uniform(0, &light_count, sizeof(g_int));
+    m_command_buffer->dispatch_compute(cluster_grid_x, cluster_grid_y, cluster_grid_z);
+    m_command_buffer->add_memory_barrier(memory_barrier_bit::SHADER_STORAGE_BARRIER_BIT);
+
+    m_command_buffer->bind_shader_program(nullptr);
+}
+
+void deferred_pbr_render_system::submit_light(const light_component& light, const glm::vec3& position, const glm::vec3& direction)
+{
+    if (m_loading_frame)
+        return;
+
+    if (m_light_count >= max_lights)
     {
-        u.emissive_color_texture = std140_bool(true);
-        m_command_buffer->bind_texture(4, mat->emissive_color_texture, 5);
+        MANGO_LOG_WARN("Light buffer is full! Light is not rendered.");
+        return;
     }
-    else
+
+    // the spot falloff is saturate(cos(angle) * scale + offset), point lights are never attenuated by it.
+    float scale  = 0.0f;
+    float offset = 1.0f;
+    if (light.type == light_type::spot_light)
     {
-        u.emissive_color_texture = std140_bool(false);
-        m_command_buffer->bind_texture(4, default_texture, 5);
+        float cos_outer = std::cos(light.outer_cone_angle);
+        float cos_inner = std::cos(glm::min(light.inner_cone_angle, light.outer_cone_angle));
+        scale           = 1.0f / glm::max(cos_inner - cos_outer, 1e-4f);
+        offset          = -cos_outer * scale;
     }
 
-    u.alpha_mode   = static_cast<g_int>(mat->alpha_rendering);
-    u.alpha_cutoff = mat->alpha_cutoff;
+    scene_light_data data{ std140_vec4(glm::vec4(position, light.range)), std140_vec4(glm::vec4(light.color * light.intensity, offset)), std140_vec4(glm::vec4(direction, scale)) };
 
-    MANGO_ASSERT(m_frame_uniform_offset < uniform_buffer_size - sizeof(scene_material_uniforms), "Uniform buffer size is too small.");
-    memcpy(static_cast<g_byte*>(m_mapped_uniform_memory) + m_frame_uniform_offset, &u, sizeof(scene_material_uniforms));
-
-    m_command_buffer->submit<push_material_cmd>(m_frame_uniform_buffer, m_frame_uniform_offset);
-    m_frame_uniform_offset += m_uniform_buffer_alignment;
-
-    if (mat->double_sided)
-        m_command_buffer->set_face_culling(false);
+    memcpy(static_cast<g_byte*>(m_mapped_light_memory) + m_light_buffer_half * m_light_buffer_half_size + m_light_count * sizeof(scene_light_data), &data, sizeof(scene_light_data));
+    ++m_light_count;
+}
 
-    if (type == index_type::NONE)
-        m_command_buffer->draw_arrays(topology, first, count, instance_count);
-    else
-        m_command_buffer->draw_elements(topology, first, count, type, instance_count);
+void deferred_pbr_render_system::update_material_buffer()
+{
+    // the gpu finished the frame reading the indices released last time, so they can be reused now.
+    m_free_material_indices.insert(m_free_material_indices.end(), m_released_material_indices.begin(), m_released_material_indices.end());
+    m_released_material_indices.swap(m_replaced_material_indices);
+    m_replaced_material_indices.clear();
+    for (auto it = m_material_slots.begin(); it != m_material_slots.end();)
+    {
+        if (it->second.mat.expired())
+        {
+            m_released_material_indices.push_back(it->second.index);
+            it = m_material_slots.erase(it);
+        }
+        else
+            ++it;
+    }
 
-    m_command_buffer->set_face_culling(true);
+    m_command_buffer->bind_buffer(buffer_target::SHADER_STORAGE_BUFFER, 3, m_material_buffer, 0, static_cast<g_sizeiptr>(m_material_buffer->byte_length()));
 }
 
 void deferred_pbr_render_system::set_view_projection_matrix(const glm::mat4& view_projection)
 {
-    m_command_buffer->bind_single_uniform(0, &const_cast<glm::mat4&>(view_projection), sizeof(glm::mat4));
+    // uploaded with the other camera uniforms in one block, so it is available in all programs.
+    m_view_projection = view_projection;
 }
 
-void deferred_pbr_render_system::set_environment_texture(const texture_ptr& hdr_texture, float render_level)
+void deferred_pbr_render_system::set_camera_uniforms()
+{
+    scene_camera_uniforms u{ std140_mat4(m_view_projection), std140_mat4(glm::inverse(m_view_projection)), std140_mat4(m_view_matrix), std140_mat4(glm::inverse(m_projection_matrix)),
+                             std140_vec4(glm::vec4(m_camera_position, 1.0f)), std140_vec4(glm::vec4(m_camera_planes.x, m_camera_planes.y, 0.0f, 0.0f)) };
+
+    MANGO_ASSERT(m_frame_uniform_offset < uniform_buffer_size - sizeof(scene_camera_uniforms), "Uniform buffer size is too small.");
+    memcpy(static_cast<g_byte*>(m_mapped_uniform_memory) + m_frame_uniform_offset, &u, sizeof(scene_camera_uniforms));
+
+    m_command_buffer->bind_buffer(buffer_target::UNIFORM_BUFFER, 2, m_frame_uniform_buffer, m_frame_uniform_offset, sizeof(scene_camera_uniforms));
+    m_frame_uniform_offset += m_uniform_buffer_alignment;
+}
+
+void deferred_pbr_render_system::set_environment_texture(const texture_ptr& hdr_texture, uint64 content_hash, float render_level)
 {
     if (m_pipeline_steps[mango::render_step::ibl])
     {
         auto ibl = std::static_pointer_cast<ibl_step>(m_pipeline_steps[mango::render_step::ibl]);
-        ibl->load_from_hdr(hdr_texture);
+        // the precomputation is executed immediately, so it is measured in the current frame.
+        MANGO_PROFILE_ZONE("ibl precompute");
+        m_frame_profiler->begin_pass("ibl precompute");
+        ibl->load_from_hdr(hdr_texture, content_hash);
+        m_frame_profiler->end_pass();
         ibl->set_render_level(render_level);
     }
 }
 
+shared_ptr<texture_streaming> deferred_pbr_render_system::get_texture_streaming()
+{
+    return m_texture_streaming;
+}
+
+uint32 deferred_pbr_render_system::get_render_height()
+{
+    return m_render_height;
+}
+
+uint32 deferred_pbr_render_system::get_render_target_size(uint32 size)
+{
+    uint32 target_size = 64;
+    uint32 step        = 16;
+    while (target_size < size)
+    {
+        target_size += step;
+        if (target_size == step * 8)
+            step *= 2;
+    }
+    return target_size;
+}
+
 #ifdef MANGO_DEBUG
 
 static const char* getStringForType(GLenum type)
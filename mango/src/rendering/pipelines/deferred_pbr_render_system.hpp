@@ -7,8 +7,13 @@
 #ifndef MANGO_DEFERRED_PBR_RENDER_SYSTEM_HPP
 #define MANGO_DEFERRED_PBR_RENDER_SYSTEM_HPP
 
+#include <graphics/shader.hpp>
+#include <rendering/frame_profiler.hpp>
+#include <rendering/hi_z_culling.hpp>
+#include <rendering/overdraw_counter.hpp>
 #include <rendering/render_system_impl.hpp>
 #include <rendering/steps/pipeline_step.hpp>
+#include <rendering/texture_streaming.hpp>
 
 namespace mango
 {
@@ -30,24 +35,188 @@ namespace mango
         virtual void update(float dt) override;
         virtual void destroy() override;
         virtual render_pipeline get_base_render_pipeline() override;
+        virtual texture_streaming_statistics get_texture_streaming_statistics() override;
+        virtual state_change_statistics get_state_change_statistics() override;
+        virtual std::vector<frame_timings> get_frame_timings() override;
+        virtual gbuffer_statistics get_gbuffer_statistics() override;
+        virtual overdraw_statistics get_overdraw_statistics() override;
+        virtual occlusion_culling_statistics get_occlusion_culling_statistics() override;
 
-        void set_model_info(const glm::mat4& model_matrix, bool has_normals, bool has_tangents) override;
-        void draw_mesh(const material_ptr& mat, primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count) override;
+        void set_model_info(uint32 object_id, const glm::mat4& model_matrix, bool has_normals, bool has_tangents, bool has_quantized_attributes, const glm::vec3& position_offset,
+                            const glm::vec3& position_scale) override;
+        bool set_model_bounds(const glm::vec3& min_extents, const glm::vec3& max_extents) override;
+        void draw_mesh(const vertex_array_ptr& vertex_array, const material_ptr& mat, primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count,
+                       const shared_ptr<primitive_meshlets>& meshlets) override;
+        void submit_light(const light_component& light, const glm::vec3& position, const glm::vec3& direction) override;
         void set_view_projection_matrix(const glm::mat4& view_projection) override;
-        void set_environment_texture(const texture_ptr& hdr_texture, float render_level) override;
+        void set_environment_texture(const texture_ptr& hdr_texture, uint64 content_hash, float render_level) override;
+        shared_ptr<texture_streaming> get_texture_streaming() override;
+        uint32 get_render_height() override;
+        void set_gbuffer_layout(gbuffer_layout layout) override;
+        void set_depth_pre_pass(bool enabled) override;
+        void set_front_to_back_sorting(bool enabled) override;
+        void set_overdraw_measurement(bool enabled) override;
+        void set_occlusion_culling(bool enabled) override;
+        void set_meshlet_culling(bool enabled) override;
+        void set_target_frame_time(float milliseconds) override;
+
+        //! \brief Returns the size of a render target holding a viewport size.
+        //! \details Sizes are rounded up to 4, 5, 6 or 7 times a power of two, so viewports above 64 pixels use at least 80% of the target in each direction.
+        //! Slightly different viewports share the same target size and do not need a reallocation.
+        //! \param[in] size The width or the height of the viewport in pixels.
+        //! \return The width or the height of the render target in pixels.
+        static uint32 get_render_target_size(uint32 size);
 
       private:
         //! \brief The gbuffer of the deferred pipeline.
         framebuffer_ptr m_gbuffer;
+        //! \brief The layout of the gbuffer.
+        gbuffer_layout m_gbuffer_layout;
+
+        //! \brief Creates the gbuffer with the current \a gbuffer_layout.
+        //! \param[in] width The width of the gbuffer in pixels.
+        //! \param[in] height The height of the gbuffer in pixels.
+        //! \return True on success, else false.
+        bool create_gbuffer(uint32 width, uint32 height);
+
+        //! \brief Returns the target of the gbuffer holding the depth.
+        //! \return The depth or the depth stencil attachment, depending on the \a gbuffer_layout.
+        texture_ptr get_gbuffer_depth();
+
+        //! \brief Features of a material selecting a permutation of the geometry pass.
+        enum material_feature : uint32
+        {
+            base_color_texture_feature         = 1 << 0, //!< The material has a base color texture.
+            roughness_metallic_texture_feature = 1 << 1, //!< The material has a texture with roughness and metallic values.
+            occlusion_texture_feature          = 1 << 2, //!< The material has an occlusion texture.
+            packed_occlusion_feature           = 1 << 3, //!< The occlusion is packed into the roughness metallic texture.
+            normal_texture_feature             = 1 << 4, //!< The material has a normal texture.
+            emissive_color_texture_feature     = 1 << 5, //!< The material has an emissive color texture.
+            alpha_mask_feature                 = 1 << 6  //!< The material discards fragments below the alpha cutoff.
+        };
+
+        //! \brief Retrieves the permutation of the geometry pass for a set of material features.
+        //! \details Permutations are built lazily on first use and cached.
+        //! \param[in] features The features of the material as a combination of \a material_features.
+        //! \return The \a shader_program specialized for the features.
+        shader_program_ptr get_scene_geometry_pass(uint32 features);
 
-        //! \brief The \a shader_program for the deferred geometry pass.
+        //! \brief The \a shader_program for the deferred geometry pass used for materials without any features.
         //! \details This fills the g-buffer for later use in the lighting pass.
         shader_program_ptr m_scene_geometry_pass;
+        //! \brief All built permutations of the geometry pass. The key is the combination of \a material_features.
+        std::unordered_map<uint32, shader_program_ptr> m_scene_geometry_passes;
+        //! \brief The permutation of the geometry pass currently bound while recording the frame.
+        shader_program_ptr m_bound_geometry_pass;
+        //! \brief The view projection matrix of the current frame.
+        glm::mat4 m_view_projection;
+
+        //! \brief A draw call recorded by draw_mesh(). The draw calls of a frame are reordered before they are submitted.
+        struct draw_call
+        {
+            vertex_array_ptr vertex_array;    //!< The \a vertex_array with the vertex data.
+            material_ptr mat;                 //!< The \a material to draw with.
+            shader_program_ptr geometry_pass; //!< The permutation of the geometry pass for the \a material.
+            primitive_topology topology;      //!< The topology used for drawing the vertex data.
+            uint32 first;                     //!< The first index to start drawing from.
+            uint32 count;                     //!< The number of indices to draw.
+            index_type type;                  //!< The \a index_type of the values in the index buffer.
+            uint32 instance_count;            //!< The number of instances to draw.
+            uint32 draw_index;                //!< The object index in the upper bits and the material index in the lower bits.
+            float view_depth;                 //!< The depth of the model in view space, used for sorting.
+            bool alpha_mask;                  //!< True if the \a material discards fragments below the alpha cutoff.
+            //! \brief The meshlets culled on the gpu before drawing. Nullptr if the index range is drawn completely.
+            shared_ptr<primitive_meshlets> meshlets;
+            //! \brief The model matrix of the model, used for culling the meshlets.
+            glm::mat4 model_matrix;
+            //! \brief The inverse of the model matrix, used to transform the camera for culling the meshlets.
+            glm::mat4 inverse_model_matrix;
+        };
+
+        //! \brief Submits the draw calls of the frame for the optional depth pre-pass and the geometry pass.
+        void render_geometry();
+
+        //! \brief Culls the meshlets of the draw calls of the frame on the gpu.
+        //! \details Writes the indices of the visible meshlets and the indirect draw commands drawing them.
+        void cull_meshlets();
+
+        //! \brief Records the commands of a single draw call.
+        //! \param[in] call The \a draw_call to record.
+        //! \param[in] depth_only True if only the depth is written and the program is already bound, else the material is bound as well.
+        void record_draw_call(const draw_call& call, bool depth_only);
+
+        //! \brief The draw calls recorded in the current frame.
+        std::vector<draw_call> m_draw_calls;
+        //! \brief The \a shader_program for the depth pre-pass. Only transforms the vertices, nothing is shaded.
+        shader_program_ptr m_depth_pre_pass_program;
+        //! \brief True if the depth of opaque draws is written in a pre-pass before the geometry pass, else false.
+        bool m_depth_pre_pass;
+        //! \brief True if opaque draws are sorted front to back by their view depth, else false.
+        bool m_front_to_back_sorting;
+        //! \brief Counts the fragments shaded by the geometry pass. Nullptr if the overdraw is not measured.
+        shared_ptr<overdraw_counter> m_overdraw_counter;
+        //! \brief Culls models hidden behind the depth of an earlier frame. Nullptr if occlusion culling is disabled.
+        shared_ptr<hi_z_culling> m_hi_z_culling;
+        //! \brief The occlusion culling statistics of the last frame.
+        occlusion_culling_statistics m_occlusion_culling_statistics;
+        //! \brief The compute \a shader_program culling meshlets against the view, their normal cones and the hi-z pyramid. Nullptr if meshlet culling is disabled.
+        shader_program_ptr m_meshlet_culling;
+        //! \brief The number of work groups in one dimension every implementation supports.
+        const uint32 max_compute_work_groups = 65535;
 
         //! \brief The \a shader_program for the lighting pass.
         //! \details Utilizes the g-buffer filled before.
         shader_program_ptr m_lighting_pass;
 
+        //! \brief Creates the lighting pass specialized for the current \a gbuffer_layout.
+        //! \return True on success, else false.
+        bool create_lighting_pass();
+
+        //! \brief Creates the target the lighting pass renders to when the resolution is scaled.
+        //! \param[in] width The width of the target in pixels.
+        //! \param[in] height The height of the target in pixels.
+        //! \return True on success, else false.
+        bool create_lighting_target(uint32 width, uint32 height);
+
+        //! \brief Creates the pass upscaling and sharpening the lighting target to the viewport.
+        //! \return True on success, else false.
+        bool create_upscale_pass();
+
+        //! \brief Adjusts the render scale to the gpu time of the latest profiled frame.
+        //! \details The scale is only changed once per measured frame. It is 1 if the dynamic resolution is disabled.
+        void update_render_scale();
+
+        //! \brief Returns the part of the gbuffer the current frame is rendered to in texture coordinates.
+        //! \return The scale from texture coordinates of the render area to texture coordinates of the gbuffer.
+        glm::vec2 get_render_uv_scale() const;
+
+        //! \brief The gpu frame time in milliseconds the render scale is adjusted for. 0 if the dynamic resolution is disabled.
+        float m_target_frame_time;
+        //! \brief The fraction of the viewport width and height the geometry and the lighting are rendered with.
+        float m_render_scale;
+        //! \brief The number of the last profiled frame the render scale was adjusted for.
+        uint64 m_last_scaled_frame;
+        //! \brief The width of the render area of the current frame in pixels.
+        uint32 m_render_width;
+        //! \brief The height of the render area of the current frame in pixels.
+        uint32 m_render_height;
+        //! \brief True if the whole gbuffer is cleared in the next frame, because the render area changed or the gbuffer was recreated.
+        //! \details Otherwise only the render area is cleared. The depth outside of it stays cleared, so the hi-z pyramid is not affected by stale depth.
+        bool m_clear_whole_gbuffer;
+        //! \brief The target the lighting pass renders to when the resolution is scaled. Nullptr if the dynamic resolution is disabled.
+        framebuffer_ptr m_lighting_target;
+        //! \brief The \a shader_program upscaling and sharpening the lighting target to the viewport. Nullptr if the dynamic resolution is disabled.
+        shader_program_ptr m_upscale_pass;
+        //! \brief The smallest render scale. The upscaled image gets too blurry below.
+        const float min_render_scale = 0.5f;
+        //! \brief The fraction of the difference to the ideal render scale applied per measured frame.
+        //! \details The timings are a few frames old and noisy, so the scale approaches the ideal one smoothly.
+        const float render_scale_damping = 0.25f;
+        //! \brief Changes of the ideal render scale smaller than this are ignored, so the image does not swim with the timing noise.
+        const float render_scale_tolerance = 0.02f;
+        //! \brief The strength of the sharpening at the \a min_render_scale. Less upscaled images are sharpened less.
+        const float max_sharpness = 0.6f;
+
         //! \brief The prealocated size for all uniforms.
         //! \details The buffer is filled every frame. 1 MiB should be enough for now.
         const uint32 uniform_buffer_size = 1048576;
@@ -59,41 +228,232 @@ namespace mango
         //! \brief The uniform buffer mapping the gpu buffer to the scene uniforms.
         buffer_ptr m_frame_uniform_buffer;
 
-        //! \brief Uniform struct for the geometry passes vertex shader.
-        struct scene_vertex_uniforms
+        //! \brief Uniform struct for the camera data used by the geometry and the lighting pass.
+        //! \details Uploaded once per frame instead of setting single uniforms after each program change.
+        struct scene_camera_uniforms
+        {
+            std140_mat4 view_projection;         //!< The view projection matrix of the active camera.
+            std140_mat4 inverse_view_projection; //!< The inverse of the view projection matrix.
+            std140_mat4 view;                    //!< The view matrix of the active camera.
+            std140_mat4 inverse_projection;      //!< The inverse of the projection matrix of the active camera.
+            std140_vec4 camera_position;         //!< The position of the active camera. This is a vec3, but there are annoying bugs with some drivers.
+            std140_vec4 camera_planes;           //!< The distance of the near (x) and the far (y) plane of the active camera.
+        };
+
+        //! \brief Writes the \a scene_camera_uniforms of the current frame and binds them.
+        void set_camera_uniforms();
+
+        //! \brief Data of one model in the persistent object buffer. Uses the std430 layout.
+        struct scene_object_data
         {
             std140_mat4 model_matrix;  //!< The model matrix.
             std140_mat3 normal_matrix; //!< The normal matrix.
 
-            std140_bool has_normals;   //!< Specifies if the next mesh has normals as a vertex attribute.
-            std140_bool has_tangents;  //!< Specifies if the next mesh has tangents as a vertex attribute.
+            std140_bool has_normals;              //!< Specifies if the mesh has normals as a vertex attribute.
+            std140_bool has_tangents;             //!< Specifies if the mesh has tangents as a vertex attribute.
+            std140_bool has_quantized_attributes; //!< Specifies if the vertex attributes of the mesh are quantized.
+
+            g_float padding0; //!< Padding needed for std430 layout.
 
-            g_float padding0; //!< Padding needed for st140 layout.
-            g_float padding1; //!< Padding needed for st140 layout.
+            std140_vec4 position_offset; //!< The minimum of the bounds the positions are quantized in. The w component is unused.
+            std140_vec4 position_scale;  //!< The size of the bounds the positions are quantized in. The w component is unused.
         };
 
-        //! \brief Uniform struct for the geometry passes fragment shader to implement \a materials.
-        struct scene_material_uniforms
+        //! \brief The model info last written to one entry of the object buffer.
+        struct object_slot
+        {
+            glm::mat4 model_matrix;         //!< The model matrix.
+            glm::mat4 inverse_model_matrix; //!< The inverse of the model matrix. Only calculated when the entry is written.
+            bool has_normals;               //!< Specifies if the mesh has normals as a vertex attribute.
+            bool has_tangents;              //!< Specifies if the mesh has tangents as a vertex attribute.
+            bool has_quantized_attributes;  //!< Specifies if the vertex attributes of the mesh are quantized.
+            glm::vec3 position_offset;      //!< The minimum of the bounds the positions are quantized in.
+            glm::vec3 position_scale;       //!< The size of the bounds the positions are quantized in.
+            bool written;                   //!< True if the entry was written before.
+        };
+
+        //! \brief Switches to the other half of the object buffer and binds it for the frame.
+        void update_object_buffer();
+
+        //! \brief The shader storage buffer with the data of all models.
+        //! \details Split into two halves used in alternating frames, so entries are not overwritten while the gpu reads them.
+        //! Only entries with a changed model info are written.
+        buffer_ptr m_object_buffer;
+        //! \brief The mapped memory of the object buffer.
+        void* m_mapped_object_memory;
+        //! \brief The size of one half of the object buffer in bytes, aligned for binding.
+        ptr_size m_object_buffer_half_size;
+        //! \brief The half of the object buffer used in the current frame.
+        uint32 m_object_buffer_half;
+        //! \brief The number of entries in each half of the object buffer.
+        //! \details Entity ids start at 1 and are used as index directly, so the first entry is never written.
+        const uint32 object_entries = max_entities + 1;
+        //! \brief The model info written to the object buffer. Holds \a object_entries entries for each half.
+        std::vector<object_slot> m_object_slots;
+        //! \brief The object id of the next draw calls.
+        uint32 m_object_id;
+        //! \brief True if the draw index is passed as base instance and read via ARB_shader_draw_parameters, else it is set as uniform for each draw call.
+        bool m_draw_parameters;
+
+        //! \brief Data of one punctual light in the persistent light buffer. Uses the std430 layout.
+        struct scene_light_data
+        {
+            std140_vec4 position_range;        //!< The world space position (xyz) and the range (w) of the light.
+            std140_vec4 color_angle_offset;    //!< The color scaled by the intensity (rgb) and the offset of the spot falloff (w).
+            std140_vec4 direction_angle_scale; //!< The world space spot direction (xyz) and the scale of the spot falloff (w).
+        };
+
+        //! \brief Switches to the other half of the light buffer and binds it for the frame.
+        void update_light_buffer();
+
+        //! \brief Bins the lights of the frame into the clusters touched by the gbuffer depth.
+        void assign_lights_to_clusters();
+
+        //! \brief The maximum number of lights per frame.
+        const uint32 max_lights = 4096;
+        //! \brief The shader storage buffer with the lights submitted in the frame.
+        //! \details Split into two halves used in alternating frames, so lights are not overwritten while the gpu reads them.
+        buffer_ptr m_light_buffer;
+        //! \brief The mapped memory of the light buffer.
+        void* m_mapped_light_memory;
+        //! \brief The size of one half of the light buffer in bytes, aligned for binding.
+        ptr_size m_light_buffer_half_size;
+        //! \brief The half of the light buffer used in the current frame.
+        uint32 m_light_buffer_half;
+        //! \brief The number of lights submitted in the current frame.
+        uint32 m_light_count;
+
+        //! \brief The number of clusters in x direction. The clusters divide the screen into tiles.
+        const uint32 cluster_grid_x = 16;
+        //! \brief The number of clusters in y direction.
+        const uint32 cluster_grid_y = 9;
+        //! \brief The number of depth slices of the clusters. The slices are distributed exponentially between the near and the far plane.
+        const uint32 cluster_grid_z = 24;
+        //! \brief The maximum number of lights affecting one cluster. Further lights are ignored.
+        const uint32 max_lights_per_cluster = 256;
+        //! \brief Returns the definitions of the cluster grid for all programs using the light clusters.
+        //! \return The \a shader_defines describing the cluster grid.
+        std::vector<shader_define> get_light_cluster_defines() const;
+        //! \brief The shader storage buffer with the active flag and the number of lights of each cluster.
+        buffer_ptr m_cluster_buffer;
+        //! \brief The shader storage buffer with the light indices of each cluster.
+        buffer_ptr m_cluster_light_index_buffer;
+        //! \brief The compute \a shader_program marking the clusters containing visible pixels.
+        shader_program_ptr m_mark_active_clusters;
+        //! \brief The compute \a shader_program assigning the lights to the active clusters.
+        shader_program_ptr m_assign_lights;
+
+        //! \brief Data of one material in the persistent material buffer. Uses the std430 layout.
+        struct scene_material_data
         {
             std140_vec4 base_color;     //!< The base color (rgba). Also used as reflection color for metallic surfaces.
-            std140_vec3 emissive_color; //!< The emissive color of the material if existent, else (0, 0, 0).
+            std140_vec4 emissive_color; //!< The emissive color of the material if existent, else (0, 0, 0).
             g_float metallic;           //!< The metallic value of the material.
             g_float roughness;          //!< The roughness of the material.
+            g_float alpha_cutoff;       //!< Specifies the alpha cutoff value to render the material with.
+            g_float padding0;           //!< Padding needed for std430 layout.
 
-            std140_bool base_color_texture;         //!< Specifies, if the the base color texture is enabled.
-            std140_bool roughness_metallic_texture; //!< Specifies, if the component texture is enabled for the metallic value and the roughness value.
-            std140_bool occlusion_texture;          //!< Specifies, if the component texture is enabled for the occlusion value.
-            std140_bool packed_occlusion;           //!< Specifies, if the occlusion value is packed into the r channel of the roughness_metallic_texture.
-            std140_bool normal_texture;             //!< Specifies, if the normal texture is enabled.
-            std140_bool emissive_color_texture;     //!< Specifies, if the the emissive color texture is enabled.
-
-            g_int alpha_mode;     //!< Specifies the alpha mode to render the material with.
-            g_float alpha_cutoff; //!< Specifies the alpha cutoff value to render the material with.
+            //! \brief The bindless handles of the base color, roughness metallic, occlusion, normal and emissive color textures. 0 if not existent or not supported.
+            g_uint64 texture_handles[5];
+            g_uint64 padding1; //!< Padding needed for std430 layout.
+        };
 
-            g_float padding0; //!< Padding needed for st140 layout.
-            g_float padding1; //!< Padding needed for st140 layout.
+        //! \brief A material uploaded to the persistent material buffer.
+        struct material_slot
+        {
+            weak_ptr<material> mat;  //!< The uploaded material.
+            uint32 index;            //!< The index in the material buffer.
+            g_uint texture_names[5]; //!< The names of the textures when the material was uploaded. Used to detect changes by the \a texture_streaming.
         };
 
+        //! \brief Returns the index of a material in the persistent material buffer.
+        //! \details Materials are uploaded on first use. Their properties are not expected to change afterwards.
+        //! If streaming changed the textures of a material, it is uploaded to a fresh slot and the old one is released delayed.
+        //! \param[in] mat The material to get the index for.
+        //! \return The index of the material.
+        uint32 get_material_index(const material_ptr& mat);
+
+        //! \brief Frees the indices of released materials and binds the material buffer for the frame.
+        void update_material_buffer();
+
+        //! \brief The number of bits of the draw index used for the material index. The object index is stored in the upper bits.
+        const uint32 material_index_bits = 12;
+        //! \brief The maximum number of materials in the material buffer.
+        const uint32 max_materials = 1 << material_index_bits;
+        //! \brief The shader storage buffer with all materials in use.
+        buffer_ptr m_material_buffer;
+        //! \brief The mapped memory of the material buffer.
+        void* m_mapped_material_memory;
+        //! \brief The materials in the material buffer.
+        std::unordered_map<material*, material_slot> m_material_slots;
+        //! \brief The indices in the material buffer that are not used.
+        std::vector<uint32> m_free_material_indices;
+        //! \brief The indices of materials released in the last frame. They may still be read by the gpu.
+        std::vector<uint32> m_released_material_indices;
+        //! \brief The indices of materials replaced by a fresh slot in the current frame. They are released with the next update of the material buffer.
+        std::vector<uint32> m_replaced_material_indices;
+        //! \brief True if material textures are accessed via bindless handles, else they are bound for each draw call.
+        bool m_bindless_textures;
+
+        //! \brief The streaming of material textures. Nullptr if texture streaming is disabled.
+        shared_ptr<texture_streaming> m_texture_streaming;
+
+        //! \brief The model matrix of the next draw calls.
+        glm::mat4 m_model_matrix;
+        //! \brief The inverse of the model matrix of the next draw calls.
+        glm::mat4 m_inverse_model_matrix;
+        //! \brief The estimated screen space size in pixels of the model of the next draw calls.
+        float m_model_footprint;
+        //! \brief The depth in view space of the model of the next draw calls. Positive in front of the camera.
+        float m_model_view_depth;
+        //! \brief The position of the active camera in this frame.
+        glm::vec3 m_camera_position;
+        //! \brief The view matrix of the active camera in this frame.
+        glm::mat4 m_view_matrix;
+        //! \brief The projection matrix of the active camera in this frame.
+        glm::mat4 m_projection_matrix;
+        //! \brief The distance of the near (x) and the far (y) plane of the active camera in this frame.
+        glm::vec2 m_camera_planes;
+        //! \brief The vertical scale of the projection of the active camera in this frame.
+        float m_projection_scale;
+        //! \brief Specifies if the active camera in this frame uses a perspective projection.
+        bool m_perspective_projection;
+        //! \brief The x position of the viewport in pixels.
+        uint32 m_viewport_x;
+        //! \brief The y position of the viewport in pixels.
+        uint32 m_viewport_y;
+        //! \brief The width of the viewport in pixels.
+        uint32 m_viewport_width;
+        //! \brief The height of the viewport in pixels.
+        uint32 m_viewport_height;
+        //! \brief True if the viewport changed since the render targets were last adjusted to it.
+        bool m_viewport_changed;
+
+        //! \brief Adjusts the gbuffer and the lighting target to the viewport.
+        //! \details The targets are allocated in size buckets and only reallocated, if the viewport does not fit or uses less than half of them.
+        void resize_render_targets();
+
+        //! \brief Checks if all \a shader_programs of the pipeline finished compiling and linking.
+        //! \return True if all \a shader_programs can be used without blocking, else false.
+        bool shader_programs_ready();
+
+        //! \brief True if all \a shader_programs were ready once.
+        //! \details Reloads are built in the background and only swapped in between frames by finish_reload(), after is_reload_ready() reported them finished.
+        //! A swapped in program is completely linked, so the readiness is not checked again.
+        bool m_shader_programs_ready;
+        //! \brief True if the current frame only shows a loading screen, because \a shader_programs are still compiling.
+        bool m_loading_frame;
+
+        //! \brief Takes the state change counters of the recorded frame and resets them.
+        void update_state_change_statistics();
+        //! \brief The state change statistics of the last frame.
+        state_change_statistics m_state_change_statistics;
+
+        //! \brief Measures the gpu and cpu time of the passes.
+        shared_ptr<frame_profiler> m_frame_profiler;
+        //! \brief The number of frames the pass timings are kept for.
+        const uint32 profiled_frames = 120;
+
         //! \brief Optional additional steps of the deferred pipeline.
         shared_ptr<pipeline_step> m_pipeline_steps[mango::render_step::number_of_step_types];
     };
@@ -4,8 +4,11 @@
 //! \date      2020
 //! \copyright Apache License 2.0
 
+#include <algorithm>
+#include <core/window_system_impl.hpp>
 #include <rendering/pipelines/deferred_pbr_render_system.hpp>
 #include <rendering/render_system_impl.hpp>
+#include <stb_image_write.h>
 
 using namespace mango;
 
@@ -58,6 +61,42 @@ void render_system_impl::configure(const render_configuration& configuration)
     }
 }
 
+texture_streaming_statistics render_system_impl::get_texture_streaming_statistics()
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    return m_current_render_system->get_texture_streaming_statistics();
+}
+
+state_change_statistics render_system_impl::get_state_change_statistics()
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    return m_current_render_system->get_state_change_statistics();
+}
+
+std::vector<frame_timings> render_system_impl::get_frame_timings()
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    return m_current_render_system->get_frame_timings();
+}
+
+gbuffer_statistics render_system_impl::get_gbuffer_statistics()
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    return m_current_render_system->get_gbuffer_statistics();
+}
+
+overdraw_statistics render_system_impl::get_overdraw_statistics()
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    return m_current_render_system->get_overdraw_statistics();
+}
+
+occlusion_culling_statistics render_system_impl::get_occlusion_culling_statistics()
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    return m_current_render_system->get_occlusion_culling_statistics();
+}
+
 void render_system_impl::begin_render()
 {
     MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
@@ -76,16 +115,72 @@ void render_system_impl::set_viewport(uint32 x, uint32 y, uint32 width, uint32 h
     m_current_render_system->set_viewport(x, y, width, height);
 }
 
-void render_system_impl::set_model_info(const glm::mat4& model_matrix, bool has_normals, bool has_tangents)
+void render_system_impl::set_model_info(uint32 object_id, const glm::mat4& model_matrix, bool has_normals, bool has_tangents, bool has_quantized_attributes, const glm::vec3& position_offset,
+                                        const glm::vec3& position_scale)
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    m_current_render_system->set_model_info(object_id, model_matrix, has_normals, has_tangents, has_quantized_attributes, position_offset, position_scale);
+}
+
+bool render_system_impl::set_model_bounds(const glm::vec3& min_extents, const glm::vec3& max_extents)
 {
     MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
-    m_current_render_system->set_model_info(model_matrix, has_normals, has_tangents);
+    return m_current_render_system->set_model_bounds(min_extents, max_extents);
 }
 
-void render_system_impl::draw_mesh(const material_ptr& mat, primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count)
+void render_system_impl::draw_mesh(const vertex_array_ptr& vertex_array, const material_ptr& mat, primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count,
+                                   const shared_ptr<primitive_meshlets>& meshlets)
 {
     MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
-    m_current_render_system->draw_mesh(mat, topology, first, count, type, instance_count);
+    m_current_render_system->draw_mesh(vertex_array, mat, topology, first, count, type, instance_count, meshlets);
+}
+
+void render_system_impl::submit_light(const light_component& light, const glm::vec3& position, const glm::vec3& direction)
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    m_current_render_system->submit_light(light, position, direction);
+}
+
+void render_system_impl::set_gbuffer_layout(gbuffer_layout layout)
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    m_current_render_system->set_gbuffer_layout(layout);
+}
+
+void render_system_impl::set_depth_pre_pass(bool enabled)
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    m_current_render_system->set_depth_pre_pass(enabled);
+}
+
+void render_system_impl::set_front_to_back_sorting(bool enabled)
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    m_current_render_system->set_front_to_back_sorting(enabled);
+}
+
+void render_system_impl::set_overdraw_measurement(bool enabled)
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    m_current_render_system->set_overdraw_measurement(enabled);
+}
+
+void render_system_impl::set_occlusion_culling(bool enabled)
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    m_current_render_system->set_occlusion_culling(enabled);
+}
+
+void render_system_impl::set_meshlet_culling(bool enabled)
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    m_current_render_system->set_meshlet_culling(enabled);
+}
+
+void render_system_impl::set_target_frame_time(float milliseconds)
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    m_current_render_system->set_target_frame_time(milliseconds);
 }
 
 void render_system_impl::set_view_projection_matrix(const glm::mat4& view_projection)
@@ -94,10 +189,54 @@ void render_system_impl::set_view_projection_matrix(const glm::mat4& view_projec
     m_current_render_system->set_view_projection_matrix(view_projection);
 }
 
-void render_system_impl::set_environment_texture(const texture_ptr& hdr_texture, float render_level)
+void render_system_impl::set_environment_texture(const texture_ptr& hdr_texture, uint64 content_hash, float render_level)
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    m_current_render_system->set_environment_texture(hdr_texture, content_hash, render_level);
+}
+
+shared_ptr<texture_streaming> render_system_impl::get_texture_streaming()
+{
+    MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
+    return m_current_render_system->get_texture_streaming();
+}
+
+uint32 render_system_impl::get_render_height()
 {
     MANGO_ASSERT(m_current_render_system, "Current render sytem not valid!");
-    m_current_render_system->set_environment_texture(hdr_texture, render_level);
+    return m_current_render_system->get_render_height();
+}
+
+bool render_system_impl::write_screenshot(const string& path)
+{
+    shared_ptr<window_system_impl> ws = m_shared_context->get_window_system_internal().lock();
+    MANGO_ASSERT(ws, "Window System is expired!");
+    const uint32 width  = ws->get_width();
+    const uint32 height = ws->get_height();
+    const uint32 stride = width * 3;
+    std::vector<g_ubyte> pixels(static_cast<ptr_size>(stride) * height);
+
+    // the read framebuffer is restored, so the cached state of the command buffer stays valid.
+    g_int read_framebuffer = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_framebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, static_cast<g_sizei>(width), static_cast<g_sizei>(height), GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<g_uint>(read_framebuffer));
+
+    // OpenGl starts with the bottom row, png files with the top one.
+    std::vector<g_ubyte> flipped(pixels.size());
+    for (uint32 y = 0; y < height; ++y)
+        std::copy(pixels.begin() + static_cast<std::ptrdiff_t>(y * stride), pixels.begin() + static_cast<std::ptrdiff_t>((y + 1) * stride),
+                  flipped.begin() + static_cast<std::ptrdiff_t>((height - 1 - y) * stride));
+
+    if (!stbi_write_png(path.c_str(), static_cast<int>(width), static_cast<int>(height), 3, flipped.data(), static_cast<int>(stride)))
+    {
+        MANGO_LOG_ERROR("Could not write the screenshot to {0}!", path);
+        return false;
+    }
+    return true;
 }
 
 void render_system_impl::update(float dt)
@@ -11,10 +11,13 @@
 #include <glm/glm.hpp>
 #include <graphics/command_buffer.hpp>
 #include <mango/render_system.hpp>
+#include <mango/scene_types.hpp>
 #include <queue>
 
 namespace mango
 {
+    class texture_streaming;
+
     //! \brief The implementation of the \a render_system.
     //! \details This class only manages the configuration of the base \a render_system and forwards everything else to the real implementation of the specific configured one.
     class render_system_impl : public render_system
@@ -27,6 +30,12 @@ namespace mango
 
         virtual bool create() override;
         virtual void configure(const render_configuration& configuration) override;
+        virtual texture_streaming_statistics get_texture_streaming_statistics() override;
+        virtual state_change_statistics get_state_change_statistics() override;
+        virtual std::vector<frame_timings> get_frame_timings() override;
+        virtual gbuffer_statistics get_gbuffer_statistics() override;
+        virtual overdraw_statistics get_overdraw_statistics() override;
+        virtual occlusion_culling_statistics get_occlusion_culling_statistics() override;
 
         //! \brief Retrieves the \a command_buffer of a \a render_system.
         //! \details The \a command_buffer should be created and destroyed by the \a render_system.
@@ -64,19 +73,77 @@ namespace mango
         virtual render_pipeline get_base_render_pipeline();
 
         //! \brief Sets some model info for the next draw calls.
+        //! \param[in] object_id An id of the model unique in the current scene and smaller than \a max_entities. Used to keep the model info between frames.
         //! \param[in] model_matrix The model matrix for the next draw calls.
         //! \param[in] has_normals Specifies if the next mesh has normals as a vertex attribute
         //! \param[in] has_tangents Specifies if the next mesh has tangents as a vertex attribute
-        virtual void set_model_info(const glm::mat4& model_matrix, bool has_normals, bool has_tangents);
+        //! \param[in] has_quantized_attributes Specifies if the vertex attributes of the next mesh are quantized.
+        //! \param[in] position_offset The minimum of the bounds the positions of the next mesh are quantized in. Ignored without quantized attributes.
+        //! \param[in] position_scale The size of the bounds the positions of the next mesh are quantized in. Ignored without quantized attributes.
+        virtual void set_model_info(uint32 object_id, const glm::mat4& model_matrix, bool has_normals, bool has_tangents, bool has_quantized_attributes, const glm::vec3& position_offset,
+                                    const glm::vec3& position_scale);
+
+        //! \brief Sets the bounds of the model for the next draw calls.
+        //! \details The bounds are used to estimate the screen space footprint of the next draw calls.
+        //! \param[in] min_extents The minimum of the axis aligned bounding box of the model in model space.
+        //! \param[in] max_extents The maximum of the axis aligned bounding box of the model in model space.
+        //! \return True if the model can be visible, false if it is occluded and the next draw calls can be skipped.
+        virtual bool set_model_bounds(const glm::vec3& min_extents, const glm::vec3& max_extents);
 
         //! \brief Schedules drawing of a \a mesh with \a material.
+        //! \details The draw call can be reordered, so the \a vertex_array is bound by the \a render_system.
+        //! \param[in] vertex_array The \a vertex_array with the vertex data of the \a mesh.
         //! \param[in] mat The \a material for the next draw call.
-        //! \param[in] topology The topology used for drawing the bound vertex data.
+        //! \param[in] topology The topology used for drawing the vertex data.
         //! \param[in] first The first index to start drawing from.
         //! \param[in] count The number of indices to draw.
         //! \param[in] type The \a index_type of the values in the index buffer.
         //! \param[in] instance_count The number of instances to draw. For normal drawing pass 1.
-        virtual void draw_mesh(const material_ptr& mat, primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count = 1);
+        //! \param[in] meshlets The meshlets of the indices to draw, if they can be culled separately. Nullptr if the range is drawn completely.
+        virtual void draw_mesh(const vertex_array_ptr& vertex_array, const material_ptr& mat, primitive_topology topology, uint32 first, uint32 count, index_type type, uint32 instance_count = 1,
+                               const shared_ptr<primitive_meshlets>& meshlets = nullptr);
+
+        //! \brief Submits a punctual light for the current frame.
+        //! \details Lights have to be submitted each frame between begin_render() and finish_render().
+        //! \param[in] light The \a light_component describing the light.
+        //! \param[in] position The position of the light in world space.
+        //! \param[in] direction The normalized direction of the light in world space. Only used by spot lights.
+        virtual void submit_light(const light_component& light, const glm::vec3& position, const glm::vec3& direction);
+
+        //! \brief Changes the \a gbuffer_layout of the current \a render_system.
+        //! \details Overrides the layout of the \a render_configuration. Used to compare the layouts without changing the application.
+        //! \param[in] layout The \a gbuffer_layout to use.
+        virtual void set_gbuffer_layout(gbuffer_layout layout);
+
+        //! \brief Enables or disables the depth pre-pass of the current \a render_system.
+        //! \details Overrides the setting of the \a render_configuration. Used to measure the effect without changing the application.
+        //! \param[in] enabled True if the depth pre-pass should be rendered, else false.
+        virtual void set_depth_pre_pass(bool enabled);
+
+        //! \brief Enables or disables sorting opaque draws front to back in the current \a render_system.
+        //! \details Overrides the setting of the \a render_configuration.
+        //! \param[in] enabled True if opaque draws should be sorted, else false.
+        virtual void set_front_to_back_sorting(bool enabled);
+
+        //! \brief Enables or disables measuring the overdraw of the geometry pass in the current \a render_system.
+        //! \details Overrides the setting of the \a render_configuration.
+        //! \param[in] enabled True if the shaded fragments should be counted, else false.
+        virtual void set_overdraw_measurement(bool enabled);
+
+        //! \brief Enables or disables occlusion culling in the current \a render_system.
+        //! \details Overrides the setting of the \a render_configuration.
+        //! \param[in] enabled True if occluded models should be culled, else false.
+        virtual void set_occlusion_culling(bool enabled);
+
+        //! \brief Enables or disables culling the meshlets of dense primitives in the current \a render_system.
+        //! \details Overrides the setting of the \a render_configuration.
+        //! \param[in] enabled True if meshlets should be culled, else false.
+        virtual void set_meshlet_culling(bool enabled);
+
+        //! \brief Sets the gpu frame time the resolution of the current \a render_system is scaled for.
+        //! \details Overrides the setting of the \a render_configuration.
+        //! \param[in] milliseconds The target gpu time of a frame in milliseconds. 0 disables the dynamic resolution.
+        virtual void set_target_frame_time(float milliseconds);
 
         //! \brief Sets the view projection matrix for the next draw calls.
         //! \param[in] view_projection The view projection for the next draw calls.
@@ -84,8 +151,26 @@ namespace mango
 
         //! \brief Sets the \a texture for a environment.
         //! \param[in] hdr_texture The pointer to the hdr \a texture to use as an environment.
+        //! \param[in] content_hash A hash of the hdr image data, used to find precomputed data in caches.
         //! \param[in] render_level The level from the hdr \a texture to render. -1 means no rendering.
-        virtual void set_environment_texture(const texture_ptr& hdr_texture, float render_level);
+        virtual void set_environment_texture(const texture_ptr& hdr_texture, uint64 content_hash, float render_level);
+
+        //! \brief Retrieves the \a texture_streaming of the \a render_system.
+        //! \details Material textures should be added to it, so that only the required mipmap levels are resident.
+        //! \return The \a texture_streaming or nullptr if texture streaming is disabled.
+        virtual shared_ptr<texture_streaming> get_texture_streaming();
+
+        //! \brief Returns the height of the area the scene is rendered to in the current frame.
+        //! \details Differs from the window height if the resolution is scaled. Screen space sizes in the scene should be measured with this height.
+        //! \return The render height in pixels.
+        virtual uint32 get_render_height();
+
+        //! \brief Writes the content of the default framebuffer to a png file.
+        //! \details Reads back the color of the last rendered frame, so it has to be called after finish_render() and before the buffers are swapped.
+        //! This blocks until the gpu finished rendering.
+        //! \param[in] path The path of the png file to write.
+        //! \return True on success, else false.
+        virtual bool write_screenshot(const string& path);
 
       protected:
         //! \brief Mangos internal context for shared usage in all \a render_systems.
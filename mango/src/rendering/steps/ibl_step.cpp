@@ -4,12 +4,21 @@
 //! \date      2020
 //! \copyright Apache License 2.0
 
+#include <cstdio>
+#include <fstream>
+#include <glad/glad.h>
 #include <graphics/buffer.hpp>
 #include <graphics/shader.hpp>
 #include <graphics/shader_program.hpp>
 #include <graphics/texture.hpp>
 #include <graphics/vertex_array.hpp>
 #include <rendering/steps/ibl_step.hpp>
+#include <util/hashing.hpp>
+#if defined(LINUX)
+#include <sys/stat.h>
+#elif defined(WIN32)
+#include <direct.h>
+#endif
 
 using namespace mango;
 
@@ -21,6 +30,129 @@ static const uint8 cubemap_indices[18] = { 8, 9, 0, 2, 1, 3, 3, 2, 5, 4, 7, 6, 6
 //! \brief Default texture that is bound to every texture unit not in use to prevent warnings.
 texture_ptr default_ibl_texture;
 
+//! \brief The directory precomputed maps are stored in. Relative to project folder.
+static const string ibl_cache_directory = "res/ibl_cache/";
+//! \brief Identifies a file in the ibl cache.
+static const uint32 ibl_cache_magic = 0x4c42494d; // MIBL
+
+//! \brief Header of a file in the ibl cache.
+//! \details Followed by all levels of all maps as half float rgba texels, cubemap levels with all six faces.
+struct ibl_cache_header
+{
+    uint32 magic;  //!< Has to be ibl_cache_magic.
+    uint32 maps;   //!< The number of maps in the file.
+    uint64 key;    //!< The key of the maps.
+    uint64 length; //!< The length of the texel data in bytes.
+};
+
+//! \brief Returns the path of the ibl cache file for a key.
+//! \param[in] key The key of the maps.
+//! \return The path of the file.
+static string ibl_cache_path(uint64 key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.ibl", static_cast<unsigned long long>(key));
+    return ibl_cache_directory + name;
+}
+
+//! \brief Returns the size of a level of a map in the ibl cache.
+//! \param[in] map The map.
+//! \param[in] level The level of the map.
+//! \return The size of the texel data of the level in bytes.
+static ptr_size ibl_cache_level_size(const texture_ptr& map, uint32 level)
+{
+    ptr_size faces = map->is_cubemap() ? 6 : 1;
+    return static_cast<ptr_size>(glm::max(map->get_width() >> level, 1u)) * glm::max(map->get_height() >> level, 1u) * faces * 4 * sizeof(uint16);
+}
+
+//! \brief Loads maps from the ibl cache.
+//! \param[in] key The key of the maps.
+//! \param[in] maps The allocated rgba16f maps to upload the cached texels to.
+//! \return True if all maps were loaded, false if they are not cached.
+static bool load_cached_maps(uint64 key, const std::vector<texture_ptr>& maps)
+{
+    std::ifstream input_stream(ibl_cache_path(key), std::ios::in | std::ios::binary);
+    if (!input_stream)
+        return false;
+
+    ptr_size length = 0;
+    for (auto& map : maps)
+    {
+        for (uint32 level = 0; level < map->mipmaps(); ++level)
+            length += ibl_cache_level_size(map, level);
+    }
+
+    ibl_cache_header header;
+    input_stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!input_stream || header.magic != ibl_cache_magic || header.maps != maps.size() || header.key != key || header.length != length)
+        return false;
+
+    std::vector<char> texels(length);
+    input_stream.read(texels.data(), static_cast<std::streamsize>(length));
+    if (!input_stream)
+        return false;
+
+    ptr_size offset = 0;
+    for (auto& map : maps)
+    {
+        for (uint32 level = 0; level < map->mipmaps(); ++level)
+        {
+            g_sizei width  = static_cast<g_sizei>(glm::max(map->get_width() >> level, 1u));
+            g_sizei height = static_cast<g_sizei>(glm::max(map->get_height() >> level, 1u));
+            // the faces of a cubemap are uploaded as layers.
+            if (map->is_cubemap())
+                glTextureSubImage3D(map->get_name(), static_cast<g_int>(level), 0, 0, 0, width, height, 6, GL_RGBA, GL_HALF_FLOAT, texels.data() + offset);
+            else
+                glTextureSubImage2D(map->get_name(), static_cast<g_int>(level), 0, 0, width, height, GL_RGBA, GL_HALF_FLOAT, texels.data() + offset);
+            offset += ibl_cache_level_size(map, level);
+        }
+    }
+    return true;
+}
+
+//! \brief Stores maps in the ibl cache.
+//! \details Reads the maps back synchronously, so this should only be done after expensive precomputations.
+//! \param[in] key The key of the maps.
+//! \param[in] maps The rgba16f maps to store.
+static void store_cached_maps(uint64 key, const std::vector<texture_ptr>& maps)
+{
+    // the maps are written by image stores.
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+    std::vector<char> texels;
+    for (auto& map : maps)
+    {
+        for (uint32 level = 0; level < map->mipmaps(); ++level)
+        {
+            ptr_size offset = texels.size();
+            ptr_size size   = ibl_cache_level_size(map, level);
+            texels.resize(offset + size);
+            glGetTextureImage(map->get_name(), static_cast<g_int>(level), GL_RGBA, GL_HALF_FLOAT, static_cast<g_sizei>(size), texels.data() + offset);
+        }
+    }
+
+    ibl_cache_header header;
+    header.magic  = ibl_cache_magic;
+    header.maps   = static_cast<uint32>(maps.size());
+    header.key    = key;
+    header.length = texels.size();
+
+#if defined(LINUX)
+    mkdir(ibl_cache_directory.c_str(), 0755);
+#elif defined(WIN32)
+    _mkdir(ibl_cache_directory.c_str());
+#endif
+
+    std::ofstream output_stream(ibl_cache_path(key), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!output_stream)
+    {
+        MANGO_LOG_WARN("Can not write image based light maps to cache directory {0}!", ibl_cache_directory);
+        return;
+    }
+    output_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output_stream.write(texels.data(), static_cast<std::streamsize>(texels.size()));
+}
+
 bool ibl_step::create()
 {
     // compute shader to convert from equirectangular projected hdr textures to a cube map.
@@ -92,6 +224,20 @@ bool ibl_step::create()
         return false;
     }
 
+    // the cached maps are only valid for the same precomputation, so the sources and sizes are part of the keys.
+    fnv1a environment_hash;
+    for (auto& s : { to_cube_compute, irradiance_map_compute, specular_prefiltered_map_compute })
+        environment_hash(s->get_source().data(), s->get_source().size());
+    const uint32 environment_sizes[] = { m_cube_width, m_cube_height, m_irradiance_width, m_irradiance_height, m_prefiltered_base_width, m_prefiltered_base_height };
+    environment_hash(environment_sizes, sizeof(environment_sizes));
+    m_cache_key = static_cast<uint64>(static_cast<std::size_t>(environment_hash));
+
+    fnv1a lut_hash;
+    lut_hash(brdf_integration_compute->get_source().data(), brdf_integration_compute->get_source().size());
+    const uint32 lut_sizes[] = { m_integration_lut_width, m_integration_lut_height };
+    lut_hash(lut_sizes, sizeof(lut_sizes));
+    uint64 lut_key = static_cast<uint64>(static_cast<std::size_t>(lut_hash));
+
     // cubemap rendering
     shader_config.m_path      = "res/shader/v_cubemap.glsl";
     shader_config.m_type      = shader_type::VERTEX_SHADER;
@@ -153,25 +299,30 @@ bool ibl_step::create()
     m_brdf_integration_lut                   = texture::create(texture_config);
     m_brdf_integration_lut->set_data(format::RGBA16F, m_integration_lut_width, m_integration_lut_height, format::RGBA, format::FLOAT, nullptr);
 
-    // creating a temporal command buffer for compute shader execution.
-    command_buffer_ptr compute_commands = command_buffer::create();
+    if (!load_cached_maps(lut_key, { m_brdf_integration_lut }))
+    {
+        // creating a temporal command buffer for compute shader execution.
+        command_buffer_ptr compute_commands = command_buffer::create();
 
-    // build integration look up texture
-    compute_commands->bind_shader_program(m_build_integration_lut);
+        // build integration look up texture
+        compute_commands->bind_shader_program(m_build_integration_lut);
 
-    // bind output lut
-    compute_commands->bind_image_texture(0, m_brdf_integration_lut, 0, false, 0, base_access::WRITE_ONLY, format::RGBA16F);
-    // bind uniforms
-    glm::vec2 out = glm::vec2(m_brdf_integration_lut->get_width(), m_brdf_integration_lut->get_height());
-    compute_commands->bind_single_uniform(0, &(out), sizeof(out));
-    // execute compute
-    compute_commands->dispatch_compute(m_brdf_integration_lut->get_width() / 8, m_brdf_integration_lut->get_height() / 8, 1);
+        // bind output lut
+        compute_commands->bind_image_texture(0, m_brdf_integration_lut, 0, false, 0, base_access::WRITE_ONLY, format::RGBA16F);
+        // bind uniforms
+        glm::vec2 out = glm::vec2(m_brdf_integration_lut->get_width(), m_brdf_integration_lut->get_height());
+        compute_commands->bind_single_uniform(0, &(out), sizeof(out));
+        // execute compute
+        compute_commands->dispatch_compute(m_brdf_integration_lut->get_width() / 8, m_brdf_integration_lut->get_height() / 8, 1);
 
-    compute_commands->add_memory_barrier(memory_barrier_bit::SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        compute_commands->add_memory_barrier(memory_barrier_bit::SHADER_IMAGE_ACCESS_BARRIER_BIT);
 
-    compute_commands->bind_shader_program(nullptr);
+        compute_commands->bind_shader_program(nullptr);
 
-    compute_commands->execute();
+        compute_commands->execute();
+
+        store_cached_maps(lut_key, { m_brdf_integration_lut });
+    }
 
     // default texture needed
     texture_config.m_texture_min_filter = texture_parameter::FILTER_NEAREST;
@@ -198,7 +349,7 @@ void ibl_step::attach() {}
 
 void ibl_step::execute(command_buffer_ptr& command_buffer)
 {
-    if (m_render_level < 0.0f || !m_cubemap)
+    if (m_render_level < 0.0f || !m_prefiltered_specular)
         return;
 
     command_buffer->bind_shader_program(m_draw_environment);
@@ -214,12 +365,17 @@ void ibl_step::execute(command_buffer_ptr& command_buffer)
     command_buffer->bind_shader_program(nullptr);
 }
 
+std::vector<shader_program_ptr> ibl_step::get_shader_programs()
+{
+    return { m_equi_to_cubemap, m_build_irradiance_map, m_build_specular_prefiltered_map, m_build_integration_lut, m_draw_environment };
+}
+
 void ibl_step::destroy() {}
 
-void ibl_step::load_from_hdr(const texture_ptr& hdr_texture)
+void ibl_step::load_from_hdr(const texture_ptr& hdr_texture, uint64 content_hash)
 {
     texture_configuration texture_config;
-    texture_config.m_generate_mipmaps        = calculate_mip_count(m_cube_width, m_cube_height);
+    texture_config.m_generate_mipmaps        = calculate_mip_count(m_prefiltered_base_width, m_prefiltered_base_height);
     texture_config.m_is_standard_color_space = false;
     texture_config.m_is_cubemap              = true;
     texture_config.m_texture_min_filter      = texture_parameter::FILTER_LINEAR_MIPMAP_LINEAR;
@@ -227,11 +383,7 @@ void ibl_step::load_from_hdr(const texture_ptr& hdr_texture)
     texture_config.m_texture_wrap_s          = texture_parameter::WRAP_CLAMP_TO_EDGE;
     texture_config.m_texture_wrap_t          = texture_parameter::WRAP_CLAMP_TO_EDGE;
 
-    m_cubemap = texture::create(texture_config);
-    m_cubemap->set_data(format::RGBA16F, m_cube_width, m_cube_height, format::RGBA, format::FLOAT, nullptr);
-
-    texture_config.m_generate_mipmaps = calculate_mip_count(m_prefiltered_base_width, m_prefiltered_base_height);
-    m_prefiltered_specular            = texture::create(texture_config);
+    m_prefiltered_specular = texture::create(texture_config);
     m_prefiltered_specular->set_data(format::RGBA16F, m_prefiltered_base_width, m_prefiltered_base_height, format::RGBA, format::FLOAT, nullptr);
 
     texture_config.m_generate_mipmaps   = 1;
@@ -239,6 +391,22 @@ void ibl_step::load_from_hdr(const texture_ptr& hdr_texture)
     m_irradiance_map                    = texture::create(texture_config);
     m_irradiance_map->set_data(format::RGBA16F, m_irradiance_width, m_irradiance_height, format::RGBA, format::FLOAT, nullptr);
 
+    fnv1a key_hash;
+    key_hash(&m_cache_key, sizeof(m_cache_key));
+    key_hash(&content_hash, sizeof(content_hash));
+    uint64 key = static_cast<uint64>(static_cast<std::size_t>(key_hash));
+    if (load_cached_maps(key, { m_irradiance_map, m_prefiltered_specular }))
+    {
+        // the cubemap is only the input of the precomputation, the skybox is rendered from the prefiltered specular map.
+        m_cubemap = nullptr;
+        return;
+    }
+
+    texture_config.m_generate_mipmaps   = calculate_mip_count(m_cube_width, m_cube_height);
+    texture_config.m_texture_min_filter = texture_parameter::FILTER_LINEAR_MIPMAP_LINEAR;
+    m_cubemap                           = texture::create(texture_config);
+    m_cubemap->set_data(format::RGBA16F, m_cube_width, m_cube_height, format::RGBA, format::FLOAT, nullptr);
+
     glm::vec2 out;
 
     // creating a temporal command buffer for compute shader execution.
@@ -301,11 +469,13 @@ void ibl_step::load_from_hdr(const texture_ptr& hdr_texture)
     compute_commands->bind_shader_program(nullptr);
 
     compute_commands->execute();
+
+    store_cached_maps(key, { m_irradiance_map, m_prefiltered_specular });
 }
 
 void ibl_step::bind_image_based_light_maps(command_buffer_ptr& command_buffer)
 {
-    if (m_cubemap)
+    if (m_prefiltered_specular)
     {
         command_buffer->bind_texture(5, m_irradiance_map, 7);       // TODO Paul: Binding and location...
         command_buffer->bind_texture(6, m_prefiltered_specular, 8); // TODO Paul: Binding and location...
@@ -20,13 +20,16 @@ namespace mango
 
         void attach() override;
         void execute(command_buffer_ptr& command_buffer) override;
+        std::vector<shader_program_ptr> get_shader_programs() override;
 
         void destroy() override;
 
         //! \brief Loads and creates an image based light step from a hdr texture.
         //! \details Creates irradiance map and prefiltered specular map.
+        //! The maps are stored in a cache on disk and loaded from there, if the same hdr image was used before.
         //! \param[in] hdr_texture The texture with the hdr image data.
-        void load_from_hdr(const texture_ptr& hdr_texture);
+        //! \param[in] content_hash A hash of the hdr image data. Identifies the cached maps together with the parameters of the precomputation.
+        void load_from_hdr(const texture_ptr& hdr_texture, uint64 content_hash);
 
         //! \brief Sets the mip level to render that environment with.
         //! \details For higher values the prefiltered specular filtered map is used.
@@ -76,6 +79,9 @@ namespace mango
         glm::mat4 m_view_projection;
         //! \brief The miplevel to render th cubemap with.
         float m_render_level;
+        //! \brief The hash of the precomputation shaders and parameters.
+        //! \details Combined with the content hash of a hdr image it identifies the cached maps.
+        uint64 m_cache_key = 0;
 
         //! \brief The width of one cubemap face.
         const uint32 m_cube_width = 1024;
@@ -10,6 +10,7 @@
 #include <graphics/command_buffer.hpp>
 #include <mango/system.hpp>
 #include <mango/types.hpp>
+#include <vector>
 
 namespace mango
 {
@@ -25,6 +26,10 @@ namespace mango
         //! \param[in] command_buffer The buffer given by the \a render to execute into.
         virtual void execute(command_buffer_ptr& command_buffer) = 0;
 
+        //! \brief Retrieves all \a shader_programs used by the step.
+        //! \return A list of pointers to the \a shader_programs of the step.
+        virtual std::vector<shader_program_ptr> get_shader_programs() = 0;
+
       protected:
         virtual bool create()         = 0;
         virtual void update(float dt) = 0;
@@ -0,0 +1,206 @@
+//! \file      texture_streaming.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <cstring>
+#include <rendering/texture_streaming.hpp>
+#include <vector>
+
+using namespace mango;
+
+texture_streaming::texture_streaming(ptr_size memory_budget)
+    : m_memory_budget(memory_budget)
+    , m_resident_memory(0)
+    , m_frame(1)
+{
+    std::memset(&m_statistics, 0, sizeof(m_statistics));
+    m_statistics.memory_budget = m_memory_budget;
+}
+
+texture_streaming::~texture_streaming() {}
+
+void texture_streaming::add_texture(const texture_ptr& tex, format internal_format, uint32 width, uint32 height, format pixel_format, format type, const void* data)
+{
+    MANGO_ASSERT(tex, "Texture is not valid!");
+
+    auto it = m_textures.find(tex.get());
+    if (it != m_textures.end())
+    {
+        MANGO_ASSERT(it->second.streamed.expired(), "Texture is already streamed!");
+        // a released texture had the same address.
+        m_resident_memory -= it->second.resident_memory;
+        m_textures.erase(it);
+    }
+
+    // the smallest levels are always resident.
+    uint32 base_level = 0;
+    while ((glm::max(width, height) >> base_level) > base_resident_size && base_level + 1 < tex->mipmaps())
+        ++base_level;
+
+    tex->set_streamed_data(internal_format, width, height, pixel_format, type, data, base_level);
+    if (!tex->is_streamed())
+        return;
+    // the initial storage was never used for rendering.
+    tex->release_retired_storage();
+
+    streamed_texture st;
+    st.streamed             = tex;
+    st.base_level           = base_level;
+    st.requested_level      = base_level;
+    st.resident_memory      = tex->level_memory(tex->resident_level());
+    st.last_requested_frame = 0;
+
+    m_resident_memory += st.resident_memory;
+    m_textures.insert({ tex.get(), st });
+}
+
+void texture_streaming::request(const texture_ptr& tex, float footprint)
+{
+    if (!tex || !tex->is_streamed())
+        return;
+
+    auto it = m_textures.find(tex.get());
+    if (it == m_textures.end() || it->second.streamed.expired())
+        return;
+
+    streamed_texture& st = it->second;
+
+    // one texel per pixel is enough, so every halving of the footprint drops one level.
+    const float largest_size = static_cast<float>(glm::max(tex->get_width(), tex->get_height()));
+    uint32 level             = 0;
+    if (footprint < largest_size)
+        level = static_cast<uint32>(glm::log2(largest_size / glm::max(footprint, 1.0f)));
+    level = glm::min(level, st.base_level);
+
+    if (st.last_requested_frame != m_frame)
+    {
+        st.requested_level      = level;
+        st.last_requested_frame = m_frame;
+    }
+    else
+        st.requested_level = glm::min(st.requested_level, level);
+}
+
+void texture_streaming::update()
+{
+    m_statistics.uploaded_levels  = 0;
+    m_statistics.evicted_levels   = 0;
+    m_statistics.starved_textures = 0;
+
+    // the frames sampling the storage replaced in the last update are finished now, textures with evicted levels still in transfer are kept.
+    for (auto it = m_retired_textures.begin(); it != m_retired_textures.end();)
+    {
+        texture_ptr tex = it->lock();
+        if (tex && !tex->release_retired_storage())
+            ++it;
+        else
+            it = m_retired_textures.erase(it);
+    }
+
+    // released textures do not occupy memory anymore.
+    for (auto it = m_textures.begin(); it != m_textures.end();)
+    {
+        if (it->second.streamed.expired())
+        {
+            m_resident_memory -= it->second.resident_memory;
+            it = m_textures.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    // textures requested in the last frame with missing levels, the ones missing the most levels first.
+    std::vector<std::pair<uint32, texture*>> promotions;
+    for (auto& entry : m_textures)
+    {
+        const streamed_texture& st = entry.second;
+        uint32 resident            = entry.first->resident_level();
+        if (st.last_requested_frame == m_frame && st.requested_level < resident)
+            promotions.push_back({ resident - st.requested_level, entry.first });
+    }
+    std::sort(promotions.begin(), promotions.end(), [](const std::pair<uint32, texture*>& a, const std::pair<uint32, texture*>& b) { return a.first > b.first; });
+
+    uint32 uploads = 0;
+    for (auto& promotion : promotions)
+    {
+        if (uploads >= max_uploads_per_update)
+        {
+            m_statistics.starved_textures++;
+            continue;
+        }
+
+        streamed_texture& st = m_textures.at(promotion.second);
+        texture_ptr tex      = st.streamed.lock();
+
+        ptr_size memory   = tex->level_memory(st.requested_level);
+        ptr_size required = memory - st.resident_memory;
+        if (m_resident_memory + required > m_memory_budget && !evict(m_resident_memory + required - m_memory_budget, promotion.second))
+        {
+            m_statistics.starved_textures++;
+            continue;
+        }
+
+        m_statistics.uploaded_levels += tex->resident_level() - st.requested_level;
+        tex->set_resident_level(st.requested_level);
+        m_retired_textures.push_back(tex);
+        m_resident_memory += required;
+        st.resident_memory = memory;
+        ++uploads;
+    }
+
+    m_statistics.streamed_textures = static_cast<uint32>(m_textures.size());
+    m_statistics.resident_levels   = 0;
+    m_statistics.total_levels      = 0;
+    for (auto& entry : m_textures)
+    {
+        m_statistics.resident_levels += entry.first->mipmaps() - entry.first->resident_level();
+        m_statistics.total_levels += entry.first->mipmaps();
+    }
+    m_statistics.resident_memory = m_resident_memory;
+    m_statistics.memory_budget   = m_memory_budget;
+
+    // requests from now on belong to the next frame.
+    ++m_frame;
+}
+
+bool texture_streaming::evict(ptr_size required, texture* exclude)
+{
+    // Textures not requested in the last frame only keep their base level, requested ones only the requested levels.
+    auto keep_level = [this](const streamed_texture& st) { return st.last_requested_frame == m_frame ? st.requested_level : st.base_level; };
+
+    // candidates are evicted in least recently used order.
+    std::vector<std::pair<uint64, texture*>> candidates;
+    for (auto& entry : m_textures)
+    {
+        if (entry.first == exclude)
+            continue;
+        if (entry.first->resident_level() < keep_level(entry.second))
+            candidates.push_back({ entry.second.last_requested_frame, entry.first });
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const std::pair<uint64, texture*>& a, const std::pair<uint64, texture*>& b) { return a.first < b.first; });
+
+    ptr_size freed = 0;
+    for (auto& candidate : candidates)
+    {
+        if (freed >= required)
+            break;
+
+        streamed_texture& st = m_textures.at(candidate.second);
+        texture_ptr tex      = st.streamed.lock();
+        uint32 level         = keep_level(st);
+
+        m_statistics.evicted_levels += level - tex->resident_level();
+        tex->set_resident_level(level);
+        m_retired_textures.push_back(tex);
+
+        ptr_size memory = tex->level_memory(level);
+        freed += st.resident_memory - memory;
+        m_resident_memory -= st.resident_memory - memory;
+        st.resident_memory = memory;
+    }
+
+    return freed >= required;
+}
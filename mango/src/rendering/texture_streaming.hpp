@@ -0,0 +1,102 @@
+//! \file      texture_streaming.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_TEXTURE_STREAMING_HPP
+#define MANGO_TEXTURE_STREAMING_HPP
+
+#include <graphics/texture.hpp>
+#include <mango/render_system.hpp>
+#include <unordered_map>
+
+namespace mango
+{
+    //! \brief Manages the mipmap levels of streamed \a textures resident on the gpu.
+    //! \details Textures start with only the low resolution levels resident.
+    //! During rendering the screen space footprint of each \a texture is requested and more detailed levels are made resident in the next update.
+    //! The resident levels of all \a textures are limited by a memory budget. If the budget is exceeded, the least recently used \a textures get evicted to lower levels.
+    class texture_streaming
+    {
+      public:
+        //! \brief Constructs the \a texture_streaming.
+        //! \param[in] memory_budget The gpu memory budget for all streamed \a textures in bytes.
+        texture_streaming(ptr_size memory_budget);
+        ~texture_streaming();
+
+        //! \brief Sets the data of a \a texture and adds it to the streamed ones.
+        //! \details Only the levels with a size smaller or equal to \a base_resident_size are uploaded initially.
+        //! If the data can not be streamed, the complete \a texture is uploaded and it is not managed by the \a texture_streaming.
+        //! \param[in] tex The \a texture to set the data for.
+        //! \param[in] internal_format The internal \a texture \a format to use.
+        //! \param[in] width The width of the \a texture.
+        //! \param[in] height The height of the \a texture.
+        //! \param[in] pixel_format The pixel \a format.
+        //! \param[in] type The type of the data.
+        //! \param[in] data The data of the most detailed level.
+        void add_texture(const texture_ptr& tex, format internal_format, uint32 width, uint32 height, format pixel_format, format type, const void* data);
+
+        //! \brief Requests the levels required to render a \a texture with a specific screen space footprint in this frame.
+        //! \details Multiple requests for the same \a texture in one frame are combined, the most detailed one is used.
+        //! \param[in] tex The \a texture used for rendering.
+        //! \param[in] footprint The screen space size of the rendered object in pixels.
+        void request(const texture_ptr& tex, float footprint);
+
+        //! \brief Makes the requested levels resident and evicts levels to stay in the memory budget.
+        //! \details Has to be called once per frame before recording any draw calls.
+        //! Uses the requests of the last frame. Storage replaced in the last update is released, the frames using it are finished by then.
+        void update();
+
+        //! \brief Sets the gpu memory budget for all streamed \a textures.
+        //! \param[in] memory_budget The budget in bytes.
+        inline void set_memory_budget(ptr_size memory_budget)
+        {
+            m_memory_budget = memory_budget;
+        }
+
+        //! \brief Returns the statistics of the last update.
+        //! \return The current \a texture_streaming_statistics.
+        inline const texture_streaming_statistics& get_statistics() const
+        {
+            return m_statistics;
+        }
+
+      private:
+        //! \brief Information about a streamed \a texture.
+        struct streamed_texture
+        {
+            weak_ptr<texture> streamed;  //!< The streamed \a texture.
+            uint32 base_level;           //!< The level that is always resident.
+            uint32 requested_level;      //!< The most detailed level requested in the current frame.
+            ptr_size resident_memory;    //!< The gpu memory occupied by the resident levels in bytes.
+            uint64 last_requested_frame; //!< The frame the \a texture was requested last time.
+        };
+
+        //! \brief Evicts levels of the least recently used \a textures until the required memory is free.
+        //! \param[in] required The memory in bytes that should be available in the budget.
+        //! \param[in] exclude The \a texture that should not be evicted.
+        //! \return True if enough memory could be freed, else false.
+        bool evict(ptr_size required, texture* exclude);
+
+        //! \brief All streamed \a textures.
+        std::unordered_map<texture*, streamed_texture> m_textures;
+        //! \brief The \a textures with storage replaced in the current update. It is released in the next one, or later if evicted levels are still copied back.
+        std::vector<weak_ptr<texture>> m_retired_textures;
+        //! \brief The gpu memory budget for all streamed \a textures in bytes.
+        ptr_size m_memory_budget;
+        //! \brief The gpu memory currently occupied by all streamed \a textures in bytes.
+        ptr_size m_resident_memory;
+        //! \brief The current frame.
+        uint64 m_frame;
+        //! \brief The statistics of the last update.
+        texture_streaming_statistics m_statistics;
+
+        //! \brief The size in pixels the levels that are always resident are smaller than or equal to.
+        const uint32 base_resident_size = 64;
+        //! \brief The maximum number of \a textures made more detailed in one update. Limits the upload cost per frame.
+        const uint32 max_uploads_per_update = 4;
+    };
+} // namespace mango
+
+#endif // MANGO_TEXTURE_STREAMING_HPP
@@ -0,0 +1,119 @@
+//! \file      file_watcher.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <mango/log.hpp>
+#include <resources/file_watcher.hpp>
+#if defined(LINUX)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace mango;
+
+//! \brief Splits a path into the directory and the file name.
+//! \param[in] path The path to split.
+//! \param[out] directory The directory of the file. "." if the path has none.
+//! \param[out] file_name The name of the file.
+static void split_path(const string& path, string& directory, string& file_name);
+
+file_watcher::file_watcher()
+    : m_inotify(-1)
+{
+#if defined(LINUX)
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0)
+    {
+        MANGO_LOG_ERROR("Could not initialize inotify! Files are not watched!");
+    }
+#else
+    MANGO_LOG_WARN("File watching is not supported on this platform! Files are not watched!");
+#endif
+}
+
+file_watcher::~file_watcher()
+{
+#if defined(LINUX)
+    if (m_inotify >= 0)
+        close(m_inotify);
+#endif
+}
+
+void file_watcher::watch(const string& path)
+{
+    string directory, file_name;
+    split_path(path, directory, file_name);
+    string normalized = directory + "/" + file_name;
+    if (m_files.find(normalized) != m_files.end())
+        return;
+    m_files.insert({ normalized, path });
+
+#if defined(LINUX)
+    if (m_inotify < 0)
+        return;
+
+    auto it = std::find_if(m_directories.begin(), m_directories.end(), [&directory](const std::pair<const int32, string>& d) { return d.second == directory; });
+    if (it != m_directories.end())
+        return;
+
+    // files are usually replaced on save, so the directory is watched instead of the file.
+    int32 descriptor = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (descriptor < 0)
+    {
+        MANGO_LOG_ERROR("Could not watch directory {0}!", directory);
+        return;
+    }
+    m_directories.insert({ descriptor, directory });
+#endif
+}
+
+void file_watcher::poll(std::vector<string>& changed_files)
+{
+#if defined(LINUX)
+    if (m_inotify < 0)
+        return;
+
+    alignas(inotify_event) char buffer[4096];
+    while (true)
+    {
+        ssize_t length = read(m_inotify, buffer, sizeof(buffer));
+        if (length <= 0)
+            break; // no more events.
+
+        for (char* ptr = buffer; ptr < buffer + length;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            auto dir = m_directories.find(event->wd);
+            if (event->len == 0 || dir == m_directories.end())
+                continue;
+
+            auto file = m_files.find(dir->second + "/" + event->name);
+            if (file == m_files.end())
+                continue;
+
+            if (std::find(changed_files.begin(), changed_files.end(), file->second) == changed_files.end())
+                changed_files.push_back(file->second);
+        }
+    }
+#else
+    MANGO_UNUSED(changed_files);
+#endif
+}
+
+static void split_path(const string& path, string& directory, string& file_name)
+{
+    auto separator = path.find_last_of("\\/");
+    if (separator == string::npos)
+    {
+        directory = ".";
+        file_name = path;
+        return;
+    }
+    directory = path.substr(0, separator);
+    file_name = path.substr(separator + 1);
+}
@@ -0,0 +1,44 @@
+//! \file      file_watcher.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_FILE_WATCHER_HPP
+#define MANGO_FILE_WATCHER_HPP
+
+#include <mango/types.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace mango
+{
+    //! \brief Watches files for modifications on disk.
+    //! \details Uses inotify on linux. The directories of the watched files are observed, so files replaced by editors are also detected.
+    //! On other platforms no modifications are reported.
+    class file_watcher
+    {
+      public:
+        file_watcher();
+        ~file_watcher();
+
+        //! \brief Adds a file to the watched ones.
+        //! \param[in] path The path to the file. Relative to the project folder.
+        void watch(const string& path);
+
+        //! \brief Retrieves all watched files modified since the last call.
+        //! \details Does not block. Multiple modifications of the same file are reported once.
+        //! \param[out] changed_files The paths of the modified files, as they were passed to watch().
+        void poll(std::vector<string>& changed_files);
+
+      private:
+        //! \brief The inotify instance. -1 if not available.
+        int32 m_inotify;
+        //! \brief Mapping from watch descriptors to the watched directories.
+        std::unordered_map<int32, string> m_directories;
+        //! \brief Mapping from normalized file paths to the paths passed to watch().
+        std::unordered_map<string, string> m_files;
+    };
+} // namespace mango
+
+#endif // MANGO_FILE_WATCHER_HPP
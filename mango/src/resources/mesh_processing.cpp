@@ -0,0 +1,754 @@
+//! \file      mesh_processing.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/packing.hpp>
+#include <mango/assert.hpp>
+#include <resources/mesh_processing.hpp>
+#include <unordered_map>
+
+using namespace mango;
+
+//! \brief A symmetric 4x4 matrix summing the squared distances to a set of planes.
+struct quadric
+{
+    double a2, ab, ac, ad; //!< The first row.
+    double b2, bc, bd;     //!< The second row without the symmetric part.
+    double c2, cd;         //!< The third row without the symmetric part.
+    double d2;             //!< The last element.
+    double weight;         //!< The sum of the weights of all planes.
+};
+
+//! \brief Creates the \a quadric of a weighted plane.
+//! \param[in] normal The normalized plane normal.
+//! \param[in] distance The signed distance of the plane to the origin.
+//! \param[in] weight The weight of the plane.
+//! \return The \a quadric.
+static quadric plane_quadric(const glm::vec3& normal, float distance, float weight)
+{
+    double a = normal.x, b = normal.y, c = normal.z, d = distance, w = weight;
+    quadric q;
+    q.a2     = w * a * a;
+    q.ab     = w * a * b;
+    q.ac     = w * a * c;
+    q.ad     = w * a * d;
+    q.b2     = w * b * b;
+    q.bc     = w * b * c;
+    q.bd     = w * b * d;
+    q.c2     = w * c * c;
+    q.cd     = w * c * d;
+    q.d2     = w * d * d;
+    q.weight = w;
+    return q;
+}
+
+//! \brief Adds one \a quadric to another.
+//! \param[in,out] q The \a quadric to add to.
+//! \param[in] r The \a quadric to add.
+static void add_quadric(quadric& q, const quadric& r)
+{
+    q.a2 += r.a2;
+    q.ab += r.ab;
+    q.ac += r.ac;
+    q.ad += r.ad;
+    q.b2 += r.b2;
+    q.bc += r.bc;
+    q.bd += r.bd;
+    q.c2 += r.c2;
+    q.cd += r.cd;
+    q.d2 += r.d2;
+    q.weight += r.weight;
+}
+
+//! \brief Evaluates the mean squared distance of a point to the planes of a \a quadric.
+//! \param[in] q The \a quadric.
+//! \param[in] p The point.
+//! \return The mean squared distance.
+static double evaluate_quadric(const quadric& q, const glm::vec3& p)
+{
+    double x = p.x, y = p.y, z = p.z;
+    double e = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z + 2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z + q.ad * x + q.bd * y + q.cd * z) + q.d2;
+    return q.weight > 0.0 ? std::max(e, 0.0) / q.weight : 0.0;
+}
+
+//! \brief Checks if moving a vertex flips or degenerates any triangle around it.
+//! \param[in] indices The indices of the triangle list.
+//! \param[in] positions The positions of the vertices.
+//! \param[in] triangles The triangles around the vertex.
+//! \param[in] triangle_count The number of triangles around the vertex.
+//! \param[in] from The vertex to move.
+//! \param[in] to The vertex to move onto.
+//! \return True if the collapse keeps all remaining triangles oriented, else false.
+static bool keeps_orientation(const std::vector<uint32>& indices, const std::vector<glm::vec3>& positions, const uint32* triangles, uint32 triangle_count, uint32 from, uint32 to)
+{
+    for (uint32 i = 0; i < triangle_count; ++i)
+    {
+        const uint32* t = &indices[triangles[i] * 3];
+        if (t[0] == to || t[1] == to || t[2] == to)
+            continue; // collapsed to a line and removed.
+
+        glm::vec3 p[3], q[3];
+        for (uint32 k = 0; k < 3; ++k)
+        {
+            p[k] = positions[t[k]];
+            q[k] = positions[t[k] == from ? to : t[k]];
+        }
+        glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+        glm::vec3 after  = glm::cross(q[1] - q[0], q[2] - q[0]);
+        // rejects flips and triangles turning into slivers.
+        if (glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after))
+            return false;
+    }
+    return true;
+}
+
+std::vector<uint32> mango::simplify_triangles(const std::vector<uint32>& indices, const std::vector<glm::vec3>& positions, ptr_size target_index_count, float& result_error)
+{
+    MANGO_ASSERT(indices.size() % 3 == 0, "Indices do not describe a triangle list!");
+    result_error = 0.0f;
+
+    uint32 vertex_count = static_cast<uint32>(positions.size());
+    std::vector<uint32> result(indices);
+    if (result.size() <= target_index_count)
+        return result;
+
+    // the planes of the adjacent triangles weighted by their area.
+    quadric zero_quadric = plane_quadric(glm::vec3(0.0f), 0.0f, 0.0f);
+    std::vector<quadric> quadrics(vertex_count, zero_quadric);
+    for (ptr_size i = 0; i < result.size(); i += 3)
+    {
+        const glm::vec3& p0 = positions[result[i]];
+        glm::vec3 normal    = glm::cross(positions[result[i + 1]] - p0, positions[result[i + 2]] - p0);
+        float length        = glm::length(normal);
+        if (length <= 0.0f)
+            continue;
+        normal /= length;
+        quadric q = plane_quadric(normal, -glm::dot(normal, p0), 0.5f * length);
+        for (ptr_size k = 0; k < 3; ++k)
+            add_quadric(quadrics[result[i + k]], q);
+    }
+
+    // edges with only one triangle are borders or seams, their vertices are locked.
+    std::unordered_map<uint64, uint32> edge_use;
+    for (ptr_size i = 0; i < result.size(); i += 3)
+    {
+        for (ptr_size k = 0; k < 3; ++k)
+        {
+            uint64 a = result[i + k], b = result[i + (k + 1) % 3];
+            edge_use[a < b ? (a << 32) | b : (b << 32) | a]++;
+        }
+    }
+    std::vector<bool> locked(vertex_count, false);
+    for (auto& edge : edge_use)
+    {
+        if (edge.second == 1)
+        {
+            locked[static_cast<uint32>(edge.first >> 32)]        = true;
+            locked[static_cast<uint32>(edge.first & 0xffffffff)] = true;
+        }
+    }
+    edge_use.clear();
+
+    struct collapse
+    {
+        uint32 from;
+        uint32 to;
+        double error;
+    };
+    std::vector<collapse> collapses;
+    std::vector<uint32> triangle_offsets(vertex_count + 1);
+    std::vector<uint32> vertex_triangles;
+    std::vector<bool> touched(vertex_count);
+    std::vector<uint32> remap(vertex_count);
+    double max_error = 0.0;
+
+    while (result.size() > target_index_count)
+    {
+        uint32 triangle_count = static_cast<uint32>(result.size() / 3);
+
+        // triangles around each vertex.
+        std::fill(triangle_offsets.begin(), triangle_offsets.end(), 0);
+        for (uint32 idx : result)
+            triangle_offsets[idx + 1]++;
+        for (uint32 v = 0; v < vertex_count; ++v)
+            triangle_offsets[v + 1] += triangle_offsets[v];
+        vertex_triangles.resize(result.size());
+        std::vector<uint32> fill(triangle_offsets.begin(), triangle_offsets.end() - 1);
+        for (uint32 t = 0; t < triangle_count; ++t)
+        {
+            for (uint32 k = 0; k < 3; ++k)
+                vertex_triangles[fill[result[t * 3 + k]]++] = t;
+        }
+
+        // every edge in both directions, ordered by the error of the collapse.
+        collapses.clear();
+        for (uint32 t = 0; t < triangle_count; ++t)
+        {
+            for (uint32 k = 0; k < 3; ++k)
+            {
+                uint32 a = result[t * 3 + k], b = result[t * 3 + (k + 1) % 3];
+                quadric q = quadrics[a];
+                add_quadric(q, quadrics[b]);
+                if (!locked[a])
+                    collapses.push_back({ a, b, evaluate_quadric(q, positions[b]) });
+                if (!locked[b])
+                    collapses.push_back({ b, a, evaluate_quadric(q, positions[a]) });
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const collapse& l, const collapse& r) { return l.error < r.error; });
+
+        // collapse greedily, every triangle is changed at most once per pass, so the orientation checks stay valid.
+        std::fill(touched.begin(), touched.end(), false);
+        for (uint32 v = 0; v < vertex_count; ++v)
+            remap[v] = v;
+        ptr_size removed_indices = 0;
+        uint32 applied           = 0;
+        for (const collapse& c : collapses)
+        {
+            if (result.size() - removed_indices <= target_index_count)
+                break;
+            if (touched[c.from] || touched[c.to])
+                continue;
+
+            const uint32* around = &vertex_triangles[triangle_offsets[c.from]];
+            uint32 around_count  = triangle_offsets[c.from + 1] - triangle_offsets[c.from];
+            if (!keeps_orientation(result, positions, around, around_count, c.from, c.to))
+                continue;
+
+            for (uint32 i = 0; i < around_count; ++i)
+            {
+                const uint32* t = &result[around[i] * 3];
+                touched[t[0]] = touched[t[1]] = touched[t[2]] = true;
+                if (t[0] == c.to || t[1] == c.to || t[2] == c.to)
+                    removed_indices += 3;
+            }
+            remap[c.from] = c.to;
+            add_quadric(quadrics[c.to], quadrics[c.from]);
+            max_error = std::max(max_error, c.error);
+            ++applied;
+        }
+        if (applied == 0)
+            break;
+
+        // remove triangles that collapsed to lines.
+        ptr_size write = 0;
+        for (ptr_size i = 0; i < result.size(); i += 3)
+        {
+            uint32 a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    result_error = static_cast<float>(std::sqrt(max_error));
+    return result;
+}
+
+//! \brief Computes the bounding sphere and the normal cone of a \a meshlet.
+//! \param[in,out] m The \a meshlet with a valid index range.
+//! \param[in] indices The indices of the triangle list.
+//! \param[in] positions The positions of the vertices.
+static void compute_meshlet_bounds(meshlet& m, const std::vector<uint32>& indices, const std::vector<glm::vec3>& positions)
+{
+    glm::vec3 min_position(3.402823e+38f);
+    glm::vec3 max_position(-3.402823e+38f);
+    for (uint32 i = m.first_index; i < m.first_index + m.index_count; ++i)
+    {
+        min_position = glm::min(min_position, positions[indices[i]]);
+        max_position = glm::max(max_position, positions[indices[i]]);
+    }
+    glm::vec3 center = 0.5f * (min_position + max_position);
+    float radius     = 0.0f;
+    for (uint32 i = m.first_index; i < m.first_index + m.index_count; ++i)
+        radius = std::max(radius, glm::length(positions[indices[i]] - center));
+    m.bounding_sphere = glm::vec4(center, radius);
+
+    // the axis is the mean of the triangle normals, the spread is the largest angle of any normal to it.
+    std::vector<glm::vec3> normals;
+    glm::vec3 axis = glm::vec3(0.0f);
+    for (uint32 i = m.first_index; i < m.first_index + m.index_count; i += 3)
+    {
+        const glm::vec3& p0 = positions[indices[i]];
+        glm::vec3 normal    = glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+        float length        = glm::length(normal);
+        if (length <= 0.0f)
+            continue;
+        normals.push_back(normal / length);
+        axis += normals.back();
+    }
+
+    m.normal_cone     = glm::vec4(0.0f, 0.0f, 1.0f, 2.0f);
+    float axis_length = glm::length(axis);
+    if (normals.empty() || axis_length <= 1e-6f)
+        return;
+    axis /= axis_length;
+
+    float min_cos = 1.0f;
+    for (const glm::vec3& normal : normals)
+        min_cos = std::min(min_cos, glm::dot(normal, axis));
+    // normals spread over more than a hemisphere can never all face away from the camera.
+    if (min_cos <= 0.0f)
+        return;
+    m.normal_cone = glm::vec4(axis, std::sqrt(1.0f - min_cos * min_cos));
+}
+
+std::vector<meshlet> mango::build_meshlets(std::vector<uint32>& indices, const std::vector<glm::vec3>& positions, uint32 max_vertices, uint32 max_triangles)
+{
+    MANGO_ASSERT(indices.size() % 3 == 0, "Indices do not describe a triangle list!");
+    MANGO_ASSERT(max_vertices >= 3 && max_triangles > 0, "Meshlets can not hold a single triangle!");
+    const uint32 invalid = 0xffffffff;
+
+    uint32 vertex_count   = static_cast<uint32>(positions.size());
+    uint32 triangle_count = static_cast<uint32>(indices.size() / 3);
+
+    // triangles around each vertex.
+    std::vector<uint32> triangle_offsets(vertex_count + 1, 0);
+    for (uint32 idx : indices)
+        triangle_offsets[idx + 1]++;
+    for (uint32 v = 0; v < vertex_count; ++v)
+        triangle_offsets[v + 1] += triangle_offsets[v];
+    std::vector<uint32> vertex_triangles(indices.size());
+    std::vector<uint32> fill(triangle_offsets.begin(), triangle_offsets.end() - 1);
+    for (uint32 t = 0; t < triangle_count; ++t)
+    {
+        for (uint32 k = 0; k < 3; ++k)
+            vertex_triangles[fill[indices[t * 3 + k]]++] = t;
+    }
+
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<uint32> vertex_meshlet(vertex_count, invalid);
+    std::vector<uint32> meshlet_vertices;
+    std::vector<uint32> reordered;
+    reordered.reserve(indices.size());
+    std::vector<meshlet> meshlets;
+
+    uint32 seed = 0;
+    while (true)
+    {
+        while (seed < triangle_count && emitted[seed])
+            ++seed;
+        if (seed == triangle_count)
+            break;
+
+        uint32 id     = static_cast<uint32>(meshlets.size());
+        meshlet m     = meshlet();
+        m.first_index = static_cast<uint32>(reordered.size());
+        meshlet_vertices.clear();
+
+        // grows the meshlet with the adjacent triangle adding the fewest vertices, so it stays compact.
+        uint32 next      = seed;
+        uint32 triangles = 0;
+        while (next != invalid)
+        {
+            emitted[next] = true;
+            for (uint32 k = 0; k < 3; ++k)
+            {
+                uint32 v = indices[next * 3 + k];
+                if (vertex_meshlet[v] != id)
+                {
+                    vertex_meshlet[v] = id;
+                    meshlet_vertices.push_back(v);
+                }
+                reordered.push_back(v);
+            }
+            if (++triangles == max_triangles)
+                break;
+
+            next            = invalid;
+            uint32 best_new = 4;
+            for (auto it = meshlet_vertices.rbegin(); it != meshlet_vertices.rend() && best_new > 0; ++it)
+            {
+                for (uint32 i = triangle_offsets[*it]; i < triangle_offsets[*it + 1]; ++i)
+                {
+                    uint32 t = vertex_triangles[i];
+                    if (emitted[t])
+                        continue;
+
+                    uint32 new_vertices = 0;
+                    for (uint32 k = 0; k < 3; ++k)
+                        new_vertices += vertex_meshlet[indices[t * 3 + k]] != id ? 1 : 0;
+                    if (new_vertices < best_new && meshlet_vertices.size() + new_vertices <= max_vertices)
+                    {
+                        best_new = new_vertices;
+                        next     = t;
+                        if (best_new == 0)
+                            break;
+                    }
+                }
+            }
+        }
+
+        m.index_count = static_cast<uint32>(reordered.size()) - m.first_index;
+        meshlets.push_back(m);
+    }
+
+    indices.swap(reordered);
+    for (meshlet& m : meshlets)
+        compute_meshlet_bounds(m, indices, positions);
+    return meshlets;
+}
+
+//! \brief The number of vertices in the cache modeled by the vertex cache optimization.
+static const uint32 forsyth_cache_size = 32;
+//! \brief The power the score of vertices falls off with their position in the cache.
+static const float forsyth_cache_decay_power = 1.5f;
+//! \brief The score of the vertices of the last triangle. Lower than the next ones, so strips do not turn back on themselves.
+static const float forsyth_last_triangle_score = 0.75f;
+//! \brief The scale of the score of vertices with few remaining triangles, so they are finished instead of left behind.
+static const float forsyth_valence_boost_scale = 2.0f;
+//! \brief The power the score of vertices falls off with their remaining triangles.
+static const float forsyth_valence_boost_power = 0.5f;
+
+//! \brief Calculates the score of a vertex for the vertex cache optimization.
+//! \param[in] cache_position The position of the vertex in the cache, -1 if it is not in the cache.
+//! \param[in] remaining_triangles The number of triangles of the vertex not emitted yet.
+//! \return The score of the vertex, higher scores are emitted earlier.
+static float forsyth_vertex_score(int32 cache_position, uint32 remaining_triangles)
+{
+    if (remaining_triangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cache_position >= 0 && cache_position < 3)
+        score = forsyth_last_triangle_score;
+    else if (cache_position >= 3)
+        score = std::pow(1.0f - static_cast<float>(cache_position - 3) / static_cast<float>(forsyth_cache_size - 3), forsyth_cache_decay_power);
+
+    return score + forsyth_valence_boost_scale * std::pow(static_cast<float>(remaining_triangles), -forsyth_valence_boost_power);
+}
+
+void mango::optimize_vertex_cache(std::vector<uint32>& indices, uint32 vertex_count)
+{
+    MANGO_ASSERT(indices.size() % 3 == 0, "Indices do not describe a triangle list!");
+    const uint32 invalid = 0xffffffff;
+
+    uint32 triangle_count = static_cast<uint32>(indices.size() / 3);
+    if (triangle_count < 2)
+        return;
+
+    // triangles around each vertex, the ones not emitted yet are kept in front.
+    std::vector<uint32> triangle_offsets(vertex_count + 1, 0);
+    for (uint32 idx : indices)
+        triangle_offsets[idx + 1]++;
+    for (uint32 v = 0; v < vertex_count; ++v)
+        triangle_offsets[v + 1] += triangle_offsets[v];
+    std::vector<uint32> vertex_triangles(indices.size());
+    std::vector<uint32> remaining(vertex_count, 0);
+    for (uint32 t = 0; t < triangle_count; ++t)
+    {
+        for (uint32 k = 0; k < 3; ++k)
+        {
+            uint32 v = indices[t * 3 + k];
+            vertex_triangles[triangle_offsets[v] + remaining[v]++] = t;
+        }
+    }
+
+    std::vector<int32> cache_position(vertex_count, -1);
+    std::vector<float> vertex_score(vertex_count);
+    for (uint32 v = 0; v < vertex_count; ++v)
+        vertex_score[v] = forsyth_vertex_score(-1, remaining[v]);
+    std::vector<float> triangle_score(triangle_count);
+    for (uint32 t = 0; t < triangle_count; ++t)
+        triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<uint32> cache;
+    std::vector<uint32> next_cache;
+    std::vector<uint32> result;
+    result.reserve(indices.size());
+
+    uint32 best   = 0;
+    uint32 cursor = 0;
+    while (result.size() < indices.size())
+    {
+        // no triangle around the cache is left, so the next one in the input order starts over.
+        if (best == invalid)
+        {
+            while (emitted[cursor])
+                ++cursor;
+            best = cursor;
+        }
+
+        emitted[best]     = true;
+        const uint32* tri = &indices[best * 3];
+        result.insert(result.end(), tri, tri + 3);
+        for (uint32 k = 0; k < 3; ++k)
+        {
+            uint32* first = &vertex_triangles[triangle_offsets[tri[k]]];
+            uint32* last  = first + remaining[tri[k]] - 1;
+            std::swap(*std::find(first, last, best), *last);
+            remaining[tri[k]]--;
+        }
+
+        // the vertices of the triangle move to the front of the cache, the last ones drop out.
+        next_cache.assign(tri, tri + 3);
+        for (uint32 v : cache)
+        {
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                next_cache.push_back(v);
+        }
+        for (ptr_size i = 0; i < next_cache.size(); ++i)
+        {
+            uint32 v          = next_cache[i];
+            cache_position[v] = i < forsyth_cache_size ? static_cast<int32>(i) : -1;
+            vertex_score[v]   = forsyth_vertex_score(cache_position[v], remaining[v]);
+        }
+
+        // only the triangles around the changed vertices change their score.
+        best             = invalid;
+        float best_score = -1.0f;
+        for (uint32 v : next_cache)
+        {
+            for (uint32 i = triangle_offsets[v]; i < triangle_offsets[v] + remaining[v]; ++i)
+            {
+                uint32 t          = vertex_triangles[i];
+                triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+                if (triangle_score[t] > best_score)
+                {
+                    best       = t;
+                    best_score = triangle_score[t];
+                }
+            }
+        }
+
+        if (next_cache.size() > forsyth_cache_size)
+            next_cache.resize(forsyth_cache_size);
+        cache.swap(next_cache);
+    }
+
+    indices.swap(result);
+}
+
+//! \brief Simulates a first in first out vertex cache.
+struct fifo_cache
+{
+    std::vector<uint32> timestamps; //!< The time each vertex was put into the cache.
+    uint32 time;                    //!< Increased with every miss.
+    uint32 size;                    //!< The number of vertices in the cache.
+};
+
+//! \brief Creates an empty \a fifo_cache.
+//! \param[in] vertex_count The number of vertices that can be referenced.
+//! \param[in] cache_size The number of vertices in the cache.
+//! \return The \a fifo_cache.
+static fifo_cache create_fifo_cache(uint32 vertex_count, uint32 cache_size)
+{
+    fifo_cache cache;
+    cache.timestamps.assign(vertex_count, 0);
+    cache.time = cache_size + 1;
+    cache.size = cache_size;
+    return cache;
+}
+
+//! \brief Empties a \a fifo_cache.
+//! \param[in,out] cache The \a fifo_cache to empty.
+static void reset_fifo_cache(fifo_cache& cache)
+{
+    cache.time += cache.size + 1;
+}
+
+//! \brief Simulates the vertices of a triangle going through a \a fifo_cache.
+//! \param[in,out] cache The \a fifo_cache.
+//! \param[in] triangle The three indices of the triangle.
+//! \return The number of vertices missing the cache.
+static uint32 fifo_cache_misses(fifo_cache& cache, const uint32* triangle)
+{
+    uint32 misses = 0;
+    for (uint32 k = 0; k < 3; ++k)
+    {
+        if (cache.time - cache.timestamps[triangle[k]] > cache.size)
+        {
+            cache.timestamps[triangle[k]] = cache.time++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+void mango::optimize_overdraw(std::vector<uint32>& indices, const std::vector<glm::vec3>& positions, float threshold)
+{
+    MANGO_ASSERT(indices.size() % 3 == 0, "Indices do not describe a triangle list!");
+    const uint32 cluster_cache_size = 16;
+
+    uint32 triangle_count = static_cast<uint32>(indices.size() / 3);
+    if (triangle_count < 2)
+        return;
+
+    // the vertex cache optimization starts over where all vertices of a triangle miss, these are hard borders.
+    fifo_cache cache = create_fifo_cache(static_cast<uint32>(positions.size()), cluster_cache_size);
+    std::vector<uint32> hard_borders;
+    for (uint32 t = 0; t < triangle_count; ++t)
+    {
+        if (fifo_cache_misses(cache, &indices[t * 3]) == 3)
+            hard_borders.push_back(t);
+    }
+    hard_borders.push_back(triangle_count);
+
+    // splits the hard clusters further wherever the cache efficiency of the part is good enough.
+    std::vector<uint32> cluster_starts;
+    for (ptr_size c = 0; c + 1 < hard_borders.size(); ++c)
+    {
+        uint32 start = hard_borders[c];
+        uint32 end   = hard_borders[c + 1];
+
+        reset_fifo_cache(cache);
+        uint32 misses = 0;
+        for (uint32 t = start; t < end; ++t)
+            misses += fifo_cache_misses(cache, &indices[t * 3]);
+        float limit = threshold * static_cast<float>(misses) / static_cast<float>(end - start);
+
+        reset_fifo_cache(cache);
+        cluster_starts.push_back(start);
+        uint32 cluster_start  = start;
+        uint32 cluster_misses = 0;
+        for (uint32 t = start; t + 1 < end; ++t)
+        {
+            cluster_misses += fifo_cache_misses(cache, &indices[t * 3]);
+            if (static_cast<float>(cluster_misses) / static_cast<float>(t + 1 - cluster_start) <= limit)
+            {
+                cluster_start  = t + 1;
+                cluster_misses = 0;
+                cluster_starts.push_back(cluster_start);
+                reset_fifo_cache(cache);
+            }
+        }
+    }
+    uint32 cluster_count = static_cast<uint32>(cluster_starts.size());
+    cluster_starts.push_back(triangle_count);
+
+    // clusters facing away from the center of the mesh are likely to occlude the others.
+    std::vector<glm::vec3> cluster_centroids(cluster_count, glm::vec3(0.0f));
+    std::vector<glm::vec3> cluster_normals(cluster_count, glm::vec3(0.0f));
+    std::vector<float> cluster_areas(cluster_count, 0.0f);
+    glm::vec3 mesh_centroid = glm::vec3(0.0f);
+    float mesh_area         = 0.0f;
+    for (uint32 c = 0; c < cluster_count; ++c)
+    {
+        for (uint32 t = cluster_starts[c]; t < cluster_starts[c + 1]; ++t)
+        {
+            const glm::vec3& p0 = positions[indices[t * 3]];
+            const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+            const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+            glm::vec3 normal    = glm::cross(p1 - p0, p2 - p0);
+            float area          = glm::length(normal);
+            cluster_centroids[c] += area * (p0 + p1 + p2) / 3.0f;
+            cluster_normals[c] += normal;
+            cluster_areas[c] += area;
+        }
+        mesh_centroid += cluster_centroids[c];
+        mesh_area += cluster_areas[c];
+    }
+    if (mesh_area <= 0.0f)
+        return;
+    mesh_centroid /= mesh_area;
+
+    std::vector<float> cluster_sort_keys(cluster_count, 0.0f);
+    std::vector<uint32> cluster_order(cluster_count);
+    for (uint32 c = 0; c < cluster_count; ++c)
+    {
+        cluster_order[c]    = c;
+        float normal_length = glm::length(cluster_normals[c]);
+        if (cluster_areas[c] <= 0.0f || normal_length <= 0.0f)
+            continue;
+        cluster_sort_keys[c] = glm::dot(cluster_centroids[c] / cluster_areas[c] - mesh_centroid, cluster_normals[c] / normal_length);
+    }
+    std::stable_sort(cluster_order.begin(), cluster_order.end(), [&cluster_sort_keys](uint32 l, uint32 r) { return cluster_sort_keys[l] > cluster_sort_keys[r]; });
+
+    std::vector<uint32> result;
+    result.reserve(indices.size());
+    for (uint32 c : cluster_order)
+        result.insert(result.end(), indices.begin() + cluster_starts[c] * 3, indices.begin() + cluster_starts[c + 1] * 3);
+    indices.swap(result);
+}
+
+std::vector<uint32> mango::optimize_vertex_fetch(std::vector<uint32>& indices, uint32 vertex_count)
+{
+    const uint32 invalid = 0xffffffff;
+
+    std::vector<uint32> remap(vertex_count, invalid);
+    uint32 next = 0;
+    for (uint32& idx : indices)
+    {
+        if (remap[idx] == invalid)
+            remap[idx] = next++;
+        idx = remap[idx];
+    }
+    for (uint32& r : remap)
+    {
+        if (r == invalid)
+            r = next++;
+    }
+    return remap;
+}
+
+float mango::compute_acmr(const std::vector<uint32>& indices, uint32 vertex_count, uint32 cache_size)
+{
+    MANGO_ASSERT(indices.size() % 3 == 0, "Indices do not describe a triangle list!");
+    if (indices.empty())
+        return 0.0f;
+
+    fifo_cache cache = create_fifo_cache(vertex_count, cache_size);
+    uint32 misses    = 0;
+    for (ptr_size i = 0; i < indices.size(); i += 3)
+        misses += fifo_cache_misses(cache, &indices[i]);
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+//! \brief Encodes a normalized direction with the octahedral mapping.
+//! \details See http://jcgt.org/published/0003/02/01/, the decoding in the shaders matches.
+//! \param[in] n The normalized direction.
+//! \return The direction mapped to [-1, 1] in both components.
+static glm::vec2 encode_octahedral(const glm::vec3& n)
+{
+    float length = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (length <= 0.0f)
+        return glm::vec2(0.0f);
+
+    glm::vec2 p = glm::vec2(n.x, n.y) / length;
+    if (n.z < 0.0f)
+        p = (glm::vec2(1.0f) - glm::abs(glm::vec2(p.y, p.x))) * glm::vec2(p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f);
+    return p;
+}
+
+std::vector<quantized_vertex> mango::quantize_vertices(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals, const std::vector<glm::vec2>& texcoords, const std::vector<glm::vec4>& tangents,
+                                                       const glm::vec3& position_offset, const glm::vec3& position_scale)
+{
+    MANGO_ASSERT(normals.empty() || normals.size() == positions.size(), "Normals do not match the positions!");
+    MANGO_ASSERT(texcoords.empty() || texcoords.size() == positions.size(), "Texture coordinates do not match the positions!");
+    MANGO_ASSERT(tangents.empty() || tangents.size() == positions.size(), "Tangents do not match the positions!");
+
+    // flat bounds are quantized to zero.
+    glm::vec3 inverse_scale;
+    for (int32 c = 0; c < 3; ++c)
+        inverse_scale[c] = position_scale[c] > 0.0f ? 1.0f / position_scale[c] : 0.0f;
+
+    std::vector<quantized_vertex> vertices(positions.size());
+    for (ptr_size i = 0; i < positions.size(); ++i)
+    {
+        quantized_vertex& v = vertices[i];
+        glm::vec3 relative  = (positions[i] - position_offset) * inverse_scale;
+        for (int32 c = 0; c < 3; ++c)
+            v.position[c] = glm::packUnorm1x16(relative[c]);
+        v.position[3] = 0;
+
+        v.normal   = normals.empty() ? 0 : glm::packSnorm2x16(encode_octahedral(normals[i]));
+        v.texcoord = texcoords.empty() ? 0 : glm::packHalf2x16(texcoords[i]);
+        v.tangent  = 0;
+        if (!tangents.empty())
+        {
+            glm::vec3 tangent = glm::vec3(tangents[i]);
+            float length      = glm::length(tangent);
+            // the sign is stored exactly, so the shaders can compare it with -1.
+            v.tangent = glm::packSnorm3x10_1x2(glm::vec4(length > 0.0f ? tangent / length : tangent, tangents[i].w < 0.0f ? -1.0f : 1.0f));
+        }
+    }
+    return vertices;
+}
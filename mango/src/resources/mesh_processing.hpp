@@ -0,0 +1,96 @@
+//! \file      mesh_processing.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_MESH_PROCESSING_HPP
+#define MANGO_MESH_PROCESSING_HPP
+
+#include <glm/glm.hpp>
+#include <mango/types.hpp>
+#include <vector>
+
+namespace mango
+{
+    //! \brief Simplifies an indexed triangle list by collapsing edges with the lowest quadric error.
+    //! \details Each collapse moves a vertex onto one of its neighbours, so the result only references existing vertices and can share the vertex buffers with the input.
+    //! Vertices on borders, which includes the seams of split vertices, are never moved. The simplification stops early if no edge can be collapsed without flipping a triangle.
+    //! \param[in] indices The indices of the triangle list. The size has to be a multiple of three.
+    //! \param[in] positions The positions of the vertices referenced by the indices.
+    //! \param[in] target_index_count The number of indices to reduce the triangle list to.
+    //! \param[out] result_error The largest distance of the simplified surface to the input in model space, estimated from the quadrics.
+    //! \return The indices of the simplified triangle list.
+    std::vector<uint32> simplify_triangles(const std::vector<uint32>& indices, const std::vector<glm::vec3>& positions, ptr_size target_index_count, float& result_error);
+
+    //! \brief A small cluster of triangles of a mesh with bounds for culling.
+    //! \details The layout matches a shader storage buffer with std430 layout.
+    struct meshlet
+    {
+        glm::vec4 bounding_sphere; //!< The center of the bounding sphere in model space in xyz and the radius in w.
+        glm::vec4 normal_cone;     //!< The axis of the cone containing all triangle normals in xyz and the sine of its half angle in w. Larger than one if the cone is too wide to cull.
+        uint32 first_index;        //!< The first index of the meshlet in the reordered triangle list.
+        uint32 index_count;        //!< The number of indices of the meshlet.
+        uint32 padding0;           //!< Padding needed for alignment.
+        uint32 padding1;           //!< Padding needed for alignment.
+    };
+
+    //! \brief Splits an indexed triangle list into meshlets of connected triangles.
+    //! \details The triangles are reordered, so each meshlet is a continuous range of the list.
+    //! \param[in,out] indices The indices of the triangle list. The size has to be a multiple of three.
+    //! \param[in] positions The positions of the vertices referenced by the indices.
+    //! \param[in] max_vertices The maximum number of unique vertices per meshlet.
+    //! \param[in] max_triangles The maximum number of triangles per meshlet.
+    //! \return The meshlets covering all triangles.
+    std::vector<meshlet> build_meshlets(std::vector<uint32>& indices, const std::vector<glm::vec3>& positions, uint32 max_vertices, uint32 max_triangles);
+
+    //! \brief Reorders the triangles of an indexed triangle list, so transformed vertices are reused from the post transform cache.
+    //! \details Uses the algorithm of Tom Forsyth, which does not depend on the exact cache size of the hardware.
+    //! \param[in,out] indices The indices of the triangle list. The size has to be a multiple of three.
+    //! \param[in] vertex_count The number of vertices referenced by the indices.
+    void optimize_vertex_cache(std::vector<uint32>& indices, uint32 vertex_count);
+
+    //! \brief Reorders clusters of triangles, so triangles facing outwards are drawn first and hide the ones behind them.
+    //! \details Should be called after \a optimize_vertex_cache(). The triangle list is split where the cache efficiency stays close to the one of the input, so it is mostly kept.
+    //! \param[in,out] indices The indices of the triangle list. The size has to be a multiple of three.
+    //! \param[in] positions The positions of the vertices referenced by the indices.
+    //! \param[in] threshold The factor the average cache miss ratio is allowed to get worse by, 1.05 is a good start.
+    void optimize_overdraw(std::vector<uint32>& indices, const std::vector<glm::vec3>& positions, float threshold);
+
+    //! \brief Renumbers the vertices in the order they are first referenced, so the vertex data is fetched linearly.
+    //! \details Vertices that are not referenced are moved to the end.
+    //! \param[in,out] indices The indices of the triangle list, rewritten to the new vertex order.
+    //! \param[in] vertex_count The number of vertices referenced by the indices.
+    //! \return The new index of every vertex, the vertex data has to be moved accordingly.
+    std::vector<uint32> optimize_vertex_fetch(std::vector<uint32>& indices, uint32 vertex_count);
+
+    //! \brief Calculates the average number of cache misses per triangle of a first in first out vertex cache.
+    //! \param[in] indices The indices of the triangle list. The size has to be a multiple of three.
+    //! \param[in] vertex_count The number of vertices referenced by the indices.
+    //! \param[in] cache_size The number of vertices in the simulated cache.
+    //! \return The average cache miss ratio. Between 0.5 for large regular grids and 3.0 without any reuse.
+    float compute_acmr(const std::vector<uint32>& indices, uint32 vertex_count, uint32 cache_size);
+
+    //! \brief An interleaved vertex with quantized attributes. Has 20 instead of 48 bytes.
+    struct quantized_vertex
+    {
+        uint16 position[4]; //!< The position relative to the bounds of the mesh as unsigned normalized values. The last one is unused.
+        uint32 normal;      //!< The octahedral encoded normal as two signed normalized 16 bit values.
+        uint32 texcoord;    //!< The texture coordinates as two half floats.
+        uint32 tangent;     //!< The tangent as three signed normalized 10 bit values and the sign of the bitangent in the last two bits.
+    };
+
+    //! \brief Interleaves and quantizes the vertex attributes of a primitive.
+    //! \details Attributes that are not available are left empty and have to be zero filled in the result.
+    //! \param[in] positions The positions of the vertices.
+    //! \param[in] normals The normals of the vertices. Empty or as many as positions.
+    //! \param[in] texcoords The texture coordinates of the vertices. Empty or as many as positions.
+    //! \param[in] tangents The tangents of the vertices with the sign of the bitangent in w. Empty or as many as positions.
+    //! \param[in] position_offset The minimum of the bounds the positions are quantized in.
+    //! \param[in] position_scale The size of the bounds the positions are quantized in.
+    //! \return The quantized vertices.
+    std::vector<quantized_vertex> quantize_vertices(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals, const std::vector<glm::vec2>& texcoords, const std::vector<glm::vec4>& tangents,
+                                                    const glm::vec3& position_offset, const glm::vec3& position_scale);
+} // namespace mango
+
+#endif // MANGO_MESH_PROCESSING_HPP
@@ -25,6 +25,8 @@ namespace mango
         tinygltf::Model gltf_model;
         //! \brief The \a model_configuration of this \a model.
         model_configuration configuration;
+        //! \brief True if the primitives of the \a gltf_model were already reordered for the vertex cache, overdraw and vertex fetch, else false.
+        bool primitives_optimized = false;
     };
 
 } // namespace mango
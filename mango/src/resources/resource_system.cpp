@@ -4,6 +4,9 @@
 //! \date      2020
 //! \copyright Apache License 2.0
 
+#include <algorithm>
+#include <graphics/shader.hpp>
+#include <graphics/shader_program.hpp>
 #include <mango/log.hpp>
 #include <resources/resource_system.hpp>
 #define TINYGLTF_IMPLEMENTATION
@@ -18,9 +21,15 @@
 using namespace mango;
 
 static image load_image_from_file(const string& path, const image_configuration& configuration);
+static ptr_size model_memory(const model& m);
 
 resource_system::resource_system(const shared_ptr<context_impl>& context)
     : m_shared_context(context)
+    , m_memory_budget(default_memory_budget)
+    , m_image_memory(0)
+    , m_model_memory(0)
+    , m_access_counter(0)
+    , m_next_callback_id(1)
 {
 }
 
@@ -28,22 +37,67 @@ resource_system::~resource_system() {}
 
 bool resource_system::create()
 {
+    m_file_watcher = mango::make_unique<file_watcher>();
     return true;
 }
 
 void resource_system::update(float dt)
 {
     MANGO_UNUSED(dt);
+
+    std::vector<string> changed_files;
+    m_file_watcher->poll(changed_files);
+    for (auto& path : changed_files)
+    {
+        MANGO_LOG_INFO("File '{0}' was modified!", path);
+
+        // modified resources are loaded again on the next load call.
+        for (auto it = m_image_storage.begin(); it != m_image_storage.end();)
+        {
+            if (it->second.path == path)
+            {
+                m_image_memory -= it->second.memory;
+                it = m_image_storage.erase(it);
+            }
+            else
+                ++it;
+        }
+        for (auto it = m_model_storage.begin(); it != m_model_storage.end();)
+        {
+            if (it->second.path == path)
+            {
+                m_model_memory -= it->second.memory;
+                it = m_model_storage.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        // callbacks can register new callbacks, so the list is copied.
+        std::vector<file_callback> callbacks = m_file_callbacks;
+        for (auto& fc : callbacks)
+        {
+            if (fc.path == path)
+                fc.callback();
+        }
+    }
+
+    update_shader_programs();
+
+    // resources released by the user since the last update can be evicted now.
+    evict();
 }
 
 void resource_system::destroy()
 {
-    for (auto sp : m_image_storage)
-    {
-        stbi_image_free(sp.second->data);
-    }
+    // image data is freed when the last reference is released.
     m_image_storage.clear();
     m_model_storage.clear();
+    m_image_memory = 0;
+    m_model_memory = 0;
+    m_file_callbacks.clear();
+    m_watched_programs.clear();
+    m_file_watcher.reset();
 }
 
 const shared_ptr<image> resource_system::load_image(const string& path, const image_configuration& configuration)
@@ -54,12 +108,28 @@ const shared_ptr<image> resource_system::load_image(const string& path, const im
     if (it != m_image_storage.end())
     {
         MANGO_LOG_INFO("Image '{0}' is already loaded!", configuration.name);
-        return it->second;
+        it->second.last_access = ++m_access_counter;
+        return it->second.resource;
     }
 
     image img = load_image_from_file(path, configuration);
-    m_image_storage.insert({ handle, std::make_shared<image>(img) });
-    return m_image_storage.at(handle);
+
+    stored_resource<image> stored;
+    stored.resource    = shared_ptr<image>(new image(img), [](image* i) {
+        if (i->data)
+            stbi_image_free(i->data);
+        delete i;
+    });
+    stored.path        = path;
+    stored.memory      = img.data ? static_cast<ptr_size>(img.width) * img.height * 4 * (configuration.is_hdr ? sizeof(float) : sizeof(uint8)) : 0; // always loaded with four components.
+    stored.last_access = ++m_access_counter;
+
+    m_image_memory += stored.memory;
+    m_image_storage.insert({ handle, stored });
+    m_file_watcher->watch(path);
+    evict();
+
+    return stored.resource;
 }
 
 const shared_ptr<image> resource_system::get_image(const string& name)
@@ -68,7 +138,10 @@ const shared_ptr<image> resource_system::get_image(const string& name)
     // check if image is loaded
     auto it = m_image_storage.find(handle);
     if (it != m_image_storage.end())
-        return it->second;
+    {
+        it->second.last_access = ++m_access_counter;
+        return it->second.resource;
+    }
 
     MANGO_LOG_ERROR("Image '{0}' is not loaded!", name);
     return nullptr;
@@ -82,19 +155,20 @@ const shared_ptr<model> resource_system::load_gltf(const string& path, const mod
     if (it != m_model_storage.end())
     {
         MANGO_LOG_INFO("Model '{0}' is already loaded!", configuration.name);
-        return it->second;
+        it->second.last_access = ++m_access_counter;
+        return it->second.resource;
     }
 
-    model m;
+    shared_ptr<model> m = std::make_shared<model>();
     tinygltf::TinyGLTF loader;
     string err;
     string warn;
     auto ext = path.substr(path.find_last_of(".") + 1);
     bool ret = false;
     if (ext == "gltf")
-        ret = loader.LoadASCIIFromFile(&m.gltf_model, &err, &warn, path);
+        ret = loader.LoadASCIIFromFile(&m->gltf_model, &err, &warn, path);
     else if (ext == "glb")
-        ret = loader.LoadBinaryFromFile(&m.gltf_model, &err, &warn, path);
+        ret = loader.LoadBinaryFromFile(&m->gltf_model, &err, &warn, path);
 
     if (!warn.empty())
     {
@@ -112,11 +186,20 @@ const shared_ptr<model> resource_system::load_gltf(const string& path, const mod
         return nullptr;
     }
 
-    m.configuration = configuration;
+    m->configuration = configuration;
 
-    m_model_storage.insert({ handle, std::make_shared<model>(m) });
+    stored_resource<model> stored;
+    stored.resource    = m;
+    stored.path        = path;
+    stored.memory      = model_memory(*m);
+    stored.last_access = ++m_access_counter;
 
-    return m_model_storage.at(handle);
+    m_model_memory += stored.memory;
+    m_model_storage.insert({ handle, stored });
+    m_file_watcher->watch(path);
+    evict();
+
+    return m;
 }
 
 const shared_ptr<model> resource_system::get_gltf_model(const string& name)
@@ -125,15 +208,176 @@ const shared_ptr<model> resource_system::get_gltf_model(const string& name)
     // check if model is loaded
     auto it = m_model_storage.find(handle);
     if (it != m_model_storage.end())
-        return it->second;
+    {
+        it->second.last_access = ++m_access_counter;
+        return it->second.resource;
+    }
 
     MANGO_LOG_ERROR("Model '{0}' is not loaded!", name);
     return nullptr;
 }
 
+ptr_size resource_system::get_memory_usage(resource_type type)
+{
+    switch (type)
+    {
+    case resource_type::image:
+        return m_image_memory;
+    case resource_type::model:
+        return m_model_memory;
+    default:
+        return 0;
+    }
+}
+
+uint32 resource_system::watch_file(const string& path, std::function<void()> on_change)
+{
+    file_callback fc;
+    fc.id       = m_next_callback_id++;
+    fc.path     = path;
+    fc.callback = on_change;
+    m_file_callbacks.push_back(fc);
+    m_file_watcher->watch(path);
+    return fc.id;
+}
+
+void resource_system::unwatch_file(uint32 id)
+{
+    m_file_callbacks.erase(std::remove_if(m_file_callbacks.begin(), m_file_callbacks.end(), [id](const file_callback& fc) { return fc.id == id; }), m_file_callbacks.end());
+}
+
+void resource_system::watch_shader_program(const shader_program_ptr& program)
+{
+    MANGO_ASSERT(program, "Shader program is not valid!");
+    for (auto& wp : m_watched_programs)
+    {
+        if (wp.program.lock() == program)
+            return;
+    }
+
+    watched_program wp;
+    wp.program                       = program;
+    weak_ptr<shader_program> watched = program;
+
+    // included files are watched as well, each file only once per program.
+    std::vector<string> paths;
+    for (auto& s : program->get_shaders())
+    {
+        if (std::find(paths.begin(), paths.end(), s->get_path()) == paths.end())
+            paths.push_back(s->get_path());
+        for (auto& included : s->get_included_files())
+        {
+            if (std::find(paths.begin(), paths.end(), included) == paths.end())
+                paths.push_back(included);
+        }
+    }
+
+    for (auto& path : paths)
+    {
+        wp.callback_ids.push_back(watch_file(path, [watched, path]() {
+            shader_program_ptr p = watched.lock();
+            if (!p)
+                return;
+            MANGO_LOG_INFO("Recompiling shader program after modification of '{0}'!", path);
+            p->start_reload();
+        }));
+    }
+    m_watched_programs.push_back(wp);
+}
+
+void resource_system::update_shader_programs()
+{
+    for (auto it = m_watched_programs.begin(); it != m_watched_programs.end();)
+    {
+        shader_program_ptr p = it->program.lock();
+        if (!p)
+        {
+            // the program was replaced or released, so its callbacks would never do anything again.
+            for (uint32 id : it->callback_ids)
+                unwatch_file(id);
+            it = m_watched_programs.erase(it);
+            continue;
+        }
+
+        // swapping happens between two frames, so no recorded command uses the old program anymore.
+        if (p->is_reload_ready())
+        {
+            if (p->finish_reload())
+            {
+                MANGO_LOG_INFO("Reloaded shader program!");
+            }
+            else
+            {
+                MANGO_LOG_ERROR("Reloading shader program failed! The old program is kept!");
+            }
+        }
+        ++it;
+    }
+}
+
+void resource_system::evict()
+{
+    if (m_image_memory + m_model_memory <= m_memory_budget)
+        return;
+
+    // only resources without references outside of the storage can be released.
+    std::vector<std::pair<uint64, resource_handle>> image_candidates;
+    std::vector<std::pair<uint64, resource_handle>> model_candidates;
+    for (auto& entry : m_image_storage)
+    {
+        if (entry.second.resource.use_count() == 1)
+            image_candidates.push_back({ entry.second.last_access, entry.first });
+    }
+    for (auto& entry : m_model_storage)
+    {
+        if (entry.second.resource.use_count() == 1)
+            model_candidates.push_back({ entry.second.last_access, entry.first });
+    }
+
+    auto least_recently_used = [](const std::pair<uint64, resource_handle>& a, const std::pair<uint64, resource_handle>& b) { return a.first < b.first; };
+    std::sort(image_candidates.begin(), image_candidates.end(), least_recently_used);
+    std::sort(model_candidates.begin(), model_candidates.end(), least_recently_used);
+
+    auto image_it = image_candidates.begin();
+    auto model_it = model_candidates.begin();
+    while (m_image_memory + m_model_memory > m_memory_budget && (image_it != image_candidates.end() || model_it != model_candidates.end()))
+    {
+        bool evict_image = model_it == model_candidates.end() || (image_it != image_candidates.end() && image_it->first < model_it->first);
+        if (evict_image)
+        {
+            auto stored = m_image_storage.find(image_it->second);
+            MANGO_LOG_DEBUG("Releasing image '{0}'!", image_it->second.name);
+            m_image_memory -= stored->second.memory;
+            m_image_storage.erase(stored);
+            ++image_it;
+        }
+        else
+        {
+            auto stored = m_model_storage.find(model_it->second);
+            MANGO_LOG_DEBUG("Releasing model '{0}'!", model_it->second.name);
+            m_model_memory -= stored->second.memory;
+            m_model_storage.erase(stored);
+            ++model_it;
+        }
+    }
+}
+
+static ptr_size model_memory(const model& m)
+{
+    ptr_size memory = 0;
+    for (auto& b : m.gltf_model.buffers)
+        memory += b.data.size();
+    for (auto& i : m.gltf_model.images)
+        memory += i.image.size();
+    return memory;
+}
+
 static image load_image_from_file(const string& path, const image_configuration& configuration)
 {
     image img;
+    img.data   = nullptr;
+    img.width  = 0;
+    img.height = 0;
     // stbi_set_flip_vertically_on_load(true); // This is usually needed for OpenGl
 
     int width = 0, height = 0, components = 0;
@@ -8,7 +8,9 @@
 #define MANGO_RESOURCE_SYSTEM_HPP
 
 #include <core/context_impl.hpp>
+#include <graphics/graphics_common.hpp>
 #include <mango/system.hpp>
+#include <resources/file_watcher.hpp>
 #include <resources/image_structures.hpp>
 #include <resources/model_structures.hpp>
 #include <util/hashing.hpp>
@@ -40,9 +42,22 @@ namespace mango
         }
     };
 
+    //! \brief A resource stored in the \a resource_system.
+    //! \details The \a resource_system holds one reference, so a resource is unreferenced if the use count is one.
+    template <typename T>
+    struct stored_resource
+    {
+        shared_ptr<T> resource; //!< The stored resource.
+        string path;            //!< The path the resource was loaded from.
+        ptr_size memory;        //!< The cpu memory occupied by the resource in bytes.
+        uint64 last_access;     //!< The access counter value of the last load or retrieval of the resource.
+    };
+
     //! \brief The \a resource_system of mango.
     //! \details This system is responsible for all resources in mango.
     //! This includes images and meshes.
+    //! Resources are reference counted, unreferenced resources are released in least recently used order when the memory budget is exceeded.
+    //! All loaded files are watched, modified ones are dropped from the storage and reloaded on the next load call.
     class resource_system : public system
     {
       public:
@@ -77,17 +92,89 @@ namespace mango
         //! \return A pointer to the model specified.
         const shared_ptr<model> get_gltf_model(const string& name);
 
+        //! \brief Sets the cpu memory budget for all resources.
+        //! \param[in] budget The memory budget in bytes.
+        inline void set_memory_budget(ptr_size budget)
+        {
+            m_memory_budget = budget;
+        }
+
+        //! \brief Returns the cpu memory occupied by resources of a specific type.
+        //! \param[in] type The \a resource_type to query the memory for.
+        //! \return The memory in bytes.
+        ptr_size get_memory_usage(resource_type type);
+
+        //! \brief Registers a callback for modifications of a file on disk.
+        //! \details The callback is called in update(), so it is executed between two frames.
+        //! \param[in] path The path to the file. Relative to the project folder.
+        //! \param[in] on_change The function to call after the file was modified.
+        //! \return An id that can be used to remove the callback with unwatch_file().
+        uint32 watch_file(const string& path, std::function<void()> on_change);
+
+        //! \brief Removes a callback registered with watch_file().
+        //! \param[in] id The id returned by watch_file().
+        void unwatch_file(uint32 id);
+
+        //! \brief Reloads a \a shader_program whenever the source of one of its \a shaders is modified.
+        //! \details The new program is built in the background and swapped in by update() once it is ready.
+        //! The \a shader_program is only replaced if all \a shaders compile and the program links, else the old one stays in use.
+        //! Watching the same \a shader_program again has no effect. The watch is removed when the \a shader_program is released.
+        //! \param[in] program The \a shader_program to watch.
+        void watch_shader_program(const shader_program_ptr& program);
+
       private:
+        //! \brief Releases unreferenced resources in least recently used order until the memory budget is satisfied.
+        void evict();
+
+        //! \brief The default cpu memory budget for all resources in bytes.
+        const ptr_size default_memory_budget = 512 * 1024 * 1024;
+
         //! \brief Mangos internal context for shared usage in the \a resource_system.
         shared_ptr<context_impl> m_shared_context;
 
         //! \brief The storage for \a images.
         //! \details The key is a resource_handle which is hashed with fnv1a.
-        std::unordered_map<resource_handle, shared_ptr<image>, hash<resource_handle>> m_image_storage;
+        std::unordered_map<resource_handle, stored_resource<image>, hash<resource_handle>> m_image_storage;
 
-        //! \brief The storage for \a images.
+        //! \brief The storage for \a models.
         //! \details The key is a resource_handle which is hashed with fnv1a.
-        std::unordered_map<resource_handle, shared_ptr<model>, hash<resource_handle>> m_model_storage;
+        std::unordered_map<resource_handle, stored_resource<model>, hash<resource_handle>> m_model_storage;
+
+        //! \brief The cpu memory budget for all resources in bytes.
+        ptr_size m_memory_budget;
+        //! \brief The cpu memory occupied by all \a images in bytes.
+        ptr_size m_image_memory;
+        //! \brief The cpu memory occupied by all \a models in bytes.
+        ptr_size m_model_memory;
+        //! \brief Counter incremented on each resource access. Used to determine the least recently used resources.
+        uint64 m_access_counter;
+
+        //! \brief A callback for file modifications.
+        struct file_callback
+        {
+            uint32 id;                      //!< The id returned by watch_file().
+            string path;                    //!< The path to the watched file.
+            std::function<void()> callback; //!< The function to call.
+        };
+
+        //! \brief A \a shader_program reloaded on modifications.
+        struct watched_program
+        {
+            weak_ptr<shader_program> program; //!< The watched \a shader_program.
+            std::vector<uint32> callback_ids; //!< The ids of the file callbacks for the sources of the program.
+        };
+
+        //! \brief Swaps in reloaded \a shader_programs that are ready and removes the watches of released ones.
+        void update_shader_programs();
+
+        //! \brief Watches all loaded and registered files.
+        unique_ptr<file_watcher> m_file_watcher;
+        //! \brief All registered file callbacks.
+        std::vector<file_callback> m_file_callbacks;
+        //! \brief All watched \a shader_programs.
+        std::vector<watched_program> m_watched_programs;
+        //! \brief The id of the next registered callback.
+        uint32 m_next_callback_id;
     };
 
 } // namespace mango
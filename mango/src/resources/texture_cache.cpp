@@ -0,0 +1,54 @@
+//! \file      texture_cache.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <resources/texture_cache.hpp>
+
+using namespace mango;
+
+texture_cache::texture_cache() {}
+
+texture_cache::~texture_cache() {}
+
+texture_ptr texture_cache::get_texture(const texture_cache_key& key)
+{
+    auto it = m_textures.find(key);
+    if (it == m_textures.end())
+        return nullptr;
+
+    texture_ptr cached = it->second.lock();
+    if (!cached)
+        m_textures.erase(it); // released by all materials.
+
+    return cached;
+}
+
+void texture_cache::add_texture(const texture_cache_key& key, const texture_ptr& tex)
+{
+    MANGO_ASSERT(tex, "Texture is not valid!");
+    m_textures[key] = tex;
+}
+
+void texture_cache::remove_textures(const string& model)
+{
+    for (auto it = m_textures.begin(); it != m_textures.end();)
+    {
+        if (it->first.model == model)
+            it = m_textures.erase(it);
+        else
+            ++it;
+    }
+}
+
+sampler_ptr texture_cache::get_sampler(const sampler_configuration& configuration)
+{
+    auto it = m_samplers.find(configuration);
+    if (it != m_samplers.end())
+        return it->second;
+
+    sampler_ptr new_sampler = sampler::create(configuration);
+    m_samplers.insert({ configuration, new_sampler });
+    return new_sampler;
+}
@@ -0,0 +1,89 @@
+//! \file      texture_cache.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_TEXTURE_CACHE_HPP
+#define MANGO_TEXTURE_CACHE_HPP
+
+#include <graphics/sampler.hpp>
+#include <graphics/texture.hpp>
+#include <unordered_map>
+#include <util/hashing.hpp>
+
+namespace mango
+{
+    //! \brief The key of a cached \a texture.
+    //! \details A \a texture is identified by the image it was created from, the color space it is interpreted in and if it is used as normal map.
+    struct texture_cache_key
+    {
+        string model;              //!< The path of the model the image belongs to.
+        int32 image;               //!< The index of the image in the model.
+        bool standard_color_space; //!< Specifies if the \a texture is interpreted as SRGB.
+        bool normal_map;           //!< Specifies if the \a texture contains tangent space normals.
+
+        //! \brief Hash function for the \a texture_cache_key.
+        //! \return The hash value.
+        std::size_t hash_code() const
+        {
+            fnv1a hash;
+            hash(model.data(), model.size());
+            hash(&image, sizeof(image));
+            hash(&standard_color_space, sizeof(standard_color_space));
+            hash(&normal_map, sizeof(normal_map));
+            return static_cast<std::size_t>(hash);
+        }
+
+        //! \brief Comparison operator for \a texture_cache_keys.
+        //! \param[in] other The \a texture_cache_key to compare this to.
+        //! \return True if this and other are equal, else false.
+        bool operator==(const texture_cache_key& other) const
+        {
+            return image == other.image && standard_color_space == other.standard_color_space && normal_map == other.normal_map && model == other.model;
+        }
+    };
+
+    //! \brief Cache for \a textures and \a samplers shared between materials.
+    //! \details Each image is uploaded only once per color space, \a textures are shared as long as any material references them.
+    //! \a Samplers are shared between all \a textures with the same filter and wrap parameters.
+    class texture_cache
+    {
+      public:
+        texture_cache();
+        ~texture_cache();
+
+        //! \brief Retrieves a cached \a texture.
+        //! \param[in] key The \a texture_cache_key of the \a texture.
+        //! \return A pointer to the cached \a texture or nullptr if there is none.
+        texture_ptr get_texture(const texture_cache_key& key);
+
+        //! \brief Adds a \a texture to the cache.
+        //! \details The cache does not keep the \a texture alive.
+        //! \param[in] key The \a texture_cache_key of the \a texture.
+        //! \param[in] tex The \a texture to cache.
+        void add_texture(const texture_cache_key& key, const texture_ptr& tex);
+
+        //! \brief Removes all cached \a textures of a model.
+        //! \details Used when the model gets reimported, \a textures still referenced by materials stay alive.
+        //! \param[in] model The path of the model.
+        void remove_textures(const string& model);
+
+        //! \brief Retrieves the \a sampler for a \a sampler_configuration.
+        //! \details Creates the \a sampler if there is none cached yet.
+        //! \param[in] configuration The \a sampler_configuration of the \a sampler.
+        //! \return A pointer to the \a sampler.
+        sampler_ptr get_sampler(const sampler_configuration& configuration);
+
+      private:
+        //! \brief The cached \a textures.
+        //! \details The key is a texture_cache_key which is hashed with fnv1a.
+        std::unordered_map<texture_cache_key, weak_ptr<texture>, hash<texture_cache_key>> m_textures;
+
+        //! \brief The cached \a samplers.
+        //! \details The key is a sampler_configuration which is hashed with fnv1a.
+        std::unordered_map<sampler_configuration, sampler_ptr, hash<sampler_configuration>> m_samplers;
+    };
+} // namespace mango
+
+#endif // MANGO_TEXTURE_CACHE_HPP
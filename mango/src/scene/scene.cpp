@@ -5,18 +5,26 @@
 //! \copyright Apache License 2.0
 
 #include <core/context_impl.hpp>
+#include <core/window_system_impl.hpp>
+#include <cstddef>
+#include <cstring>
 #include <glad/glad.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/component_wise.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
 #include <graphics/buffer.hpp>
+#include <graphics/sampler.hpp>
 #include <graphics/texture.hpp>
 #include <graphics/vertex_array.hpp>
 #include <mango/scene.hpp>
 #include <mango/scene_types.hpp>
 #include <rendering/render_system_impl.hpp>
+#include <rendering/texture_streaming.hpp>
+#include <resources/mesh_processing.hpp>
 #include <resources/resource_system.hpp>
+#include <resources/texture_cache.hpp>
+#include <util/hashing.hpp>
 
 using namespace mango;
 
@@ -25,13 +33,41 @@ static void update_scene_boundaries(glm::mat4& trafo, tinygltf::Model& m, tinygl
 static void scene_graph_update(scene_component_manager<node_component>& nodes, scene_component_manager<transform_component>& transformations);
 static void transformation_update(scene_component_manager<transform_component>& transformations);
 static void camera_update(scene_component_manager<camera_component>& cameras, scene_component_manager<transform_component>& transformations);
-static void render_meshes(shared_ptr<render_system_impl> rs, scene_component_manager<mesh_component>& meshes, scene_component_manager<transform_component>& transformations);
+static void render_meshes(shared_ptr<render_system_impl> rs, scene_component_manager<mesh_component>& meshes, scene_component_manager<transform_component>& transformations, const camera_data& camera,
+                          uint32 viewport_height);
+static void render_lights(shared_ptr<render_system_impl> rs, scene_component_manager<light_component>& lights, scene_component_manager<transform_component>& transformations);
+static void set_texture_data(const shared_ptr<render_system_impl>& rs, const texture_ptr& tex, format internal, const tinygltf::Image& image, format f, format type);
+static void build_primitive_lods(primitive_component& p, const tinygltf::Model& m, const tinygltf::Primitive& primitive);
+static uint32 select_primitive_lod(const primitive_component& p, float pixels_per_unit);
+static void optimize_model_primitives(tinygltf::Model& m);
+static bool compute_quantization_bounds(const tinygltf::Model& m, const tinygltf::Mesh& mesh, glm::vec3& min_position, glm::vec3& max_position);
+static bool bind_quantized_vertices(primitive_component& p, const tinygltf::Model& m, const tinygltf::Primitive& primitive, const glm::vec3& position_offset, const glm::vec3& position_scale);
+
+//! \brief The maximum number of levels of detail per primitive, including the full detail one.
+static const uint32 max_primitive_lods = 5;
+//! \brief Primitives with less triangles are not simplified any further.
+static const uint32 min_lod_triangles = 128;
+//! \brief The largest error of a level of detail in pixels that is accepted.
+static const float lod_pixel_error = 1.0f;
+//! \brief Factor for the pixel error a coarser level of detail has to stay below before it is taken, so models near a switching distance do not pop every frame.
+static const float lod_hysteresis = 0.5f;
+//! \brief Primitives with less triangles are not split into meshlets.
+static const uint32 min_meshlet_triangles = 8192;
+//! \brief The maximum number of unique vertices per meshlet.
+static const uint32 max_meshlet_vertices = 64;
+//! \brief The maximum number of triangles per meshlet.
+static const uint32 max_meshlet_triangles = 124;
+//! \brief The factor the cache efficiency may get worse by when triangles are reordered to reduce overdraw.
+static const float overdraw_threshold = 1.05f;
+//! \brief The size of the vertex cache the average cache miss ratio is reported for.
+static const uint32 reported_vertex_cache_size = 16;
 
 scene::scene(const string& name)
     : m_nodes()
     , m_transformations()
     , m_meshes()
     , m_cameras()
+    , m_lights()
 {
     MANGO_UNUSED(name);
     m_active_camera        = invalid_entity;
@@ -40,9 +76,20 @@ scene::scene(const string& name)
 
     for (uint32 i = 1; i <= max_entities; ++i)
         m_free_entities.push(i);
+
+    m_texture_cache       = std::make_shared<texture_cache>();
+    m_vertex_quantization = false;
 }
 
-scene::~scene() {}
+scene::~scene()
+{
+    shared_ptr<resource_system> res = m_shared_context ? m_shared_context->get_resource_system_internal().lock() : nullptr;
+    if (res)
+    {
+        for (auto& watch : m_file_watches)
+            res->unwatch_file(watch.second);
+    }
+}
 
 entity scene::create_empty()
 {
@@ -62,6 +109,9 @@ void scene::remove_entity(entity e)
     m_meshes.remove_component_from(e);
     m_cameras.remove_component_from(e);
     m_environments.remove_component_from(e);
+    m_lights.remove_component_from(e);
+    m_model_sources.erase(e);
+    m_environment_sources.erase(e);
     m_free_entities.push(e);
     MANGO_LOG_DEBUG("Removed entity {0}, {1} left", e, m_free_entities.size());
 }
@@ -95,27 +145,76 @@ entity scene::create_default_camera()
     return camera_entity;
 }
 
+entity scene::create_light(light_type type)
+{
+    entity light_entity       = create_empty();
+    auto& light_component     = m_lights.create_component_for(light_entity);
+    auto& transform_component = m_transformations.create_component_for(light_entity);
+    MANGO_UNUSED(transform_component);
+
+    light_component.type = type;
+
+    return light_entity;
+}
+
 std::vector<entity> scene::create_entities_from_model(const string& path)
 {
     std::vector<entity> scene_entities;
     entity scene_root = create_empty();
     auto& transform   = m_transformations.create_component_for(scene_root);
     scene_entities.push_back(scene_root);
+
+    glm::vec3 max_backup   = m_scene_boundaries.max;
+    glm::vec3 min_backup   = m_scene_boundaries.min;
+    m_scene_boundaries.max = glm::vec3(-3.402823e+38f);
+    m_scene_boundaries.min = glm::vec3(3.402823e+38f);
+
+    build_model(scene_root, path, scene_entities);
+    m_model_sources.insert({ scene_root, path });
+    watch_file(path);
+
+    // normalize scale
+    const glm::vec3 scale = glm::vec3(1.0f / (glm::compMax(m_scene_boundaries.max) - glm::compMin(m_scene_boundaries.min)));
+    transform.scale       = scale;
+
+    if (m_active_camera == invalid_entity)
+    {
+        // We have at least one default camera in each scene and at the moment the first camera is the active one everytime.
+        create_default_camera();
+    }
+
+    m_cameras.get_component_for_entity(m_active_camera)->target = (m_scene_boundaries.max + m_scene_boundaries.min) * 0.5f * scale;
+
+    m_scene_boundaries.max =
+        glm::max(m_scene_boundaries.max, max_backup); // TODO Paul: This is just in case all other assets are still here, we need to do the calculation with all still existing entities.
+    m_scene_boundaries.min =
+        glm::min(m_scene_boundaries.min, min_backup); // TODO Paul: This is just in case all other assets are still here, we need to do the calculation with all still existing entities.
+
+    return scene_entities;
+}
+
+void scene::build_model(entity root, const string& path, std::vector<entity>& entities)
+{
     shared_ptr<resource_system> rs = m_shared_context->get_resource_system_internal().lock();
     MANGO_ASSERT(rs, "Resource System is invalid!");
     auto start                     = path.find_last_of("\\/") + 1;
     auto name                      = path.substr(start, path.find_last_of(".") - start);
     model_configuration config     = { name };
     const shared_ptr<model> loaded = rs->load_gltf(path, config);
-    tinygltf::Model& m             = loaded->gltf_model;
+    if (!loaded)
+        return;
+    tinygltf::Model& m = loaded->gltf_model;
 
     // load the default scene or the first one.
-    glm::vec3 max_backup   = m_scene_boundaries.max;
-    glm::vec3 min_backup   = m_scene_boundaries.min;
-    m_scene_boundaries.max = glm::vec3(-3.402823e+38f);
-    m_scene_boundaries.min = glm::vec3(3.402823e+38f);
     MANGO_ASSERT(m.scenes.size() > 0, "No scenes in the gltf model found!");
 
+    // the buffer data is reordered before it is uploaded. Cached models were already reordered by an earlier load.
+    if (!loaded->primitives_optimized)
+    {
+        optimize_model_primitives(m);
+        loaded->primitives_optimized = true;
+    }
+
     // load all model buffer views into buffers.
     std::map<int, buffer_ptr> index_to_buffer_data;
 
@@ -146,29 +245,10 @@ std::vector<entity> scene::create_entities_from_model(const string& path)
     const tinygltf::Scene& scene = m.scenes[scene_id];
     for (uint32 i = 0; i < scene.nodes.size(); ++i)
     {
-        entity node = build_model_node(scene_entities, m, m.nodes.at(scene.nodes.at(i)), glm::mat4(1.0), index_to_buffer_data);
-
-        attach(node, scene_root);
-    }
+        entity node = build_model_node(entities, m, m.nodes.at(scene.nodes.at(i)), glm::mat4(1.0), index_to_buffer_data, path);
 
-    // normalize scale
-    const glm::vec3 scale = glm::vec3(1.0f / (glm::compMax(m_scene_boundaries.max) - glm::compMin(m_scene_boundaries.min)));
-    transform.scale       = scale;
-
-    if (m_active_camera == invalid_entity)
-    {
-        // We have at least one default camera in each scene and at the moment the first camera is the active one everytime.
-        create_default_camera();
+        attach(node, root);
     }
-
-    m_cameras.get_component_for_entity(m_active_camera)->target = (m_scene_boundaries.max + m_scene_boundaries.min) * 0.5f * scale;
-
-    m_scene_boundaries.max =
-        glm::max(m_scene_boundaries.max, max_backup); // TODO Paul: This is just in case all other assets are still here, we need to do the calculation with all still existing entities.
-    m_scene_boundaries.min =
-        glm::min(m_scene_boundaries.min, min_backup); // TODO Paul: This is just in case all other assets are still here, we need to do the calculation with all still existing entities.
-
-    return scene_entities;
 }
 
 entity scene::create_environment_from_hdr(const string& path, float rendered_mip_level)
@@ -179,6 +259,15 @@ entity scene::create_environment_from_hdr(const string& path, float rendered_mip
     // default rotation and scale
     environment.rotation_scale_matrix = glm::mat3(1.0f);
 
+    build_environment(environment, path, rendered_mip_level);
+    m_environment_sources.insert({ environment_entity, { path, rendered_mip_level } });
+    watch_file(path);
+
+    return environment_entity;
+}
+
+void scene::build_environment(environment_component& environment, const string& path, float rendered_mip_level)
+{
     // load image and texture
     shared_ptr<resource_system> res = m_shared_context->get_resource_system_internal().lock();
     MANGO_ASSERT(res, "Resource System is expired!");
@@ -208,11 +297,82 @@ entity scene::create_environment_from_hdr(const string& path, float rendered_mip
 
     environment.hdr_texture = hdr_texture;
 
+    // the precomputed lighting is cached by the content, so a modified file with the same path is not mixed up.
+    fnv1a content_hash;
+    content_hash(hdr_image->data, static_cast<std::size_t>(hdr_image->width) * hdr_image->height * 4 * sizeof(float));
+    content_hash(&hdr_image->width, sizeof(hdr_image->width));
+    content_hash(&hdr_image->height, sizeof(hdr_image->height));
+
     shared_ptr<render_system_impl> rs = m_shared_context->get_render_system_internal().lock();
     MANGO_ASSERT(rs, "Render System is expired!");
-    rs->set_environment_texture(environment.hdr_texture, rendered_mip_level); // TODO Paul: Transformation?
+    rs->set_environment_texture(environment.hdr_texture, static_cast<uint64>(static_cast<std::size_t>(content_hash)), rendered_mip_level); // TODO Paul: Transformation?
+}
 
-    return environment_entity;
+void scene::watch_file(const string& path)
+{
+    if (m_file_watches.find(path) != m_file_watches.end())
+        return;
+
+    shared_ptr<resource_system> res = m_shared_context->get_resource_system_internal().lock();
+    MANGO_ASSERT(res, "Resource System is expired!");
+    m_file_watches.insert({ path, res->watch_file(path, [this, path]() { reload_file(path); }) });
+}
+
+void scene::reload_file(const string& path)
+{
+    // the resource system already dropped the old data, so everything built from the file is loaded again.
+    m_texture_cache->remove_textures(path);
+
+    glm::vec3 max_backup = m_scene_boundaries.max;
+    glm::vec3 min_backup = m_scene_boundaries.min;
+    for (auto& source : m_model_sources)
+    {
+        if (source.second != path)
+            continue;
+
+        // only the entities below the root are replaced, so the transformation of the model is kept.
+        MANGO_LOG_INFO("Reimporting model '{0}'!", path);
+        std::vector<entity> children;
+        for (size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            if (m_nodes.component_at(i).parent_entity == source.first)
+                children.push_back(m_nodes.entity_at(i));
+        }
+        for (entity child : children)
+            remove_entity_tree(child);
+
+        std::vector<entity> entities;
+        build_model(source.first, path, entities);
+    }
+    m_scene_boundaries.max = max_backup;
+    m_scene_boundaries.min = min_backup;
+
+    for (auto& source : m_environment_sources)
+    {
+        if (source.second.path != path)
+            continue;
+
+        environment_component* environment = m_environments.get_component_for_entity(source.first);
+        if (environment)
+        {
+            MANGO_LOG_INFO("Reimporting environment '{0}'!", path);
+            build_environment(*environment, path, source.second.rendered_mip_level);
+        }
+    }
+}
+
+void scene::remove_entity_tree(entity e)
+{
+    std::vector<entity> children;
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        if (m_nodes.component_at(i).parent_entity == e)
+            children.push_back(m_nodes.entity_at(i));
+    }
+    for (entity child : children)
+        remove_entity_tree(child);
+
+    remove_entity(e);
 }
 
 void scene::update(float dt)
@@ -228,7 +388,9 @@ void scene::render()
     shared_ptr<render_system_impl> rs = m_shared_context->get_render_system_internal().lock();
     MANGO_ASSERT(rs, "Render System is expired!");
 
-    render_meshes(rs, m_meshes, m_transformations);
+    render_lights(rs, m_lights, m_transformations);
+    // levels of detail are selected for the resolution the scene is rendered in, not the window size.
+    render_meshes(rs, m_meshes, m_transformations, get_active_camera_data(), rs->get_render_height());
 }
 
 void scene::attach(entity child, entity parent)
@@ -298,7 +460,8 @@ void scene::detach(entity child)
     m_nodes.sort_remove_component_from(child);
 }
 
-entity scene::build_model_node(std::vector<entity>& entities, tinygltf::Model& m, tinygltf::Node& n, const glm::mat4& parent_world, const std::map<int, buffer_ptr>& buffer_map)
+entity scene::build_model_node(std::vector<entity>& entities, tinygltf::Model& m, tinygltf::Node& n, const glm::mat4& parent_world, const std::map<int, buffer_ptr>& buffer_map,
+                              const string& model_path)
 {
     entity node     = create_empty();
     auto& transform = m_transformations.create_component_for(node);
@@ -337,7 +500,7 @@ entity scene::build_model_node(std::vector<entity>& entities, tinygltf::Model& m
     if (n.mesh > -1)
     {
         MANGO_ASSERT((uint32)n.mesh < m.meshes.size(), "Invalid gltf mesh!");
-        build_model_mesh(node, m, m.meshes.at(n.mesh), buffer_map);
+        build_model_mesh(node, m, m.meshes.at(n.mesh), buffer_map, model_path);
         update_scene_boundaries(trafo, m, m.meshes.at(n.mesh), m_scene_boundaries.min, m_scene_boundaries.max);
     }
 
@@ -348,16 +511,23 @@ entity scene::build_model_node(std::vector<entity>& entities, tinygltf::Model& m
     {
         MANGO_ASSERT((uint32)n.children[i] < m.nodes.size(), "Invalid gltf node!");
 
-        entity child = build_model_node(entities, m, m.nodes.at(n.children.at(i)), trafo, buffer_map);
+        entity child = build_model_node(entities, m, m.nodes.at(n.children.at(i)), trafo, buffer_map, model_path);
         attach(child, node);
     }
 
     return node;
 }
 
-void scene::build_model_mesh(entity node, tinygltf::Model& m, tinygltf::Mesh& mesh, const std::map<int, buffer_ptr>& buffer_map)
+void scene::build_model_mesh(entity node, tinygltf::Model& m, tinygltf::Mesh& mesh, const std::map<int, buffer_ptr>& buffer_map, const string& model_path)
 {
-    auto& component_mesh = m_meshes.create_component_for(node);
+    auto& component_mesh       = m_meshes.create_component_for(node);
+    component_mesh.min_extents = glm::vec3(3.402823e+38f);
+    component_mesh.max_extents = glm::vec3(-3.402823e+38f);
+
+    // the vertices of all primitives are quantized relative to the bounds of the mesh, so they are dequantized with the model info.
+    glm::vec3 quantization_min, quantization_max;
+    bool quantize                           = m_vertex_quantization && compute_quantization_bounds(m, mesh, quantization_min, quantization_max);
+    component_mesh.has_quantized_attributes = quantize;
 
     for (size_t i = 0; i < mesh.primitives.size(); ++i)
     {
@@ -393,13 +563,19 @@ void scene::build_model_mesh(entity node, tinygltf::Model& m, tinygltf::Mesh& me
             has_indices = false;
         }
 
+        if (quantize && !bind_quantized_vertices(p, m, primitive, quantization_min, quantization_max - quantization_min))
+        {
+            MANGO_LOG_ERROR("Creation of the quantized vertex buffer failed!");
+            continue;
+        }
+
         material_component mat;
         mat.component_material             = std::make_shared<material>();
         mat.component_material->base_color = glm::vec4(glm::vec3(0.9f), 1.0f);
         mat.component_material->metallic   = 0.0f;
         mat.component_material->roughness  = 1.0f;
 
-        load_material(mat, primitive, m);
+        load_material(mat, primitive, m, model_path);
 
         component_mesh.materials.push_back(mat);
 
@@ -420,7 +596,14 @@ void scene::build_model_mesh(entity node, tinygltf::Model& m, tinygltf::Mesh& me
 
             int attrib_array = -1;
             if (attrib.first.compare("POSITION") == 0)
+            {
                 attrib_array = 0;
+                if (accessor.minValues.size() >= 3 && accessor.maxValues.size() >= 3)
+                {
+                    component_mesh.min_extents = glm::min(component_mesh.min_extents, glm::vec3((float)accessor.minValues[0], (float)accessor.minValues[1], (float)accessor.minValues[2]));
+                    component_mesh.max_extents = glm::max(component_mesh.max_extents, glm::vec3((float)accessor.maxValues[0], (float)accessor.maxValues[1], (float)accessor.maxValues[2]));
+                }
+            }
             if (attrib.first.compare("NORMAL") == 0)
             {
                 component_mesh.has_normals = true;
@@ -433,7 +616,15 @@ void scene::build_model_mesh(entity node, tinygltf::Model& m, tinygltf::Mesh& me
                 component_mesh.has_tangents = true;
                 attrib_array                = 3;
             }
-            if (attrib_array > -1)
+            if (attrib_array > -1 && quantize)
+            {
+                // already bound as one interleaved buffer.
+                if (attrib_array == 0 && !has_indices)
+                {
+                    p.count = accessor.count;
+                }
+            }
+            else if (attrib_array > -1)
             {
                 auto it = buffer_map.find(accessor.bufferView);
                 if (it == buffer_map.end())
@@ -459,11 +650,21 @@ void scene::build_model_mesh(entity node, tinygltf::Model& m, tinygltf::Mesh& me
             }
         }
 
+        p.current_lod = 0;
+        if (has_indices && p.topology == primitive_topology::TRIANGLES)
+            build_primitive_lods(p, m, primitive);
+
         component_mesh.primitives.push_back(p);
     }
+
+    if (quantize)
+    {
+        component_mesh.min_extents = quantization_min;
+        component_mesh.max_extents = quantization_max;
+    }
 }
 
-void scene::load_material(material_component& material, const tinygltf::Primitive& primitive, tinygltf::Model& m)
+void scene::load_material(material_component& material, const tinygltf::Primitive& primitive, tinygltf::Model& m, const string& model_path)
 {
     if (primitive.material < 0)
         return;
@@ -478,16 +679,6 @@ void scene::load_material(material_component& material, const tinygltf::Primitiv
 
     auto& pbr = p_m.pbrMetallicRoughness;
 
-    // TODO Paul: Better structure?!
-
-    texture_configuration config;
-    config.m_generate_mipmaps        = 1;
-    config.m_is_standard_color_space = true;
-    config.m_texture_min_filter      = texture_parameter::FILTER_LINEAR_MIPMAP_LINEAR;
-    config.m_texture_mag_filter      = texture_parameter::FILTER_LINEAR;
-    config.m_texture_wrap_s          = texture_parameter::WRAP_REPEAT;
-    config.m_texture_wrap_t          = texture_parameter::WRAP_REPEAT;
-
     if (pbr.baseColorTexture.index < 0)
     {
         auto col                                = pbr.baseColorFactor;
@@ -496,55 +687,9 @@ void scene::load_material(material_component& material, const tinygltf::Primitiv
     else
     {
         // base color
-        const tinygltf::Texture& base_col = m.textures.at(pbr.baseColorTexture.index);
-
-        if (base_col.source < 0)
+        material.component_material->base_color_texture = load_texture(m, pbr.baseColorTexture.index, true, false, model_path, material.component_material->base_color_sampler);
+        if (!material.component_material->base_color_texture)
             return;
-
-        const tinygltf::Image& image     = m.images[static_cast<g_enum>(base_col.source)];
-        const tinygltf::Sampler& sampler = m.samplers[static_cast<g_enum>(base_col.sampler)];
-
-        if (base_col.sampler >= 0)
-        {
-            config.m_texture_min_filter = filter_parameter_from_gl(static_cast<g_enum>(sampler.minFilter));
-            config.m_texture_mag_filter = filter_parameter_from_gl(static_cast<g_enum>(sampler.magFilter));
-            config.m_texture_wrap_s     = wrap_parameter_from_gl(static_cast<g_enum>(sampler.wrapS));
-            config.m_texture_wrap_t     = wrap_parameter_from_gl(static_cast<g_enum>(sampler.wrapT));
-        }
-
-        config.m_is_standard_color_space = true;
-        config.m_generate_mipmaps        = calculate_mip_count(image.width, image.height);
-        texture_ptr base_color           = texture::create(config);
-
-        format f        = format::RGBA;
-        format internal = format::SRGB8_ALPHA8;
-
-        if (image.component == 1)
-        {
-            f = format::RED;
-        }
-        else if (image.component == 2)
-        {
-            f = format::RG;
-        }
-        else if (image.component == 3)
-        {
-            f        = format::RGB;
-            internal = format::SRGB8;
-        }
-
-        format type = format::UNSIGNED_BYTE;
-        if (image.bits == 16)
-        {
-            type = format::UNSIGNED_SHORT;
-        }
-        else if (image.bits == 32)
-        {
-            type = format::UNSIGNED_INT;
-        }
-
-        base_color->set_data(internal, image.width, image.height, f, type, &image.image.at(0));
-        material.component_material->base_color_texture = base_color;
     }
 
     // metallic / roughness
@@ -555,55 +700,10 @@ void scene::load_material(material_component& material, const tinygltf::Primitiv
     }
     else
     {
-        const tinygltf::Texture& o_r_m_t = m.textures.at(pbr.metallicRoughnessTexture.index);
-
-        if (o_r_m_t.source < 0)
+        material.component_material->roughness_metallic_texture =
+            load_texture(m, pbr.metallicRoughnessTexture.index, false, false, model_path, material.component_material->roughness_metallic_sampler);
+        if (!material.component_material->roughness_metallic_texture)
             return;
-
-        const tinygltf::Image& image     = m.images[o_r_m_t.source];
-        const tinygltf::Sampler& sampler = m.samplers[o_r_m_t.sampler];
-
-        if (o_r_m_t.sampler >= 0)
-        {
-            config.m_texture_min_filter = filter_parameter_from_gl(sampler.minFilter);
-            config.m_texture_mag_filter = filter_parameter_from_gl(sampler.magFilter);
-            config.m_texture_wrap_s     = wrap_parameter_from_gl(sampler.wrapS);
-            config.m_texture_wrap_t     = wrap_parameter_from_gl(sampler.wrapT);
-        }
-
-        config.m_is_standard_color_space = false;
-        config.m_generate_mipmaps        = calculate_mip_count(image.width, image.height);
-        texture_ptr o_r_m                = texture::create(config);
-
-        format f        = format::RGBA;
-        format internal = format::RGBA8;
-
-        if (image.component == 1)
-        {
-            f = format::RED;
-        }
-        else if (image.component == 2)
-        {
-            f = format::RG;
-        }
-        else if (image.component == 3)
-        {
-            f        = format::RGB;
-            internal = format::RGB8;
-        }
-
-        format type = format::UNSIGNED_BYTE;
-        if (image.bits == 16)
-        {
-            type = format::UNSIGNED_SHORT;
-        }
-        else if (image.bits == 32)
-        {
-            type = format::UNSIGNED_INT;
-        }
-
-        o_r_m->set_data(internal, image.width, image.height, f, type, &image.image.at(0));
-        material.component_material->roughness_metallic_texture = o_r_m;
     }
 
     // occlusion
@@ -616,110 +716,19 @@ void scene::load_material(material_component& material, const tinygltf::Primitiv
         }
         else
         {
-            material.component_material->packed_occlusion = false;
-            const tinygltf::Texture& occ                  = m.textures.at(p_m.occlusionTexture.index);
-            if (occ.source < 0)
+            material.component_material->packed_occlusion  = false;
+            material.component_material->occlusion_texture = load_texture(m, p_m.occlusionTexture.index, false, false, model_path, material.component_material->occlusion_sampler);
+            if (!material.component_material->occlusion_texture)
                 return;
-
-            const tinygltf::Image& image     = m.images[occ.source];
-            const tinygltf::Sampler& sampler = m.samplers[occ.sampler];
-
-            if (occ.sampler >= 0)
-            {
-                config.m_texture_min_filter = filter_parameter_from_gl(sampler.minFilter);
-                config.m_texture_mag_filter = filter_parameter_from_gl(sampler.magFilter);
-                config.m_texture_wrap_s     = wrap_parameter_from_gl(sampler.wrapS);
-                config.m_texture_wrap_t     = wrap_parameter_from_gl(sampler.wrapT);
-            }
-
-            config.m_is_standard_color_space = false;
-            config.m_generate_mipmaps        = calculate_mip_count(image.width, image.height);
-            texture_ptr occlusion            = texture::create(config);
-
-            format f        = format::RGBA;
-            format internal = format::RGBA8;
-
-            if (image.component == 1)
-            {
-                f = format::RED;
-            }
-            else if (image.component == 2)
-            {
-                f = format::RG;
-            }
-            else if (image.component == 3)
-            {
-                f        = format::RGB;
-                internal = format::RGB8;
-            }
-
-            format type = format::UNSIGNED_BYTE;
-            if (image.bits == 16)
-            {
-                type = format::UNSIGNED_SHORT;
-            }
-            else if (image.bits == 32)
-            {
-                type = format::UNSIGNED_INT;
-            }
-
-            occlusion->set_data(internal, image.width, image.height, f, type, &image.image.at(0));
-            material.component_material->occlusion_texture = occlusion;
         }
     }
 
     // normal
     if (p_m.normalTexture.index >= 0)
     {
-        const tinygltf::Texture& norm = m.textures.at(p_m.normalTexture.index);
-
-        if (norm.source < 0)
+        material.component_material->normal_texture = load_texture(m, p_m.normalTexture.index, false, true, model_path, material.component_material->normal_sampler);
+        if (!material.component_material->normal_texture)
             return;
-
-        const tinygltf::Image& image     = m.images[norm.source];
-        const tinygltf::Sampler& sampler = m.samplers[norm.sampler];
-
-        if (norm.sampler >= 0)
-        {
-            config.m_texture_min_filter = filter_parameter_from_gl(sampler.minFilter);
-            config.m_texture_mag_filter = filter_parameter_from_gl(sampler.magFilter);
-            config.m_texture_wrap_s     = wrap_parameter_from_gl(sampler.wrapS);
-            config.m_texture_wrap_t     = wrap_parameter_from_gl(sampler.wrapT);
-        }
-
-        config.m_is_standard_color_space = false;
-        config.m_generate_mipmaps        = calculate_mip_count(image.width, image.height);
-        texture_ptr normal_t             = texture::create(config);
-
-        format f        = format::RGBA;
-        format internal = format::RGBA8;
-
-        if (image.component == 1)
-        {
-            f = format::RED;
-        }
-        else if (image.component == 2)
-        {
-            f = format::RG;
-        }
-        else if (image.component == 3)
-        {
-            f        = format::RGB;
-            internal = format::RGB8;
-        }
-
-        format type = format::UNSIGNED_BYTE;
-        if (image.bits == 16)
-        {
-            type = format::UNSIGNED_SHORT;
-        }
-        else if (image.bits == 32)
-        {
-            type = format::UNSIGNED_INT;
-        }
-
-        normal_t->set_data(internal, image.width, image.height, f, type, &image.image.at(0));
-        material.component_material->normal_texture = normal_t;
     }
 
     // emissive
@@ -730,55 +739,9 @@ void scene::load_material(material_component& material, const tinygltf::Primitiv
     }
     else
     {
-        const tinygltf::Texture& emissive = m.textures.at(p_m.emissiveTexture.index);
-
-        if (emissive.source < 0)
+        material.component_material->emissive_color_texture = load_texture(m, p_m.emissiveTexture.index, true, false, model_path, material.component_material->emissive_color_sampler);
+        if (!material.component_material->emissive_color_texture)
             return;
-
-        const tinygltf::Image& image     = m.images[emissive.source];
-        const tinygltf::Sampler& sampler = m.samplers[emissive.sampler];
-
-        if (emissive.sampler >= 0)
-        {
-            config.m_texture_min_filter = filter_parameter_from_gl(sampler.minFilter);
-            config.m_texture_mag_filter = filter_parameter_from_gl(sampler.magFilter);
-            config.m_texture_wrap_s     = wrap_parameter_from_gl(sampler.wrapS);
-            config.m_texture_wrap_t     = wrap_parameter_from_gl(sampler.wrapT);
-        }
-
-        config.m_is_standard_color_space = true;
-        config.m_generate_mipmaps        = calculate_mip_count(image.width, image.height);
-        texture_ptr emissive_color       = texture::create(config);
-
-        format f        = format::RGBA;
-        format internal = format::SRGB8_ALPHA8;
-
-        if (image.component == 1)
-        {
-            f = format::RED;
-        }
-        else if (image.component == 2)
-        {
-            f = format::RG;
-        }
-        else if (image.component == 3)
-        {
-            f        = format::RGB;
-            internal = format::SRGB8;
-        }
-
-        format type = format::UNSIGNED_BYTE;
-        if (image.bits == 16)
-        {
-            type = format::UNSIGNED_SHORT;
-        }
-        else if (image.bits == 32)
-        {
-            type = format::UNSIGNED_INT;
-        }
-
-        emissive_color->set_data(internal, image.width, image.height, f, type, &image.image.at(0));
-        material.component_material->emissive_color_texture = emissive_color;
     }
 
     // transparency
@@ -800,6 +763,79 @@ void scene::load_material(material_component& material, const tinygltf::Primitiv
     }
 }
 
+texture_ptr scene::load_texture(tinygltf::Model& m, int texture_index, bool standard_color_space, bool normal_map, const string& model_path, sampler_ptr& texture_sampler)
+{
+    const tinygltf::Texture& tex = m.textures.at(texture_index);
+    if (tex.source < 0)
+        return nullptr;
+
+    // the sampling state is independent of the texture, so textures can be shared between different samplers.
+    sampler_configuration s_config;
+    s_config.m_texture_min_filter = texture_parameter::FILTER_LINEAR_MIPMAP_LINEAR;
+    s_config.m_texture_mag_filter = texture_parameter::FILTER_LINEAR;
+    s_config.m_texture_wrap_s     = texture_parameter::WRAP_REPEAT;
+    s_config.m_texture_wrap_t     = texture_parameter::WRAP_REPEAT;
+
+    if (tex.sampler >= 0)
+    {
+        const tinygltf::Sampler& sampler = m.samplers[static_cast<g_enum>(tex.sampler)];
+        s_config.m_texture_min_filter    = filter_parameter_from_gl(static_cast<g_enum>(sampler.minFilter));
+        s_config.m_texture_mag_filter    = filter_parameter_from_gl(static_cast<g_enum>(sampler.magFilter));
+        s_config.m_texture_wrap_s        = wrap_parameter_from_gl(static_cast<g_enum>(sampler.wrapS));
+        s_config.m_texture_wrap_t        = wrap_parameter_from_gl(static_cast<g_enum>(sampler.wrapT));
+    }
+    texture_sampler = m_texture_cache->get_sampler(s_config);
+
+    texture_cache_key key = { model_path, tex.source, standard_color_space, normal_map };
+    texture_ptr cached    = m_texture_cache->get_texture(key);
+    if (cached)
+        return cached;
+
+    const tinygltf::Image& image = m.images[static_cast<g_enum>(tex.source)];
+
+    texture_configuration config;
+    config.m_texture_min_filter      = s_config.m_texture_min_filter;
+    config.m_texture_mag_filter      = s_config.m_texture_mag_filter;
+    config.m_texture_wrap_s          = s_config.m_texture_wrap_s;
+    config.m_texture_wrap_t          = s_config.m_texture_wrap_t;
+    config.m_is_standard_color_space = standard_color_space;
+    config.m_generate_mipmaps        = calculate_mip_count(image.width, image.height);
+    config.m_is_normal_map           = normal_map;
+    texture_ptr loaded               = texture::create(config);
+
+    format f        = format::RGBA;
+    format internal = standard_color_space ? format::SRGB8_ALPHA8 : format::RGBA8;
+
+    if (image.component == 1)
+    {
+        f = format::RED;
+    }
+    else if (image.component == 2)
+    {
+        f = format::RG;
+    }
+    else if (image.component == 3)
+    {
+        f        = format::RGB;
+        internal = standard_color_space ? format::SRGB8 : format::RGB8;
+    }
+
+    format type = format::UNSIGNED_BYTE;
+    if (image.bits == 16)
+    {
+        type = format::UNSIGNED_SHORT;
+    }
+    else if (image.bits == 32)
+    {
+        type = format::UNSIGNED_INT;
+    }
+
+    set_texture_data(m_shared_context->get_render_system_internal().lock(), loaded, internal, image, f, type);
+    m_texture_cache->add_texture(key, loaded);
+
+    return loaded;
+}
+
 static void scene_graph_update(scene_component_manager<node_component>& nodes, scene_component_manager<transform_component>& transformations)
 {
     nodes.for_each(
@@ -857,29 +893,96 @@ static void camera_update(scene_component_manager<camera_component>& cameras, sc
         false);
 }
 
-static void render_meshes(shared_ptr<render_system_impl> rs, scene_component_manager<mesh_component>& meshes, scene_component_manager<transform_component>& transformations)
+static void render_meshes(shared_ptr<render_system_impl> rs, scene_component_manager<mesh_component>& meshes, scene_component_manager<transform_component>& transformations, const camera_data& camera,
+                          uint32 viewport_height)
 {
+    // projects lengths in world space to pixels, perspective cameras divide by the distance afterwards.
+    bool perspective          = false;
+    float pixels_per_unit     = 0.0f;
+    float near_plane          = 0.0f;
+    glm::vec3 camera_position = glm::vec3(0.0f);
+    if (camera.camera_info && camera.transform)
+    {
+        perspective     = camera.camera_info->type == camera_type::perspective_camera;
+        pixels_per_unit = camera.camera_info->projection[1][1] * 0.5f * static_cast<float>(viewport_height);
+        near_plane      = camera.camera_info->z_near;
+        camera_position = glm::vec3(camera.transform->world_transformation_matrix[3]);
+    }
+
     meshes.for_each(
-        [&rs, &meshes, &transformations](mesh_component& c, uint32& index) {
+        [&rs, &meshes, &transformations, perspective, pixels_per_unit, near_plane, camera_position](mesh_component& c, uint32& index) {
             entity e                       = meshes.entity_at(index);
             transform_component* transform = transformations.get_component_for_entity(e);
             if (transform)
             {
-                auto cmdb = rs->get_command_buffer();
-                rs->set_model_info(transform->world_transformation_matrix, c.has_normals, c.has_tangents);
+                const glm::mat4& model = transform->world_transformation_matrix;
+                rs->set_model_info(e, model, c.has_normals, c.has_tangents, c.has_quantized_attributes, c.min_extents, c.max_extents - c.min_extents);
+                // no bounds without positions, occluded models are skipped.
+                bool has_bounds = c.min_extents.x <= c.max_extents.x;
+                if (has_bounds && !rs->set_model_bounds(c.min_extents, c.max_extents))
+                    return;
+
+                // the errors of the levels of detail are in model space, they are scaled with the largest axis and projected with the distance to the bounds.
+                float lod_pixels_per_unit = 0.0f;
+                if (has_bounds && pixels_per_unit > 0.0f)
+                {
+                    float scale         = glm::max(glm::length(glm::vec3(model[0])), glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+                    lod_pixels_per_unit = pixels_per_unit * scale;
+                    if (perspective)
+                    {
+                        glm::vec3 center = glm::vec3(model * glm::vec4(0.5f * (c.min_extents + c.max_extents), 1.0f));
+                        float radius     = 0.5f * scale * glm::length(c.max_extents - c.min_extents);
+                        float distance   = glm::max(glm::length(center - camera_position) - radius, near_plane);
+                        lod_pixels_per_unit /= glm::max(distance, 1e-4f);
+                    }
+                }
 
                 for (uint32 i = 0; i < c.primitives.size(); ++i)
                 {
-                    auto m = c.materials[i];
-                    auto p = c.primitives[i];
-                    cmdb->bind_vertex_array(p.vertex_array_object);
-                    rs->draw_mesh(m.component_material, p.topology, p.first, p.count, p.type_index, p.instance_count);
+                    auto m  = c.materials[i];
+                    auto& p = c.primitives[i];
+                    if (p.lods.empty())
+                    {
+                        rs->draw_mesh(p.vertex_array_object, m.component_material, p.topology, p.first, p.count, p.type_index, p.instance_count);
+                        continue;
+                    }
+
+                    // without a projection every primitive is drawn in full detail.
+                    p.current_lod            = lod_pixels_per_unit > 0.0f ? select_primitive_lod(p, lod_pixels_per_unit) : 0;
+                    const primitive_lod& lod = p.lods[p.current_lod];
+                    // the meshlets belong to the full detail level, coarser levels are drawn completely.
+                    rs->draw_mesh(p.vertex_array_object, m.component_material, p.topology, lod.first, lod.count, p.type_index, p.instance_count, p.current_lod == 0 ? p.meshlets : nullptr);
                 }
             }
         },
         false);
 }
 
+static void render_lights(shared_ptr<render_system_impl> rs, scene_component_manager<light_component>& lights, scene_component_manager<transform_component>& transformations)
+{
+    lights.for_each(
+        [&rs, &lights, &transformations](light_component& c, uint32& index) {
+            entity e                       = lights.entity_at(index);
+            transform_component* transform = transformations.get_component_for_entity(e);
+            if (transform)
+            {
+                glm::vec3 position  = glm::vec3(transform->world_transformation_matrix[3]);
+                glm::vec3 direction = -glm::normalize(glm::vec3(transform->world_transformation_matrix[2]));
+                rs->submit_light(c, position, direction);
+            }
+        },
+        false);
+}
+
+static void set_texture_data(const shared_ptr<render_system_impl>& rs, const texture_ptr& tex, format internal, const tinygltf::Image& image, format f, format type)
+{
+    shared_ptr<texture_streaming> streaming = rs ? rs->get_texture_streaming() : nullptr;
+    if (streaming)
+        streaming->add_texture(tex, internal, static_cast<uint32>(image.width), static_cast<uint32>(image.height), f, type, &image.image.at(0));
+    else
+        tex->set_data(internal, static_cast<uint32>(image.width), static_cast<uint32>(image.height), f, type, &image.image.at(0));
+}
+
 static void update_scene_boundaries(glm::mat4& trafo, tinygltf::Model& m, tinygltf::Mesh& mesh, glm::vec3& min, glm::vec3& max)
 {
     if (mesh.primitives.empty())
@@ -922,3 +1025,417 @@ static void update_scene_boundaries(glm::mat4& trafo, tinygltf::Model& m, tinygl
         min = glm::min(min, min_a);
     }
 }
+
+//! \brief Reads the indices of a primitive from the model data.
+//! \param[in] m The model loaded by tinygltf.
+//! \param[in] accessor The accessor of the indices.
+//! \param[out] indices The indices.
+//! \return True on success, else false.
+static bool read_indices(const tinygltf::Model& m, const tinygltf::Accessor& accessor, std::vector<uint32>& indices)
+{
+    if (accessor.bufferView < 0 || accessor.sparse.isSparse)
+        return false;
+
+    const tinygltf::BufferView& view = m.bufferViews[accessor.bufferView];
+    int stride                       = accessor.ByteStride(view);
+    if (stride <= 0)
+        return false;
+
+    const unsigned char* data = m.buffers[view.buffer].data.data() + view.byteOffset + accessor.byteOffset;
+    indices.resize(accessor.count);
+    for (ptr_size i = 0; i < accessor.count; ++i)
+    {
+        const unsigned char* element = data + i * static_cast<ptr_size>(stride);
+        if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
+        {
+            indices[i] = *element;
+        }
+        else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+        {
+            uint16 value;
+            std::memcpy(&value, element, sizeof(value));
+            indices[i] = value;
+        }
+        else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
+        {
+            std::memcpy(&indices[i], element, sizeof(uint32));
+        }
+        else
+            return false;
+    }
+    return true;
+}
+
+//! \brief Reads a vertex attribute of 32 bit floats from the model data.
+//! \param[in] m The model loaded by tinygltf.
+//! \param[in] accessor The accessor of the attribute.
+//! \param[in] type The tinygltf type the attribute has to have.
+//! \param[out] values The values.
+//! \return True on success, else false.
+template <typename T>
+static bool read_float_attribute(const tinygltf::Model& m, const tinygltf::Accessor& accessor, int type, std::vector<T>& values)
+{
+    if (accessor.bufferView < 0 || accessor.sparse.isSparse || accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || accessor.type != type)
+        return false;
+
+    const tinygltf::BufferView& view = m.bufferViews[accessor.bufferView];
+    int stride                       = accessor.ByteStride(view);
+    if (stride <= 0)
+        return false;
+
+    const unsigned char* data = m.buffers[view.buffer].data.data() + view.byteOffset + accessor.byteOffset;
+    values.resize(accessor.count);
+    for (ptr_size i = 0; i < accessor.count; ++i)
+        std::memcpy(&values[i], data + i * static_cast<ptr_size>(stride), sizeof(T));
+    return true;
+}
+
+//! \brief Reads the positions of a primitive from the model data.
+//! \param[in] m The model loaded by tinygltf.
+//! \param[in] accessor The accessor of the positions.
+//! \param[out] positions The positions.
+//! \return True on success, else false.
+static bool read_positions(const tinygltf::Model& m, const tinygltf::Accessor& accessor, std::vector<glm::vec3>& positions)
+{
+    return read_float_attribute(m, accessor, TINYGLTF_TYPE_VEC3, positions);
+}
+
+//! \brief Writes the indices of a primitive back to the model data.
+//! \details The component type of the accessor is kept, so all indices have to fit into it.
+//! \param[in,out] m The model loaded by tinygltf.
+//! \param[in] accessor The accessor of the indices.
+//! \param[in] indices The indices, as many as the accessor holds.
+static void write_indices(tinygltf::Model& m, const tinygltf::Accessor& accessor, const std::vector<uint32>& indices)
+{
+    const tinygltf::BufferView& view = m.bufferViews[accessor.bufferView];
+    ptr_size stride                  = static_cast<ptr_size>(accessor.ByteStride(view));
+
+    unsigned char* data = m.buffers[view.buffer].data.data() + view.byteOffset + accessor.byteOffset;
+    for (ptr_size i = 0; i < accessor.count; ++i)
+    {
+        unsigned char* element = data + i * stride;
+        if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
+        {
+            *element = static_cast<unsigned char>(indices[i]);
+        }
+        else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+        {
+            uint16 value = static_cast<uint16>(indices[i]);
+            std::memcpy(element, &value, sizeof(value));
+        }
+        else
+        {
+            std::memcpy(element, &indices[i], sizeof(uint32));
+        }
+    }
+}
+
+//! \brief Checks if the elements of a vertex attribute can be moved in place.
+//! \param[in] m The model loaded by tinygltf.
+//! \param[in] accessor The accessor of the vertex attribute.
+//! \param[in] vertex_count The number of vertices of the primitive.
+//! \return True if the attribute holds one dense element per vertex inside of its buffer, else false.
+static bool can_remap_vertex_attribute(const tinygltf::Model& m, const tinygltf::Accessor& accessor, ptr_size vertex_count)
+{
+    if (accessor.bufferView < 0 || accessor.sparse.isSparse || accessor.count != vertex_count)
+        return false;
+
+    const tinygltf::BufferView& view = m.bufferViews[accessor.bufferView];
+    int stride                       = accessor.ByteStride(view);
+    int element_size                 = tinygltf::GetComponentSizeInBytes(static_cast<uint32>(accessor.componentType)) * tinygltf::GetNumComponentsInType(static_cast<uint32>(accessor.type));
+    if (stride <= 0 || element_size <= 0 || vertex_count == 0)
+        return false;
+
+    ptr_size end = view.byteOffset + accessor.byteOffset + (vertex_count - 1) * static_cast<ptr_size>(stride) + static_cast<ptr_size>(element_size);
+    return end <= m.buffers[view.buffer].data.size();
+}
+
+//! \brief Moves the elements of a vertex attribute to their new position.
+//! \param[in,out] m The model loaded by tinygltf.
+//! \param[in] accessor The accessor of the vertex attribute. Has to pass \a can_remap_vertex_attribute().
+//! \param[in] remap The new index of every vertex.
+static void remap_vertex_attribute(tinygltf::Model& m, const tinygltf::Accessor& accessor, const std::vector<uint32>& remap)
+{
+    const tinygltf::BufferView& view = m.bufferViews[accessor.bufferView];
+    ptr_size stride                  = static_cast<ptr_size>(accessor.ByteStride(view));
+    ptr_size element_size            = static_cast<ptr_size>(tinygltf::GetComponentSizeInBytes(static_cast<uint32>(accessor.componentType)) * tinygltf::GetNumComponentsInType(static_cast<uint32>(accessor.type)));
+
+    // interleaved attributes only touch their own bytes of each vertex.
+    unsigned char* data = m.buffers[view.buffer].data.data() + view.byteOffset + accessor.byteOffset;
+    std::vector<unsigned char> elements(remap.size() * element_size);
+    for (ptr_size i = 0; i < remap.size(); ++i)
+        std::memcpy(&elements[remap[i] * element_size], data + i * stride, element_size);
+    for (ptr_size i = 0; i < remap.size(); ++i)
+        std::memcpy(data + i * stride, &elements[i * element_size], element_size);
+}
+
+//! \brief Generates the levels of detail and the meshlets of an indexed triangle primitive.
+//! \details Each level halves the triangles of the full detail one. Dense primitives are additionally split into meshlets, which reorders the triangles of the full detail level.
+//! All levels are stored as 32 bit indices in one new index buffer that replaces the one of the model, followed by the range receiving the visible indices of the meshlets.
+//! \param[in,out] p The \a primitive_component to generate the levels for. The vertex array object has to be created.
+//! \param[in] m The model loaded by tinygltf.
+//! \param[in] primitive The tinygltf primitive.
+static void build_primitive_lods(primitive_component& p, const tinygltf::Model& m, const tinygltf::Primitive& primitive)
+{
+    auto position_attribute = primitive.attributes.find("POSITION");
+    if (position_attribute == primitive.attributes.end())
+        return;
+
+    std::vector<uint32> indices;
+    std::vector<glm::vec3> positions;
+    if (!read_indices(m, m.accessors[primitive.indices], indices) || !read_positions(m, m.accessors[position_attribute->second], positions))
+        return;
+    if (indices.size() % 3 != 0 || indices.size() < 6 * min_lod_triangles)
+        return;
+    for (uint32 idx : indices)
+    {
+        if (idx >= positions.size())
+            return;
+    }
+
+    // meshlets only pay off if there are many of them to cull.
+    std::vector<meshlet> meshlets;
+    if (indices.size() >= 3 * min_meshlet_triangles)
+        meshlets = build_meshlets(indices, positions, max_meshlet_vertices, max_meshlet_triangles);
+
+    std::vector<uint32> lod_indices(indices);
+    std::vector<primitive_lod> lods;
+    lods.push_back({ 0, static_cast<uint32>(indices.size()), 0.0f });
+    for (uint32 level = 1; level < max_primitive_lods; ++level)
+    {
+        ptr_size target = (indices.size() / 3 >> level) * 3;
+        if (target < 3 * min_lod_triangles)
+            break;
+
+        float error;
+        std::vector<uint32> simplified = simplify_triangles(indices, positions, target, error);
+        // stop if locked borders or flips keep the simplification from making progress.
+        if (simplified.size() * 4 > lods.back().count * 3)
+            break;
+        optimize_vertex_cache(simplified, static_cast<uint32>(positions.size()));
+
+        lods.push_back({ static_cast<uint32>(lod_indices.size() * sizeof(uint32)), static_cast<uint32>(simplified.size()), glm::max(error, lods.back().error) });
+        lod_indices.insert(lod_indices.end(), simplified.begin(), simplified.end());
+    }
+    if (lods.size() < 2 && meshlets.empty())
+        return;
+
+    // the visible indices are written by a compute shader, so their range is aligned for binding it as shader storage.
+    ptr_size visible_offset = 0;
+    if (!meshlets.empty())
+    {
+        g_int alignment = 0;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        ptr_size storage_alignment = static_cast<ptr_size>(glm::max(alignment, 4));
+        visible_offset             = (lod_indices.size() * sizeof(uint32) + storage_alignment - 1) / storage_alignment * storage_alignment;
+        lod_indices.resize(visible_offset / sizeof(uint32) + indices.size(), 0);
+    }
+
+    buffer_configuration config;
+    config.m_access = buffer_access::NONE;
+    config.m_size   = lod_indices.size() * sizeof(uint32);
+    config.m_target = buffer_target::INDEX_BUFFER;
+    config.m_data   = static_cast<const void*>(lod_indices.data());
+    buffer_ptr buf  = buffer::create(config);
+    if (!buf)
+        return;
+
+    p.vertex_array_object->bind_index_buffer(buf);
+    p.first      = lods[0].first;
+    p.count      = lods[0].count;
+    p.type_index = index_type::UINT;
+    p.lods       = lods;
+    MANGO_LOG_DEBUG("Generated {0} levels of detail and {1} meshlets for a primitive with {2} triangles.", lods.size(), meshlets.size(), indices.size() / 3);
+    if (meshlets.empty())
+        return;
+
+    config.m_size          = meshlets.size() * sizeof(meshlet);
+    config.m_target        = buffer_target::SHADER_STORAGE_BUFFER;
+    config.m_data          = static_cast<const void*>(meshlets.data());
+    buffer_ptr meshlet_buf = buffer::create(config);
+
+    // the instance count and base instance are written by the culling shader, the index count is cleared every frame.
+    uint32 draw_command[5] = { 0, 1, static_cast<uint32>(visible_offset / sizeof(uint32)), 0, 0 };
+    config.m_access        = buffer_access::DYNAMIC_STORAGE;
+    config.m_size          = sizeof(draw_command);
+    config.m_data          = static_cast<const void*>(draw_command);
+    buffer_ptr draw_buf    = buffer::create(config);
+    if (!meshlet_buf || !draw_buf)
+        return;
+
+    p.meshlets                 = std::make_shared<primitive_meshlets>();
+    p.meshlets->meshlet_buffer = meshlet_buf;
+    p.meshlets->index_buffer   = buf;
+    p.meshlets->draw_buffer    = draw_buf;
+    p.meshlets->meshlet_count  = static_cast<uint32>(meshlets.size());
+    p.meshlets->index_count    = static_cast<uint32>(indices.size());
+    p.meshlets->visible_offset = static_cast<uint32>(visible_offset);
+}
+
+//! \brief Selects the level of detail of a primitive for the current frame.
+//! \details Finer levels are taken as soon as the error gets visible, coarser ones only when the error stays clearly below the threshold.
+//! \param[in] p The \a primitive_component with levels of detail.
+//! \param[in] pixels_per_unit The size of one model space unit on the screen in pixels.
+//! \return The index of the level of detail to draw.
+static uint32 select_primitive_lod(const primitive_component& p, float pixels_per_unit)
+{
+    uint32 lod = glm::min(p.current_lod, static_cast<uint32>(p.lods.size() - 1));
+    while (lod > 0 && p.lods[lod].error * pixels_per_unit > lod_pixel_error)
+        --lod;
+    while (lod + 1 < p.lods.size() && p.lods[lod + 1].error * pixels_per_unit <= lod_pixel_error * lod_hysteresis)
+        ++lod;
+    return lod;
+}
+
+//! \brief Reorders the triangles and vertices of the indexed triangle primitives of a model before it is uploaded.
+//! \details The triangles are ordered for the vertex cache first and then in clusters to reduce overdraw. After that the vertices are renumbered in the order they are used.
+//! Vertices are only moved if no other primitive shares the accessors or the primitive has morph targets. The average cache miss ratio before and after is logged for each primitive.
+//! \param[in,out] m The model loaded by tinygltf.
+static void optimize_model_primitives(tinygltf::Model& m)
+{
+    // accessors used by more than one primitive can not be reordered for one of them.
+    std::map<int, uint32> accessor_users;
+    for (const tinygltf::Mesh& mesh : m.meshes)
+    {
+        for (const tinygltf::Primitive& primitive : mesh.primitives)
+        {
+            accessor_users[primitive.indices]++;
+            for (auto& attrib : primitive.attributes)
+                accessor_users[attrib.second]++;
+            for (auto& target : primitive.targets)
+            {
+                for (auto& attrib : target)
+                    accessor_users[attrib.second]++;
+            }
+        }
+    }
+
+    for (tinygltf::Mesh& mesh : m.meshes)
+    {
+        for (tinygltf::Primitive& primitive : mesh.primitives)
+        {
+            auto position_attribute = primitive.attributes.find("POSITION");
+            if (primitive.indices < 0 || primitive.mode != TINYGLTF_MODE_TRIANGLES || position_attribute == primitive.attributes.end() || accessor_users[primitive.indices] != 1)
+                continue;
+
+            const tinygltf::Accessor& index_accessor = m.accessors[primitive.indices];
+            std::vector<uint32> indices;
+            std::vector<glm::vec3> positions;
+            if (!read_indices(m, index_accessor, indices) || !read_positions(m, m.accessors[position_attribute->second], positions) || indices.size() % 3 != 0)
+                continue;
+            uint32 vertex_count = static_cast<uint32>(positions.size());
+            bool valid          = true;
+            for (uint32 idx : indices)
+                valid &= idx < vertex_count;
+            if (!valid || indices.size() < 6)
+                continue;
+
+            float acmr_before = compute_acmr(indices, vertex_count, reported_vertex_cache_size);
+            optimize_vertex_cache(indices, vertex_count);
+            optimize_overdraw(indices, positions, overdraw_threshold);
+
+            bool remap_vertices = primitive.targets.empty();
+            for (auto& attrib : primitive.attributes)
+                remap_vertices &= accessor_users[attrib.second] == 1 && can_remap_vertex_attribute(m, m.accessors[attrib.second], vertex_count);
+            if (remap_vertices)
+            {
+                std::vector<uint32> remap = optimize_vertex_fetch(indices, vertex_count);
+                for (auto& attrib : primitive.attributes)
+                    remap_vertex_attribute(m, m.accessors[attrib.second], remap);
+            }
+
+            write_indices(m, index_accessor, indices);
+            MANGO_LOG_DEBUG("Optimized a primitive with {0} triangles: ACMR {1} -> {2}, vertices {3}.", indices.size() / 3, acmr_before, compute_acmr(indices, vertex_count, reported_vertex_cache_size),
+                            remap_vertices ? "remapped" : "shared");
+        }
+    }
+}
+
+//! \brief Computes the bounds the vertices of a mesh are quantized in.
+//! \param[in] m The model loaded by tinygltf.
+//! \param[in] mesh The tinygltf mesh.
+//! \param[out] min_position The minimum of the positions of all primitives.
+//! \param[out] max_position The maximum of the positions of all primitives.
+//! \return True if all primitives can be quantized, false if any attribute is not stored as 32 bit floats.
+static bool compute_quantization_bounds(const tinygltf::Model& m, const tinygltf::Mesh& mesh, glm::vec3& min_position, glm::vec3& max_position)
+{
+    min_position = glm::vec3(3.402823e+38f);
+    max_position = glm::vec3(-3.402823e+38f);
+    for (const tinygltf::Primitive& primitive : mesh.primitives)
+    {
+        std::vector<glm::vec3> positions;
+        auto position_attribute = primitive.attributes.find("POSITION");
+        if (position_attribute == primitive.attributes.end() || !read_positions(m, m.accessors[position_attribute->second], positions))
+            return false;
+
+        for (auto& attrib : primitive.attributes)
+        {
+            const tinygltf::Accessor& accessor = m.accessors[attrib.second];
+            bool is_float                      = accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT && !accessor.sparse.isSparse && accessor.count == positions.size();
+            if (attrib.first.compare("NORMAL") == 0 && !(is_float && accessor.type == TINYGLTF_TYPE_VEC3))
+                return false;
+            if (attrib.first.compare("TEXCOORD_0") == 0 && !(is_float && accessor.type == TINYGLTF_TYPE_VEC2))
+                return false;
+            if (attrib.first.compare("TANGENT") == 0 && !(is_float && accessor.type == TINYGLTF_TYPE_VEC4))
+                return false;
+        }
+
+        for (const glm::vec3& position : positions)
+        {
+            min_position = glm::min(min_position, position);
+            max_position = glm::max(max_position, position);
+        }
+    }
+    return min_position.x <= max_position.x;
+}
+
+//! \brief Interleaves and quantizes the vertex attributes of a primitive and binds them to its vertex array object.
+//! \param[in,out] p The \a primitive_component to bind the vertices for. The vertex array object has to be created.
+//! \param[in] m The model loaded by tinygltf.
+//! \param[in] primitive The tinygltf primitive. Has to pass \a compute_quantization_bounds().
+//! \param[in] position_offset The minimum of the bounds of the mesh.
+//! \param[in] position_scale The size of the bounds of the mesh.
+//! \return True on success, else false.
+static bool bind_quantized_vertices(primitive_component& p, const tinygltf::Model& m, const tinygltf::Primitive& primitive, const glm::vec3& position_offset, const glm::vec3& position_scale)
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texcoords;
+    std::vector<glm::vec4> tangents;
+    for (auto& attrib : primitive.attributes)
+    {
+        const tinygltf::Accessor& accessor = m.accessors[attrib.second];
+        bool valid                         = true;
+        if (attrib.first.compare("POSITION") == 0)
+            valid = read_positions(m, accessor, positions);
+        else if (attrib.first.compare("NORMAL") == 0)
+            valid = read_float_attribute(m, accessor, TINYGLTF_TYPE_VEC3, normals);
+        else if (attrib.first.compare("TEXCOORD_0") == 0)
+            valid = read_float_attribute(m, accessor, TINYGLTF_TYPE_VEC2, texcoords);
+        else if (attrib.first.compare("TANGENT") == 0)
+            valid = read_float_attribute(m, accessor, TINYGLTF_TYPE_VEC4, tangents);
+        if (!valid)
+            return false;
+    }
+
+    std::vector<quantized_vertex> vertices = quantize_vertices(positions, normals, texcoords, tangents, position_offset, position_scale);
+
+    buffer_configuration config;
+    config.m_access = buffer_access::NONE;
+    config.m_size   = vertices.size() * sizeof(quantized_vertex);
+    config.m_target = buffer_target::VERTEX_BUFFER;
+    config.m_data   = static_cast<const void*>(vertices.data());
+    buffer_ptr buf  = buffer::create(config);
+    if (!buf)
+        return false;
+
+    p.vertex_array_object->bind_vertex_buffer(0, buf, 0, sizeof(quantized_vertex));
+    p.vertex_array_object->set_vertex_attribute(0, 0, format::RGBA16UI, offsetof(quantized_vertex, position));
+    if (!normals.empty())
+        p.vertex_array_object->set_vertex_attribute(1, 0, format::RG16I, offsetof(quantized_vertex, normal));
+    if (!texcoords.empty())
+        p.vertex_array_object->set_vertex_attribute(2, 0, format::RG16F, offsetof(quantized_vertex, texcoord));
+    if (!tangents.empty())
+        p.vertex_array_object->set_vertex_attribute(3, 0, format::INT_2_10_10_10_REV, offsetof(quantized_vertex, tangent));
+    return true;
+}
@@ -0,0 +1,83 @@
+#version 430 core
+
+#include "include/scene_camera_uniforms.glsl"
+#include "include/light_clusters.glsl"
+
+layout(local_size_x = 64) in;
+
+layout(location = 0) uniform int light_count;
+
+shared uint s_light_count;
+
+vec3 point_at_view_depth(in vec2 ndc, in float view_depth);
+
+void main()
+{
+    uvec3 cluster      = gl_WorkGroupID;
+    uint cluster_index = (cluster.z * cluster_grid.y + cluster.y) * cluster_grid.x + cluster.x;
+
+    // clusters without any visible pixel do not need lights.
+    if (clusters[cluster_index].active == 0)
+    {
+        if (gl_LocalInvocationIndex == 0)
+            clusters[cluster_index].light_count = 0;
+        return;
+    }
+
+    if (gl_LocalInvocationIndex == 0)
+        s_light_count = 0;
+
+    // view space bounding box of the froxel.
+    vec2 tile_min    = vec2(cluster.xy) / vec2(cluster_grid.xy) * 2.0 - 1.0;
+    vec2 tile_max    = vec2(cluster.xy + 1) / vec2(cluster_grid.xy) * 2.0 - 1.0;
+    float depth_near = get_cluster_slice_depth(cluster.z);
+    float depth_far  = get_cluster_slice_depth(cluster.z + 1);
+
+    vec3 corners[8] = vec3[8](point_at_view_depth(tile_min, depth_near), point_at_view_depth(vec2(tile_max.x, tile_min.y), depth_near),
+                              point_at_view_depth(vec2(tile_min.x, tile_max.y), depth_near), point_at_view_depth(tile_max, depth_near),
+                              point_at_view_depth(tile_min, depth_far), point_at_view_depth(vec2(tile_max.x, tile_min.y), depth_far),
+                              point_at_view_depth(vec2(tile_min.x, tile_max.y), depth_far), point_at_view_depth(tile_max, depth_far));
+    vec3 aabb_min = corners[0];
+    vec3 aabb_max = corners[0];
+    for (int i = 1; i < 8; ++i)
+    {
+        aabb_min = min(aabb_min, corners[i]);
+        aabb_max = max(aabb_max, corners[i]);
+    }
+
+    barrier();
+
+    // spot lights are tested with their bounding sphere, this is conservative.
+    for (uint i = gl_LocalInvocationIndex; i < uint(light_count); i += gl_WorkGroupSize.x)
+    {
+        vec3 center   = (u_view_matrix * vec4(lights[i].position_range.xyz, 1.0)).xyz;
+        float range   = lights[i].position_range.w;
+        vec3 closest  = clamp(center, aabb_min, aabb_max);
+        vec3 distance = closest - center;
+        if (dot(distance, distance) > range * range)
+            continue;
+
+        uint slot = atomicAdd(s_light_count, 1);
+        if (slot < max_lights_per_cluster)
+            cluster_light_indices[cluster_index * max_lights_per_cluster + slot] = i;
+    }
+
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0)
+    {
+        clusters[cluster_index].light_count = min(s_light_count, max_lights_per_cluster);
+        clusters[cluster_index].active      = 0; // marked again in the next frame.
+    }
+}
+
+// works for perspective and orthographic projections.
+vec3 point_at_view_depth(in vec2 ndc, in float view_depth)
+{
+    vec4 near_point = u_inverse_projection * vec4(ndc, -1.0, 1.0);
+    vec4 far_point  = u_inverse_projection * vec4(ndc, 1.0, 1.0);
+    vec3 a          = near_point.xyz / near_point.w;
+    vec3 b          = far_point.xyz / far_point.w;
+    float t         = (view_depth + a.z) / (a.z - b.z);
+    return mix(a, b, t);
+}
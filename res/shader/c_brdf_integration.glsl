@@ -1,10 +1,8 @@
 #version 430 core
 
-#define saturate(x) clamp(x, 0.0, 1.0)
-
-const float PI = 3.1415926535897932384626433832795;
-const float TWO_PI = PI * 2.0;
-const float INV_PI = 1.0 / PI;
+#include "include/common_constants.glsl"
+#include "include/pbr_functions.glsl"
+#include "include/ibl_functions.glsl"
 
 const uint sample_count = 512;
 float inverse_sample_count = 1.0 / float(sample_count);
@@ -17,14 +15,9 @@ layout(location = 0) uniform vec2 out_size;
 
 float inv_tex_size = 1.0 / out_size.x;
 
-float radical_inverse_VdC(in uint bits);
 vec2 sample_hammersley(uint i);
 void importance_sample_ggx_direction(in vec2 u, in vec3 view, in vec3 normal, in float roughness, out float n_dot_l, out vec3 halfway, out vec3 to_light);
 void importance_sample_cosinus_direction(in vec2 u, in vec3 normal, out vec3 to_light, out float n_dot_l, out float pdf);
-vec3 F_Schlick(in float dot, in vec3 f0, in float f90);
-float Fd_BurleyRenormalized(in float n_dot_v, in float n_dot_l, in float l_dot_h, in float roughness);
-float V_SmithGGXCorrelated(in float n_dot_v, in float n_dot_l, in float roughness);
-
 
 vec3 up;
 vec3 tangent_x;
@@ -57,7 +50,7 @@ void main()
         float n_dot_l;
         importance_sample_ggx_direction(eta, view, normal, roughness, n_dot_l, halfway, to_light);
         n_dot_l = saturate(n_dot_l);
-        float G = V_SmithGGXCorrelated(n_dot_v, n_dot_l, roughness);
+        float G = V_SmithGGXCorrelated(n_dot_v, n_dot_l, roughness * roughness);
 
         // specular preintegration
         if(n_dot_l > 0.0 && G > 0.0)
@@ -96,16 +89,6 @@ void main()
 // https://seblagarde.files.wordpress.com/2015/07/course_notes_moving_frostbite_to_pbr_v32.pdf
 // https://blog.selfshadow.com/publications/s2013-shading-course/karis/s2013_pbs_epic_notes_v2.pdf
 
-float radical_inverse_VdC(in uint bits)
-{
-    bits = (bits << 16u) | (bits >> 16u);
-    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
-    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
-    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
-    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
-    return float(bits) * 2.3283064365386963e-10;
-}
-
 vec2 sample_hammersley(uint i)
 {
     return vec2(float(i) * inverse_sample_count, radical_inverse_VdC(i));
@@ -145,33 +128,3 @@ void importance_sample_cosinus_direction(in vec2 u, in vec3 normal, out vec3 to_
     n_dot_l = dot(normal, to_light);
     pdf = n_dot_l * INV_PI;
 }
-
-vec3 F_Schlick(in float dot, in vec3 f0, in float f90) // can be optimized
-{
-    return f0 + (vec3(f90) - f0) * pow(saturate(1.0 - dot), 5.0);
-}
-
-float Fd_BurleyRenormalized(in float n_dot_v, in float n_dot_l, in float l_dot_h, in float roughness) // normalized Frostbyte version
-{
-    float energy_bias = mix(0.0, 0.5, roughness);
-    float energy_factor = mix(1.0, 1.0 / 1.51, roughness);
-    float f90 = energy_bias + 2.0 * l_dot_h * l_dot_h * roughness;
-    vec3 f0 = vec3(1.0);
-    float light_scatter = F_Schlick(n_dot_l, f0, f90).x;
-    float view_scatter = F_Schlick(n_dot_v, f0, f90).x;
-    return energy_factor * light_scatter * view_scatter;
-}
-
-float V_SmithGGXCorrelated(in float n_dot_v, in float n_dot_l, in float roughness) // can be optimized
-{
-    float a_sqr = roughness * roughness;
-    float a_q = a_sqr * a_sqr;
-    float GGXL = n_dot_v * sqrt((-n_dot_l * a_q + n_dot_l) * n_dot_l + a_q);
-    float GGXV = n_dot_l * sqrt((-n_dot_v * a_q + n_dot_v) * n_dot_v + a_q);
-    float GGX = GGXV + GGXL;
-    if (GGX > 0.0)
-    {
-        return 0.5 / GGX;
-    }
-    return 0.0;
-}
\ No newline at end of file
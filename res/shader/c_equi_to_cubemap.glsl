@@ -12,7 +12,8 @@ layout(binding = 1, rgba16f) uniform writeonly imageCube cubemap_out;
 
 layout(location = 1) uniform vec2 out_size;
 
-vec3 cube_to_world(in ivec3 cube_coord, in vec2 cubemap_size);
+#include "include/ibl_functions.glsl"
+
 vec2 cube_to_equi(in vec3 v);
 
 void main()
@@ -31,22 +32,6 @@ void main()
     imageStore(cubemap_out, coords, pixel);
 }
 
-vec3 cube_to_world(in ivec3 cube_coord, in vec2 cubemap_size)
-{
-    vec2 tex_coord = vec2(cube_coord.xy) / cubemap_size;
-    tex_coord = tex_coord  * 2.0 - 1.0;
-    switch(cube_coord.z)
-    {
-        case 0: return vec3(1.0, -tex_coord.yx);
-        case 1: return vec3(-1.0, -tex_coord.y, tex_coord.x);
-        case 2: return vec3(tex_coord.x, 1.0, tex_coord.y);
-        case 3: return vec3(tex_coord.x, -1.0, -tex_coord.y);
-        case 4: return vec3(tex_coord.x, -tex_coord.y, 1.0);
-        case 5: return vec3(-tex_coord.xy, -1.0);
-    }
-    return vec3(0.0);
-}
-
 vec2 cube_to_equi(in vec3 v)
 {
     vec2 theta_pi = vec2(atan(v.z, v.x), asin(v.y));
@@ -0,0 +1,51 @@
+#version 430 core
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+#ifdef FROM_DEPTH
+layout(binding = 0, location = 0) uniform sampler2D source_depth;
+#else
+layout(binding = 0, r32f) uniform readonly image2D source_level;
+#endif
+
+layout(binding = 1, r32f) uniform writeonly image2D target_level;
+
+ivec2 get_source_size()
+{
+#ifdef FROM_DEPTH
+    return textureSize(source_depth, 0);
+#else
+    return imageSize(source_level);
+#endif
+}
+
+float load_source(ivec2 texel)
+{
+#ifdef FROM_DEPTH
+    return texelFetch(source_depth, texel, 0).r;
+#else
+    return imageLoad(source_level, texel).r;
+#endif
+}
+
+void main()
+{
+    ivec2 target_size = imageSize(target_level);
+    ivec2 texel       = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, target_size)))
+        return;
+
+    // all source texels overlapping the target texel, this includes the odd rows and columns.
+    ivec2 source_size = get_source_size();
+    ivec2 first       = texel * source_size / target_size;
+    ivec2 last        = min(((texel + 1) * source_size + target_size - 1) / target_size, source_size);
+
+    float farthest = 0.0;
+    for (int y = first.y; y < last.y; ++y)
+    {
+        for (int x = first.x; x < last.x; ++x)
+            farthest = max(farthest, load_source(ivec2(x, y)));
+    }
+
+    imageStore(target_level, texel, vec4(farthest));
+}
@@ -1,8 +1,7 @@
 #version 430 core
 
-const float PI = 3.1415926535897932384626433832795;
-const float TWO_PI = PI * 2.0;
-const float INV_PI = 1.0 / PI;
+#include "include/common_constants.glsl"
+#include "include/ibl_functions.glsl"
 
 const uint sample_count = 512; // sufficient because of the mipmap optimization -> we would need more without!
 const float inverse_sample_count = 1.0 / float(sample_count);
@@ -15,10 +14,8 @@ layout(binding = 1, rgba16f) uniform writeonly imageCube irradiance_map_out;
 
 layout(location = 1) uniform vec2 out_size;
 
-float radical_inverse_VdC(in uint bits);
 vec2 sample_hammersley(uint i);
 void importance_sample_cosinus_direction(in vec2 u, in vec3 normal, out vec3 to_light, out float n_dot_l, out float pdf);
-vec3 cube_to_world(in ivec3 cube_coord, in vec2 cubemap_size);
 
 vec3 up;
 vec3 tangent_x;
@@ -34,7 +31,6 @@ void main()
     tangent_x = normalize(cross(up, normal));
     tangent_y = normalize(cross(normal, tangent_x));
 
-
     vec3 irradiance = vec3(0.0);
 
     for(uint s = 0; s < sample_count; ++s)
@@ -70,16 +66,6 @@ void main()
 // http://alinloghin.com/articles/compute_ibl.html
 // See: http://holger.dammertz.org/stuff/notes_HammersleyOnHemisphere.html
 
-float radical_inverse_VdC(in uint bits)
-{
-    bits = (bits << 16u) | (bits >> 16u);
-    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
-    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
-    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
-    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
-    return float(bits) * 2.3283064365386963e-10;
-}
-
 vec2 sample_hammersley(uint i)
 {
     return vec2(float(i) * inverse_sample_count, radical_inverse_VdC(i));
@@ -99,20 +85,3 @@ void importance_sample_cosinus_direction(in vec2 u, in vec3 normal, out vec3 to_
     n_dot_l = dot(normal, to_light);
     pdf = n_dot_l * INV_PI;
 }
-
-vec3 cube_to_world(in ivec3 cube_coord, in vec2 cubemap_size)
-{
-    vec2 tex_coord = vec2(cube_coord.xy) / cubemap_size;
-    tex_coord = tex_coord  * 2.0 - 1.0;
-    switch(cube_coord.z)
-    {
-        case 0: return vec3(1.0, -tex_coord.yx);
-        case 1: return vec3(-1.0, -tex_coord.y, tex_coord.x);
-        case 2: return vec3(tex_coord.x, 1.0, tex_coord.y);
-        case 3: return vec3(tex_coord.x, -1.0, -tex_coord.y);
-        case 4: return vec3(tex_coord.x, -tex_coord.y, 1.0);
-        case 5: return vec3(-tex_coord.xy, -1.0);
-    }
-
-    return vec3(0.0);
-}
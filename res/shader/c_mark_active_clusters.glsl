@@ -0,0 +1,27 @@
+#version 430 core
+
+#include "include/scene_camera_uniforms.glsl"
+#include "include/light_clusters.glsl"
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0, location = 1) uniform sampler2D gbuffer_depth;
+layout(location = 2) uniform ivec2 u_render_size; // the part of the gbuffer rendered to in this frame.
+
+void main()
+{
+    ivec2 size  = u_render_size;
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pixel, size)))
+        return;
+
+    float depth = texelFetch(gbuffer_depth, pixel, 0).r;
+    if (depth >= 1.0)
+        return; // background.
+
+    vec2 uv          = (vec2(pixel) + 0.5) / vec2(size);
+    float view_depth = -view_space_from_depth(depth, uv).z;
+
+    // all pixels of a cluster write the same value, so no atomics are required.
+    clusters[get_cluster_index(uv, view_depth)].active = 1;
+}
@@ -0,0 +1,158 @@
+#version 430 core
+
+// one work group per meshlet, the invocations copy the indices of a visible meshlet.
+layout(local_size_x = 64) in;
+
+#include "include/scene_camera_uniforms.glsl"
+
+struct meshlet
+{
+    vec4 bounding_sphere; // center (xyz) and radius (w) in model space.
+    vec4 normal_cone;     // axis (xyz) and sine of the half angle (w), larger than one if the meshlet can not be backface culled.
+    uint first_index;
+    uint index_count;
+    uint padding0;
+    uint padding1;
+};
+
+layout(binding = 9, std430) readonly buffer primitive_meshlets
+{
+    meshlet meshlets[];
+};
+
+layout(binding = 10, std430) readonly buffer primitive_indices
+{
+    uint source_indices[];
+};
+
+layout(binding = 11, std430) writeonly buffer visible_primitive_indices
+{
+    uint visible_indices[];
+};
+
+layout(binding = 12, std430) buffer draw_elements_command
+{
+    uint index_count;
+    uint instance_count;
+    uint first_index;
+    int base_vertex;
+    uint base_instance;
+} draw_command;
+
+layout(binding = 0, location = 0) uniform sampler2D u_hi_z;
+layout(location = 1) uniform mat4 u_model_matrix;
+layout(location = 2) uniform mat4 u_hi_z_view_projection;
+layout(location = 3) uniform vec3 u_model_camera_position;
+layout(location = 4) uniform ivec4 u_meshlet_info; // meshlet count (x), first visible index (y), instance count (z) and base instance (w).
+layout(location = 5) uniform ivec2 u_cull_flags;   // normal cone culling (x) and number of hi-z levels (y), 0 disables the test.
+
+shared bool s_visible;
+shared uint s_offset;
+
+bool is_outside_view(vec3 center, float radius)
+{
+    // the planes are the sums and differences of the rows of the view projection matrix.
+    mat4 rows = transpose(u_view_projection_matrix);
+    for (int i = 0; i < 3; ++i)
+    {
+        vec4 lower = rows[3] + rows[i];
+        vec4 upper = rows[3] - rows[i];
+        if (dot(lower.xyz, center) + lower.w < -radius * length(lower.xyz))
+            return true;
+        if (dot(upper.xyz, center) + upper.w < -radius * length(upper.xyz))
+            return true;
+    }
+    return false;
+}
+
+bool is_backfacing(meshlet m)
+{
+    // tested in model space, so the meshlet is backfacing if the camera is behind all triangle planes.
+    vec3 to_center = m.bounding_sphere.xyz - u_model_camera_position;
+    return dot(to_center, m.normal_cone.xyz) >= m.normal_cone.w * length(to_center) + m.bounding_sphere.w;
+}
+
+bool is_occluded(vec3 center, float radius)
+{
+    // screen space bounds of the sphere in the frame the pyramid was built in.
+    vec2 min_uv   = vec2(1.0);
+    vec2 max_uv   = vec2(0.0);
+    float nearest = 1.0;
+    for (int i = 0; i < 8; ++i)
+    {
+        vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip   = u_hi_z_view_projection * vec4(corner, 1.0);
+        if (clip.w <= 0.0)
+            return false; // crosses the camera plane.
+
+        vec3 ndc = clip.xyz / clip.w;
+        min_uv   = min(min_uv, ndc.xy * 0.5 + 0.5);
+        max_uv   = max(max_uv, ndc.xy * 0.5 + 0.5);
+        nearest  = min(nearest, ndc.z * 0.5 + 0.5);
+    }
+    if (nearest <= 0.0 || any(lessThan(min_uv, vec2(0.0))) || any(greaterThan(max_uv, vec2(1.0))))
+        return false;
+
+    // the finest level where the bounds cover about two texels in each direction.
+    vec2 extent  = (max_uv - min_uv) * vec2(textureSize(u_hi_z, 0));
+    int level    = clamp(int(ceil(log2(max(max(extent.x, extent.y), 1.0)))), 0, u_cull_flags.y - 1);
+    ivec2 size   = textureSize(u_hi_z, level);
+    ivec2 first  = min(ivec2(min_uv * vec2(size)), size - 1);
+    ivec2 last   = min(ivec2(max_uv * vec2(size)), size - 1);
+    if (any(greaterThan(last - first, ivec2(3))))
+        return false; // too large for the coarsest level.
+
+    float farthest = 0.0;
+    for (int y = first.y; y <= last.y; ++y)
+    {
+        for (int x = first.x; x <= last.x; ++x)
+            farthest = max(farthest, texelFetch(u_hi_z, ivec2(x, y), level).r);
+    }
+    return nearest > farthest;
+}
+
+bool is_visible(meshlet m)
+{
+    vec3 center  = (u_model_matrix * vec4(m.bounding_sphere.xyz, 1.0)).xyz;
+    float scale  = max(length(u_model_matrix[0].xyz), max(length(u_model_matrix[1].xyz), length(u_model_matrix[2].xyz)));
+    float radius = m.bounding_sphere.w * scale;
+
+    if (is_outside_view(center, radius))
+        return false;
+    if (u_cull_flags.x != 0 && is_backfacing(m))
+        return false;
+    if (u_cull_flags.y > 0 && is_occluded(center, radius))
+        return false;
+    return true;
+}
+
+void main()
+{
+    uint meshlet_index = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    if (meshlet_index >= uint(u_meshlet_info.x))
+        return; // uniform for the whole work group.
+
+    meshlet m = meshlets[meshlet_index];
+    if (gl_LocalInvocationIndex == 0)
+    {
+        s_visible = is_visible(m);
+        if (s_visible)
+            s_offset = atomicAdd(draw_command.index_count, m.index_count);
+
+        // the index count is cleared on the cpu, the other parameters are the same for all meshlets.
+        if (meshlet_index == 0)
+        {
+            draw_command.instance_count = uint(u_meshlet_info.z);
+            draw_command.first_index    = uint(u_meshlet_info.y);
+            draw_command.base_vertex    = 0;
+            draw_command.base_instance  = uint(u_meshlet_info.w);
+        }
+    }
+    barrier();
+
+    if (!s_visible)
+        return;
+
+    for (uint i = gl_LocalInvocationIndex; i < m.index_count; i += gl_WorkGroupSize.x)
+        visible_indices[s_offset + i] = source_indices[m.first_index + i];
+}
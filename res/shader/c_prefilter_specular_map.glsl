@@ -1,10 +1,7 @@
 #version 430 core
 
-#define saturate(x) clamp(x, 0.0, 1.0)
-
-const float PI = 3.1415926535897932384626433832795;
-const float TWO_PI = PI * 2.0;
-const float INV_PI = 1.0 / PI;
+#include "include/common_constants.glsl"
+#include "include/ibl_functions.glsl"
 
 const float width_sqr = 1024.0 * 1024.0; // TODO Paul: Hardcoded -.-
 const uint sample_count = 512;
@@ -17,10 +14,8 @@ layout(binding = 1, rgba16f) uniform writeonly imageCube prefiltered_spec_out;
 layout(location = 1) uniform vec2 out_size;
 layout(location = 2) uniform float roughness;
 
-float radical_inverse_VdC(in uint bits);
 vec2 sample_hammersley(uint i, uint sample_count);
 void importance_sample_ggx_direction(in vec2 u, in vec3 view, in vec3 normal, in float roughness, out float n_dot_l, out vec3 halfway, out vec3 to_light);
-vec3 cube_to_world(in ivec3 cube_coord, in vec2 cubemap_size);
 float D_GGX_divided_by_pi(in float n_dot_h, in float roughness);
 
 vec3 up;
@@ -88,22 +83,11 @@ void main()
 // https://blog.selfshadow.com/publications/s2013-shading-course/karis/s2013_pbs_epic_notes_v2.pdf
 // See: http://holger.dammertz.org/stuff/notes_HammersleyOnHemisphere.html
 
-float radical_inverse_VdC(in uint bits)
-{
-    bits = (bits << 16u) | (bits >> 16u);
-    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
-    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
-    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
-    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
-    return float(bits) * 2.3283064365386963e-10;
-}
-
 vec2 sample_hammersley(uint i, uint sample_count)
 {
     return vec2(float(i) / float(sample_count), radical_inverse_VdC(i));
 }
 
-
 void importance_sample_ggx_direction(in vec2 u, in vec3 view, in vec3 normal, in float roughness, out float n_dot_l, out vec3 halfway, out vec3 to_light)
 {
     float u1 = u.x;
@@ -124,23 +108,6 @@ void importance_sample_ggx_direction(in vec2 u, in vec3 view, in vec3 normal, in
     n_dot_l = dot(normal, to_light);
 }
 
-vec3 cube_to_world(in ivec3 cube_coord, in vec2 cubemap_size)
-{
-    vec2 tex_coord = vec2(cube_coord.xy) / cubemap_size;
-    tex_coord = tex_coord  * 2.0 - 1.0;
-    switch(cube_coord.z)
-    {
-        case 0: return vec3(1.0, -tex_coord.yx);
-        case 1: return vec3(-1.0, -tex_coord.y, tex_coord.x);
-        case 2: return vec3(tex_coord.x, 1.0, tex_coord.y);
-        case 3: return vec3(tex_coord.x, -1.0, -tex_coord.y);
-        case 4: return vec3(tex_coord.x, -tex_coord.y, 1.0);
-        case 5: return vec3(-tex_coord.xy, -1.0);
-    }
-
-    return vec3(0.0);
-}
-
 float D_GGX_divided_by_pi(in float n_dot_h, in float roughness) // can be optimized
 {
     float a_sqr = roughness * roughness;
@@ -1,35 +1,36 @@
 #version 430 core
 
-const float PI = 3.1415926535897932384626433832795;
-const float INV_PI = 1.0 / PI;
-
-#define saturate(x) clamp(x, 0.0, 1.0)
+#include "include/common_constants.glsl"
 
 out vec4 frag_color;
 
 in vec2 texcoord;
 
-layout (location = 0) uniform mat4 u_inverse_view_projection;
-layout (location = 1) uniform vec3 u_camera_position;
+#include "include/scene_camera_uniforms.glsl"
+#include "include/light_clusters.glsl"
 
 layout(location = 2, binding = 0) uniform sampler2D gbuffer_c0;
 layout(location = 3, binding = 1) uniform sampler2D gbuffer_c1;
 layout(location = 4, binding = 2) uniform sampler2D gbuffer_c2;
-layout(location = 5, binding = 3) uniform sampler2D gbuffer_c3;
+layout(location = 5, binding = 3) uniform sampler2D gbuffer_c3; // not used by the compact layout.
 layout(location = 6, binding = 4) uniform sampler2D gbuffer_depth;
 
 layout(location = 7, binding = 5) uniform samplerCube irradiance_map;
 layout(location = 8, binding = 6) uniform samplerCube prefiltered_specular;
 layout(location = 9, binding = 7) uniform sampler2D brdf_integration_lut;
 
-float D_GGX(in float n_dot_h, in float roughness);
-float V_SmithGGXCorrelated(in float n_dot_v, in float n_dot_l, in float roughness);
-vec3 F_Schlick(in float dot, in vec3 f0, in float f90);
-vec3 F_Schlick_roughness(in float dot, in vec3 f0, in float roughness);
-float Fd_BurleyRenormalized(in float n_dot_v, in float n_dot_l, in float l_dot_h, in float roughness);
+layout(location = 10) uniform vec2 u_gbuffer_uv_scale; // the part of the gbuffer rendered to in this frame.
+
+vec2 gbuffer_uv; // texcoord spans the rendered part, this the whole gbuffer.
+
+#include "include/pbr_functions.glsl"
+#ifdef COMPACT_GBUFFER
+#include "include/normal_encoding.glsl"
+#endif
 
 vec3 world_space_from_depth(in float depth, in vec2 uv, in mat4 inverse_view_projection);
 vec3 calculateTestLight(in float n_dot_v, in vec3 view_dir, in vec3 normal, in float perceptual_roughness, in vec3 f0, in vec3 real_albedo, in vec3 position, in float occlusion_factor);
+vec3 calculate_clustered_lights(in vec3 real_albedo, in float n_dot_v, in vec3 view_dir, in vec3 normal, in float perceptual_roughness, in vec3 f0, in float f90, in vec3 position);
 vec3 calculate_image_based_light(in vec3 real_albedo, in float n_dot_v, in vec3 view_dir, in vec3 normal, in float perceptual_roughness, in vec3 f0, in float f90, in float occlusion_factor);
 vec4 tonemap_with_gamma_correction(in vec4 color);
 vec4 srgb_to_linear(in vec4 srgb);
@@ -37,32 +38,57 @@ vec4 linear_to_srgb(in vec4 linear);
 
 vec3 get_specular_dominant_direction(in vec3 normal, in vec3 reflection, in float roughness);
 
+#ifdef COMPACT_GBUFFER
+// the compact layout has no alpha, everything in the gbuffer is opaque.
+vec4 get_base_color()
+{
+    return vec4(texture(gbuffer_c0, gbuffer_uv).rgb, 1.0);
+}
+
+vec3 get_normal()
+{
+    return decode_octahedral(texture(gbuffer_c1, gbuffer_uv).rg);
+}
+
+vec3 get_emissive()
+{
+    return texture(gbuffer_c2, gbuffer_uv).rgb;
+}
 
+vec3 get_occlusion_roughness_metallic()
+{
+    vec3 o_r_m = vec3(texture(gbuffer_c0, gbuffer_uv).a, texture(gbuffer_c1, gbuffer_uv).b, texture(gbuffer_c2, gbuffer_uv).a);
+    o_r_m.x = max(o_r_m.x, 0.089f);
+    return o_r_m;
+}
+#else
 vec4 get_base_color()
 {
-    return texture(gbuffer_c0, texcoord);
+    return texture(gbuffer_c0, gbuffer_uv);
 }
 
 vec3 get_normal()
 {
-    return normalize(texture(gbuffer_c1, texcoord).rgb * 2.0 - 1.0);
+    return normalize(texture(gbuffer_c1, gbuffer_uv).rgb * 2.0 - 1.0);
 }
 
 vec3 get_emissive()
 {
-    return texture(gbuffer_c2, texcoord).rgb;
+    return texture(gbuffer_c2, gbuffer_uv).rgb;
 }
 
 vec3 get_occlusion_roughness_metallic()
 {
-    vec3 o_r_m = texture(gbuffer_c3, texcoord).rgb;
+    vec3 o_r_m = texture(gbuffer_c3, gbuffer_uv).rgb;
     o_r_m.x = max(o_r_m.x, 0.089f);
     return o_r_m;
 }
+#endif
 
 void main()
 {
-    float depth = texture(gbuffer_depth, texcoord).r;
+    gbuffer_uv  = texcoord * u_gbuffer_uv_scale;
+    float depth = texture(gbuffer_depth, gbuffer_uv).r;
     gl_FragDepth = depth; // This is for the potential cubemap.
     if(depth >= 1.0) discard;
 
@@ -78,7 +104,7 @@ void main()
     vec3 f0          = 0.16 * reflectance * reflectance * (1.0 - metallic) + base_color.rgb * metallic;
     vec3 real_albedo = base_color.rgb * (1.0 - metallic);
 
-    vec3 view_dir = normalize(u_camera_position - position);
+    vec3 view_dir = normalize(u_camera_position.xyz - position);
     float n_dot_v = clamp(dot(normal, view_dir), 1e-5, 1.0 - 1e-5);
 
     vec3 lighting = vec3(0.0);
@@ -87,6 +113,9 @@ void main()
     float f90 = saturate(dot(f0, vec3(50.0 * 0.33)));
     lighting += calculate_image_based_light(real_albedo, n_dot_v, view_dir, normal, perceptual_roughness, f0, f90, occlusion_factor);
 
+    // punctual lights
+    lighting += calculate_clustered_lights(real_albedo, n_dot_v, view_dir, normal, perceptual_roughness, f0, f90, position);
+
     // lighting += calculateTestLight(n_dot_v, view_dir, normal, perceptual_roughness, f0, real_albedo, position, occlusion_factor);
 
     vec3 emissive = get_emissive();
@@ -119,6 +148,54 @@ vec3 calculate_image_based_light(in vec3 real_albedo, in float n_dot_v, in vec3
     return (diffuse_ibl + specular_ibl) * occlusion_factor;
 }
 
+vec3 calculate_clustered_lights(in vec3 real_albedo, in float n_dot_v, in vec3 view_dir, in vec3 normal, in float perceptual_roughness, in vec3 f0, in float f90, in vec3 position)
+{
+    float roughness = perceptual_roughness * perceptual_roughness;
+
+    // only the lights binned into the cluster of the pixel are evaluated.
+    float view_depth   = -(u_view_matrix * vec4(position, 1.0)).z;
+    uint cluster_index = get_cluster_index(texcoord, view_depth);
+    uint light_count   = clusters[cluster_index].light_count;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0; i < light_count; ++i)
+    {
+        light_data light = lights[cluster_light_indices[cluster_index * max_lights_per_cluster + i]];
+
+        vec3 to_light  = light.position_range.xyz - position;
+        float dist_sqr = dot(to_light, to_light);
+        float range    = light.position_range.w;
+        vec3 light_dir = to_light * inversesqrt(max(dist_sqr, 1e-8));
+        float n_dot_l  = saturate(dot(normal, light_dir));
+        if (n_dot_l <= 0.0 || dist_sqr >= range * range)
+            continue;
+
+        // inverse square falloff windowed to reach zero at the range.
+        float window      = saturate(1.0 - (dist_sqr * dist_sqr) / (range * range * range * range));
+        float attenuation = window * window / max(dist_sqr, 1e-4);
+
+        // spot falloff. The scale is zero and the offset one for point lights.
+        float cd   = dot(light.direction_angle_scale.xyz, -light_dir);
+        float spot = saturate(cd * light.direction_angle_scale.w + light.color_angle_offset.w);
+        attenuation *= spot * spot;
+
+        vec3 half_vector = normalize(view_dir + light_dir);
+        float n_dot_h    = saturate(dot(normal, half_vector));
+        float l_dot_h    = saturate(dot(light_dir, half_vector));
+
+        float D = D_GGX(n_dot_h, roughness);
+        float V = V_SmithGGXCorrelated(n_dot_v, n_dot_l, roughness);
+        vec3 F  = F_Schlick(l_dot_h, f0, f90);
+
+        vec3 specular = D * V * F;
+        vec3 diffuse  = real_albedo * Fd_BurleyRenormalized(n_dot_v, n_dot_l, l_dot_h, perceptual_roughness);
+
+        result += (diffuse + specular) * INV_PI * light.color_angle_offset.rgb * attenuation * n_dot_l;
+    }
+
+    return result;
+}
+
 vec3 uncharted2_tonemap(in vec3 color)
 {
     const float A = 0.15;
@@ -149,53 +226,6 @@ vec4 linear_to_srgb(in vec4 linear)
     return vec4(pow(linear.rgb, vec3(1.0 / 2.2)), linear.a);
 }
 
-//
-// see https://seblagarde.files.wordpress.com/2015/07/course_notes_moving_frostbite_to_pbr_v32.pdf.
-//
-
-float D_GGX(in float n_dot_h, in float roughness) // can be optimized
-{
-    float a_sqr = roughness * roughness;
-    float f = (n_dot_h * a_sqr - n_dot_h) * n_dot_h + 1.0;
-    // Gets divided by pi later on.
-    return a_sqr / (f * f);
-}
-
-float V_SmithGGXCorrelated(in float n_dot_v, in float n_dot_l, in float roughness) // can be optimized
-{
-    float a_sqr = roughness * roughness;
-    float GGXL = n_dot_v * sqrt((-n_dot_l * a_sqr + n_dot_l) * n_dot_l + a_sqr);
-    float GGXV = n_dot_l * sqrt((-n_dot_v * a_sqr + n_dot_v) * n_dot_v + a_sqr);
-    float GGX = GGXV + GGXL;
-    if (GGX > 0.0)
-    {
-        return 0.5 / GGX;
-    }
-    return 0.0;
-}
-
-vec3 F_Schlick(in float dot, in vec3 f0, in float f90) // can be optimized
-{
-    return f0 + (vec3(f90) - f0) * pow(saturate(1.0 - dot), 5.0);
-}
-
-vec3 F_Schlick_roughness(in float dot, in vec3 f0, in float roughness)
-{
-    return f0 + (max(vec3(1.0 - roughness), f0) - f0) * pow(saturate(1.0 - dot), 5.0);
-}
-
-float Fd_BurleyRenormalized(in float n_dot_v, in float n_dot_l, in float l_dot_h, in float roughness) // normalized Frostbyte version
-{
-    float energy_bias = mix(0.0, 0.5, roughness);
-    float energy_factor = mix(1.0, 1.0 / 1.51, roughness);
-    float f90 = energy_bias + 2.0 * l_dot_h * l_dot_h * roughness;
-    vec3 f0 = vec3(1.0);
-    float light_scatter = F_Schlick(n_dot_l, f0, f90).x;
-    float view_scatter = F_Schlick(n_dot_v, f0, f90).x;
-    // Gets divided by pi later on.
-    return energy_factor * light_scatter * view_scatter;
-}
-
 vec3 world_space_from_depth(in float depth, in vec2 uv, in mat4 inverse_view_projection)
 {
     float z = depth * 2.0 - 1.0;
@@ -0,0 +1,6 @@
+#version 430 core
+
+// depth pre-pass, the depth is written by the fixed function pipeline and nothing is shaded.
+void main()
+{
+}
@@ -1,9 +1,34 @@
 #version 430 core
 
+#ifdef BINDLESS_TEXTURES
+#extension GL_ARB_bindless_texture : require
+#endif
+
+#ifdef COMPACT_GBUFFER
+layout (location = 0) out vec4 gbuffer_c0; // base_color / reflection_color (rgb8) and occlusion (a8)
+layout (location = 1) out vec4 gbuffer_c1; // octahedral normal (rg10) and roughness (b10)
+layout (location = 2) out vec4 gbuffer_c2; // emissive (rgb8) and metallic (a8)
+
+#include "include/normal_encoding.glsl"
+#else
 layout (location = 0) out vec4 gbuffer_c0; // base_color / reflection_color (rgba8)
 layout (location = 1) out vec4 gbuffer_c1; // normal (rgb10)
 layout (location = 2) out vec4 gbuffer_c2; // emissive (rgb8) and something else
 layout (location = 3) out vec4 gbuffer_c3; // occlusion (r8), roughness (g8), metallic (b8) and something else
+#endif
+
+#ifdef OVERDRAW_COUNTER
+#ifndef ALPHA_MASK
+// the counter has side effects, without this the depth test would run after shading and every fragment would be counted.
+layout(early_fragment_tests) in;
+#endif
+
+// debug mode counting the shaded fragments.
+layout(binding = 8, std430) buffer overdraw_counter
+{
+    uint shaded_fragments;
+};
+#endif
 
 in shader_shared
 {
@@ -14,62 +39,85 @@ in shader_shared
     vec3 shared_bitangent;
     flat bool calculate_normals;
     flat bool calculate_tangents;
+    flat int material_index;
 } fs_in;
 
-layout (location = 1, binding = 0) uniform sampler2D t_base_color;
-layout (location = 2, binding = 1) uniform sampler2D t_roughness_metallic;
-layout (location = 3, binding = 2) uniform sampler2D t_occlusion;
-layout (location = 4, binding = 3) uniform sampler2D t_normal;
-layout (location = 5, binding = 4) uniform sampler2D t_emissive_color;
-
-layout(binding = 0, std140) uniform scene_vertex_uniforms
-{
-    mat4 u_model_matrix;
-    mat3 u_normal_matrix;
-    bool u_has_normals;
-    bool u_has_tangents;
-};
-
-layout(binding = 1, std140) uniform scene_material_uniforms
+struct material_data
 {
     vec4  base_color;
     vec4  emissive_color; // this is a vec3, but there are annoying bugs with some drivers.
     float metallic;
     float roughness;
+    float alpha_cutoff;
+    float padding0;
 
-    bool base_color_texture;
-    bool roughness_metallic_texture;
-    bool occlusion_texture;
-    bool packed_occlusion;
-    bool normal_texture;
-    bool emissive_color_texture;
+    // bindless texture handles, only valid if the texture feature is defined.
+    uvec2 base_color_texture;
+    uvec2 roughness_metallic_texture;
+    uvec2 occlusion_texture;
+    uvec2 normal_texture;
+    uvec2 emissive_color_texture;
+    uvec2 padding1;
+};
 
-    int alpha_mode;
-    float alpha_cutoff;
+// all materials in use, persistent over frames.
+layout(binding = 3, std430) readonly buffer scene_materials
+{
+    material_data materials[];
 };
 
+#ifdef BINDLESS_TEXTURES
+#define t_base_color sampler2D(materials[fs_in.material_index].base_color_texture)
+#define t_roughness_metallic sampler2D(materials[fs_in.material_index].roughness_metallic_texture)
+#define t_occlusion sampler2D(materials[fs_in.material_index].occlusion_texture)
+#define t_normal sampler2D(materials[fs_in.material_index].normal_texture)
+#define t_emissive_color sampler2D(materials[fs_in.material_index].emissive_color_texture)
+#else
+layout (location = 1, binding = 0) uniform sampler2D t_base_color;
+layout (location = 2, binding = 1) uniform sampler2D t_roughness_metallic;
+layout (location = 3, binding = 2) uniform sampler2D t_occlusion;
+layout (location = 4, binding = 3) uniform sampler2D t_normal;
+layout (location = 5, binding = 4) uniform sampler2D t_emissive_color;
+#endif
+
+// the material features are compile time definitions, each material uses a specialized permutation.
 vec4 get_base_color()
 {
-    vec4 color = base_color_texture ? texture(t_base_color, fs_in.shared_texcoord) : base_color;
-    if(alpha_mode == 1 && color.a <= alpha_cutoff)
+#ifdef BASE_COLOR_TEXTURE
+    vec4 color = texture(t_base_color, fs_in.shared_texcoord);
+#else
+    vec4 color = materials[fs_in.material_index].base_color;
+#endif
+#ifdef ALPHA_MASK
+    if(color.a <= materials[fs_in.material_index].alpha_cutoff)
         discard;
+#endif
     return color;
 }
 
 vec3 get_emissive()
 {
-    return emissive_color_texture ? texture(t_emissive_color, fs_in.shared_texcoord).rgb : emissive_color.rgb;
+#ifdef EMISSIVE_COLOR_TEXTURE
+    return texture(t_emissive_color, fs_in.shared_texcoord).rgb;
+#else
+    return materials[fs_in.material_index].emissive_color.rgb;
+#endif
 }
 
 vec3 get_occlusion_roughness_metallic()
 {
-    vec3 o_r_m = roughness_metallic_texture ? texture(t_roughness_metallic, fs_in.shared_texcoord).rgb : vec3(1.0, roughness, metallic);
-    if(packed_occlusion)
-        return o_r_m;
-
-    float occlusion = occlusion_texture ? texture(t_occlusion, fs_in.shared_texcoord).r : 1.0;
-    o_r_m.r = occlusion;
-
+#ifdef ROUGHNESS_METALLIC_TEXTURE
+    vec3 o_r_m = texture(t_roughness_metallic, fs_in.shared_texcoord).rgb;
+#else
+    vec3 o_r_m = vec3(1.0, materials[fs_in.material_index].roughness, materials[fs_in.material_index].metallic);
+#endif
+#ifndef PACKED_OCCLUSION
+#ifdef OCCLUSION_TEXTURE
+    o_r_m.r = texture(t_occlusion, fs_in.shared_texcoord).r;
+#else
+    o_r_m.r = 1.0;
+#endif
+#endif
     return o_r_m;
 }
 
@@ -78,13 +126,13 @@ vec3 get_normal()
     vec3 normal = normalize(fs_in.shared_normal);
     vec3 dfdx = dFdx(fs_in.shared_vertex_position);
     vec3 dfdy = dFdy(fs_in.shared_vertex_position);
-    if(!u_has_normals)
+    if(fs_in.calculate_normals)
         normal = normalize(cross(dfdx, dfdy)); // approximation
-    if(normal_texture)
+#ifdef NORMAL_TEXTURE
     {
         vec3 tangent   = fs_in.shared_tangent;
         vec3 bitangent = fs_in.shared_bitangent;
-        if(!u_has_tangents)
+        if(fs_in.calculate_tangents)
         {
             vec3 uv_dx = dFdx(vec3(fs_in.shared_texcoord, 0.0));
             vec3 uv_dy = dFdy(vec3(fs_in.shared_texcoord, 0.0));
@@ -97,13 +145,24 @@ vec3 get_normal()
         vec3 mapped_normal = normalize(texture(t_normal, fs_in.shared_texcoord).rgb * 2.0 - 1.0);
         normal = normalize(tbn * mapped_normal.rgb);
     }
-    return normal * 0.5 + 0.5;
+#endif
+    return normal;
 }
 
 void main()
 {
+#ifdef COMPACT_GBUFFER
+    vec3 o_r_m = get_occlusion_roughness_metallic();
+    gbuffer_c0 = vec4(get_base_color().rgb, o_r_m.r);
+    gbuffer_c1 = vec4(encode_octahedral(get_normal()), o_r_m.g, 0.0);
+    gbuffer_c2 = vec4(get_emissive(), o_r_m.b);
+#else
     gbuffer_c0 = vec4(get_base_color());
-    gbuffer_c1 = vec4(get_normal(), 0.0);
+    gbuffer_c1 = vec4(get_normal() * 0.5 + 0.5, 0.0);
     gbuffer_c2 = vec4(get_emissive(), 0.0);
     gbuffer_c3 = vec4(get_occlusion_roughness_metallic(), 0.0);
+#endif
+#ifdef OVERDRAW_COUNTER
+    atomicAdd(shaded_fragments, 1u);
+#endif
 }
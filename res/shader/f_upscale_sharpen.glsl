@@ -0,0 +1,32 @@
+#version 430 core
+
+out vec4 frag_color;
+
+in vec2 texcoord;
+
+layout(location = 0, binding = 0) uniform sampler2D u_color;
+layout(location = 1) uniform vec2 u_uv_scale;   // the part of the color target holding the image.
+layout(location = 2) uniform float u_sharpness; // 0 is a plain bilinear upscale.
+
+void main()
+{
+    // the filter stays half a texel inside the image, so nothing outside of it is blended in.
+    vec2 texel  = 1.0 / vec2(textureSize(u_color, 0));
+    vec2 min_uv = 0.5 * texel;
+    vec2 max_uv = u_uv_scale - 0.5 * texel;
+    vec2 uv     = clamp(texcoord * u_uv_scale, min_uv, max_uv);
+
+    vec3 center = texture(u_color, uv).rgb;
+    vec3 left   = texture(u_color, clamp(uv - vec2(texel.x, 0.0), min_uv, max_uv)).rgb;
+    vec3 right  = texture(u_color, clamp(uv + vec2(texel.x, 0.0), min_uv, max_uv)).rgb;
+    vec3 down   = texture(u_color, clamp(uv - vec2(0.0, texel.y), min_uv, max_uv)).rgb;
+    vec3 up     = texture(u_color, clamp(uv + vec2(0.0, texel.y), min_uv, max_uv)).rgb;
+
+    // unsharp mask limited to the range of the neighbourhood, so edges do not ring.
+    vec3 neighbourhood_min = min(center, min(min(left, right), min(down, up)));
+    vec3 neighbourhood_max = max(center, max(max(left, right), max(down, up)));
+    vec3 blurred           = (left + right + down + up) * 0.25;
+    vec3 sharpened         = center + (center - blurred) * u_sharpness;
+
+    frag_color = vec4(clamp(sharpened, neighbourhood_min, neighbourhood_max), 1.0);
+}
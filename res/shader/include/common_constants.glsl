@@ -0,0 +1,7 @@
+// constants and helpers shared by all shaders.
+
+const float PI = 3.1415926535897932384626433832795;
+const float TWO_PI = PI * 2.0;
+const float INV_PI = 1.0 / PI;
+
+#define saturate(x) clamp(x, 0.0, 1.0)
@@ -0,0 +1,29 @@
+// helpers shared by the image based lighting compute shaders.
+
+// See: http://holger.dammertz.org/stuff/notes_HammersleyOnHemisphere.html
+float radical_inverse_VdC(in uint bits)
+{
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+    return float(bits) * 2.3283064365386963e-10;
+}
+
+vec3 cube_to_world(in ivec3 cube_coord, in vec2 cubemap_size)
+{
+    vec2 tex_coord = vec2(cube_coord.xy) / cubemap_size;
+    tex_coord = tex_coord  * 2.0 - 1.0;
+    switch(cube_coord.z)
+    {
+        case 0: return vec3(1.0, -tex_coord.yx);
+        case 1: return vec3(-1.0, -tex_coord.y, tex_coord.x);
+        case 2: return vec3(tex_coord.x, 1.0, tex_coord.y);
+        case 3: return vec3(tex_coord.x, -1.0, -tex_coord.y);
+        case 4: return vec3(tex_coord.x, -tex_coord.y, 1.0);
+        case 5: return vec3(-tex_coord.xy, -1.0);
+    }
+
+    return vec3(0.0);
+}
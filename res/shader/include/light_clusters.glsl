@@ -0,0 +1,57 @@
+// punctual lights and the froxel cluster grid they are binned into.
+// requires scene_camera_uniforms.glsl and the defines CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z and MAX_LIGHTS_PER_CLUSTER.
+
+const uvec3 cluster_grid = uvec3(CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z);
+const uint max_lights_per_cluster = MAX_LIGHTS_PER_CLUSTER;
+
+struct light_data
+{
+    vec4 position_range;        // world space position (xyz) and range (w).
+    vec4 color_angle_offset;    // color scaled by the intensity (rgb) and offset of the spot falloff (w). 1.0 for point lights.
+    vec4 direction_angle_scale; // world space spot direction (xyz) and scale of the spot falloff (w). 0.0 for point lights.
+};
+
+struct cluster_data
+{
+    uint active;      // set if any pixel of the current frame lies in the cluster.
+    uint light_count; // number of light indices of the cluster.
+};
+
+layout(binding = 5, std430) readonly buffer scene_lights
+{
+    light_data lights[];
+};
+
+layout(binding = 6, std430) buffer light_clusters
+{
+    cluster_data clusters[];
+};
+
+layout(binding = 7, std430) buffer light_cluster_indices
+{
+    uint cluster_light_indices[];
+};
+
+// the depth slices are distributed exponentially between the near and the far plane.
+uint get_cluster_slice(in float view_depth)
+{
+    float slice = log(max(view_depth, u_camera_planes.x) / u_camera_planes.x) * float(cluster_grid.z) / log(u_camera_planes.y / u_camera_planes.x);
+    return min(uint(slice), cluster_grid.z - 1);
+}
+
+float get_cluster_slice_depth(in uint slice)
+{
+    return u_camera_planes.x * pow(u_camera_planes.y / u_camera_planes.x, float(slice) / float(cluster_grid.z));
+}
+
+uint get_cluster_index(in vec2 uv, in float view_depth)
+{
+    uvec2 tile = min(uvec2(uv * vec2(cluster_grid.xy)), cluster_grid.xy - 1);
+    return (get_cluster_slice(view_depth) * cluster_grid.y + tile.y) * cluster_grid.x + tile.x;
+}
+
+vec3 view_space_from_depth(in float depth, in vec2 uv)
+{
+    vec4 view = u_inverse_projection * vec4(uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    return view.xyz / view.w;
+}
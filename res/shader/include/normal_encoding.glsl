@@ -0,0 +1,25 @@
+// octahedral normal encoding used by the compact gbuffer layout.
+// see http://jcgt.org/published/0003/02/01/.
+
+vec2 sign_not_zero(in vec2 v)
+{
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// encodes a normalized vector in [0, 1] for unorm targets.
+vec2 encode_octahedral(in vec3 n)
+{
+    vec2 p = n.xy / (abs(n.x) + abs(n.y) + abs(n.z));
+    if (n.z < 0.0)
+        p = (1.0 - abs(p.yx)) * sign_not_zero(p);
+    return p * 0.5 + 0.5;
+}
+
+vec3 decode_octahedral(in vec2 e)
+{
+    vec2 p = e * 2.0 - 1.0;
+    vec3 n = vec3(p, 1.0 - abs(p.x) - abs(p.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * sign_not_zero(n.xy);
+    return normalize(n);
+}
@@ -0,0 +1,49 @@
+// brdf functions shared by the lighting and the image based lighting precomputation.
+// requires common_constants.glsl.
+
+//
+// see https://seblagarde.files.wordpress.com/2015/07/course_notes_moving_frostbite_to_pbr_v32.pdf.
+//
+
+float D_GGX(in float n_dot_h, in float roughness) // can be optimized
+{
+    float a_sqr = roughness * roughness;
+    float f = (n_dot_h * a_sqr - n_dot_h) * n_dot_h + 1.0;
+    // Gets divided by pi later on.
+    return a_sqr / (f * f);
+}
+
+float V_SmithGGXCorrelated(in float n_dot_v, in float n_dot_l, in float roughness) // can be optimized
+{
+    float a_sqr = roughness * roughness;
+    float GGXL = n_dot_v * sqrt((-n_dot_l * a_sqr + n_dot_l) * n_dot_l + a_sqr);
+    float GGXV = n_dot_l * sqrt((-n_dot_v * a_sqr + n_dot_v) * n_dot_v + a_sqr);
+    float GGX = GGXV + GGXL;
+    if (GGX > 0.0)
+    {
+        return 0.5 / GGX;
+    }
+    return 0.0;
+}
+
+vec3 F_Schlick(in float dot, in vec3 f0, in float f90) // can be optimized
+{
+    return f0 + (vec3(f90) - f0) * pow(saturate(1.0 - dot), 5.0);
+}
+
+vec3 F_Schlick_roughness(in float dot, in vec3 f0, in float roughness)
+{
+    return f0 + (max(vec3(1.0 - roughness), f0) - f0) * pow(saturate(1.0 - dot), 5.0);
+}
+
+float Fd_BurleyRenormalized(in float n_dot_v, in float n_dot_l, in float l_dot_h, in float roughness) // normalized Frostbyte version
+{
+    float energy_bias = mix(0.0, 0.5, roughness);
+    float energy_factor = mix(1.0, 1.0 / 1.51, roughness);
+    float f90 = energy_bias + 2.0 * l_dot_h * l_dot_h * roughness;
+    vec3 f0 = vec3(1.0);
+    float light_scatter = F_Schlick(n_dot_l, f0, f90).x;
+    float view_scatter = F_Schlick(n_dot_v, f0, f90).x;
+    // Gets divided by pi later on.
+    return energy_factor * light_scatter * view_scatter;
+}
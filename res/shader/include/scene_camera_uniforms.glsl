@@ -0,0 +1,11 @@
+// camera data of the current frame shared by the scene passes.
+
+layout(binding = 2, std140) uniform scene_camera_uniforms
+{
+    mat4 u_view_projection_matrix;
+    mat4 u_inverse_view_projection;
+    mat4 u_view_matrix;
+    mat4 u_inverse_projection;
+    vec4 u_camera_position; // this is a vec3, but there are annoying bugs with some drivers.
+    vec4 u_camera_planes;   // distance of the near (x) and the far (y) plane.
+};
@@ -1,20 +1,41 @@
 #version 430 core
 
+#ifdef DRAW_PARAMETERS
+#extension GL_ARB_shader_draw_parameters : require
+#endif
+
 layout(location = 0) in vec3 v_position;
-layout(location = 1) in vec3 v_normal;
+layout(location = 1) in vec3 v_normal; // octahedral encoded in xy if the attributes are quantized.
 layout(location = 2) in vec2 v_texcoord;
 layout(location = 3) in vec4 v_tangent;
 
-layout(location = 0) uniform mat4 u_view_projection_matrix;
+#include "include/scene_camera_uniforms.glsl"
+#include "include/normal_encoding.glsl"
+
+struct object_data
+{
+    mat4 model_matrix;
+    mat3 normal_matrix;
+    bool has_normals;
+    bool has_tangents;
+    bool has_quantized_attributes;
+    vec4 position_offset;
+    vec4 position_scale;
+};
 
-layout(binding = 0, std140) uniform scene_vertex_uniforms
+// all objects, entries are only written when the model info changes.
+layout(binding = 4, std430) readonly buffer scene_objects
 {
-    mat4 u_model_matrix;
-    mat3 u_normal_matrix;
-    bool u_has_normals;
-    bool u_has_tangents;
+    object_data objects[];
 };
 
+#ifndef DRAW_PARAMETERS
+layout(location = 0) uniform int u_draw_index;
+#endif
+
+// the depth pre-pass uses this shader as well, both passes have to compute exactly the same depth.
+invariant gl_Position;
+
 out shader_shared
 {
     vec3 shared_vertex_position;
@@ -24,26 +45,44 @@ out shader_shared
     vec3 shared_bitangent;
     flat bool calculate_normals;
     flat bool calculate_tangents;
+    flat int material_index;
 } vs_out;
 
 void main()
 {
-    vec4 v_pos = u_model_matrix * vec4(v_position, 1.0);
+#ifdef DRAW_PARAMETERS
+    int draw_index = gl_BaseInstanceARB;
+#else
+    int draw_index = u_draw_index;
+#endif
+    // the object index is stored in the upper bits, the material index in the lower 12 bits.
+    object_data object    = objects[draw_index >> 12];
+    vs_out.material_index = draw_index & 0xFFF;
+
+    // quantized positions are relative to the bounds of the mesh.
+    vec3 position = v_position;
+    vec3 normal   = v_normal;
+    if(object.has_quantized_attributes)
+    {
+        position = object.position_offset.xyz + v_position * object.position_scale.xyz;
+        normal   = decode_octahedral(v_normal.xy * 0.5 + 0.5);
+    }
+
+    vec4 v_pos = object.model_matrix * vec4(position, 1.0);
     vs_out.shared_vertex_position = v_pos.xyz / v_pos.w;
 
     vs_out.shared_texcoord = v_texcoord;
 
+    vs_out.calculate_normals  = !object.has_normals;
+    vs_out.calculate_tangents = !object.has_tangents;
 
-    vs_out.calculate_normals  = false;
-    vs_out.calculate_tangents = false;
-
-    if(u_has_normals)
-        vs_out.shared_normal = u_normal_matrix * normalize(v_normal);
+    if(object.has_normals)
+        vs_out.shared_normal = object.normal_matrix * normalize(normal);
 
-    if(u_has_tangents)
+    if(object.has_tangents)
     {
-        vs_out.shared_tangent = u_normal_matrix * normalize(v_tangent.xyz);
-        if(u_has_normals)
+        vs_out.shared_tangent = object.normal_matrix * normalize(v_tangent.xyz);
+        if(object.has_normals)
         {
             vs_out.shared_bitangent = cross(vs_out.shared_normal, vs_out.shared_tangent);
             if(v_tangent.w == -1.0) // TODO Paul: Check this convention.
@@ -0,0 +1,92 @@
+//! \file      file_watcher_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <resources/file_watcher.hpp>
+
+//! \cond NO_DOC
+
+#if defined(LINUX)
+class file_watcher_test : public ::testing::Test
+{
+  protected:
+    file_watcher_test() {}
+
+    ~file_watcher_test() override {}
+
+    void SetUp() override
+    {
+        write_file(m_watched_path, "initial");
+        write_file(m_other_path, "initial");
+        m_watcher = std::make_shared<mango::file_watcher>();
+        m_watcher->watch(m_watched_path);
+    }
+
+    void TearDown() override
+    {
+        m_watcher.reset();
+        std::remove(m_watched_path);
+        std::remove(m_other_path);
+        std::remove(m_temporary_path);
+    }
+
+    void write_file(const char* path, const char* content)
+    {
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        file << content;
+    }
+
+    const char* m_watched_path   = "./file_watcher_test_watched.glsl";
+    const char* m_other_path     = "./file_watcher_test_other.glsl";
+    const char* m_temporary_path = "./file_watcher_test_watched.glsl.tmp";
+    mango::shared_ptr<mango::file_watcher> m_watcher;
+};
+
+TEST_F(file_watcher_test, reports_written_files_once)
+{
+    std::vector<mango::string> changed_files;
+    m_watcher->poll(changed_files);
+    EXPECT_TRUE(changed_files.empty());
+
+    // closing a file opened for writing triggers IN_CLOSE_WRITE.
+    write_file(m_watched_path, "first");
+    write_file(m_watched_path, "second");
+    m_watcher->poll(changed_files);
+    ASSERT_EQ(1u, changed_files.size());
+    EXPECT_EQ(m_watched_path, changed_files[0]);
+
+    changed_files.clear();
+    m_watcher->poll(changed_files);
+    EXPECT_TRUE(changed_files.empty());
+}
+
+TEST_F(file_watcher_test, reports_replaced_files)
+{
+    // editors often write a temporary file and move it over the original one, which triggers IN_MOVED_TO.
+    write_file(m_temporary_path, "replaced");
+    std::vector<mango::string> changed_files;
+    m_watcher->poll(changed_files);
+    EXPECT_TRUE(changed_files.empty());
+
+    ASSERT_EQ(0, std::rename(m_temporary_path, m_watched_path));
+    m_watcher->poll(changed_files);
+    ASSERT_EQ(1u, changed_files.size());
+    EXPECT_EQ(m_watched_path, changed_files[0]);
+}
+
+TEST_F(file_watcher_test, ignores_files_not_watched)
+{
+    // the directory is observed, but only watched files are reported.
+    write_file(m_other_path, "changed");
+    std::vector<mango::string> changed_files;
+    m_watcher->poll(changed_files);
+    EXPECT_TRUE(changed_files.empty());
+}
+#endif // LINUX
+
+//! \endcond
@@ -0,0 +1,436 @@
+//! \file      mesh_processing_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/gtc/packing.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <resources/mesh_processing.hpp>
+
+//! \cond NO_DOC
+
+class mesh_processing_test : public ::testing::Test
+{
+  protected:
+    mesh_processing_test() {}
+
+    ~mesh_processing_test() override {}
+
+    void SetUp() override {}
+
+    void TearDown() override {}
+
+    // a regular grid of quads in the xy plane with size x size vertices and the height given by the amplitude.
+    void create_grid(mango::uint32 size, float amplitude)
+    {
+        m_positions.clear();
+        m_indices.clear();
+        for (mango::uint32 y = 0; y < size; ++y)
+        {
+            for (mango::uint32 x = 0; x < size; ++x)
+            {
+                float u = static_cast<float>(x) / static_cast<float>(size - 1);
+                float v = static_cast<float>(y) / static_cast<float>(size - 1);
+                m_positions.push_back(glm::vec3(u, v, amplitude * std::sin(u * 6.0f) * std::cos(v * 6.0f)));
+            }
+        }
+        for (mango::uint32 y = 0; y < size - 1; ++y)
+        {
+            for (mango::uint32 x = 0; x < size - 1; ++x)
+            {
+                mango::uint32 i = y * size + x;
+                m_indices.insert(m_indices.end(), { i, i + 1, i + size + 1, i, i + size + 1, i + size });
+            }
+        }
+    }
+
+    // checks that the triangle list is valid and does not contain degenerate triangles.
+    void expect_valid_triangles(const std::vector<mango::uint32>& indices)
+    {
+        ASSERT_EQ(0u, indices.size() % 3);
+        for (mango::ptr_size i = 0; i < indices.size(); i += 3)
+        {
+            ASSERT_LT(indices[i], m_positions.size());
+            ASSERT_LT(indices[i + 1], m_positions.size());
+            ASSERT_LT(indices[i + 2], m_positions.size());
+            EXPECT_NE(indices[i], indices[i + 1]);
+            EXPECT_NE(indices[i + 1], indices[i + 2]);
+            EXPECT_NE(indices[i], indices[i + 2]);
+        }
+    }
+
+    // shuffles the triangles of the grid, so the order has no locality left.
+    void shuffle_triangles()
+    {
+        std::vector<mango::uint32> order(m_indices.size() / 3);
+        for (mango::uint32 t = 0; t < order.size(); ++t)
+            order[t] = t;
+        std::mt19937 generator(42);
+        std::shuffle(order.begin(), order.end(), generator);
+
+        std::vector<mango::uint32> shuffled;
+        for (mango::uint32 t : order)
+            shuffled.insert(shuffled.end(), m_indices.begin() + t * 3, m_indices.begin() + t * 3 + 3);
+        m_indices.swap(shuffled);
+    }
+
+    // appends a box with subdivided faces, each face has its own vertices. The faces point inwards if inverted.
+    void create_box(float half_extent, bool inverted, mango::uint32 subdivisions)
+    {
+        const glm::vec3 axes[3] = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+        for (mango::uint32 face = 0; face < 6; ++face)
+        {
+            // cross(u, v) is the outward normal of the face.
+            float side          = face < 3 ? 1.0f : -1.0f;
+            glm::vec3 n         = axes[face % 3] * side;
+            glm::vec3 u         = face < 3 ? axes[(face + 1) % 3] : axes[(face + 2) % 3];
+            glm::vec3 v         = face < 3 ? axes[(face + 2) % 3] : axes[(face + 1) % 3];
+            mango::uint32 first = static_cast<mango::uint32>(m_positions.size());
+            mango::uint32 size  = subdivisions + 1;
+            for (mango::uint32 y = 0; y < size; ++y)
+            {
+                for (mango::uint32 x = 0; x < size; ++x)
+                {
+                    float s = 2.0f * static_cast<float>(x) / static_cast<float>(subdivisions) - 1.0f;
+                    float t = 2.0f * static_cast<float>(y) / static_cast<float>(subdivisions) - 1.0f;
+                    m_positions.push_back(half_extent * (n + s * u + t * v));
+                }
+            }
+            for (mango::uint32 y = 0; y < subdivisions; ++y)
+            {
+                for (mango::uint32 x = 0; x < subdivisions; ++x)
+                {
+                    mango::uint32 i = first + y * size + x;
+                    if (inverted)
+                        m_indices.insert(m_indices.end(), { i, i + size + 1, i + 1, i, i + size, i + size + 1 });
+                    else
+                        m_indices.insert(m_indices.end(), { i, i + 1, i + size + 1, i, i + size + 1, i + size });
+                }
+            }
+        }
+    }
+
+    // the triangles of a list in order, rotated to the smallest index, so the winding is kept.
+    std::vector<std::array<mango::uint32, 3>> rotated_triangles(const std::vector<mango::uint32>& list)
+    {
+        std::vector<std::array<mango::uint32, 3>> triangles;
+        for (mango::ptr_size i = 0; i < list.size(); i += 3)
+        {
+            mango::ptr_size first = i;
+            if (list[i + 1] < list[first])
+                first = i + 1;
+            if (list[i + 2] < list[first])
+                first = i + 2;
+            mango::ptr_size offset = first - i;
+            triangles.push_back({ { list[i + offset], list[i + (offset + 1) % 3], list[i + (offset + 2) % 3] } });
+        }
+        return triangles;
+    }
+
+    // decodes an octahedral encoded normal like the shaders do.
+    glm::vec3 decode_octahedral(const glm::vec2& p)
+    {
+        glm::vec3 n = glm::vec3(p.x, p.y, 1.0f - std::abs(p.x) - std::abs(p.y));
+        if (n.z < 0.0f)
+        {
+            glm::vec2 xy = (glm::vec2(1.0f) - glm::abs(glm::vec2(n.y, n.x))) * glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+            n.x          = xy.x;
+            n.y          = xy.y;
+        }
+        return glm::normalize(n);
+    }
+
+    std::vector<glm::vec3> m_positions;
+    std::vector<mango::uint32> m_indices;
+};
+
+TEST_F(mesh_processing_test, simplify_triangles_reaches_target_on_flat_grid)
+{
+    create_grid(16, 0.0f);
+    mango::ptr_size target = m_indices.size() / 2;
+    float error            = -1.0f;
+
+    std::vector<mango::uint32> simplified = mango::simplify_triangles(m_indices, m_positions, target, error);
+
+    ASSERT_NO_FATAL_FAILURE(expect_valid_triangles(simplified));
+    EXPECT_LE(simplified.size(), target);
+    EXPECT_GT(simplified.size(), 0u);
+    // collapses in a plane do not change the surface.
+    EXPECT_NEAR(0.0f, error, 1e-4f);
+}
+
+TEST_F(mesh_processing_test, simplify_triangles_keeps_input_below_target)
+{
+    create_grid(4, 0.0f);
+    float error = -1.0f;
+
+    std::vector<mango::uint32> simplified = mango::simplify_triangles(m_indices, m_positions, m_indices.size(), error);
+
+    EXPECT_EQ(m_indices, simplified);
+    EXPECT_EQ(0.0f, error);
+}
+
+TEST_F(mesh_processing_test, simplify_triangles_error_grows_with_reduction)
+{
+    create_grid(24, 0.1f);
+    float mild_error       = -1.0f;
+    float aggressive_error = -1.0f;
+
+    std::vector<mango::uint32> mild       = mango::simplify_triangles(m_indices, m_positions, m_indices.size() / 2, mild_error);
+    std::vector<mango::uint32> aggressive = mango::simplify_triangles(m_indices, m_positions, m_indices.size() / 8, aggressive_error);
+
+    ASSERT_NO_FATAL_FAILURE(expect_valid_triangles(mild));
+    ASSERT_NO_FATAL_FAILURE(expect_valid_triangles(aggressive));
+    EXPECT_LT(aggressive.size(), mild.size());
+    EXPECT_LE(mild.size(), m_indices.size() / 2);
+    // the curved surface can not be simplified without error, more collapses can only add to the largest one.
+    EXPECT_GT(aggressive_error, 0.0f);
+    EXPECT_GE(aggressive_error, mild_error);
+    EXPECT_TRUE(std::isfinite(aggressive_error));
+}
+
+TEST_F(mesh_processing_test, build_meshlets_respects_limits)
+{
+    create_grid(40, 0.1f);
+    const mango::uint32 max_vertices   = 64;
+    const mango::uint32 max_triangles  = 124;
+    std::vector<mango::uint32> indices = m_indices;
+
+    std::vector<mango::meshlet> meshlets = mango::build_meshlets(indices, m_positions, max_vertices, max_triangles);
+
+    ASSERT_FALSE(meshlets.empty());
+    ASSERT_EQ(m_indices.size(), indices.size());
+    mango::uint32 next_index = 0;
+    for (const mango::meshlet& m : meshlets)
+    {
+        // meshlets are continuous ranges covering the reordered list.
+        EXPECT_EQ(next_index, m.first_index);
+        EXPECT_EQ(0u, m.index_count % 3);
+        EXPECT_GT(m.index_count, 0u);
+        EXPECT_LE(m.index_count / 3, max_triangles);
+        next_index = m.first_index + m.index_count;
+
+        std::vector<mango::uint32> vertices(indices.begin() + m.first_index, indices.begin() + next_index);
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        EXPECT_LE(vertices.size(), max_vertices);
+
+        glm::vec3 center(m.bounding_sphere.x, m.bounding_sphere.y, m.bounding_sphere.z);
+        for (mango::uint32 v : vertices)
+            EXPECT_LE(glm::length(m_positions[v] - center), m.bounding_sphere.w + 1e-5f);
+    }
+    EXPECT_EQ(indices.size(), next_index);
+}
+
+TEST_F(mesh_processing_test, build_meshlets_emits_every_triangle_once)
+{
+    create_grid(40, 0.1f);
+    std::vector<mango::uint32> indices = m_indices;
+
+    mango::build_meshlets(indices, m_positions, 64, 124);
+
+    std::vector<std::array<mango::uint32, 3>> expected = rotated_triangles(m_indices);
+    std::vector<std::array<mango::uint32, 3>> result   = rotated_triangles(indices);
+    std::sort(expected.begin(), expected.end());
+    std::sort(result.begin(), result.end());
+    EXPECT_EQ(expected, result);
+    EXPECT_EQ(result.end(), std::adjacent_find(result.begin(), result.end()));
+}
+
+TEST_F(mesh_processing_test, optimize_vertex_cache_does_not_increase_acmr)
+{
+    create_grid(32, 0.0f);
+    shuffle_triangles();
+    mango::uint32 vertex_count         = static_cast<mango::uint32>(m_positions.size());
+    std::vector<mango::uint32> indices = m_indices;
+
+    mango::optimize_vertex_cache(indices, vertex_count);
+
+    ASSERT_EQ(m_indices.size(), indices.size());
+    for (mango::uint32 cache_size : { 16u, 32u })
+    {
+        float before = mango::compute_acmr(m_indices, vertex_count, cache_size);
+        float after  = mango::compute_acmr(indices, vertex_count, cache_size);
+        EXPECT_LE(after, before) << "Cache size " << cache_size;
+        EXPECT_GE(after, 0.5f);
+        EXPECT_LE(after, 3.0f);
+    }
+
+    // an already optimized list does not get worse.
+    std::vector<mango::uint32> optimized = indices;
+    mango::optimize_vertex_cache(optimized, vertex_count);
+    EXPECT_LE(mango::compute_acmr(optimized, vertex_count, 32), mango::compute_acmr(indices, vertex_count, 32));
+}
+
+TEST_F(mesh_processing_test, optimize_vertex_fetch_remap_is_permutation)
+{
+    create_grid(16, 0.0f);
+    shuffle_triangles();
+    // one vertex is not referenced and has to be moved to the end.
+    m_positions.push_back(glm::vec3(2.0f));
+    mango::uint32 vertex_count         = static_cast<mango::uint32>(m_positions.size());
+    std::vector<mango::uint32> indices = m_indices;
+
+    std::vector<mango::uint32> remap = mango::optimize_vertex_fetch(indices, vertex_count);
+
+    ASSERT_EQ(vertex_count, remap.size());
+    std::vector<mango::uint32> sorted = remap;
+    std::sort(sorted.begin(), sorted.end());
+    for (mango::uint32 v = 0; v < vertex_count; ++v)
+        EXPECT_EQ(v, sorted[v]);
+    EXPECT_EQ(vertex_count - 1, remap.back());
+
+    // indices are rewritten and new vertices are referenced in increasing order.
+    ASSERT_EQ(m_indices.size(), indices.size());
+    mango::uint32 next = 0;
+    for (mango::ptr_size i = 0; i < indices.size(); ++i)
+    {
+        EXPECT_EQ(remap[m_indices[i]], indices[i]);
+        EXPECT_LE(indices[i], next);
+        if (indices[i] == next)
+            ++next;
+    }
+    EXPECT_EQ(vertex_count - 1, next);
+}
+
+TEST_F(mesh_processing_test, quantize_vertices_round_trip)
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texcoords;
+    std::vector<glm::vec4> tangents;
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    for (mango::uint32 i = 0; i < 256; ++i)
+    {
+        glm::vec3 direction = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+        // the axes and the edges of the octahedron are the critical cases.
+        if (i < 6)
+        {
+            direction        = glm::vec3(0.0f);
+            direction[i % 3] = i < 3 ? 1.0f : -1.0f;
+        }
+        if (glm::length(direction) < 1e-3f)
+            direction = glm::vec3(1.0f, -1.0f, 0.0f);
+        direction = glm::normalize(direction);
+
+        positions.push_back(glm::vec3(10.0f * distribution(generator), 2.0f * distribution(generator), 0.5f * distribution(generator)) + glm::vec3(3.0f));
+        normals.push_back(direction);
+        texcoords.push_back(glm::vec2(4.0f * distribution(generator), distribution(generator) * 0.5f + 0.5f));
+        tangents.push_back(glm::vec4(glm::normalize(glm::cross(direction, glm::vec3(0.3f, 0.5f, 0.81f))), i % 2 == 0 ? 1.0f : -1.0f));
+    }
+    glm::vec3 min_position = positions[0];
+    glm::vec3 max_position = positions[0];
+    for (const glm::vec3& p : positions)
+    {
+        min_position = glm::min(min_position, p);
+        max_position = glm::max(max_position, p);
+    }
+    glm::vec3 scale = max_position - min_position;
+
+    std::vector<mango::quantized_vertex> vertices = mango::quantize_vertices(positions, normals, texcoords, tangents, min_position, scale);
+
+    ASSERT_EQ(positions.size(), vertices.size());
+    for (mango::ptr_size i = 0; i < vertices.size(); ++i)
+    {
+        const mango::quantized_vertex& v = vertices[i];
+        for (mango::int32 c = 0; c < 3; ++c)
+        {
+            float position = min_position[c] + scale[c] * static_cast<float>(v.position[c]) / 65535.0f;
+            EXPECT_NEAR(positions[i][c], position, scale[c] / 65535.0f);
+        }
+        EXPECT_EQ(0u, v.position[3]);
+
+        glm::vec3 normal = decode_octahedral(glm::unpackSnorm2x16(v.normal));
+        EXPECT_LT(glm::length(normal - normals[i]), 1e-3f) << "Normal " << i;
+
+        glm::vec2 texcoord = glm::unpackHalf2x16(v.texcoord);
+        EXPECT_NEAR(texcoords[i].x, texcoord.x, 4e-3f);
+        EXPECT_NEAR(texcoords[i].y, texcoord.y, 1e-3f);
+
+        glm::vec4 tangent = glm::unpackSnorm3x10_1x2(v.tangent);
+        EXPECT_LT(glm::length(glm::normalize(glm::vec3(tangent)) - glm::vec3(tangents[i])), 5e-3f) << "Tangent " << i;
+        EXPECT_EQ(tangents[i].w, tangent.w);
+    }
+}
+
+TEST_F(mesh_processing_test, quantize_vertices_missing_attributes_are_zero)
+{
+    std::vector<glm::vec3> positions = { glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f) };
+
+    // the bounds are flat in y and z.
+    std::vector<mango::quantized_vertex> vertices = mango::quantize_vertices(positions, {}, {}, {}, glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+
+    ASSERT_EQ(2u, vertices.size());
+    EXPECT_EQ(0u, vertices[0].position[0]);
+    EXPECT_EQ(65535u, vertices[1].position[0]);
+    for (const mango::quantized_vertex& v : vertices)
+    {
+        EXPECT_EQ(0u, v.position[1]);
+        EXPECT_EQ(0u, v.position[2]);
+        EXPECT_EQ(0u, v.normal);
+        EXPECT_EQ(0u, v.texcoord);
+        EXPECT_EQ(0u, v.tangent);
+    }
+}
+
+TEST_F(mesh_processing_test, optimize_overdraw_keeps_triangles_and_cache_order)
+{
+    create_grid(32, 0.2f);
+    mango::uint32 vertex_count = static_cast<mango::uint32>(m_positions.size());
+    mango::optimize_vertex_cache(m_indices, vertex_count);
+    std::vector<mango::uint32> indices = m_indices;
+
+    mango::optimize_overdraw(indices, m_positions, 1.05f);
+
+    // the result is a permutation of the input triangles.
+    std::vector<std::array<mango::uint32, 3>> input  = rotated_triangles(m_indices);
+    std::vector<std::array<mango::uint32, 3>> result = rotated_triangles(indices);
+    ASSERT_EQ(input.size(), result.size());
+    std::vector<std::array<mango::uint32, 3>> sorted_input  = input;
+    std::vector<std::array<mango::uint32, 3>> sorted_result = result;
+    std::sort(sorted_input.begin(), sorted_input.end());
+    std::sort(sorted_result.begin(), sorted_result.end());
+    EXPECT_EQ(sorted_input, sorted_result);
+
+    // clusters are moved as a whole, so the result consists of few continuous ranges of the input.
+    mango::uint32 ranges = 0;
+    mango::ptr_size last = input.size();
+    for (const std::array<mango::uint32, 3>& triangle : result)
+    {
+        mango::ptr_size position = static_cast<mango::ptr_size>(std::find(input.begin(), input.end(), triangle) - input.begin());
+        if (position != last + 1)
+            ++ranges;
+        last = position;
+    }
+    EXPECT_LT(ranges, result.size() / 4);
+    EXPECT_LE(mango::compute_acmr(indices, vertex_count, 16), 1.05f * mango::compute_acmr(m_indices, vertex_count, 16) + 0.05f);
+}
+
+TEST_F(mesh_processing_test, optimize_overdraw_draws_outward_clusters_first)
+{
+    // a small box facing inwards inside a large one facing outwards, the inner triangles come first in the input.
+    create_box(0.5f, true, 4);
+    mango::uint32 inner_vertices = static_cast<mango::uint32>(m_positions.size());
+    create_box(1.0f, false, 4);
+
+    mango::optimize_overdraw(m_indices, m_positions, 1.05f);
+
+    bool inner_reached = false;
+    for (mango::ptr_size i = 0; i < m_indices.size(); i += 3)
+    {
+        bool inner = m_indices[i] < inner_vertices;
+        if (inner)
+            inner_reached = true;
+        else
+            EXPECT_FALSE(inner_reached) << "Outward facing triangle " << i / 3 << " after an inward facing one.";
+    }
+    EXPECT_TRUE(inner_reached);
+}
+
+//! \endcond
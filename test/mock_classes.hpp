@@ -5,9 +5,12 @@
 //! \date      2020
 //! \copyright Apache License 2.0
 
+#include <algorithm>
 #include <core/context_impl.hpp>
 #include <core/input_system_impl.hpp>
 #include <gmock/gmock.h>
+#include <graphics/shader_program.hpp>
+#include <graphics/texture.hpp>
 #include <mango/mango.hpp>
 
 using ::testing::_;
@@ -68,3 +71,180 @@ class fake_input : public mango::input_system_impl
     MOCK_METHOD(void, hide_cursor, (bool hide), (override));
     //! \endcond
 };
+
+//! \brief A fake shader_program.
+//! \details Does not create any OpenGl objects. The uniforms are listed with the given types.
+//! Command buffers recording uniforms of other types than \a NONE for it can not be executed without an OpenGl context.
+class fake_shader_program : public mango::shader_program
+{
+  public:
+    //! \cond NO_DOC
+    fake_shader_program(mango::g_uint name, const std::vector<mango::shader_resource_type>& uniform_types)
+    {
+        m_name = name;
+        for (mango::shader_resource_type type : uniform_types)
+            m_bindings.listed_data.push_back({ type });
+    }
+    void use() override {}
+    const mango::uniform_binding_data& get_single_bindings() override
+    {
+        return m_bindings;
+    }
+    bool is_ready() override
+    {
+        return true;
+    }
+    void start_reload() override {}
+    bool is_reload_ready() override
+    {
+        return false;
+    }
+    bool finish_reload() override
+    {
+        return false;
+    }
+    const std::vector<mango::shader_ptr>& get_shaders() override
+    {
+        return m_shaders;
+    }
+
+  private:
+    mango::uniform_binding_data m_bindings;
+    std::vector<mango::shader_ptr> m_shaders;
+    //! \endcond
+};
+
+//! \brief A fake texture.
+//! \details Does not create any OpenGl objects. Keeps track of the resident levels of streamed data with four bytes per pixel.
+class fake_texture : public mango::texture
+{
+  public:
+    //! \cond NO_DOC
+    fake_texture(mango::uint32 mipmaps)
+        : m_width(0)
+        , m_height(0)
+        , m_mipmaps(mipmaps)
+        , m_streamed(false)
+        , m_resident_level(0)
+        , m_retired(false)
+        , m_released_storages(0)
+    {
+        m_name = 1;
+    }
+    mango::uint32 get_width() override
+    {
+        return m_width;
+    }
+    mango::uint32 get_height() override
+    {
+        return m_height;
+    }
+    mango::uint32 mipmaps() override
+    {
+        return m_mipmaps;
+    }
+    bool is_in_standard_color_space() override
+    {
+        return false;
+    }
+    mango::format get_format() override
+    {
+        return mango::format::RGBA;
+    }
+    mango::format get_internal_format() override
+    {
+        return mango::format::RGBA8;
+    }
+    mango::format component_type() override
+    {
+        return mango::format::UNSIGNED_BYTE;
+    }
+    mango::texture_parameter min_filter() override
+    {
+        return mango::texture_parameter::FILTER_LINEAR_MIPMAP_LINEAR;
+    }
+    mango::texture_parameter mag_filter() override
+    {
+        return mango::texture_parameter::FILTER_LINEAR;
+    }
+    mango::texture_parameter wrap_s() override
+    {
+        return mango::texture_parameter::WRAP_REPEAT;
+    }
+    mango::texture_parameter wrap_t() override
+    {
+        return mango::texture_parameter::WRAP_REPEAT;
+    }
+    bool is_cubemap() override
+    {
+        return false;
+    }
+    void set_data(mango::format, mango::uint32 width, mango::uint32 height, mango::format, mango::format, const void*) override
+    {
+        m_width          = width;
+        m_height         = height;
+        m_streamed       = false;
+        m_resident_level = 0;
+    }
+    void set_streamed_data(mango::format, mango::uint32 width, mango::uint32 height, mango::format, mango::format, const void*, mango::uint32 resident_level) override
+    {
+        m_width          = width;
+        m_height         = height;
+        m_streamed       = true;
+        m_resident_level = resident_level;
+        m_retired        = true;
+    }
+    bool is_streamed() override
+    {
+        return m_streamed;
+    }
+    mango::uint32 resident_level() override
+    {
+        return m_resident_level;
+    }
+    void set_resident_level(mango::uint32 level) override
+    {
+        m_resident_level = level;
+        m_retired        = true;
+    }
+    bool release_retired_storage() override
+    {
+        if (m_retired)
+            m_released_storages++;
+        m_retired = false;
+        return true;
+    }
+    mango::ptr_size level_memory(mango::uint32 level) override
+    {
+        mango::ptr_size memory = 0;
+        for (mango::uint32 l = level; l < m_mipmaps; ++l)
+            memory += static_cast<mango::ptr_size>(std::max(m_width >> l, 1u)) * std::max(m_height >> l, 1u) * 4;
+        return memory;
+    }
+    mango::g_uint64 get_bindless_handle(const mango::sampler_ptr&) override
+    {
+        return 0;
+    }
+    void bind_texture_unit(mango::g_uint) override {}
+    void unbind() override {}
+    void release() override {}
+
+    bool has_retired_storage()
+    {
+        return m_retired;
+    }
+    mango::uint32 released_storages()
+    {
+        return m_released_storages;
+    }
+
+  private:
+    mango::uint32 m_width;
+    mango::uint32 m_height;
+    mango::uint32 m_mipmaps;
+    bool m_streamed;
+    mango::uint32 m_resident_level;
+    bool m_retired;
+    mango::uint32 m_released_storages;
+    //! \endcond
+};
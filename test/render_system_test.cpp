@@ -5,8 +5,11 @@
 //! \copyright Apache License 2.0
 
 #include "mock_classes.hpp"
+#include <cstdio>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <mango/mango.hpp>
+#include <rendering/pipelines/deferred_pbr_render_system.hpp>
 #include <rendering/render_system_impl.hpp>
 
 //! \cond NO_DOC
@@ -40,4 +43,66 @@ TEST_F(render_system_test, render_system_no_failure_on_function_calls)
     ASSERT_NO_FATAL_FAILURE(m_render_system->destroy());
 }
 
+TEST_F(render_system_test, render_target_sizes_are_bucketed)
+{
+    using mango::deferred_pbr_render_system;
+    EXPECT_EQ(64u, deferred_pbr_render_system::get_render_target_size(0));
+    EXPECT_EQ(64u, deferred_pbr_render_system::get_render_target_size(64));
+    EXPECT_EQ(80u, deferred_pbr_render_system::get_render_target_size(65));
+    EXPECT_EQ(128u, deferred_pbr_render_system::get_render_target_size(128));
+    EXPECT_EQ(160u, deferred_pbr_render_system::get_render_target_size(129));
+    EXPECT_EQ(768u, deferred_pbr_render_system::get_render_target_size(720));
+    EXPECT_EQ(1280u, deferred_pbr_render_system::get_render_target_size(1080));
+    EXPECT_EQ(1280u, deferred_pbr_render_system::get_render_target_size(1280));
+    EXPECT_EQ(2048u, deferred_pbr_render_system::get_render_target_size(1920));
+    EXPECT_EQ(4096u, deferred_pbr_render_system::get_render_target_size(3840));
+
+    // every viewport above 64 pixels uses at least 80% of its target, slightly larger viewports never get a smaller one.
+    mango::uint32 last = 64;
+    for (mango::uint32 size = 65; size <= 8192; ++size)
+    {
+        mango::uint32 target = deferred_pbr_render_system::get_render_target_size(size);
+        EXPECT_GE(target, size);
+        EXPECT_LE(target * 4, size * 5) << "Size " << size;
+        EXPECT_GE(target, last);
+        last = target;
+    }
+}
+
+#if defined(MANGO_HEADLESS)
+TEST_F(render_system_test, headless_render_system_renders_frames)
+{
+    // the headless window system creates a real OpenGl context, so the complete pipeline runs without a display.
+    auto application   = std::make_shared<fake_application>();
+    auto mango_context = application->get_context().lock();
+    ASSERT_NE(nullptr, mango_context);
+    mango::window_configuration window_config(128, 128, "Test");
+    ASSERT_NO_FATAL_FAILURE(mango_context->get_window_system().lock()->configure(window_config));
+    mango::render_configuration render_config(mango::render_pipeline::deferred_pbr, false);
+    ASSERT_NO_FATAL_FAILURE(mango_context->get_render_system().lock()->configure(render_config));
+
+    auto test_scene = std::make_shared<mango::scene>("headless_test_scene");
+    mango_context->register_scene(test_scene);
+    test_scene->create_default_camera();
+    mango_context->make_scene_current(test_scene);
+
+    const char* screenshot = "headless_render_system_test.png";
+    char arg_0[]           = "AllTests";
+    char arg_1[]           = "--frames";
+    char arg_2[]           = "3";
+    char arg_3[]           = "--screenshot";
+    char arg_4[]           = "headless_render_system_test.png";
+    char* argv[]           = { arg_0, arg_1, arg_2, arg_3, arg_4 };
+
+    EXPECT_CALL(*application, update(_)).Times(3);
+    ASSERT_EQ(0u, application->run(5, argv));
+
+    std::ifstream written(screenshot, std::ios::in | std::ios::binary | std::ios::ate);
+    ASSERT_TRUE(written.is_open());
+    EXPECT_GT(written.tellg(), 0);
+    written.close();
+    std::remove(screenshot);
+}
+#endif // MANGO_HEADLESS
+
 //! \endcond
@@ -0,0 +1,99 @@
+//! \file      shader_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include <cstdio>
+#include <fstream>
+#include <graphics/impl/shader_impl.hpp>
+#include <gtest/gtest.h>
+
+//! \cond NO_DOC
+
+class shader_test : public ::testing::Test
+{
+  protected:
+    shader_test() {}
+
+    ~shader_test() override {}
+
+    void SetUp() override
+    {
+        write_file("./shader_test_main.glsl", "#version 430 core\n#include \"shader_test_common.glsl\"\n#include \"shader_test_common.glsl\"\nvoid main() { value(); }\n");
+        write_file("./shader_test_common.glsl", "#include \"shader_test_constants.glsl\"\nfloat value() { return PI; }\n");
+        write_file("./shader_test_constants.glsl", "#define PI 3.14\n");
+        write_file("./shader_test_invalid.glsl", "#version 430 core\n#include shader_test_common.glsl\n");
+        write_file("./shader_test_missing.glsl", "#version 430 core\n  #include \"shader_test_not_there.glsl\"\n");
+    }
+
+    void TearDown() override
+    {
+        for (const char* file : { "./shader_test_main.glsl", "./shader_test_common.glsl", "./shader_test_constants.glsl", "./shader_test_invalid.glsl", "./shader_test_missing.glsl" })
+            std::remove(file);
+    }
+
+    void write_file(const char* path, const char* content)
+    {
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        file << content;
+    }
+};
+
+TEST_F(shader_test, preprocess_resolves_includes_once)
+{
+    mango::string source;
+    std::vector<mango::string> included_files;
+
+    ASSERT_TRUE(mango::shader_impl::preprocess("./shader_test_main.glsl", 0, {}, source, included_files));
+
+    // every include starts with line 1 of its own source number, the including file continues after the directive.
+    EXPECT_EQ("#version 430 core\n"
+              "#line 1 1\n"
+              "#line 1 2\n"
+              "#define PI 3.14\n"
+              "#line 2 1\n"
+              "float value() { return PI; }\n"
+              "#line 3 0\n"
+              "#line 4 0\n"
+              "void main() { value(); }\n",
+              source);
+    ASSERT_EQ(2u, included_files.size());
+    EXPECT_EQ("./shader_test_common.glsl", included_files[0]);
+    EXPECT_EQ("./shader_test_constants.glsl", included_files[1]);
+}
+
+TEST_F(shader_test, preprocess_adds_defines_after_version)
+{
+    mango::string source;
+    std::vector<mango::string> included_files;
+    std::vector<mango::shader_define> defines = { { "MAX_LIGHTS", "4" }, { "QUANTIZED", "" } };
+
+    ASSERT_TRUE(mango::shader_impl::preprocess("./shader_test_main.glsl", 0, defines, source, included_files));
+
+    mango::string expected_start = "#version 430 core\n"
+                                   "#define MAX_LIGHTS 4\n"
+                                   "#define QUANTIZED \n"
+                                   "#line 2 0\n"
+                                   "#line 1 1\n";
+    EXPECT_EQ(expected_start, source.substr(0, expected_start.size()));
+    // includes do not get the definitions again.
+    EXPECT_EQ(mango::string::npos, source.find("#define MAX_LIGHTS", expected_start.size()));
+}
+
+TEST_F(shader_test, preprocess_fails_on_invalid_includes)
+{
+    mango::string source;
+    std::vector<mango::string> included_files;
+    EXPECT_FALSE(mango::shader_impl::preprocess("./shader_test_invalid.glsl", 0, {}, source, included_files));
+
+    source.clear();
+    included_files.clear();
+    EXPECT_FALSE(mango::shader_impl::preprocess("./shader_test_missing.glsl", 0, {}, source, included_files));
+
+    source.clear();
+    included_files.clear();
+    EXPECT_FALSE(mango::shader_impl::preprocess("./shader_test_not_there.glsl", 0, {}, source, included_files));
+}
+
+//! \endcond
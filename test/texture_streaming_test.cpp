@@ -0,0 +1,149 @@
+//! \file      texture_streaming_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include "mock_classes.hpp"
+#include <gtest/gtest.h>
+#include <rendering/texture_streaming.hpp>
+
+//! \cond NO_DOC
+
+class texture_streaming_test : public ::testing::Test
+{
+  protected:
+    texture_streaming_test() {}
+
+    ~texture_streaming_test() override {}
+
+    void SetUp() override {}
+
+    void TearDown() override
+    {
+        m_streaming.reset();
+    }
+
+    // a 256 x 256 texture with a complete mipmap chain, the levels up to 64 x 64 pixels are always resident.
+    mango::shared_ptr<fake_texture> add_texture()
+    {
+        auto tex = std::make_shared<fake_texture>(size_levels);
+        m_streaming->add_texture(tex, mango::format::RGBA8, size, size, mango::format::RGBA, mango::format::UNSIGNED_BYTE, nullptr);
+        return tex;
+    }
+
+    const mango::uint32 size        = 256;
+    const mango::uint32 size_levels = 9;
+    const mango::uint32 base_level  = 2;
+
+    mango::shared_ptr<mango::texture_streaming> m_streaming;
+};
+
+TEST_F(texture_streaming_test, textures_start_with_base_levels)
+{
+    m_streaming = std::make_shared<mango::texture_streaming>(1024 * 1024);
+    auto tex    = add_texture();
+
+    EXPECT_TRUE(tex->is_streamed());
+    EXPECT_EQ(base_level, tex->resident_level());
+    // the initial storage is released immediately.
+    EXPECT_FALSE(tex->has_retired_storage());
+
+    m_streaming->update();
+    const mango::texture_streaming_statistics& statistics = m_streaming->get_statistics();
+    EXPECT_EQ(1u, statistics.streamed_textures);
+    EXPECT_EQ(size_levels - base_level, statistics.resident_levels);
+    EXPECT_EQ(size_levels, statistics.total_levels);
+    EXPECT_EQ(tex->level_memory(base_level), statistics.resident_memory);
+}
+
+TEST_F(texture_streaming_test, requested_levels_are_made_resident)
+{
+    m_streaming = std::make_shared<mango::texture_streaming>(1024 * 1024);
+    auto tex    = add_texture();
+    m_streaming->update();
+
+    // a footprint of a quarter of the size needs level 2, a footprint of the size level 0.
+    m_streaming->request(tex, static_cast<float>(size / 4));
+    m_streaming->request(tex, static_cast<float>(size));
+    m_streaming->update();
+
+    EXPECT_EQ(0u, tex->resident_level());
+    EXPECT_EQ(base_level, m_streaming->get_statistics().uploaded_levels);
+    EXPECT_EQ(tex->level_memory(0), m_streaming->get_statistics().resident_memory);
+
+    // the replaced storage is still used by the last frame and released one update later.
+    mango::uint32 released = tex->released_storages();
+    EXPECT_TRUE(tex->has_retired_storage());
+    m_streaming->update();
+    EXPECT_FALSE(tex->has_retired_storage());
+    EXPECT_EQ(released + 1, tex->released_storages());
+}
+
+TEST_F(texture_streaming_test, least_recently_used_textures_are_evicted)
+{
+    // two complete textures and the base levels of a third one fit in the budget.
+    auto probe = std::make_shared<fake_texture>(size_levels);
+    probe->set_data(mango::format::RGBA8, size, size, mango::format::RGBA, mango::format::UNSIGNED_BYTE, nullptr);
+    m_streaming = std::make_shared<mango::texture_streaming>(2 * probe->level_memory(0) + probe->level_memory(base_level));
+
+    auto first  = add_texture();
+    auto second = add_texture();
+    auto third  = add_texture();
+
+    m_streaming->request(first, static_cast<float>(size));
+    m_streaming->request(second, static_cast<float>(size));
+    m_streaming->update();
+    EXPECT_EQ(0u, first->resident_level());
+    EXPECT_EQ(0u, second->resident_level());
+
+    m_streaming->request(first, static_cast<float>(size));
+    m_streaming->update();
+
+    // the second texture was requested less recently than the first one.
+    m_streaming->request(third, static_cast<float>(size));
+    m_streaming->update();
+    EXPECT_EQ(0u, first->resident_level());
+    EXPECT_EQ(base_level, second->resident_level());
+    EXPECT_EQ(0u, third->resident_level());
+    EXPECT_EQ(base_level, m_streaming->get_statistics().evicted_levels);
+    EXPECT_LE(m_streaming->get_statistics().resident_memory, m_streaming->get_statistics().memory_budget);
+}
+
+TEST_F(texture_streaming_test, requests_over_budget_are_starved)
+{
+    auto probe = std::make_shared<fake_texture>(size_levels);
+    probe->set_data(mango::format::RGBA8, size, size, mango::format::RGBA, mango::format::UNSIGNED_BYTE, nullptr);
+    m_streaming = std::make_shared<mango::texture_streaming>(probe->level_memory(0) + probe->level_memory(base_level));
+
+    auto first  = add_texture();
+    auto second = add_texture();
+
+    // both requested textures keep their levels, so the second one can not get more.
+    m_streaming->request(first, static_cast<float>(size));
+    m_streaming->update();
+    m_streaming->request(first, static_cast<float>(size));
+    m_streaming->request(second, static_cast<float>(size));
+    m_streaming->update();
+
+    EXPECT_EQ(0u, first->resident_level());
+    EXPECT_EQ(base_level, second->resident_level());
+    EXPECT_EQ(1u, m_streaming->get_statistics().starved_textures);
+    EXPECT_LE(m_streaming->get_statistics().resident_memory, m_streaming->get_statistics().memory_budget);
+}
+
+TEST_F(texture_streaming_test, released_textures_free_memory)
+{
+    m_streaming = std::make_shared<mango::texture_streaming>(1024 * 1024);
+    auto tex    = add_texture();
+    m_streaming->request(tex, static_cast<float>(size));
+    m_streaming->update();
+    ASSERT_EQ(tex->level_memory(0), m_streaming->get_statistics().resident_memory);
+
+    tex.reset();
+    m_streaming->update();
+    EXPECT_EQ(0u, m_streaming->get_statistics().streamed_textures);
+    EXPECT_EQ(0u, m_streaming->get_statistics().resident_memory);
+}
+
+//! \endcond
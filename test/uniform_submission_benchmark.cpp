@@ -0,0 +1,59 @@
+//! \file      uniform_submission_benchmark.cpp
+//! Measures recording and executing single uniforms. Not part of the unit tests.
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include "mock_classes.hpp"
+#include <chrono>
+#include <cstdio>
+#include <graphics/command_buffer.hpp>
+
+//! \cond NO_DOC
+
+int main()
+{
+    const mango::uint32 uniform_count = 6;
+    const mango::uint32 rounds        = 8;
+    const mango::uint32 frames        = 20000;
+
+    // the uniforms have the type NONE, so nothing is uploaded and no OpenGl context is required.
+    // the timings cover recording, state tracking and the binding lookup.
+    auto command_buffer = mango::command_buffer::create();
+    auto program        = std::make_shared<fake_shader_program>(1, std::vector<mango::shader_resource_type>(uniform_count, mango::shader_resource_type::NONE));
+
+    using clock = std::chrono::high_resolution_clock;
+    clock::duration record_time(0);
+    clock::duration execute_time(0);
+    float value[16] = { 0.0f };
+
+    // every frame binds the program and records rounds * uniform_count changing values, so none of them is elided.
+    for (mango::uint32 f = 0; f < frames; ++f)
+    {
+        clock::time_point start = clock::now();
+        command_buffer->bind_shader_program(program);
+        for (mango::uint32 r = 0; r < rounds; ++r)
+        {
+            for (mango::uint32 location = 0; location < uniform_count; ++location)
+            {
+                value[0] += 1.0f;
+                command_buffer->bind_single_uniform(location, value, static_cast<mango::g_intptr>(sizeof(float) * (1 + location % 4)));
+            }
+        }
+        clock::time_point recorded = clock::now();
+        command_buffer->execute();
+        clock::time_point executed = clock::now();
+
+        record_time += recorded - start;
+        execute_time += executed - recorded;
+    }
+
+    const double uniforms   = static_cast<double>(frames) * rounds * uniform_count;
+    const double record_ns  = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(record_time).count()) / uniforms;
+    const double execute_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(execute_time).count()) / uniforms;
+    std::printf("Single uniforms: record %.1f ns, execute %.1f ns per uniform.\n", record_ns, execute_ns);
+    return 0;
+}
+
+//! \endcond
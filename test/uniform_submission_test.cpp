@@ -0,0 +1,139 @@
+//! \file      uniform_submission_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2020
+//! \copyright Apache License 2.0
+
+#include "mock_classes.hpp"
+#include <graphics/command_buffer.hpp>
+#include <gtest/gtest.h>
+
+//! \cond NO_DOC
+
+class uniform_submission_test : public ::testing::Test
+{
+  protected:
+    uniform_submission_test() {}
+
+    ~uniform_submission_test() override {}
+
+    void SetUp() override
+    {
+        std::vector<mango::shader_resource_type> types = { mango::shader_resource_type::MAT4, mango::shader_resource_type::FVEC4, mango::shader_resource_type::FLOAT,
+                                                           mango::shader_resource_type::INT };
+        m_command_buffer = mango::command_buffer::create();
+        m_program        = std::make_shared<fake_shader_program>(1, types);
+        m_other_program  = std::make_shared<fake_shader_program>(2, types);
+    }
+
+    void TearDown() override
+    {
+        // the recorded uniforms are not executed, that would require an OpenGl context.
+        m_command_buffer.reset();
+        m_program.reset();
+        m_other_program.reset();
+    }
+
+    // binds the program and resets the change counters, so only the uniforms are counted.
+    void bind_program(const mango::shader_program_ptr& program)
+    {
+        m_command_buffer->bind_shader_program(program);
+        reset_counters();
+    }
+
+    void reset_counters()
+    {
+        m_command_buffer->get_state().m_change_counters.issued = 0;
+        m_command_buffer->get_state().m_change_counters.elided = 0;
+    }
+
+    // submits one value for each uniform of the fake programs.
+    void submit_uniforms(float value)
+    {
+        glm::mat4 matrix     = glm::mat4(value);
+        glm::vec4 vector     = glm::vec4(value);
+        mango::int32 integer = static_cast<mango::int32>(value);
+        m_command_buffer->bind_single_uniform(0, &matrix, sizeof(glm::mat4));
+        m_command_buffer->bind_single_uniform(1, &vector, sizeof(glm::vec4));
+        m_command_buffer->bind_single_uniform(2, &value, sizeof(float));
+        m_command_buffer->bind_single_uniform(3, &integer, sizeof(mango::int32));
+    }
+
+    mango::uint32 issued()
+    {
+        return m_command_buffer->get_state().m_change_counters.issued;
+    }
+
+    mango::uint32 elided()
+    {
+        return m_command_buffer->get_state().m_change_counters.elided;
+    }
+
+    mango::command_buffer_ptr m_command_buffer;
+    mango::shared_ptr<fake_shader_program> m_program;
+    mango::shared_ptr<fake_shader_program> m_other_program;
+};
+
+TEST_F(uniform_submission_test, identical_uniforms_are_elided)
+{
+    bind_program(m_program);
+
+    submit_uniforms(1.0f);
+    EXPECT_EQ(4u, issued());
+    EXPECT_EQ(0u, elided());
+
+    // the same values are not uploaded again, also not in later frames.
+    for (mango::uint32 frame = 0; frame < 3; ++frame)
+    {
+        reset_counters();
+        submit_uniforms(1.0f);
+        EXPECT_EQ(0u, issued());
+        EXPECT_EQ(4u, elided());
+    }
+
+    reset_counters();
+    submit_uniforms(2.0f);
+    EXPECT_EQ(4u, issued());
+    EXPECT_EQ(0u, elided());
+}
+
+TEST_F(uniform_submission_test, changed_uniforms_are_issued)
+{
+    bind_program(m_program);
+    submit_uniforms(1.0f);
+    reset_counters();
+
+    // only the changed value is uploaded.
+    glm::vec4 vector = glm::vec4(1.0f, 2.0f, 1.0f, 1.0f);
+    m_command_buffer->bind_single_uniform(1, &vector, sizeof(glm::vec4));
+    submit_uniforms(1.0f);
+    EXPECT_EQ(2u, issued());
+    EXPECT_EQ(3u, elided());
+
+    // a value with a different size is never elided.
+    reset_counters();
+    glm::vec2 smaller = glm::vec2(1.0f);
+    m_command_buffer->bind_single_uniform(1, &smaller, sizeof(glm::vec2));
+    EXPECT_EQ(1u, issued());
+    EXPECT_EQ(0u, elided());
+}
+
+TEST_F(uniform_submission_test, uniforms_are_tracked_per_program)
+{
+    bind_program(m_program);
+    submit_uniforms(1.0f);
+
+    // the other program does not have the values yet.
+    bind_program(m_other_program);
+    submit_uniforms(1.0f);
+    EXPECT_EQ(4u, issued());
+    EXPECT_EQ(0u, elided());
+
+    // uniforms are part of the program state, so switching back keeps them.
+    bind_program(m_program);
+    submit_uniforms(1.0f);
+    EXPECT_EQ(0u, issued());
+    EXPECT_EQ(4u, elided());
+}
+
+//! \endcond